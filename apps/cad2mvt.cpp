@@ -0,0 +1,185 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+#include "opencad_api.h"
+#include "cadvectortilewriter.h"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+static int Usage(const char* pszErrorMsg = nullptr)
+{
+    cout << "Usage: cad2mvt [--minzoom z][--maxzoom z][--extent n][--buffer n]\n"
+            "               [--simplification v][--tolerance v][--threads n][--flat]\n"
+            "               [--help][--version] file_name output\n"
+            "Writes Mapbox Vector Tiles to output/z/x/y.mvt, or to one output file\n"
+            "with --flat." << endl;
+
+    if( pszErrorMsg != nullptr )
+    {
+        cerr << endl << "FAILURE: " << pszErrorMsg << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int Version()
+{
+    cout << "cad2mvt was compiled against libopencad "
+         << OCAD_VERSION << endl
+              << "and is running against libopencad "
+         << GetVersionString() << endl;
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    if( argc < 1 )
+       return -argc;
+    else if(argc == 1)
+        return Usage();
+
+    int nMinZoom = 0;
+    int nMaxZoom = 10;
+    int nExtent = -1;
+    int nBuffer = -1;
+    int nThreads = 0;
+    double dfSimplification = -1.0;
+    double dfTolerance = -1.0;
+    bool bFlat = false;
+    const char *pszCADFilePath = nullptr;
+    const char *pszOutputPath = nullptr;
+
+    for( int iArg = 1; iArg < argc; ++iArg)
+    {
+        if (strcmp(argv[iArg],"-h")==0 || strcmp(argv[iArg],"--help")==0)
+        {
+            return Usage();
+        }
+        else if(strcmp(argv[iArg],"-v")==0 || strcmp(argv[iArg],"--version")==0)
+        {
+            return Version();
+        }
+        else if(strcmp(argv[iArg],"--flat")==0)
+        {
+            bFlat = true;
+        }
+        else if(strcmp(argv[iArg],"--minzoom")==0 || strcmp(argv[iArg],"--maxzoom")==0 ||
+                strcmp(argv[iArg],"--extent")==0 || strcmp(argv[iArg],"--buffer")==0 ||
+                strcmp(argv[iArg],"--threads")==0 || strcmp(argv[iArg],"--simplification")==0 ||
+                strcmp(argv[iArg],"--tolerance")==0)
+        {
+            if( iArg + 1 == argc )
+                return Usage("Option needs a value");
+            const char *pszOption = argv[iArg++];
+            if(strcmp(pszOption,"--minzoom")==0)
+                nMinZoom = atoi(argv[iArg]);
+            else if(strcmp(pszOption,"--maxzoom")==0)
+                nMaxZoom = atoi(argv[iArg]);
+            else if(strcmp(pszOption,"--extent")==0)
+                nExtent = atoi(argv[iArg]);
+            else if(strcmp(pszOption,"--buffer")==0)
+                nBuffer = atoi(argv[iArg]);
+            else if(strcmp(pszOption,"--threads")==0)
+                nThreads = atoi(argv[iArg]);
+            else if(strcmp(pszOption,"--simplification")==0)
+                dfSimplification = atof(argv[iArg]);
+            else
+                dfTolerance = atof(argv[iArg]);
+        }
+        else if(pszCADFilePath == nullptr)
+        {
+            pszCADFilePath = argv[iArg];
+        }
+        else
+        {
+            pszOutputPath = argv[iArg];
+        }
+    }
+
+    if( pszCADFilePath == nullptr )
+        return Usage("No input file");
+    if( pszOutputPath == nullptr )
+        return Usage("No output");
+
+    unique_ptr<CADFile> poCADFile( OpenCADFile( pszCADFilePath, CADFile::OpenOptions::READ_FASTEST ) );
+    if( poCADFile == nullptr )
+    {
+        cerr << "Open CAD file " << pszCADFilePath << " failed." << endl;
+        return EXIT_FAILURE;
+    }
+
+    CADVectorTileWriter oWriter( nThreads > 0 ? nThreads : 0 );
+    oWriter.setZoomRange( nMinZoom, nMaxZoom );
+    if( nExtent > 0 )
+        oWriter.setExtent( nExtent );
+    if( nBuffer >= 0 )
+        oWriter.setBuffer( nBuffer );
+    if( dfSimplification >= 0.0 )
+        oWriter.setSimplification( dfSimplification );
+    if( dfTolerance >= 0.0 )
+        oWriter.getTessellator().setTolerance( dfTolerance );
+    oWriter.addFile( *poCADFile );
+
+    size_t nCount;
+    if( bFlat )
+    {
+        ofstream oFile( pszOutputPath, ios::out | ios::binary );
+        if( !oFile )
+        {
+            cerr << "Create output file " << pszOutputPath << " failed." << endl;
+            return EXIT_FAILURE;
+        }
+        nCount = oWriter.writeFlatFile( oFile );
+        if( !oFile )
+            nCount = 0;
+    }
+    else
+    {
+        nCount = oWriter.writeDirectory( pszOutputPath );
+    }
+
+    if( nCount == 0 )
+    {
+        cerr << "Write failed or no tiles." << endl;
+        return EXIT_FAILURE;
+    }
+    cout << nCount << " tiles written." << endl;
+
+    return EXIT_SUCCESS;
+}
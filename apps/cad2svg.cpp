@@ -0,0 +1,149 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+#include "opencad_api.h"
+#include "cadsvgwriter.h"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+static int Usage(const char* pszErrorMsg = nullptr)
+{
+    cout << "Usage: cad2svg [--precision digits][--tolerance value][--help][--version]\n"
+            "               file_name [output_file]\n"
+            "Writes SVG with group per layer to output_file or to standard output." << endl;
+
+    if( pszErrorMsg != nullptr )
+    {
+        cerr << endl << "FAILURE: " << pszErrorMsg << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int Version()
+{
+    cout << "cad2svg was compiled against libopencad "
+         << OCAD_VERSION << endl
+              << "and is running against libopencad "
+         << GetVersionString() << endl;
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    if( argc < 1 )
+       return -argc;
+    else if(argc == 1)
+        return Usage();
+
+    int nPrecision = 3;
+    double dfTolerance = -1.0;
+    const char *pszCADFilePath = nullptr;
+    const char *pszOutputPath = nullptr;
+
+    for( int iArg = 1; iArg < argc; ++iArg)
+    {
+        if (strcmp(argv[iArg],"-h")==0 || strcmp(argv[iArg],"--help")==0)
+        {
+            return Usage();
+        }
+        else if(strcmp(argv[iArg],"-v")==0 || strcmp(argv[iArg],"--version")==0)
+        {
+            return Version();
+        }
+        else if(strcmp(argv[iArg],"--precision")==0)
+        {
+            if( iArg + 1 == argc )
+                return Usage("--precision needs a value");
+            nPrecision = atoi(argv[++iArg]);
+        }
+        else if(strcmp(argv[iArg],"--tolerance")==0)
+        {
+            if( iArg + 1 == argc )
+                return Usage("--tolerance needs a value");
+            dfTolerance = atof(argv[++iArg]);
+        }
+        else if(pszCADFilePath == nullptr)
+        {
+            pszCADFilePath = argv[iArg];
+        }
+        else
+        {
+            pszOutputPath = argv[iArg];
+        }
+    }
+
+    if( pszCADFilePath == nullptr )
+        return Usage("No input file");
+
+    unique_ptr<CADFile> poCADFile( OpenCADFile( pszCADFilePath, CADFile::OpenOptions::READ_FASTEST ) );
+    if( poCADFile == nullptr )
+    {
+        cerr << "Open CAD file " << pszCADFilePath << " failed." << endl;
+        return EXIT_FAILURE;
+    }
+
+    ofstream oFile;
+    if( pszOutputPath != nullptr )
+    {
+        oFile.open( pszOutputPath, ios::out | ios::binary );
+        if( !oFile )
+        {
+            cerr << "Create output file " << pszOutputPath << " failed." << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    ostream& oOutput = pszOutputPath != nullptr ? static_cast<ostream&>( oFile ) : cout;
+
+    CADSVGWriter oWriter( oOutput, nPrecision );
+    if( dfTolerance >= 0.0 )
+        oWriter.getTessellator().setTolerance( dfTolerance );
+    size_t nCount = oWriter.writeFile( *poCADFile );
+    oWriter.finish();
+
+    if( !oOutput )
+    {
+        cerr << "Write failed." << endl;
+        return EXIT_FAILURE;
+    }
+    if( pszOutputPath != nullptr )
+        cout << nCount << " geometries written." << endl;
+
+    return EXIT_SUCCESS;
+}
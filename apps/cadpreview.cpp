@@ -0,0 +1,199 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+#include "opencad_api.h"
+#include "cadrasterizer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+static int Usage(const char* pszErrorMsg = nullptr)
+{
+    cout << "Usage: cadpreview [--width n][--height n][--layer name]...[--layer-color]\n"
+            "                  [--line-width v][--black][--tolerance v][--threads n]\n"
+            "                  [--help][--version] file_name output\n"
+            "Renders the drawing to a PNG image, or to PPM if output ends with .ppm.\n"
+            "All visible layers are drawn unless --layer is given." << endl;
+
+    if( pszErrorMsg != nullptr )
+    {
+        cerr << endl << "FAILURE: " << pszErrorMsg << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int Version()
+{
+    cout << "cadpreview was compiled against libopencad "
+         << OCAD_VERSION << endl
+              << "and is running against libopencad "
+         << GetVersionString() << endl;
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    if( argc < 1 )
+       return -argc;
+    else if(argc == 1)
+        return Usage();
+
+    int nWidth = 1024;
+    int nHeight = 768;
+    vector<string> aosLayers;
+    bool bLayerColor = false;
+    bool bBlack = false;
+    double dfLineWidth = 1.0;
+    double dfTolerance = -1.0;
+    int nThreads = 0;
+    const char *pszCADFilePath = nullptr;
+    const char *pszOutputPath = nullptr;
+
+    for( int iArg = 1; iArg < argc; ++iArg)
+    {
+        bool bHasValue = iArg + 1 < argc;
+        if (strcmp(argv[iArg],"-h")==0 || strcmp(argv[iArg],"--help")==0)
+        {
+            return Usage();
+        }
+        else if(strcmp(argv[iArg],"-v")==0 || strcmp(argv[iArg],"--version")==0)
+        {
+            return Version();
+        }
+        else if(strcmp(argv[iArg],"--width")==0 && bHasValue)
+        {
+            nWidth = atoi(argv[++iArg]);
+        }
+        else if(strcmp(argv[iArg],"--height")==0 && bHasValue)
+        {
+            nHeight = atoi(argv[++iArg]);
+        }
+        else if(strcmp(argv[iArg],"--layer")==0 && bHasValue)
+        {
+            aosLayers.push_back(argv[++iArg]);
+        }
+        else if(strcmp(argv[iArg],"--layer-color")==0)
+        {
+            bLayerColor = true;
+        }
+        else if(strcmp(argv[iArg],"--black")==0)
+        {
+            bBlack = true;
+        }
+        else if(strcmp(argv[iArg],"--line-width")==0 && bHasValue)
+        {
+            dfLineWidth = atof(argv[++iArg]);
+        }
+        else if(strcmp(argv[iArg],"--tolerance")==0 && bHasValue)
+        {
+            dfTolerance = atof(argv[++iArg]);
+        }
+        else if(strcmp(argv[iArg],"--threads")==0 && bHasValue)
+        {
+            nThreads = atoi(argv[++iArg]);
+        }
+        else if(strncmp(argv[iArg],"--",2)==0)
+        {
+            return Usage("Unknown option or missing value");
+        }
+        else if(pszCADFilePath == nullptr)
+        {
+            pszCADFilePath = argv[iArg];
+        }
+        else
+        {
+            pszOutputPath = argv[iArg];
+        }
+    }
+
+    if( pszCADFilePath == nullptr || pszOutputPath == nullptr )
+        return Usage("No input file or output");
+    if( nWidth <= 0 || nHeight <= 0 || nThreads < 0 )
+        return Usage("Wrong image size or thread count");
+
+    unique_ptr<CADFile> poCADFile( OpenCADFile( pszCADFilePath, CADFile::OpenOptions::READ_FASTEST ) );
+    if( poCADFile == nullptr )
+    {
+        cerr << "Open CAD file " << pszCADFilePath << " failed." << endl;
+        return EXIT_FAILURE;
+    }
+
+    CADRasterizer oRasterizer( static_cast<unsigned>( nThreads ) );
+    if( dfTolerance > 0.0 )
+        oRasterizer.getTessellator().setTolerance( dfTolerance );
+    if( bBlack )
+    {
+        RGBColor stBlack = { 0, 0, 0 };
+        oRasterizer.setBackground( stBlack );
+    }
+    oRasterizer.setColorMode( bLayerColor ? CADRasterizer::LAYER_COLOR : CADRasterizer::ENTITY_COLOR );
+    oRasterizer.setLineWidth( dfLineWidth );
+
+    size_t nCount = 0;
+    for( size_t i = 0; i < poCADFile->GetLayersCount(); ++i )
+    {
+        CADLayer& oLayer = poCADFile->GetLayer( i );
+        if( aosLayers.empty() ||
+            find( aosLayers.begin(), aosLayers.end(), oLayer.getName() ) != aosLayers.end() )
+            nCount += oRasterizer.addLayer( oLayer );
+    }
+
+    vector<uint8_t> abyImage;
+    oRasterizer.render( static_cast<unsigned>( nWidth ), static_cast<unsigned>( nHeight ), abyImage );
+
+    ofstream oFile( pszOutputPath, ios::out | ios::binary );
+    if( !oFile )
+    {
+        cerr << "Create output file " << pszOutputPath << " failed." << endl;
+        return EXIT_FAILURE;
+    }
+    size_t nPathLength = strlen( pszOutputPath );
+    bool bPPM = nPathLength > 4 && strcmp( pszOutputPath + nPathLength - 4, ".ppm" ) == 0;
+    bool bResult = bPPM ? CADRasterizer::writePPM( oFile, abyImage, nWidth, nHeight )
+                        : CADRasterizer::writePNG( oFile, abyImage, nWidth, nHeight );
+    if( !bResult )
+    {
+        cerr << "Write failed." << endl;
+        return EXIT_FAILURE;
+    }
+    cout << nCount << " geometries drawn." << endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,246 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+*******************************************************************************/
+#include "cadcachedfileio.h"
+
+#include <algorithm>
+#include <cstring>
+
+CADCachedFileIO::CADCachedFileIO( CADFileIO * poFileIO, size_t nPageSize, size_t nMaxPages, size_t nMaxReadAhead ) :
+    CADFileIO( poFileIO->GetFilePath() ),
+    m_poFileIO( poFileIO ),
+    m_nPageSize( std::max( nPageSize, static_cast<size_t>( 1 ) ) ),
+    m_nMaxPages( std::max( nMaxPages, static_cast<size_t>( 1 ) ) ),
+    m_nMaxReadAhead( std::max( std::min( nMaxReadAhead, m_nMaxPages ), static_cast<size_t>( 1 ) ) ),
+    m_nPosition( 0 ),
+    m_nFileSize( -1 ),
+    m_nLastMissedPage( -2 ),
+    m_nReadAhead( 1 ),
+    m_nHits( 0 ),
+    m_nMisses( 0 )
+{
+}
+
+CADCachedFileIO::~CADCachedFileIO()
+{
+    delete m_poFileIO;
+}
+
+const char * CADCachedFileIO::ReadLine()
+{
+    return ReadLineByBlocks();
+}
+
+bool CADCachedFileIO::Eof()
+{
+    return m_nPosition >= GetFileSize();
+}
+
+bool CADCachedFileIO::Open( int mode )
+{
+    if( !m_poFileIO->IsOpened() )
+        m_poFileIO->Open( mode );
+
+    ClearCache();
+    m_nPosition = 0;
+    m_nFileSize = -1;
+
+    return IsOpened();
+}
+
+bool CADCachedFileIO::IsOpened() const
+{
+    return m_poFileIO->IsOpened();
+}
+
+bool CADCachedFileIO::Close()
+{
+    ClearCache();
+    m_poFileIO->Close();
+    return CADFileIO::Close();
+}
+
+int CADCachedFileIO::Seek( long offset, CADFileIO::SeekOrigin origin )
+{
+    long nNewPosition = 0;
+    switch( origin )
+    {
+        case SeekOrigin::CUR:
+            nNewPosition = m_nPosition + offset;
+            break;
+        case SeekOrigin::END:
+            nNewPosition = GetFileSize() + offset;
+            break;
+        case SeekOrigin::BEG:
+            nNewPosition = offset;
+            break;
+    }
+
+    if( nNewPosition < 0 )
+        return 1;
+
+    m_nPosition = nNewPosition;
+    return 0;
+}
+
+long CADCachedFileIO::Tell()
+{
+    return m_nPosition;
+}
+
+size_t CADCachedFileIO::Read( void * ptr, size_t size )
+{
+    char * pabyOutput = static_cast<char *>( ptr );
+    size_t nReaded    = 0;
+    while( nReaded < size )
+    {
+        long               nPageIndex    = m_nPosition / static_cast<long>( m_nPageSize );
+        size_t             nOffsetInPage = static_cast<size_t>( m_nPosition ) % m_nPageSize;
+        const CachedPage * pPage         = GetPage( nPageIndex );
+        if( nullptr == pPage || nOffsetInPage >= pPage->abyData.size() )
+            break;
+
+        size_t nToCopy = std::min( size - nReaded, pPage->abyData.size() - nOffsetInPage );
+        memcpy( pabyOutput + nReaded, pPage->abyData.data() + nOffsetInPage, nToCopy );
+        nReaded += nToCopy;
+        m_nPosition += static_cast<long>( nToCopy );
+    }
+
+    return nReaded;
+}
+
+size_t CADCachedFileIO::Write( void * /*ptr*/, size_t /*size*/ )
+{
+    // unsupported
+    return 0;
+}
+
+void CADCachedFileIO::Rewind()
+{
+    m_nPosition = 0;
+}
+
+size_t CADCachedFileIO::GetHitCount() const
+{
+    return m_nHits;
+}
+
+size_t CADCachedFileIO::GetMissCount() const
+{
+    return m_nMisses;
+}
+
+void CADCachedFileIO::ClearCache()
+{
+    m_oPages.clear();
+    m_oPageMap.clear();
+    m_nLastMissedPage = -2;
+    m_nReadAhead      = 1;
+    m_nHits           = 0;
+    m_nMisses         = 0;
+}
+
+const CADCachedFileIO::CachedPage * CADCachedFileIO::GetPage( long nPageIndex )
+{
+    auto iterPage = m_oPageMap.find( nPageIndex );
+    if( iterPage != m_oPageMap.end() )
+    {
+        ++m_nHits;
+        m_oPages.splice( m_oPages.begin(), m_oPages, iterPage->second );
+        return & m_oPages.front();
+    }
+
+    ++m_nMisses;
+
+    // Sequential misses double the read ahead, any jump resets it.
+    if( nPageIndex == m_nLastMissedPage + 1 )
+        m_nReadAhead = std::min( m_nReadAhead * 2, m_nMaxReadAhead );
+    else
+        m_nReadAhead = 1;
+
+    long   nPageOffset = nPageIndex * static_cast<long>( m_nPageSize );
+    long   nFileSize   = GetFileSize();
+    if( nPageOffset >= nFileSize )
+        return nullptr;
+
+    size_t nPagesToRead = std::min( m_nReadAhead,
+                                    static_cast<size_t>( ( nFileSize - nPageOffset - 1 ) /
+                                                         static_cast<long>( m_nPageSize ) + 1 ) );
+    m_nLastMissedPage = nPageIndex + static_cast<long>( nPagesToRead ) - 1;
+
+    std::vector<char> abyBuffer( nPagesToRead * m_nPageSize );
+    if( m_poFileIO->Seek( nPageOffset, SeekOrigin::BEG ) != 0 )
+        return nullptr;
+    size_t nReaded = m_poFileIO->Read( abyBuffer.data(), abyBuffer.size() );
+    if( nReaded == 0 )
+        return nullptr;
+
+    // Insert pages in reverse order, so the requested one becomes the most recently used.
+    for( size_t i = nPagesToRead; i-- > 0; )
+    {
+        size_t nStart = i * m_nPageSize;
+        if( nStart >= nReaded )
+            continue;
+
+        long nIndex = nPageIndex + static_cast<long>( i );
+        auto iterCached = m_oPageMap.find( nIndex );
+        if( iterCached != m_oPageMap.end() )
+        {
+            m_oPages.splice( m_oPages.begin(), m_oPages, iterCached->second );
+            continue;
+        }
+
+        CachedPage oPage;
+        oPage.nIndex = nIndex;
+        oPage.abyData.assign( abyBuffer.begin() + nStart,
+                              abyBuffer.begin() + std::min( nStart + m_nPageSize, nReaded ) );
+        m_oPages.push_front( std::move( oPage ) );
+        m_oPageMap[nIndex] = m_oPages.begin();
+    }
+
+    while( m_oPages.size() > m_nMaxPages )
+    {
+        m_oPageMap.erase( m_oPages.back().nIndex );
+        m_oPages.pop_back();
+    }
+
+    return & m_oPages.front();
+}
+
+long CADCachedFileIO::GetFileSize()
+{
+    if( m_nFileSize < 0 && m_poFileIO->IsOpened() )
+    {
+        if( m_poFileIO->Seek( 0, SeekOrigin::END ) == 0 )
+            m_nFileSize = m_poFileIO->Tell();
+    }
+
+    return m_nFileSize < 0 ? 0 : m_nFileSize;
+}
@@ -0,0 +1,111 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ ******************************************************************************/
+#ifndef CADCACHEDFILEIO_H
+#define CADCACHEDFILEIO_H
+
+#include "cadfileio.h"
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief The CADCachedFileIO class wraps any CADFileIO and keeps recently read
+ * fixed-size pages of the file in memory. Least recently used pages are evicted
+ * first. When misses go page after page, the following pages are read ahead
+ * with the same request.
+ */
+class CADCachedFileIO : public CADFileIO
+{
+public:
+    /**
+     * @brief Constructor
+     * @param poFileIO wrapped file reader, owned by this object
+     * @param nPageSize size of the cached page in bytes
+     * @param nMaxPages maximum number of the pages kept in memory
+     * @param nMaxReadAhead maximum number of the pages read at once on
+     *        sequential access
+     */
+    CADCachedFileIO( CADFileIO * poFileIO, size_t nPageSize = 64 * 1024, size_t nMaxPages = 64,
+                     size_t nMaxReadAhead = 8 );
+    virtual             ~CADCachedFileIO();
+
+    virtual const char* ReadLine() override;
+    virtual bool        Eof() override;
+    virtual bool        Open( int mode ) override;
+    virtual bool        IsOpened() const override;
+    virtual bool        Close() override;
+    virtual int         Seek( long int offset, SeekOrigin origin ) override;
+    virtual long int    Tell() override;
+    virtual size_t      Read( void * ptr, size_t size ) override;
+    virtual size_t      Write( void * ptr, size_t size ) override;
+    virtual void        Rewind() override;
+
+    /**
+     * @brief Number of the page lookups served from memory
+     */
+    size_t GetHitCount() const;
+    /**
+     * @brief Number of the page lookups which needed reading from the wrapped reader
+     */
+    size_t GetMissCount() const;
+    /**
+     * @brief Drops all cached pages and resets counters
+     */
+    void   ClearCache();
+
+protected:
+    struct CachedPage
+    {
+        long              nIndex;
+        std::vector<char> abyData; // may be shorter than page size at the end of file
+    };
+    typedef std::list<CachedPage> CachedPageList;
+
+    const CachedPage * GetPage( long nPageIndex );
+    long               GetFileSize();
+
+protected:
+    CADFileIO     * m_poFileIO;
+    size_t          m_nPageSize;
+    size_t          m_nMaxPages;
+    size_t          m_nMaxReadAhead;
+    long            m_nPosition;
+    long            m_nFileSize;
+    long            m_nLastMissedPage;
+    size_t          m_nReadAhead;
+    size_t          m_nHits;
+    size_t          m_nMisses;
+    CachedPageList  m_oPages; // most recently used first
+    std::unordered_map<long, CachedPageList::iterator> m_oPageMap;
+};
+
+#endif // CADCACHEDFILEIO_H
@@ -38,6 +38,23 @@ typedef struct
     unsigned char B;
 } RGBColor;
 
+/**
+ * @brief Format color as "#rrggbb" with lower case digits.
+ * @param pszColor buffer of 8 chars at least
+ */
+inline void formatHexColor( RGBColor color, char * pszColor )
+{
+    static const char achHex[] = "0123456789abcdef";
+    pszColor[0] = '#';
+    pszColor[1] = achHex[color.R >> 4];
+    pszColor[2] = achHex[color.R & 15];
+    pszColor[3] = achHex[color.G >> 4];
+    pszColor[4] = achHex[color.G & 15];
+    pszColor[5] = achHex[color.B >> 4];
+    pszColor[6] = achHex[color.B & 15];
+    pszColor[7] = '\0';
+}
+
 /**
  * @brief Lookup table to translate ACI to RGB color.
  */
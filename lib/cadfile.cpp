@@ -32,6 +32,71 @@
 #include "opencad_api.h"
 
 #include <iostream>
+#include <memory>
+
+//------------------------------------------------------------------------------
+// CADFilter
+//------------------------------------------------------------------------------
+
+CADFilter::CADFilter() : nDecodeFlags( DECODE_ALL )
+{
+}
+
+void CADFilter::setSpatialFilter( double minx, double miny, double maxx, double maxy )
+{
+    oSpatialFilter = CADBoundingBox();
+    oSpatialFilter.addPoint( minx, miny, 0.0 );
+    oSpatialFilter.addPoint( maxx, maxy, 0.0 );
+}
+
+const CADBoundingBox& CADFilter::getSpatialFilter() const
+{
+    return oSpatialFilter;
+}
+
+bool CADFilter::hasSpatialFilter() const
+{
+    return !oSpatialFilter.isEmpty();
+}
+
+void CADFilter::addLayer( const std::string& sLayerName )
+{
+    oLayerNames.insert( sLayerName );
+}
+
+bool CADFilter::isLayerAccepted( const std::string& sLayerName ) const
+{
+    return oLayerNames.empty() || oLayerNames.count( sLayerName ) != 0;
+}
+
+void CADFilter::addObjectType( enum CADObject::ObjectType eType )
+{
+    if( eType < 0 || eType > CADObject::WIPEOUT )
+        return;
+    abObjectTypes.resize( CADObject::WIPEOUT + 1, false );
+    abObjectTypes[eType] = true;
+}
+
+bool CADFilter::isObjectTypeAccepted( short nType ) const
+{
+    if( abObjectTypes.empty() )
+        return true;
+    return nType >= 0 && nType <= CADObject::WIPEOUT && abObjectTypes[nType];
+}
+
+void CADFilter::setDecodeFlags( int nFlags )
+{
+    nDecodeFlags = nFlags;
+}
+
+int CADFilter::getDecodeFlags() const
+{
+    return nDecodeFlags;
+}
+
+//------------------------------------------------------------------------------
+// CADFile
+//------------------------------------------------------------------------------
 
 CADFile::CADFile( CADFileIO * poFileIO )
 {
@@ -59,6 +124,16 @@ const CADTables& CADFile::getTables() const
     return oTables;
 }
 
+const CADFilter& CADFile::getFilter() const
+{
+    return oFilter;
+}
+
+void CADFile::setFilter( const CADFilter& oFilterIn )
+{
+    oFilter = oFilterIn;
+}
+
 int CADFile::ParseFile( enum OpenOptions eOptions, bool bReadUnsupportedGeometries )
 {
     if( nullptr == pFileIO )
@@ -113,6 +188,49 @@ CADLayer& CADFile::GetLayer( size_t index )
     return oTables.GetLayer( index );
 }
 
+CADBoundingBox CADFile::computeExtents()
+{
+    CADBoundingBox oExtents;
+    for( size_t i = 0; i < GetLayersCount(); ++i )
+        oExtents.addBox( GetLayer( i ).getExtents() );
+    return oExtents;
+}
+
+void CADFile::GetObjects( const long * padObjectHandles, size_t nCount, CADObject ** papoObjects,
+                          bool bHandlesOnly )
+{
+    for( size_t i = 0; i < nCount; ++i )
+        papoObjects[i] = GetObject( padObjectHandles[i], bHandlesOnly );
+}
+
+bool CADFile::GetObjectAsync( long dObjectHandle, bool bHandlesOnly )
+{
+    aQueuedObjects.push_back( std::make_pair( dObjectHandle, bHandlesOnly ) );
+    return true;
+}
+
+bool CADFile::GetCompletedObject( long& dObjectHandle, CADObject *& poObject )
+{
+    if( aQueuedObjects.empty() )
+        return false;
+
+    dObjectHandle = aQueuedObjects.front().first;
+    poObject      = GetObject( dObjectHandle, aQueuedObjects.front().second );
+    aQueuedObjects.pop_front();
+    return true;
+}
+
+void CADFile::GetBoundingBoxes( size_t iLayerIndex, const long * padHandles, size_t nCount,
+                                CADBoundingBox * paoBoxes )
+{
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        unique_ptr<CADGeometry> poGeometry( GetGeometry( iLayerIndex, padHandles[i] ) );
+        if( nullptr != poGeometry )
+            paoBoxes[i] = poGeometry->getBoundingBox();
+    }
+}
+
 bool CADFile::isReadingUnsupportedGeometries()
 {
     return bReadingUnsupportedGeometries;
@@ -36,7 +36,66 @@
 #include "cadtables.h"
 #include "caddictionary.h"
 
+#include <deque>
 #include <string>
+#include <unordered_set>
+
+/**
+ * @brief Filter of the geometries which are recorded in layers while the
+ * file is parsed. Filtered out geometries cost nothing after opening.
+ */
+class OCAD_EXTERN CADFilter
+{
+public:
+    /**
+     * @brief Entity fields which decoding may be skipped
+     */
+    enum DecodeFlags
+    {
+        DECODE_ALL      = 0,
+        SKIP_EED        = 1 << 0, /**< extended entity data, geometries have no EED */
+        SKIP_REACTORS   = 1 << 1, /**< reactor handles */
+        SKIP_XDICT      = 1 << 2, /**< extension dictionary handle */
+        SKIP_EXTRUSION  = 1 << 3, /**< thickness and extrusion, defaults are used instead */
+        SKIP_ATTRIBUTES = 1 << 4  /**< block reference attributes and attribute tags of layers */
+    };
+
+    CADFilter();
+
+    /**
+     * @brief keep only geometries which bounding box intersects the window in
+     * XY plane. Geometries with unknown extents are skipped too.
+     */
+    void                  setSpatialFilter( double minx, double miny, double maxx, double maxy );
+    const CADBoundingBox& getSpatialFilter() const;
+    bool                  hasSpatialFilter() const;
+
+    /**
+     * @brief read only layers with given names. All layers are read if none
+     * is added.
+     */
+    void addLayer( const std::string& sLayerName );
+    bool isLayerAccepted( const std::string& sLayerName ) const;
+
+    /**
+     * @brief read only entities of given types. All types are read if none
+     * is added. Block references are expanded only if INSERT is accepted.
+     */
+    void addObjectType( enum CADObject::ObjectType eType );
+    bool isObjectTypeAccepted( short nType ) const;
+
+    /**
+     * @brief set DecodeFlags combination. Skipped fields are bit-skipped by
+     * the parser and keep default values in objects.
+     */
+    void setDecodeFlags( int nFlags );
+    int  getDecodeFlags() const;
+protected:
+    CADBoundingBox                  oSpatialFilter;
+    std::unordered_set<std::string> oLayerNames;
+    std::vector<bool>               abObjectTypes; // indexed by CADObject::ObjectType
+    int                             nDecodeFlags;
+};
 
 /**
  * @brief The abstract CAD file class
@@ -67,17 +126,49 @@ public:
     const CADClasses& getClasses() const;
     const CADTables & getTables() const;
 
+    const CADFilter & getFilter() const;
+    /**
+     * @brief set filter of the geometries. Must be set before ParseFile().
+     */
+    void              setFilter( const CADFilter& oFilterIn );
+
 public:
     virtual int    ParseFile( enum OpenOptions eOptions, bool bReadUnsupportedGeometries = true );
     virtual size_t GetLayersCount() const;
     virtual CADLayer& GetLayer( size_t index );
 
+    /**
+     * @brief Compute extents of all layers geometries. Unlike $EXTMIN/$EXTMAX
+     * header values this is always up to date.
+     * @return bounding box, empty if there is no geometries
+     */
+    virtual CADBoundingBox computeExtents();
+
     /**
      * @brief returns NamedObjectDictionary (root) of all others dictionaries
      * @return pointer to the root CADDictionary
      */
     virtual CADDictionary GetNOD() = 0;
 
+    /**
+     * @brief Queue reading of CAD Object. If file IO supports asynchronous
+     *        reads, many objects are read at once while completed ones are
+     *        decoded. Use GetCompletedObject() to get the results.
+     * @param dObjectHandle Object handle
+     * @param bHandlesOnly set TRUE if object data should be skipped, and only object handles should be read.
+     * @return false if object can't be queued
+     */
+    virtual bool GetObjectAsync( long dObjectHandle, bool bHandlesOnly = false );
+
+    /**
+     * @brief Wait for any of the objects queued by GetObjectAsync(). Objects
+     *        may be returned not in the order they were queued.
+     * @param dObjectHandle handle of the returned object
+     * @param poObject pointer to CADObject or nullptr if object was not read. User have to free returned pointer.
+     * @return false if there are no queued objects
+     */
+    virtual bool GetCompletedObject( long& dObjectHandle, CADObject *& poObject );
+
 //    virtual size_t GetBlocksCount();
 //    virtual CADBlockObject * GetBlock( size_t index );
 
@@ -90,15 +181,40 @@ protected:
      */
     virtual CADObject * GetObject( long dObjectHandle, bool bHandlesOnly = false ) = 0;
 
+    /**
+     * @brief Get several CAD Objects from file at once. Implementation may read
+     *        neighbour objects with a single request, so it is preferable to
+     *        calling GetObject() in a loop when handles are known in advance.
+     * @param padObjectHandles Object handles array
+     * @param nCount Object handles count
+     * @param papoObjects array of nCount pointers to fill. Pointer is nullptr if object was not read.
+     *        User have to free returned pointers.
+     * @param bHandlesOnly set TRUE if object data should be skipped, and only object handles should be read.
+     */
+    virtual void GetObjects( const long * padObjectHandles, size_t nCount, CADObject ** papoObjects,
+                             bool bHandlesOnly = false );
+
     /**
      * @brief read geometry from CAD file
      * @param size_t LayerIndex
      * @param handle Handle of CAD object
      * @param handle Handle of BlockRef (0 if geometry is not in block reference)
-     * @return NULL if failed or pointer which mast be feed by user
+     * @return NULL if failed or pointer which mast be feed by user. Geometry
+     * is in WCS, see CADGeometry::transformFromOCS()
      */
     virtual CADGeometry * GetGeometry( size_t iLayerIndex, long dHandle, long dBlockRefHandle = 0 ) = 0;
 
+    /**
+     * @brief Get bounding boxes of several geometries. Implementation may decode
+     *        only entity coordinates instead of building whole geometries.
+     * @param iLayerIndex Layer index
+     * @param padHandles Geometry handles array
+     * @param nCount Geometry handles count
+     * @param paoBoxes array of nCount boxes to fill. Box stays empty if geometry was not read.
+     */
+    virtual void GetBoundingBoxes( size_t iLayerIndex, const long * padHandles, size_t nCount,
+                                   CADBoundingBox * paoBoxes );
+
     /**
      * @brief initially read some basic values and section locator
      * @return CADErrorCodes::SUCCESS if OK, or error code
@@ -142,10 +258,12 @@ protected:
     CADHeader  oHeader;
     CADClasses oClasses;
     CADTables  oTables;
+    CADFilter  oFilter;
 
 protected:
     std::map<long, long> mapObjects; // object index <-> file offset
     bool bReadingUnsupportedGeometries;
+    std::deque<std::pair<long, bool> > aQueuedObjects; // handle, handles only flag
 };
 
 
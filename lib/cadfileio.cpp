@@ -30,6 +30,8 @@
  ******************************************************************************/
 #include "cadfileio.h"
 
+#include <cstring>
+
 CADFileIO::CADFileIO( const char * pszFileName )
 {
     m_soFilePath = pszFileName;
@@ -57,3 +59,51 @@ const char * CADFileIO::GetFilePath() const
 {
     return m_soFilePath.c_str();
 }
+
+bool CADFileIO::SubmitRead( long offset, void * ptr, size_t size, size_t nRequestId )
+{
+    if( Seek( offset, SeekOrigin::BEG ) != 0 )
+        return false;
+    m_aoCompletedReads.push_back( std::make_pair( nRequestId, Read( ptr, size ) ) );
+    return true;
+}
+
+bool CADFileIO::WaitRead( size_t& nRequestId, size_t& nReaded )
+{
+    if( m_aoCompletedReads.empty() )
+        return false;
+
+    nRequestId = m_aoCompletedReads.front().first;
+    nReaded    = m_aoCompletedReads.front().second;
+    m_aoCompletedReads.pop_front();
+    return true;
+}
+
+const char * CADFileIO::ReadLineByBlocks()
+{
+    m_soLine.clear();
+    char   abyBlock[256];
+    size_t nReaded  = 0;
+    bool   bHasData = false;
+    while( ( nReaded = Read( abyBlock, sizeof( abyBlock ) ) ) > 0 )
+    {
+        bHasData = true;
+        const char * pszEnd = static_cast<const char *>( memchr( abyBlock, '\n', nReaded ) );
+        if( pszEnd != nullptr )
+        {
+            size_t nLength = static_cast<size_t>( pszEnd - abyBlock );
+            m_soLine.append( abyBlock, nLength );
+            // Return to the beginning of the next line.
+            Seek( static_cast<long>( nLength + 1 ) - static_cast<long>( nReaded ), SeekOrigin::CUR );
+            break;
+        }
+        m_soLine.append( abyBlock, nReaded );
+    }
+
+    if( !bHasData )
+        return nullptr;
+
+    if( !m_soLine.empty() && m_soLine[m_soLine.size() - 1] == '\r' )
+        m_soLine.erase( m_soLine.size() - 1 );
+    return m_soLine.c_str();
+}
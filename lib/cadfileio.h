@@ -32,7 +32,9 @@
 #define CADFILEIO_H
 
 #include <cstddef>
+#include <deque>
 #include <string>
+#include <utility>
 
 /**
  * @brief The CADFileIO class provides in/out file operations as read, write,
@@ -71,9 +73,38 @@ public:
     virtual void     Rewind()                                   = 0;
     const char * GetFilePath() const;
 
+    /**
+     * @brief Queue reading of size bytes from offset into ptr. Buffer must stay
+     * valid until WaitRead() reports the request. Default implementation reads
+     * immediately, backends with asynchronous I/O keep many requests in flight.
+     * Current position is undefined after call.
+     * @param nRequestId caller defined id returned by WaitRead()
+     * @return false if request can't be queued
+     */
+    virtual bool     SubmitRead( long int offset, void * ptr, size_t size, size_t nRequestId );
+
+    /**
+     * @brief Wait for any request queued by SubmitRead()
+     * @param nRequestId id of the completed request
+     * @param nReaded bytes read by the request
+     * @return false if there are no queued requests
+     */
+    virtual bool     WaitRead( size_t& nRequestId, size_t& nReaded );
+
+protected:
+    /**
+     * @brief ReadLine() implementation on top of Read() and Seek(). Line ends
+     * with "\n" or "\r\n", which are not returned, position is moved to the
+     * next line.
+     * @return pointer valid until next call or nullptr at the end of file
+     */
+    const char *     ReadLineByBlocks();
+
 protected:
     std::string m_soFilePath;
     bool        m_bIsOpened;
+    std::deque<std::pair<size_t, size_t> > m_aoCompletedReads; // request id, bytes read
+    std::string m_soLine; // last line returned by ReadLineByBlocks()
 };
 
 #endif // CADFILEIO_H
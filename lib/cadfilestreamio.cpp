@@ -89,6 +89,8 @@ int CADFileStreamIO::Seek( long offset, CADFileIO::SeekOrigin origin )
             break;
     }
 
+    // Short read at the end of file sets failbit, which blocks any further seek.
+    m_oFileStream.clear();
     return m_oFileStream.seekg( offset, direction ).good() ? 0 : 1;
 }
 
@@ -110,5 +112,6 @@ size_t CADFileStreamIO::Write( void * /*ptr*/, size_t /*size*/ )
 
 void CADFileStreamIO::Rewind()
 {
+    m_oFileStream.clear();
     m_oFileStream.seekg( 0, std::ios_base::beg );
 }
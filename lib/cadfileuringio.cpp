@@ -0,0 +1,380 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+*******************************************************************************/
+#include "cadfileuringio.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int io_uring_setup( unsigned int nEntries, struct io_uring_params * pParams )
+{
+    return static_cast<int>( syscall( __NR_io_uring_setup, nEntries, pParams ) );
+}
+
+static int io_uring_enter( int nRingFd, unsigned int nToSubmit, unsigned int nMinComplete, unsigned int nFlags )
+{
+    return static_cast<int>( syscall( __NR_io_uring_enter, nRingFd, nToSubmit, nMinComplete, nFlags, nullptr, 0 ) );
+}
+
+CADFileUringIO::CADFileUringIO( const char * pszFilePath, unsigned int nQueueDepth ) :
+    CADFileIO( pszFilePath ),
+    m_nFd( -1 ),
+    m_nPosition( 0 ),
+    m_nFileSize( 0 ),
+    m_nRingFd( -1 ),
+    m_nQueueDepth( nQueueDepth == 0 ? 1 : nQueueDepth ),
+    m_nToSubmit( 0 ),
+    m_nInFlight( 0 ),
+    m_pSQRing( MAP_FAILED ),
+    m_nSQRingSize( 0 ),
+    m_pCQRing( MAP_FAILED ),
+    m_nCQRingSize( 0 ),
+    m_pSQEs( nullptr ),
+    m_nSQEsSize( 0 ),
+    m_pnSQHead( nullptr ),
+    m_pnSQTail( nullptr ),
+    m_pnSQMask( nullptr ),
+    m_pnSQArray( nullptr ),
+    m_pnCQHead( nullptr ),
+    m_pnCQTail( nullptr ),
+    m_pnCQMask( nullptr ),
+    m_pCQEs( nullptr )
+{
+}
+
+CADFileUringIO::~CADFileUringIO()
+{
+    if( IsOpened() )
+        Close();
+}
+
+const char * CADFileUringIO::ReadLine()
+{
+    return ReadLineByBlocks();
+}
+
+bool CADFileUringIO::Eof()
+{
+    return m_nPosition >= m_nFileSize;
+}
+
+bool CADFileUringIO::Open( int mode )
+{
+    if( mode & OpenMode::write )
+        return false;
+
+    m_nFd = open( m_soFilePath.c_str(), O_RDONLY | O_CLOEXEC );
+    if( m_nFd < 0 )
+        return false;
+
+    struct stat stFileStat;
+    m_nFileSize = fstat( m_nFd, & stFileStat ) == 0 ? static_cast<long>( stFileStat.st_size ) : 0;
+    m_nPosition = 0;
+
+    // Without io_uring the reader still works, but synchronously.
+    SetupRing();
+
+    m_bIsOpened = true;
+    return m_bIsOpened;
+}
+
+bool CADFileUringIO::Close()
+{
+    // Kernel may still write into the buffers of requests in flight.
+    while( m_nInFlight > 0 && EnterRing( 1 ) )
+        ReapCompletions();
+
+    DestroyRing();
+    m_oPendingReads.clear();
+    m_aoCompletedReads.clear();
+    if( m_nFd >= 0 )
+    {
+        close( m_nFd );
+        m_nFd = -1;
+    }
+
+    return CADFileIO::Close();
+}
+
+int CADFileUringIO::Seek( long offset, CADFileIO::SeekOrigin origin )
+{
+    long nNewPosition = 0;
+    switch( origin )
+    {
+        case SeekOrigin::CUR:
+            nNewPosition = m_nPosition + offset;
+            break;
+        case SeekOrigin::END:
+            nNewPosition = m_nFileSize + offset;
+            break;
+        case SeekOrigin::BEG:
+            nNewPosition = offset;
+            break;
+    }
+
+    if( nNewPosition < 0 )
+        return 1;
+
+    m_nPosition = nNewPosition;
+    return 0;
+}
+
+long CADFileUringIO::Tell()
+{
+    return m_nPosition;
+}
+
+size_t CADFileUringIO::Read( void * ptr, size_t size )
+{
+    size_t nReaded = ReadAt( m_nPosition, static_cast<char *>( ptr ), size );
+    m_nPosition += static_cast<long>( nReaded );
+    return nReaded;
+}
+
+size_t CADFileUringIO::Write( void * /*ptr*/, size_t /*size*/ )
+{
+    // unsupported
+    return 0;
+}
+
+void CADFileUringIO::Rewind()
+{
+    m_nPosition = 0;
+}
+
+bool CADFileUringIO::SubmitRead( long offset, void * ptr, size_t size, size_t nRequestId )
+{
+    if( m_nRingFd < 0 )
+        return CADFileIO::SubmitRead( offset, ptr, size, nRequestId );
+
+    // Keep completion queue from overflowing: wait for some of the requests
+    // if queue depth is reached.
+    while( m_nInFlight >= m_nQueueDepth )
+    {
+        if( !EnterRing( 1 ) )
+            return false;
+        ReapCompletions();
+    }
+
+    unsigned int nTail  = * m_pnSQTail;
+    unsigned int nIndex = nTail & * m_pnSQMask;
+    io_uring_sqe * pSQE = m_pSQEs + nIndex;
+    memset( pSQE, 0, sizeof( io_uring_sqe ) );
+    pSQE->opcode    = IORING_OP_READ;
+    pSQE->fd        = m_nFd;
+    pSQE->off       = static_cast<__u64>( offset );
+    pSQE->addr      = reinterpret_cast<__u64>( ptr );
+    pSQE->len       = static_cast<__u32>( size );
+    pSQE->user_data = static_cast<__u64>( nRequestId );
+    m_pnSQArray[nIndex] = nIndex;
+    __atomic_store_n( m_pnSQTail, nTail + 1, __ATOMIC_RELEASE );
+
+    PendingRead stRead;
+    stRead.nOffset    = offset;
+    stRead.pabyBuffer = static_cast<char *>( ptr );
+    stRead.nSize      = size;
+    m_oPendingReads[nRequestId] = stRead;
+
+    ++m_nToSubmit;
+    ++m_nInFlight;
+    return true;
+}
+
+bool CADFileUringIO::WaitRead( size_t& nRequestId, size_t& nReaded )
+{
+    if( m_aoCompletedReads.empty() && m_nInFlight > 0 )
+    {
+        // Requests are passed to kernel in one call here, not one by one.
+        ReapCompletions();
+        while( m_aoCompletedReads.empty() && m_nInFlight > 0 )
+        {
+            if( !EnterRing( 1 ) )
+                return false;
+            ReapCompletions();
+        }
+    }
+
+    return CADFileIO::WaitRead( nRequestId, nReaded );
+}
+
+bool CADFileUringIO::IsUringAvailable() const
+{
+    return m_nRingFd >= 0;
+}
+
+bool CADFileUringIO::SetupRing()
+{
+    struct io_uring_params stParams;
+    memset( & stParams, 0, sizeof( stParams ) );
+    m_nRingFd = io_uring_setup( m_nQueueDepth, & stParams );
+    if( m_nRingFd < 0 )
+    {
+        m_nRingFd = -1;
+        return false;
+    }
+
+    m_nQueueDepth = stParams.sq_entries;
+    m_nSQRingSize = stParams.sq_off.array + stParams.sq_entries * sizeof( unsigned int );
+    m_nCQRingSize = stParams.cq_off.cqes + stParams.cq_entries * sizeof( io_uring_cqe );
+    m_nSQEsSize   = stParams.sq_entries * sizeof( io_uring_sqe );
+
+    m_pSQRing = mmap( nullptr, m_nSQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_nRingFd,
+                      IORING_OFF_SQ_RING );
+    m_pCQRing = mmap( nullptr, m_nCQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_nRingFd,
+                      IORING_OFF_CQ_RING );
+    void * pSQEs = mmap( nullptr, m_nSQEsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_nRingFd,
+                         IORING_OFF_SQES );
+    if( m_pSQRing == MAP_FAILED || m_pCQRing == MAP_FAILED || pSQEs == MAP_FAILED )
+    {
+        if( pSQEs != MAP_FAILED )
+            munmap( pSQEs, m_nSQEsSize );
+        DestroyRing();
+        return false;
+    }
+    m_pSQEs = static_cast<io_uring_sqe *>( pSQEs );
+
+    char * pabySQ = static_cast<char *>( m_pSQRing );
+    char * pabyCQ = static_cast<char *>( m_pCQRing );
+    m_pnSQHead  = reinterpret_cast<unsigned int *>( pabySQ + stParams.sq_off.head );
+    m_pnSQTail  = reinterpret_cast<unsigned int *>( pabySQ + stParams.sq_off.tail );
+    m_pnSQMask  = reinterpret_cast<unsigned int *>( pabySQ + stParams.sq_off.ring_mask );
+    m_pnSQArray = reinterpret_cast<unsigned int *>( pabySQ + stParams.sq_off.array );
+    m_pnCQHead  = reinterpret_cast<unsigned int *>( pabyCQ + stParams.cq_off.head );
+    m_pnCQTail  = reinterpret_cast<unsigned int *>( pabyCQ + stParams.cq_off.tail );
+    m_pnCQMask  = reinterpret_cast<unsigned int *>( pabyCQ + stParams.cq_off.ring_mask );
+    m_pCQEs     = reinterpret_cast<io_uring_cqe *>( pabyCQ + stParams.cq_off.cqes );
+
+    return true;
+}
+
+void CADFileUringIO::DestroyRing()
+{
+    if( m_pSQEs != nullptr )
+        munmap( m_pSQEs, m_nSQEsSize );
+    if( m_pCQRing != MAP_FAILED )
+        munmap( m_pCQRing, m_nCQRingSize );
+    if( m_pSQRing != MAP_FAILED )
+        munmap( m_pSQRing, m_nSQRingSize );
+    if( m_nRingFd >= 0 )
+        close( m_nRingFd );
+
+    m_pSQEs   = nullptr;
+    m_pCQRing = MAP_FAILED;
+    m_pSQRing = MAP_FAILED;
+    m_nRingFd = -1;
+    m_nToSubmit = 0;
+    m_nInFlight = 0;
+}
+
+bool CADFileUringIO::EnterRing( unsigned int nMinComplete )
+{
+    if( m_nRingFd < 0 )
+        return false;
+
+    int nResult;
+    do
+    {
+        nResult = io_uring_enter( m_nRingFd, m_nToSubmit, nMinComplete,
+                                  nMinComplete > 0 ? IORING_ENTER_GETEVENTS : 0 );
+    } while( nResult < 0 && errno == EINTR );
+
+    if( nResult < 0 )
+        return false;
+
+    m_nToSubmit -= static_cast<unsigned int>( nResult ) < m_nToSubmit ? static_cast<unsigned int>( nResult )
+                                                                       : m_nToSubmit;
+    return true;
+}
+
+void CADFileUringIO::ReapCompletions()
+{
+    if( m_nRingFd < 0 )
+        return;
+
+    unsigned int nHead = * m_pnCQHead;
+    unsigned int nTail = __atomic_load_n( m_pnCQTail, __ATOMIC_ACQUIRE );
+    while( nHead != nTail )
+    {
+        const io_uring_cqe * pCQE = m_pCQEs + ( nHead & * m_pnCQMask );
+        size_t nRequestId = static_cast<size_t>( pCQE->user_data );
+        int    nResult    = pCQE->res;
+        ++nHead;
+
+        auto iterRead = m_oPendingReads.find( nRequestId );
+        if( iterRead == m_oPendingReads.end() )
+            continue;
+
+        const PendingRead& stRead = iterRead->second;
+        size_t nReaded = 0;
+        if( nResult >= 0 )
+        {
+            // Read the rest of the short read synchronously.
+            nReaded = static_cast<size_t>( nResult );
+            if( nReaded > 0 && nReaded < stRead.nSize )
+                nReaded += ReadAt( stRead.nOffset + static_cast<long>( nReaded ), stRead.pabyBuffer + nReaded,
+                                   stRead.nSize - nReaded );
+        }
+        else if( nResult == -EINVAL || nResult == -EOPNOTSUPP )
+        {
+            // Kernel older than 5.6 has no IORING_OP_READ.
+            nReaded = ReadAt( stRead.nOffset, stRead.pabyBuffer, stRead.nSize );
+        }
+
+        m_aoCompletedReads.push_back( std::make_pair( nRequestId, nReaded ) );
+        m_oPendingReads.erase( iterRead );
+        --m_nInFlight;
+    }
+
+    __atomic_store_n( m_pnCQHead, nHead, __ATOMIC_RELEASE );
+}
+
+size_t CADFileUringIO::ReadAt( long nOffset, char * pabyBuffer, size_t nSize )
+{
+    size_t nReaded = 0;
+    while( nReaded < nSize )
+    {
+        ssize_t nResult = pread( m_nFd, pabyBuffer + nReaded, nSize - nReaded,
+                                 static_cast<off_t>( nOffset ) + static_cast<off_t>( nReaded ) );
+        if( nResult < 0 && errno == EINTR )
+            continue;
+        if( nResult <= 0 )
+            break;
+        nReaded += static_cast<size_t>( nResult );
+    }
+
+    return nReaded;
+}
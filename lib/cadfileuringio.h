@@ -0,0 +1,113 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ ******************************************************************************/
+#ifndef CADFILEURINGIO_H
+#define CADFILEURINGIO_H
+
+#include "cadfileio.h"
+
+#include <unordered_map>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * @brief The CADFileUringIO class reads file with Linux io_uring interface.
+ * Requests queued by SubmitRead() are passed to kernel together and are read
+ * in parallel. Ring is set up with raw system calls, so no liburing is needed.
+ * If kernel doesn't support io_uring, all reads fall back to pread().
+ */
+class CADFileUringIO : public CADFileIO
+{
+public:
+    CADFileUringIO( const char * pszFilePath, unsigned int nQueueDepth = 64 );
+    virtual             ~CADFileUringIO();
+
+    virtual const char* ReadLine() override;
+    virtual bool        Eof() override;
+    virtual bool        Open( int mode ) override;
+    virtual bool        Close() override;
+    virtual int         Seek( long int offset, SeekOrigin origin ) override;
+    virtual long int    Tell() override;
+    virtual size_t      Read( void * ptr, size_t size ) override;
+    virtual size_t      Write( void * ptr, size_t size ) override;
+    virtual void        Rewind() override;
+    virtual bool        SubmitRead( long int offset, void * ptr, size_t size, size_t nRequestId ) override;
+    virtual bool        WaitRead( size_t& nRequestId, size_t& nReaded ) override;
+
+    /**
+     * @brief returns false if io_uring is not available and reads are synchronous
+     */
+    bool                IsUringAvailable() const;
+
+protected:
+    struct PendingRead
+    {
+        long   nOffset;
+        char * pabyBuffer;
+        size_t nSize;
+    };
+
+    bool   SetupRing();
+    void   DestroyRing();
+    bool   EnterRing( unsigned int nMinComplete );
+    void   ReapCompletions();
+    size_t ReadAt( long nOffset, char * pabyBuffer, size_t nSize );
+
+protected:
+    int              m_nFd;
+    long             m_nPosition;
+    long             m_nFileSize;
+
+    int              m_nRingFd;
+    unsigned int     m_nQueueDepth;
+    unsigned int     m_nToSubmit;
+    size_t           m_nInFlight;
+
+    void           * m_pSQRing;
+    size_t           m_nSQRingSize;
+    void           * m_pCQRing;
+    size_t           m_nCQRingSize;
+    io_uring_sqe   * m_pSQEs;
+    size_t           m_nSQEsSize;
+
+    unsigned int   * m_pnSQHead;
+    unsigned int   * m_pnSQTail;
+    unsigned int   * m_pnSQMask;
+    unsigned int   * m_pnSQArray;
+    unsigned int   * m_pnCQHead;
+    unsigned int   * m_pnCQTail;
+    unsigned int   * m_pnCQMask;
+    io_uring_cqe   * m_pCQEs;
+
+    std::unordered_map<size_t, PendingRead> m_oPendingReads;
+};
+
+#endif // CADFILEURINGIO_H
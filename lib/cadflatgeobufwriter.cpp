@@ -0,0 +1,565 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadflatgeobufwriter.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+static const uint8_t FGB_MAGIC[8] = { 'f', 'g', 'b', 3, 'f', 'g', 'b', 0 };
+
+// ColumnType of the FlatGeobuf schema
+static const uint8_t FGB_COLUMN_INT    = 5;
+static const uint8_t FGB_COLUMN_STRING = 11;
+
+// Fixed columns, attribute tag columns follow them
+enum FixedColumn
+{
+    COLUMN_LAYER = 0,
+    COLUMN_LAYER_COLOR,
+    COLUMN_LINE_WEIGHT,
+    COLUMN_COLOR,
+    COLUMN_TEXT,
+    FIXED_COLUMN_COUNT
+};
+
+static const char * const FIXED_COLUMN_NAMES[FIXED_COLUMN_COUNT] = { "layer", "layer_color", "line_weight",
+                                                                     "color", "text" };
+
+static const size_t NODE_ITEM_SIZE = 4 * sizeof( double ) + sizeof( uint64_t );
+
+/**
+ * @brief Minimal FlatBuffers encoder. Buffers are written front to back, so a
+ * table goes before the objects it references (offsets are unsigned and point
+ * forward) and the caller patches offset fields once their targets are
+ * written. Buffer starts with the size prefix, alignment is counted from it.
+ * Scalars are copied as is, so a little endian host is assumed.
+ */
+class FlatBufferEncoder
+{
+public:
+    struct Field
+    {
+        uint16_t nId;
+        uint8_t  nSize;  // 1, 2, 4 or 8 bytes, offsets are 4 bytes
+        uint64_t nValue; // offsets are patched later
+    };
+
+    explicit FlatBufferEncoder( vector<uint8_t>& buffer ) : abyBuffer( buffer )
+    {
+    }
+
+    // Size prefix and root table offset
+    void start()
+    {
+        put<uint32_t>( 0 );
+        put<uint32_t>( 0 );
+    }
+
+    void finish( size_t nStart, size_t nRoot )
+    {
+        putAt<uint32_t>( nStart, static_cast<uint32_t>( abyBuffer.size() - nStart - 4 ) );
+        putAt<uint32_t>( nStart + 4, static_cast<uint32_t>( nRoot - nStart - 4 ) );
+    }
+
+    size_t pad( size_t nAlign, size_t nAfter = 0 )
+    {
+        while( ( abyBuffer.size() + nAfter - nBase ) % nAlign != 0 )
+            abyBuffer.push_back( 0 );
+        return abyBuffer.size();
+    }
+
+    template<typename T>
+    void put( T value )
+    {
+        size_t nPos = abyBuffer.size();
+        abyBuffer.resize( nPos + sizeof( T ) );
+        memcpy( &abyBuffer[nPos], &value, sizeof( T ) );
+    }
+
+    template<typename T>
+    void putAt( size_t nPos, T value )
+    {
+        memcpy( &abyBuffer[nPos], &value, sizeof( T ) );
+    }
+
+    void setBase( size_t nBaseIn )
+    {
+        nBase = nBaseIn;
+    }
+
+    /**
+     * @brief Write vtable and table. Fields go by decreasing size after the
+     * vtable offset, so they are aligned in the 8 aligned table.
+     * @return table position, panFieldPos gets the position of every field
+     */
+    size_t table( const Field * pasFields, size_t nFields, size_t * panFieldPos )
+    {
+        size_t   anOrder[16];
+        uint16_t anInline[16];
+        uint16_t nMaxId = 0;
+        for( size_t i = 0; i < nFields; ++i )
+        {
+            anOrder[i] = i;
+            nMaxId     = max( nMaxId, pasFields[i].nId );
+        }
+        stable_sort( anOrder, anOrder + nFields,
+                     [pasFields]( size_t a, size_t b ) { return pasFields[a].nSize > pasFields[b].nSize; } );
+        uint16_t nInlineSize = 4;
+        for( size_t i = 0; i < nFields; ++i )
+        {
+            uint8_t nSize = pasFields[anOrder[i]].nSize;
+            nInlineSize   = static_cast<uint16_t>( ( nInlineSize + nSize - 1 ) / nSize * nSize );
+            anInline[anOrder[i]] = nInlineSize;
+            nInlineSize = static_cast<uint16_t>( nInlineSize + nSize );
+        }
+
+        size_t nVTable = pad( 2 );
+        put<uint16_t>( static_cast<uint16_t>( 4 + 2 * ( nMaxId + 1 ) ) );
+        put<uint16_t>( nInlineSize );
+        for( uint16_t nId = 0; nId <= nMaxId; ++nId )
+        {
+            uint16_t nOffset = 0;
+            for( size_t i = 0; i < nFields; ++i )
+                if( pasFields[i].nId == nId )
+                    nOffset = anInline[i];
+            put<uint16_t>( nOffset );
+        }
+
+        size_t nTable = pad( 8 );
+        abyBuffer.resize( nTable + nInlineSize, 0 );
+        putAt<int32_t>( nTable, static_cast<int32_t>( nTable - nVTable ) );
+        for( size_t i = 0; i < nFields; ++i )
+        {
+            size_t nPos = nTable + anInline[i];
+            switch( pasFields[i].nSize )
+            {
+                case 1: putAt<uint8_t>( nPos, static_cast<uint8_t>( pasFields[i].nValue ) ); break;
+                case 2: putAt<uint16_t>( nPos, static_cast<uint16_t>( pasFields[i].nValue ) ); break;
+                case 4: putAt<uint32_t>( nPos, static_cast<uint32_t>( pasFields[i].nValue ) ); break;
+                default: putAt<uint64_t>( nPos, pasFields[i].nValue ); break;
+            }
+            panFieldPos[i] = nPos;
+        }
+        return nTable;
+    }
+
+    // Point the offset at nPos to the object at nTarget
+    void link( size_t nPos, size_t nTarget )
+    {
+        putAt<uint32_t>( nPos, static_cast<uint32_t>( nTarget - nPos ) );
+    }
+
+    size_t addString( const string& value )
+    {
+        size_t nPos = pad( 4 );
+        put<uint32_t>( static_cast<uint32_t>( value.size() ) );
+        abyBuffer.insert( abyBuffer.end(), value.begin(), value.end() );
+        abyBuffer.push_back( 0 );
+        return nPos;
+    }
+
+    size_t addDoubles( const double * padfValues, size_t nCount )
+    {
+        size_t nPos = pad( 8, 4 );
+        put<uint32_t>( static_cast<uint32_t>( nCount ) );
+        const uint8_t * pabyValues = reinterpret_cast<const uint8_t *>( padfValues );
+        abyBuffer.insert( abyBuffer.end(), pabyValues, pabyValues + nCount * sizeof( double ) );
+        return nPos;
+    }
+
+    size_t addBytes( const vector<uint8_t>& values )
+    {
+        size_t nPos = pad( 4 );
+        put<uint32_t>( static_cast<uint32_t>( values.size() ) );
+        abyBuffer.insert( abyBuffer.end(), values.begin(), values.end() );
+        return nPos;
+    }
+
+    // Vector of table offsets, element i is at returned position + 4 + 4 * i
+    size_t addOffsets( size_t nCount )
+    {
+        size_t nPos = pad( 4 );
+        put<uint32_t>( static_cast<uint32_t>( nCount ) );
+        abyBuffer.resize( abyBuffer.size() + 4 * nCount, 0 );
+        return nPos;
+    }
+protected:
+    vector<uint8_t>& abyBuffer;
+    size_t           nBase = 0;
+};
+
+// Hilbert curve index of the 16 bit coordinates
+static uint32_t hilbert( uint32_t x, uint32_t y )
+{
+    uint32_t a = x ^ y;
+    uint32_t b = 0xFFFF ^ a;
+    uint32_t c = 0xFFFF ^ ( x | y );
+    uint32_t d = x & ( y ^ 0xFFFF );
+
+    uint32_t A = a | ( b >> 1 );
+    uint32_t B = ( a >> 1 ) ^ a;
+    uint32_t C = ( ( c >> 1 ) ^ ( b & ( d >> 1 ) ) ) ^ c;
+    uint32_t D = ( ( a & ( c >> 1 ) ) ^ ( d >> 1 ) ) ^ d;
+
+    a = A; b = B; c = C; d = D;
+    A = ( a & ( a >> 2 ) ) ^ ( b & ( b >> 2 ) );
+    B = ( a & ( b >> 2 ) ) ^ ( b & ( ( a ^ b ) >> 2 ) );
+    C ^= ( a & ( c >> 2 ) ) ^ ( b & ( d >> 2 ) );
+    D ^= ( b & ( c >> 2 ) ) ^ ( ( a ^ b ) & ( d >> 2 ) );
+
+    a = A; b = B; c = C; d = D;
+    A = ( a & ( a >> 4 ) ) ^ ( b & ( b >> 4 ) );
+    B = ( a & ( b >> 4 ) ) ^ ( b & ( ( a ^ b ) >> 4 ) );
+    C ^= ( a & ( c >> 4 ) ) ^ ( b & ( d >> 4 ) );
+    D ^= ( b & ( c >> 4 ) ) ^ ( ( a ^ b ) & ( d >> 4 ) );
+
+    a = A; b = B; c = C; d = D;
+    C ^= ( a & ( c >> 8 ) ) ^ ( b & ( d >> 8 ) );
+    D ^= ( b & ( c >> 8 ) ) ^ ( ( a ^ b ) & ( d >> 8 ) );
+
+    a = C ^ ( C >> 1 );
+    b = D ^ ( D >> 1 );
+
+    uint32_t i0 = x ^ y;
+    uint32_t i1 = b | ( 0xFFFF ^ ( i0 | a ) );
+
+    i0 = ( i0 | ( i0 << 8 ) ) & 0x00FF00FF;
+    i0 = ( i0 | ( i0 << 4 ) ) & 0x0F0F0F0F;
+    i0 = ( i0 | ( i0 << 2 ) ) & 0x33333333;
+    i0 = ( i0 | ( i0 << 1 ) ) & 0x55555555;
+
+    i1 = ( i1 | ( i1 << 8 ) ) & 0x00FF00FF;
+    i1 = ( i1 | ( i1 << 4 ) ) & 0x0F0F0F0F;
+    i1 = ( i1 | ( i1 << 2 ) ) & 0x33333333;
+    i1 = ( i1 | ( i1 << 1 ) ) & 0x55555555;
+
+    return ( i1 << 1 ) | i0;
+}
+
+static void putPropertyIndex( vector<uint8_t>& out, uint16_t nColumn )
+{
+    out.push_back( static_cast<uint8_t>( nColumn & 0xFF ) );
+    out.push_back( static_cast<uint8_t>( nColumn >> 8 ) );
+}
+
+static void putPropertyInt( vector<uint8_t>& out, uint16_t nColumn, int32_t nValue )
+{
+    putPropertyIndex( out, nColumn );
+    size_t nPos = out.size();
+    out.resize( nPos + sizeof( nValue ) );
+    memcpy( &out[nPos], &nValue, sizeof( nValue ) );
+}
+
+static void putPropertyString( vector<uint8_t>& out, uint16_t nColumn, const string& value )
+{
+    putPropertyIndex( out, nColumn );
+    uint32_t nLength = static_cast<uint32_t>( value.size() );
+    size_t   nPos    = out.size();
+    out.resize( nPos + sizeof( nLength ) );
+    memcpy( &out[nPos], &nLength, sizeof( nLength ) );
+    out.insert( out.end(), value.begin(), value.end() );
+}
+
+CADFlatGeobufWriter::CADFlatGeobufWriter( bool bZIn ) : bZ( bZIn ), nIndexNodeSize( 16 )
+{
+}
+
+bool CADFlatGeobufWriter::getZ() const
+{
+    return bZ;
+}
+
+void CADFlatGeobufWriter::setZ( bool value )
+{
+    bZ = value;
+}
+
+unsigned short CADFlatGeobufWriter::getIndexNodeSize() const
+{
+    return nIndexNodeSize;
+}
+
+void CADFlatGeobufWriter::setIndexNodeSize( unsigned short value )
+{
+    nIndexNodeSize = value == 1 ? 2 : value;
+}
+
+CADTessellator& CADFlatGeobufWriter::getTessellator()
+{
+    return oTessellator;
+}
+
+size_t CADFlatGeobufWriter::writeLayer( CADLayer& layer, ostream& stream )
+{
+    // Attribute tags go after the fixed columns in a stable order
+    unordered_set<string> tagSet = layer.getAttributesTags();
+    vector<string>        tags( tagSet.begin(), tagSet.end() );
+    sort( tags.begin(), tags.end() );
+
+    // Features are written along the Hilbert curve of their box centers, so
+    // close features are close in the file and the index nodes are compact
+    const CADBoundingBox& extents = layer.getExtents();
+    double dfWidth  = extents.isEmpty() ? 0.0 : extents.getMaxX() - extents.getMinX();
+    double dfHeight = extents.isEmpty() ? 0.0 : extents.getMaxY() - extents.getMinY();
+    vector<pair<uint32_t, size_t> > order( layer.getGeometryCount() );
+    for( size_t i = 0; i < order.size(); ++i )
+    {
+        const CADBoundingBox& box = layer.getGeometryBoundingBox( i );
+        bool     bHasCenter = !box.isEmpty() && !box.isUnbounded();
+        uint32_t x = 0, y = 0;
+        if( bHasCenter && dfWidth > 0.0 )
+            x = static_cast<uint32_t>( 0xFFFF * ( ( box.getMinX() + box.getMaxX() ) / 2 - extents.getMinX() ) /
+                                       dfWidth );
+        if( bHasCenter && dfHeight > 0.0 )
+            y = static_cast<uint32_t>( 0xFFFF * ( ( box.getMinY() + box.getMaxY() ) / 2 - extents.getMinY() ) /
+                                       dfHeight );
+        order[i] = make_pair( hilbert( min( x, 0xFFFFu ), min( y, 0xFFFFu ) ), i );
+    }
+    sort( order.begin(), order.end(),
+          []( const pair<uint32_t, size_t>& a, const pair<uint32_t, size_t>& b ) {
+              return a.first > b.first || ( a.first == b.first && a.second < b.second );
+          } );
+
+    abyBuffer.clear();
+    vector<NodeItem> leaves;
+    int              nGeometryType = -1; // unknown (0) if the types are mixed
+    NodeItem         extent = { DBL_MAX, DBL_MAX, -DBL_MAX, -DBL_MAX, 0 };
+    for( const pair<uint32_t, size_t>& item : order )
+    {
+        unique_ptr<CADGeometry> geometry( layer.getGeometry( item.second ) );
+        if( geometry == nullptr )
+            continue;
+        oPoints.clear();
+        uint8_t nType = static_cast<uint8_t>( oTessellator.getSimpleFeature( geometry.get(), oPoints ) );
+        if( nType == CADTessellator::NONE )
+            continue;
+
+        NodeItem leaf = { DBL_MAX, DBL_MAX, -DBL_MAX, -DBL_MAX, abyBuffer.size() };
+        for( size_t i = 0; i < oPoints.size(); ++i )
+        {
+            leaf.minX = min( leaf.minX, oPoints.getXs()[i] );
+            leaf.minY = min( leaf.minY, oPoints.getYs()[i] );
+            leaf.maxX = max( leaf.maxX, oPoints.getXs()[i] );
+            leaf.maxY = max( leaf.maxY, oPoints.getYs()[i] );
+        }
+        extent.minX = min( extent.minX, leaf.minX );
+        extent.minY = min( extent.minY, leaf.minY );
+        extent.maxX = max( extent.maxX, leaf.maxX );
+        extent.maxY = max( extent.maxY, leaf.maxY );
+        leaves.push_back( leaf );
+        nGeometryType = nGeometryType < 0 || nGeometryType == nType ? nType : 0;
+
+        writeFeature( geometry.get(), nType, layer, tags );
+    }
+
+    vector<uint8_t> features;
+    features.swap( abyBuffer );
+    writeHeader( layer, tags, leaves.size(), nGeometryType, extent );
+    stream.write( reinterpret_cast<const char *>( FGB_MAGIC ), sizeof( FGB_MAGIC ) );
+    stream.write( reinterpret_cast<const char *>( abyBuffer.data() ), static_cast<streamsize>( abyBuffer.size() ) );
+
+    if( nIndexNodeSize != 0 && !leaves.empty() )
+    {
+        vector<NodeItem> nodes;
+        buildIndex( leaves, nodes );
+
+        // Nodes are written by big blocks
+        const size_t nBlockSize = 4096;
+        abyBuffer.resize( nBlockSize * NODE_ITEM_SIZE );
+        for( size_t i = 0; i < nodes.size(); i += nBlockSize )
+        {
+            size_t nBlock = min( nBlockSize, nodes.size() - i );
+            for( size_t j = 0; j < nBlock; ++j )
+            {
+                const NodeItem& node     = nodes[i + j];
+                uint8_t *       pabyNode = &abyBuffer[j * NODE_ITEM_SIZE];
+                memcpy( pabyNode, &node.minX, sizeof( double ) );
+                memcpy( pabyNode + 8, &node.minY, sizeof( double ) );
+                memcpy( pabyNode + 16, &node.maxX, sizeof( double ) );
+                memcpy( pabyNode + 24, &node.maxY, sizeof( double ) );
+                memcpy( pabyNode + 32, &node.nOffset, sizeof( uint64_t ) );
+            }
+            stream.write( reinterpret_cast<const char *>( abyBuffer.data() ),
+                          static_cast<streamsize>( nBlock * NODE_ITEM_SIZE ) );
+        }
+    }
+
+    stream.write( reinterpret_cast<const char *>( features.data() ), static_cast<streamsize>( features.size() ) );
+    return leaves.size();
+}
+
+void CADFlatGeobufWriter::writeFeature( const CADGeometry * pGeom, uint8_t nType, const CADLayer& layer,
+                                        const vector<string>& tags )
+{
+    // Properties are column index and value pairs
+    abyProperties.clear();
+    putPropertyString( abyProperties, COLUMN_LAYER, layer.getName() );
+    putPropertyInt( abyProperties, COLUMN_LAYER_COLOR, layer.getColor() );
+    putPropertyInt( abyProperties, COLUMN_LINE_WEIGHT, layer.getLineWeight() );
+
+    char szColor[8];
+    formatHexColor( pGeom->getColor(), szColor );
+    putPropertyString( abyProperties, COLUMN_COLOR, szColor );
+
+    switch( pGeom->getType() )
+    {
+        case CADGeometry::TEXT:
+        case CADGeometry::MTEXT:
+        case CADGeometry::ATTRIB:
+        case CADGeometry::ATTDEF:
+            putPropertyString( abyProperties, COLUMN_TEXT, static_cast<const CADText *>( pGeom )->getTextValue() );
+            break;
+        default:
+            break;
+    }
+
+    for( const CADAttrib& attribute : pGeom->getBlockAttributes() )
+    {
+        auto it = lower_bound( tags.begin(), tags.end(), attribute.getTag() );
+        if( it != tags.end() && *it == attribute.getTag() )
+            putPropertyString( abyProperties, static_cast<uint16_t>( FIXED_COLUMN_COUNT + ( it - tags.begin() ) ),
+                               attribute.getTextValue() );
+    }
+
+    size_t nCount = oPoints.size();
+    adfXY.resize( 2 * nCount );
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        adfXY[2 * i]     = oPoints.getXs()[i];
+        adfXY[2 * i + 1] = oPoints.getYs()[i];
+    }
+    if( bZ && !oPoints.hasZ() )
+        oPoints.addZ();
+
+    size_t            nStart = abyBuffer.size();
+    FlatBufferEncoder oEncoder( abyBuffer );
+    oEncoder.setBase( nStart );
+    oEncoder.start();
+
+    // Feature: geometry (0), properties (1)
+    FlatBufferEncoder::Field asFeature[2] = { { 0, 4, 0 }, { 1, 4, 0 } };
+    size_t anFeaturePos[2];
+    size_t nFeature = oEncoder.table( asFeature, 2, anFeaturePos );
+
+    // Geometry: xy (1), type (6), z (2)
+    FlatBufferEncoder::Field asGeometry[3] = { { 1, 4, 0 }, { 6, 1, nType }, { 2, 4, 0 } };
+    size_t anGeometryPos[3];
+    oEncoder.link( anFeaturePos[0], oEncoder.table( asGeometry, bZ ? 3 : 2, anGeometryPos ) );
+    oEncoder.link( anGeometryPos[0], oEncoder.addDoubles( adfXY.data(), adfXY.size() ) );
+    if( bZ )
+        oEncoder.link( anGeometryPos[2], oEncoder.addDoubles( oPoints.getZData(), nCount ) );
+    oEncoder.link( anFeaturePos[1], oEncoder.addBytes( abyProperties ) );
+    oEncoder.finish( nStart, nFeature );
+}
+
+void CADFlatGeobufWriter::writeHeader( const CADLayer& layer, const vector<string>& tags, uint64_t nFeatures,
+                                       int nGeometryType, const NodeItem& extent )
+{
+    abyBuffer.clear();
+    FlatBufferEncoder oEncoder( abyBuffer );
+    oEncoder.start();
+
+    // Header: name (0), columns (7), geometry_type (2), has_z (3),
+    // features_count (8), index_node_size (9), envelope (1)
+    FlatBufferEncoder::Field asHeader[7] = { { 0, 4, 0 },
+                                             { 7, 4, 0 },
+                                             { 2, 1, static_cast<uint64_t>( max( nGeometryType, 0 ) ) },
+                                             { 3, 1, bZ ? 1u : 0u },
+                                             { 8, 8, nFeatures },
+                                             { 9, 2, nIndexNodeSize },
+                                             { 1, 4, 0 } };
+    size_t anHeaderPos[7];
+    size_t nHeader = oEncoder.table( asHeader, nFeatures > 0 ? 7 : 6, anHeaderPos );
+    oEncoder.link( anHeaderPos[0], oEncoder.addString( layer.getName() ) );
+
+    size_t nColumns = FIXED_COLUMN_COUNT + tags.size();
+    size_t nVector  = oEncoder.addOffsets( nColumns );
+    oEncoder.link( anHeaderPos[1], nVector );
+    for( size_t i = 0; i < nColumns; ++i )
+    {
+        // Column: name (0), type (1)
+        bool bString = i >= FIXED_COLUMN_COUNT || ( i != COLUMN_LAYER_COLOR && i != COLUMN_LINE_WEIGHT );
+        FlatBufferEncoder::Field asColumn[2] = { { 0, 4, 0 }, { 1, 1, bString ? FGB_COLUMN_STRING : FGB_COLUMN_INT } };
+        size_t anColumnPos[2];
+        oEncoder.link( nVector + 4 + 4 * i, oEncoder.table( asColumn, 2, anColumnPos ) );
+        oEncoder.link( anColumnPos[0], oEncoder.addString( i < FIXED_COLUMN_COUNT ? string( FIXED_COLUMN_NAMES[i] )
+                                                                                  : tags[i - FIXED_COLUMN_COUNT] ) );
+    }
+
+    if( nFeatures > 0 )
+    {
+        double adfEnvelope[4] = { extent.minX, extent.minY, extent.maxX, extent.maxY };
+        oEncoder.link( anHeaderPos[6], oEncoder.addDoubles( adfEnvelope, 4 ) );
+    }
+    oEncoder.finish( 0, nHeader );
+}
+
+void CADFlatGeobufWriter::buildIndex( const vector<NodeItem>& leaves, vector<NodeItem>& nodes ) const
+{
+    // Node count of every level, from leaves to root
+    vector<size_t> levelCounts( 1, leaves.size() );
+    size_t nTotal = leaves.size();
+    size_t nCount = leaves.size();
+    do
+    {
+        nCount = ( nCount + nIndexNodeSize - 1 ) / nIndexNodeSize;
+        levelCounts.push_back( nCount );
+        nTotal += nCount;
+    } while( nCount != 1 );
+
+    // Levels are stored from the root down, so leaves are the last. Node
+    // offset is the index of its first child.
+    nodes.resize( nTotal );
+    copy( leaves.begin(), leaves.end(), nodes.end() - leaves.size() );
+    size_t nLevelEnd = nTotal;
+    for( size_t nLevel = 0; nLevel + 1 < levelCounts.size(); ++nLevel )
+    {
+        size_t nChild  = nLevelEnd - levelCounts[nLevel];
+        size_t nParent = nChild - levelCounts[nLevel + 1];
+        while( nChild < nLevelEnd )
+        {
+            NodeItem& node = nodes[nParent++];
+            node = { DBL_MAX, DBL_MAX, -DBL_MAX, -DBL_MAX, nChild };
+            for( size_t i = 0; i < nIndexNodeSize && nChild < nLevelEnd; ++i, ++nChild )
+            {
+                node.minX = min( node.minX, nodes[nChild].minX );
+                node.minY = min( node.minY, nodes[nChild].minY );
+                node.maxX = max( node.maxX, nodes[nChild].maxX );
+                node.maxY = max( node.maxY, nodes[nChild].maxY );
+            }
+        }
+        nLevelEnd -= levelCounts[nLevel];
+    }
+}
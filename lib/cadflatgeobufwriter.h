@@ -0,0 +1,90 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADFLATGEOBUFWRITER_H
+#define CADFLATGEOBUFWRITER_H
+
+#include "cadlayer.h"
+#include "cadtessellator.h"
+
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Writes a layer as a FlatGeobuf file with a packed Hilbert R-tree
+ * index. FlatBuffers tables are encoded here, no FlatBuffers library is
+ * needed. Columns are the layer name, color and line weight, the entity color,
+ * the text value and one string column per block attribute tag of the layer.
+ * Features are kept in memory until the index is written, because the index
+ * goes before them in the file.
+ */
+class OCAD_EXTERN CADFlatGeobufWriter
+{
+public:
+    explicit CADFlatGeobufWriter( bool bZ = false );
+
+    bool getZ() const;
+    void setZ( bool value );
+
+    unsigned short getIndexNodeSize() const;
+    void           setIndexNodeSize( unsigned short value ); // 0 writes no index
+
+    CADTessellator& getTessellator();
+
+    /**
+     * @brief Write all layer geometries which have a simple feature
+     * representation to the stream.
+     * @return number of written features
+     */
+    size_t writeLayer( CADLayer& layer, ostream& stream );
+protected:
+    struct NodeItem
+    {
+        double   minX, minY, maxX, maxY;
+        uint64_t nOffset; // feature offset for leaves, first child index for nodes
+    };
+
+    // nType is the same in CADTessellator::SimpleFeature and FlatGeobuf
+    void writeFeature( const CADGeometry * pGeom, uint8_t nType, const CADLayer& layer,
+                       const vector<string>& tags );
+    void writeHeader( const CADLayer& layer, const vector<string>& tags, uint64_t nFeatures,
+                      int nGeometryType, const NodeItem& extent );
+    void buildIndex( const vector<NodeItem>& leaves, vector<NodeItem>& nodes ) const;
+protected:
+    bool            bZ;
+    unsigned short  nIndexNodeSize;
+    CADTessellator  oTessellator;
+    CADVertexArray  oPoints;    // coordinates of the current geometry
+    vector<double>  adfXY;      // interleaved as FlatGeobuf stores them
+    vector<uint8_t> abyBuffer;  // header or features
+    vector<uint8_t> abyProperties;
+};
+
+#endif // CADFLATGEOBUFWRITER_H
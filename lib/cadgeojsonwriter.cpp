@@ -0,0 +1,332 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadgeojsonwriter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+// Buffer is written to the stream once it is longer
+static const size_t FLUSH_SIZE = 64 * 1024;
+
+CADGeoJSONWriter::CADGeoJSONWriter( ostream& stream, enum Format eFormatIn, bool bZIn ) :
+    oStream( stream ), eFormat( eFormatIn ), bZ( bZIn ), bStarted( false ), bFinished( false ), nFeatures( 0 )
+{
+    osBuffer.reserve( FLUSH_SIZE + FLUSH_SIZE / 4 );
+}
+
+CADGeoJSONWriter::~CADGeoJSONWriter()
+{
+    finish();
+}
+
+CADTessellator& CADGeoJSONWriter::getTessellator()
+{
+    return oTessellator;
+}
+
+size_t CADGeoJSONWriter::writeFile( CADFile& file )
+{
+    size_t nCount = 0;
+    for( size_t i = 0; i < file.GetLayersCount(); ++i )
+        nCount += writeLayer( file.GetLayer( i ) );
+    return nCount;
+}
+
+size_t CADGeoJSONWriter::writeLayer( CADLayer& layer )
+{
+    size_t nCount = 0;
+    for( size_t i = 0; i < layer.getGeometryCount(); ++i )
+    {
+        unique_ptr<CADGeometry> geometry( layer.getGeometry( i ) );
+        if( geometry != nullptr && writeFeature( geometry.get(), layer ) )
+            ++nCount;
+    }
+    return nCount;
+}
+
+bool CADGeoJSONWriter::writeFeature( const CADGeometry * pGeom, const CADLayer& layer )
+{
+    if( bFinished )
+        return false;
+
+    size_t nStart = osBuffer.size();
+    if( eFormat == GEOJSON )
+    {
+        if( !bStarted )
+            osBuffer += "{\"type\":\"FeatureCollection\",\"features\":[\n";
+        else if( nFeatures > 0 )
+            osBuffer += ",\n";
+    }
+    osBuffer += "{\"type\":\"Feature\",\"geometry\":";
+    if( !appendGeometry( pGeom ) )
+    {
+        osBuffer.resize( nStart );
+        return false;
+    }
+    bStarted = true;
+
+    osBuffer += ",\"properties\":{\"layer\":";
+    appendString( layer.getName() );
+    osBuffer += ",\"layer_color\":";
+    appendDouble( layer.getColor() );
+    osBuffer += ",\"line_weight\":";
+    appendDouble( layer.getLineWeight() );
+
+    char szColor[8];
+    formatHexColor( pGeom->getColor(), szColor );
+    osBuffer += ",\"color\":\"";
+    osBuffer += szColor;
+    osBuffer += '"';
+
+    switch( pGeom->getType() )
+    {
+        case CADGeometry::TEXT:
+        case CADGeometry::MTEXT:
+        case CADGeometry::ATTRIB:
+        case CADGeometry::ATTDEF:
+            osBuffer += ",\"text\":";
+            appendString( static_cast<const CADText *>( pGeom )->getTextValue() );
+            break;
+        default:
+            break;
+    }
+
+    vector<CADAttrib> attributes = pGeom->getBlockAttributes();
+    if( !attributes.empty() )
+    {
+        osBuffer += ",\"attributes\":{";
+        for( size_t i = 0; i < attributes.size(); ++i )
+        {
+            if( i > 0 )
+                osBuffer += ',';
+            appendString( attributes[i].getTag() );
+            osBuffer += ':';
+            appendString( attributes[i].getTextValue() );
+        }
+        osBuffer += '}';
+    }
+    osBuffer += "}}";
+    if( eFormat == NDJSON )
+        osBuffer += '\n';
+
+    ++nFeatures;
+    flush( false );
+    return true;
+}
+
+void CADGeoJSONWriter::finish()
+{
+    if( bFinished )
+        return;
+    bFinished = true;
+    if( eFormat == GEOJSON )
+        osBuffer += bStarted ? "\n]}\n" : "{\"type\":\"FeatureCollection\",\"features\":[]}\n";
+    flush( true );
+    oStream.flush();
+}
+
+bool CADGeoJSONWriter::appendGeometry( const CADGeometry * pGeom )
+{
+    switch( pGeom->getType() )
+    {
+        case CADGeometry::POINT:
+        case CADGeometry::TEXT:
+        case CADGeometry::MTEXT:
+        case CADGeometry::ATTRIB:
+        case CADGeometry::ATTDEF:
+        {
+            CADVector position = static_cast<const CADPoint3D *>( pGeom )->getPosition();
+            osBuffer += "{\"type\":\"Point\",\"coordinates\":";
+            appendPosition( position.getX(), position.getY(), position.getZ() );
+            osBuffer += '}';
+            return true;
+        }
+
+        case CADGeometry::LINE:
+        {
+            auto      poLine = static_cast<const CADLine *>( pGeom );
+            CADVector start  = poLine->getStart().getPosition();
+            CADVector end    = poLine->getEnd().getPosition();
+            osBuffer += "{\"type\":\"LineString\",\"coordinates\":[";
+            appendPosition( start.getX(), start.getY(), start.getZ() );
+            osBuffer += ',';
+            appendPosition( end.getX(), end.getY(), end.getZ() );
+            osBuffer += "]}";
+            return true;
+        }
+
+        case CADGeometry::POLYLINE3D:
+        case CADGeometry::LWPOLYLINE:
+        case CADGeometry::POLYLINE2D:
+        case CADGeometry::CIRCLE:
+        case CADGeometry::ARC:
+        case CADGeometry::ELLIPSE:
+        case CADGeometry::SPLINE:
+        {
+            const double * padfX, * padfY, * padfZ;
+            size_t nCount;
+            if( pGeom->getType() == CADGeometry::POLYLINE3D )
+            {
+                auto poPolyline = static_cast<const CADPolyline3D *>( pGeom );
+                padfX  = poPolyline->getXs().data();
+                padfY  = poPolyline->getYs().data();
+                padfZ  = poPolyline->getZs().empty() ? nullptr : poPolyline->getZs().data();
+                nCount = poPolyline->getVertexCount();
+            }
+            else
+            {
+                oPoints.clear();
+                oTessellator.tessellate( pGeom, oPoints );
+                padfX  = oPoints.getXData();
+                padfY  = oPoints.getYData();
+                padfZ  = oPoints.getZData();
+                nCount = oPoints.size();
+            }
+            if( nCount < 2 )
+                return false;
+            osBuffer += "{\"type\":\"LineString\",\"coordinates\":";
+            appendPositions( padfX, padfY, padfZ, nCount );
+            osBuffer += '}';
+            return true;
+        }
+
+        case CADGeometry::FACE3D:
+        case CADGeometry::SOLID:
+        {
+            oPoints.clear();
+            if( oTessellator.getSimpleFeature( pGeom, oPoints ) != CADTessellator::POLYGON )
+                return false;
+            osBuffer += "{\"type\":\"Polygon\",\"coordinates\":[";
+            appendPositions( oPoints.getXData(), oPoints.getYData(), oPoints.getZData(), oPoints.size() );
+            osBuffer += "]}";
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+void CADGeoJSONWriter::appendPosition( double x, double y, double z )
+{
+    osBuffer += '[';
+    appendDouble( x );
+    osBuffer += ',';
+    appendDouble( y );
+    if( bZ )
+    {
+        osBuffer += ',';
+        appendDouble( z );
+    }
+    osBuffer += ']';
+}
+
+void CADGeoJSONWriter::appendPositions( const double * padfX, const double * padfY, const double * padfZ,
+                                        size_t nCount )
+{
+    osBuffer += '[';
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        if( i > 0 )
+            osBuffer += ',';
+        appendPosition( padfX[i], padfY[i], padfZ ? padfZ[i] : 0.0 );
+    }
+    osBuffer += ']';
+}
+
+void CADGeoJSONWriter::appendDouble( double dfValue )
+{
+    if( !std::isfinite( dfValue ) )
+    {
+        osBuffer += "null";
+        return;
+    }
+
+    char szBuffer[32];
+    int  nLength;
+    if( dfValue == floor( dfValue ) && fabs( dfValue ) < 1e15 )
+    {
+        nLength = snprintf( szBuffer, sizeof( szBuffer ), "%lld", static_cast<long long>( dfValue ) );
+    }
+    else
+    {
+        // The shortest precision which reads back to the same value
+        for( int nPrecision = 15; ; ++nPrecision )
+        {
+            nLength = snprintf( szBuffer, sizeof( szBuffer ), "%.*g", nPrecision, dfValue );
+            if( nPrecision == 17 || strtod( szBuffer, nullptr ) == dfValue )
+                break;
+        }
+        // printf follows the locale, JSON always uses point
+        for( int i = 0; i < nLength; ++i )
+        {
+            if( szBuffer[i] == ',' )
+                szBuffer[i] = '.';
+        }
+    }
+    osBuffer.append( szBuffer, nLength );
+}
+
+void CADGeoJSONWriter::appendString( const string& value )
+{
+    static const char achHex[] = "0123456789abcdef";
+    osBuffer += '"';
+    for( char ch : value )
+    {
+        unsigned char nCh = static_cast<unsigned char>( ch );
+        if( ch == '"' || ch == '\\' )
+        {
+            osBuffer += '\\';
+            osBuffer += ch;
+        }
+        else if( nCh < 0x20 )
+        {
+            osBuffer += "\\u00";
+            osBuffer += achHex[nCh >> 4];
+            osBuffer += achHex[nCh & 15];
+        }
+        else
+        {
+            osBuffer += ch;
+        }
+    }
+    osBuffer += '"';
+}
+
+void CADGeoJSONWriter::flush( bool bForce )
+{
+    if( osBuffer.empty() || ( !bForce && osBuffer.size() < FLUSH_SIZE ) )
+        return;
+    oStream.write( osBuffer.data(), static_cast<streamsize>( osBuffer.size() ) );
+    osBuffer.clear();
+}
@@ -0,0 +1,91 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADGEOJSONWRITER_H
+#define CADGEOJSONWRITER_H
+
+#include "cadfile.h"
+#include "cadtessellator.h"
+
+#include <ostream>
+
+/**
+ * @brief Writes geometries as GeoJSON features to a stream. Output is either
+ * one FeatureCollection or newline delimited features (one per line).
+ * Properties are the layer name, color and line weight, the entity color and
+ * block attributes. Curves are flattened with the tessellator.
+ */
+class OCAD_EXTERN CADGeoJSONWriter
+{
+public:
+    enum Format
+    {
+        GEOJSON = 0, // FeatureCollection
+        NDJSON  = 1  // Feature per line
+    };
+
+    explicit CADGeoJSONWriter( ostream& stream, enum Format eFormat = GEOJSON, bool bZ = false );
+    ~CADGeoJSONWriter(); // calls finish()
+
+    CADTessellator& getTessellator();
+
+    /**
+     * @brief Write feature of the geometry.
+     * @return false if the geometry type has no GeoJSON representation
+     */
+    bool   writeFeature( const CADGeometry * pGeom, const CADLayer& layer );
+    size_t writeLayer( CADLayer& layer ); // returns number of written features
+    size_t writeFile( CADFile& file );
+
+    /**
+     * @brief Close the collection and flush the stream. Nothing can be
+     * written after it.
+     */
+    void finish();
+protected:
+    bool appendGeometry( const CADGeometry * pGeom );
+    void appendPosition( double x, double y, double z );
+    void appendPositions( const double * padfX, const double * padfY, const double * padfZ, size_t nCount );
+    void appendDouble( double dfValue );
+    void appendString( const string& value );
+    void flush( bool bForce );
+protected:
+    ostream&       oStream;
+    enum Format    eFormat;
+    bool           bZ;
+    bool           bStarted;
+    bool           bFinished;
+    size_t         nFeatures;
+    string         osBuffer; // output is collected here and written by big blocks
+    CADTessellator oTessellator;
+    CADVertexArray oPoints;
+};
+
+#endif // CADGEOJSONWRITER_H
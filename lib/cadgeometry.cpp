@@ -30,11 +30,22 @@
  *******************************************************************************/
 
 #include "cadgeometry.h"
+#include "cadmath.h"
+#include "cadtessellator.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <limits>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#define OCAD_SIMD_WIDTH 4
+#elif defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define OCAD_SIMD_WIDTH 2
+#endif
+
 using namespace std;
 
 //------------------------------------------------------------------------------
@@ -43,56 +54,527 @@ using namespace std;
 
 Matrix::Matrix()
 {
-    matrix[0] = 1.0;
-    matrix[1] = 0.0;
-    matrix[2] = 0.0;
-    matrix[3] = 0.0;
-    matrix[4] = 1.0;
-    matrix[5] = 0.0;
-    matrix[6] = 0.0;
-    matrix[7] = 0.0;
-    matrix[8] = 1.0;
+    matrix.fill( 0.0 );
+    matrix[0]  = 1.0;
+    matrix[5]  = 1.0;
+    matrix[10] = 1.0;
+    matrix[15] = 1.0;
 }
 
 void Matrix::translate( const CADVector& vector )
 {
-    double a00 = matrix[0], a01 = matrix[1], a02 = matrix[2], a10 = matrix[3], a11 = matrix[4], a12 = matrix[5], a20 = matrix[6], a21 = matrix[7], a22 = matrix[8];
-
-    matrix[6] = vector.getX() * a00 + vector.getY() * a10 + a20;
-    matrix[7] = vector.getX() * a01 + vector.getY() * a11 + a21;
-    matrix[8] = vector.getX() * a02 + vector.getY() * a12 + a22;
+    double x = vector.getX(), y = vector.getY(), z = vector.getZ();
+    for( size_t row = 0; row < 3; ++row )
+    {
+        double * r = &matrix[row * 4];
+        r[3] += r[0] * x + r[1] * y + r[2] * z;
+    }
 }
 
 void Matrix::rotate( double rotation )
 {
-    double              s                                                                                        = sin( rotation ), c = cos(
-            rotation ), a00                                                                                      = matrix[0], a01 = matrix[1], a02 = matrix[2], a10 = matrix[3], a11 = matrix[4], a12 = matrix[5];
-
-    matrix[0] = c * a00 + s * a10;
-    matrix[1] = c * a01 + s * a11;
-    matrix[2] = c * a02 + s * a12;
-
-    matrix[3] = c * a10 - s * a00;
-    matrix[4] = c * a11 - s * a01;
-    matrix[5] = c * a12 - s * a02;
+    double s = sin( rotation ), c = cos( rotation );
+    for( size_t row = 0; row < 3; ++row )
+    {
+        double * r = &matrix[row * 4];
+        double a0 = r[0], a1 = r[1];
+        r[0] = a0 * c + a1 * s;
+        r[1] = a1 * c - a0 * s;
+    }
 }
 
 void Matrix::scale( const CADVector& vector )
 {
-    matrix[0] *= vector.getX();
-    matrix[1] *= vector.getX();
-    matrix[2] *= vector.getX();
-    matrix[3] *= vector.getY();
-    matrix[4] *= vector.getY();
-    matrix[5] *= vector.getY();
+    double z = vector.getBHasZ() ? vector.getZ() : 1.0;
+    for( size_t row = 0; row < 3; ++row )
+    {
+        double * r = &matrix[row * 4];
+        r[0] *= vector.getX();
+        r[1] *= vector.getY();
+        r[2] *= z;
+    }
+}
+
+Matrix Matrix::multiply( const Matrix& other ) const
+{
+    Matrix out;
+    for( size_t row = 0; row < 3; ++row )
+    {
+        const double * a = &matrix[row * 4];
+        for( size_t col = 0; col < 4; ++col )
+        {
+            out.matrix[row * 4 + col] = a[0] * other.matrix[col] + a[1] * other.matrix[4 + col] +
+                                        a[2] * other.matrix[8 + col];
+        }
+        out.matrix[row * 4 + 3] += a[3];
+    }
+    return out;
 }
 
 CADVector Matrix::multiply( const CADVector& vector ) const
 {
     CADVector out;
-    out.setX( vector.getX() * matrix[0] + vector.getY() * matrix[1] + vector.getZ() * matrix[2] );
-    out.setY( vector.getX() * matrix[3] + vector.getY() * matrix[4] + vector.getZ() * matrix[5] );
-    out.setZ( vector.getX() * matrix[6] + vector.getY() * matrix[7] + vector.getZ() * matrix[8] );
+    out.setX( vector.getX() * matrix[0] + vector.getY() * matrix[1] + vector.getZ() * matrix[2] + matrix[3] );
+    out.setY( vector.getX() * matrix[4] + vector.getY() * matrix[5] + vector.getZ() * matrix[6] + matrix[7] );
+    out.setZ( vector.getX() * matrix[8] + vector.getY() * matrix[9] + vector.getZ() * matrix[10] + matrix[11] );
+    return out;
+}
+
+CADVector Matrix::multiplyDirection( const CADVector& vector ) const
+{
+    return CADVector( vector.getX() * matrix[0] + vector.getY() * matrix[1] + vector.getZ() * matrix[2],
+                      vector.getX() * matrix[4] + vector.getY() * matrix[5] + vector.getZ() * matrix[6],
+                      vector.getX() * matrix[8] + vector.getY() * matrix[9] + vector.getZ() * matrix[10] );
+}
+
+bool Matrix::isIdentity() const
+{
+    return matrix == Matrix().matrix;
+}
+
+void Matrix::transformPoints( const double * padfX, const double * padfY, const double * padfZ,
+                              double * padfOutX, double * padfOutY, double * padfOutZ, size_t nCount ) const
+{
+    size_t i = 0;
+    // Operations are done in the same order as in multiply(), so results are
+    // identical to the scalar ones.
+#if OCAD_SIMD_WIDTH == 4
+    __m256d m[12];
+    for( size_t j = 0; j < 12; ++j )
+        m[j] = _mm256_set1_pd( matrix[j] );
+    for( ; i + 4 <= nCount; i += 4 )
+    {
+        __m256d x = _mm256_loadu_pd( padfX + i );
+        __m256d y = _mm256_loadu_pd( padfY + i );
+        __m256d z = padfZ ? _mm256_loadu_pd( padfZ + i ) : _mm256_setzero_pd();
+        __m256d r[3];
+        for( size_t row = 0; row < 3; ++row )
+        {
+            const __m256d * a = m + row * 4;
+            r[row] = _mm256_add_pd( _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd( x, a[0] ), _mm256_mul_pd( y, a[1] ) ),
+                                                   _mm256_mul_pd( z, a[2] ) ), a[3] );
+        }
+        _mm256_storeu_pd( padfOutX + i, r[0] );
+        _mm256_storeu_pd( padfOutY + i, r[1] );
+        _mm256_storeu_pd( padfOutZ + i, r[2] );
+    }
+#elif OCAD_SIMD_WIDTH == 2
+    __m128d m[12];
+    for( size_t j = 0; j < 12; ++j )
+        m[j] = _mm_set1_pd( matrix[j] );
+    for( ; i + 2 <= nCount; i += 2 )
+    {
+        __m128d x = _mm_loadu_pd( padfX + i );
+        __m128d y = _mm_loadu_pd( padfY + i );
+        __m128d z = padfZ ? _mm_loadu_pd( padfZ + i ) : _mm_setzero_pd();
+        __m128d r[3];
+        for( size_t row = 0; row < 3; ++row )
+        {
+            const __m128d * a = m + row * 4;
+            r[row] = _mm_add_pd( _mm_add_pd( _mm_add_pd( _mm_mul_pd( x, a[0] ), _mm_mul_pd( y, a[1] ) ),
+                                             _mm_mul_pd( z, a[2] ) ), a[3] );
+        }
+        _mm_storeu_pd( padfOutX + i, r[0] );
+        _mm_storeu_pd( padfOutY + i, r[1] );
+        _mm_storeu_pd( padfOutZ + i, r[2] );
+    }
+#endif
+    for( ; i < nCount; ++i )
+    {
+        double x = padfX[i], y = padfY[i], z = padfZ ? padfZ[i] : 0.0;
+        padfOutX[i] = x * matrix[0] + y * matrix[1] + z * matrix[2] + matrix[3];
+        padfOutY[i] = x * matrix[4] + y * matrix[5] + z * matrix[6] + matrix[7];
+        padfOutZ[i] = x * matrix[8] + y * matrix[9] + z * matrix[10] + matrix[11];
+    }
+}
+
+Matrix Matrix::ocsToWcs( const CADVector& extrusion )
+{
+    Matrix out;
+    double N[3] = { extrusion.getX(), extrusion.getY(), extrusion.getZ() };
+    double dfLength = sqrt( N[0] * N[0] + N[1] * N[1] + N[2] * N[2] );
+    if( dfLength == 0.0 || ( N[0] == 0.0 && N[1] == 0.0 && N[2] > 0.0 ) )
+        return out;
+    for( double& value : N )
+        value /= dfLength;
+
+    // Ax = Wy x N if N is close to Z axis, Wz x N otherwise. Ay = N x Ax.
+    const double dfArbitraryBound = 1.0 / 64;
+    double Ax[3];
+    if( fabs( N[0] ) < dfArbitraryBound && fabs( N[1] ) < dfArbitraryBound )
+    {
+        Ax[0] = N[2];
+        Ax[1] = 0.0;
+        Ax[2] = -N[0];
+    } else
+    {
+        Ax[0] = -N[1];
+        Ax[1] = N[0];
+        Ax[2] = 0.0;
+    }
+    dfLength = sqrt( Ax[0] * Ax[0] + Ax[1] * Ax[1] + Ax[2] * Ax[2] );
+    for( double& value : Ax )
+        value /= dfLength;
+    double Ay[3] = { N[1] * Ax[2] - N[2] * Ax[1], N[2] * Ax[0] - N[0] * Ax[2], N[0] * Ax[1] - N[1] * Ax[0] };
+
+    // OCS axes are the matrix columns.
+    for( size_t row = 0; row < 3; ++row )
+    {
+        out.matrix[row * 4]     = Ax[row];
+        out.matrix[row * 4 + 1] = Ay[row];
+        out.matrix[row * 4 + 2] = N[row];
+    }
+    return out;
+}
+
+Matrix Matrix::wcsToOcs( const CADVector& extrusion )
+{
+    // OCS axes are orthonormal, so the inverse is the transposed matrix.
+    Matrix ocs = ocsToWcs( extrusion );
+    Matrix out;
+    for( size_t row = 0; row < 3; ++row )
+        for( size_t column = 0; column < 3; ++column )
+            out.matrix[row * 4 + column] = ocs.matrix[column * 4 + row];
+    return out;
+}
+
+static double dot( const CADVector& a, const CADVector& b )
+{
+    return a.getX() * b.getX() + a.getY() * b.getY() + a.getZ() * b.getZ();
+}
+
+static CADVector normalize( const CADVector& vector )
+{
+    double dfLength = sqrt( dot( vector, vector ) );
+    if( dfLength == 0.0 )
+        return vector;
+    return CADVector( vector.getX() / dfLength, vector.getY() / dfLength, vector.getZ() / dfLength );
+}
+
+// Image of the OCS axis in WCS after the transformation.
+static CADVector transformOCSAxis( const Matrix& matrix, const CADVector& extrusion, const CADVector& axis )
+{
+    return matrix.multiplyDirection( Matrix::ocsToWcs( extrusion ).multiplyDirection( axis ) );
+}
+
+// Normal of the transformed plane. It is flipped by mirroring transformations,
+// so angles and bulges measured around it keep their values.
+static CADVector transformNormal( const Matrix& matrix, const CADVector& extrusion )
+{
+    CADVector ax = transformOCSAxis( matrix, extrusion, CADVector( 1.0, 0.0, 0.0 ) );
+    CADVector ay = transformOCSAxis( matrix, extrusion, CADVector( 0.0, 1.0, 0.0 ) );
+    return normalize( CADVector( ax.getY() * ay.getZ() - ax.getZ() * ay.getY(),
+                                 ax.getZ() * ay.getX() - ax.getX() * ay.getZ(),
+                                 ax.getX() * ay.getY() - ax.getY() * ay.getX() ) );
+}
+
+// Angle from OCS X axis of the old extrusion, measured in OCS of the new one.
+static double transformAngle( const Matrix& matrix, const CADVector& oldExtrusion, const CADVector& newExtrusion,
+                              double angle )
+{
+    CADVector dir = transformOCSAxis( matrix, oldExtrusion, CADVector( cos( angle ), sin( angle ), 0.0 ) );
+    Matrix ocs = Matrix::ocsToWcs( newExtrusion );
+    return atan2( dot( dir, ocs.multiplyDirection( CADVector( 0.0, 1.0, 0.0 ) ) ),
+                  dot( dir, ocs.multiplyDirection( CADVector( 1.0, 0.0, 0.0 ) ) ) );
+}
+
+static void transformVertexes( const Matrix& matrix, CADVertexArray& vertexes )
+{
+    if( vertexes.empty() )
+        return;
+    // multiply() always gives 3D result, keep it that way.
+    vertexes.addZ();
+    matrix.transformPoints( vertexes.getXData(), vertexes.getYData(), vertexes.getZData(), vertexes.getXData(),
+                            vertexes.getYData(), vertexes.getZData(), vertexes.size() );
+}
+
+//------------------------------------------------------------------------------
+// CADBoundingBox
+//------------------------------------------------------------------------------
+
+CADBoundingBox::CADBoundingBox() : minX( numeric_limits<double>::max() ),
+                                   minY( numeric_limits<double>::max() ),
+                                   minZ( numeric_limits<double>::max() ),
+                                   maxX( -numeric_limits<double>::max() ),
+                                   maxY( -numeric_limits<double>::max() ),
+                                   maxZ( -numeric_limits<double>::max() )
+{
+}
+
+bool CADBoundingBox::isEmpty() const
+{
+    return minX > maxX;
+}
+
+double CADBoundingBox::getMinX() const
+{
+    return minX;
+}
+
+double CADBoundingBox::getMinY() const
+{
+    return minY;
+}
+
+double CADBoundingBox::getMinZ() const
+{
+    return minZ;
+}
+
+double CADBoundingBox::getMaxX() const
+{
+    return maxX;
+}
+
+double CADBoundingBox::getMaxY() const
+{
+    return maxY;
+}
+
+double CADBoundingBox::getMaxZ() const
+{
+    return maxZ;
+}
+
+void CADBoundingBox::addPoint( double x, double y, double z )
+{
+    if( x < minX ) minX = x;
+    if( x > maxX ) maxX = x;
+    if( y < minY ) minY = y;
+    if( y > maxY ) maxY = y;
+    if( z < minZ ) minZ = z;
+    if( z > maxZ ) maxZ = z;
+}
+
+void CADBoundingBox::addPoint( const CADVector& point )
+{
+    addPoint( point.getX(), point.getY(), point.getZ() );
+}
+
+void CADBoundingBox::addBox( const CADBoundingBox& box )
+{
+    if( box.isEmpty() )
+        return;
+    addPoint( box.minX, box.minY, box.minZ );
+    addPoint( box.maxX, box.maxY, box.maxZ );
+}
+
+void CADBoundingBox::addArc( const CADVector& center, double radius, double startAngle, double endAngle )
+{
+    const double dfTwoPi = 2 * M_PI;
+    double dfSweep = fmod( endAngle - startAngle, dfTwoPi );
+    if( dfSweep <= 0.0 )
+        dfSweep += dfTwoPi;
+
+    double x = center.getX(), y = center.getY(), z = center.getZ();
+    addPoint( x + radius * cos( startAngle ), y + radius * sin( startAngle ), z );
+    addPoint( x + radius * cos( startAngle + dfSweep ), y + radius * sin( startAngle + dfSweep ), z );
+
+    // Extreme points are at the quadrant angles the arc passes through.
+    for( int i = 0; i < 4; ++i )
+    {
+        double dfDelta = fmod( i * ( M_PI / 2 ) - startAngle, dfTwoPi );
+        if( dfDelta < 0.0 )
+            dfDelta += dfTwoPi;
+        if( dfDelta <= dfSweep )
+            addPoint( x + radius * cos( i * ( M_PI / 2 ) ), y + radius * sin( i * ( M_PI / 2 ) ), z );
+    }
+}
+
+void CADBoundingBox::addArc( const CADVector& center, double radius, double startAngle, double endAngle,
+                             const CADVector& extrusion )
+{
+    Matrix ocs = Matrix::ocsToWcs( extrusion );
+    if( ocs.isIdentity() )
+    {
+        addArc( center, radius, startAngle, endAngle );
+        return;
+    }
+    if( startAngle == endAngle )
+        endAngle = startAngle + 2 * M_PI;
+    addEllipse( center, ocs.multiplyDirection( CADVector( radius, 0.0, 0.0 ) ), 1.0, startAngle, endAngle,
+                ocs.multiplyDirection( CADVector( 0.0, 0.0, 1.0 ) ) );
+}
+
+void CADBoundingBox::addEllipse( const CADVector& center, const CADVector& majorAxis, double axisRatio,
+                                 double startParam, double endParam, const CADVector& extrusion )
+{
+    const double dfTwoPi = 2 * M_PI;
+    double dfSweep = fmod( endParam - startParam, dfTwoPi );
+    if( dfSweep <= 0.0 )
+        dfSweep += dfTwoPi;
+
+    // Point on ellipse is center + A * cos(t) + B * sin(t), where minor axis
+    // B = ratio * (N x A).
+    double N[3] = { extrusion.getX(), extrusion.getY(), extrusion.getZ() };
+    double dfNLength = sqrt( N[0] * N[0] + N[1] * N[1] + N[2] * N[2] );
+    if( dfNLength == 0.0 )
+    {
+        N[0] = 0.0; N[1] = 0.0; N[2] = 1.0;
+        dfNLength = 1.0;
+    }
+    double A[3] = { majorAxis.getX(), majorAxis.getY(), majorAxis.getZ() };
+    double B[3] = { axisRatio * ( N[1] * A[2] - N[2] * A[1] ) / dfNLength,
+                    axisRatio * ( N[2] * A[0] - N[0] * A[2] ) / dfNLength,
+                    axisRatio * ( N[0] * A[1] - N[1] * A[0] ) / dfNLength };
+    double C[3] = { center.getX(), center.getY(), center.getZ() };
+
+    auto addParam = [&]( double t )
+    {
+        double c = cos( t ), s = sin( t );
+        addPoint( C[0] + A[0] * c + B[0] * s, C[1] + A[1] * c + B[1] * s, C[2] + A[2] * c + B[2] * s );
+    };
+
+    addParam( startParam );
+    addParam( startParam + dfSweep );
+    for( int i = 0; i < 3; ++i )
+    {
+        // Coordinate i is extreme where -A[i] * sin(t) + B[i] * cos(t) == 0.
+        double t = atan2( B[i], A[i] );
+        for( int j = 0; j < 2; ++j, t += M_PI )
+        {
+            double dfDelta = fmod( t - startParam, dfTwoPi );
+            if( dfDelta < 0.0 )
+                dfDelta += dfTwoPi;
+            if( dfDelta <= dfSweep )
+                addParam( t );
+        }
+    }
+}
+
+// Arc of the bulged segment in XY plane with angles going counterclockwise,
+// false if the segment is straight.
+static bool getBulgeArc( const CADVector& start, const CADVector& end, double bulge, CADVector& center,
+                         double& radius, double& startAngle, double& endAngle )
+{
+    double cx, cy;
+    if( !CADTessellator::getBulgeArc( start.getX(), start.getY(), end.getX(), end.getY(), bulge, cx, cy, radius,
+                                      startAngle, endAngle ) )
+        return false;
+
+    center = CADVector( cx, cy, start.getZ() );
+    // Negative bulge goes clockwise.
+    if( bulge < 0 )
+        swap( startAngle, endAngle );
+    return true;
+}
+
+void CADBoundingBox::addBulgeSegment( const CADVector& start, const CADVector& end, double bulge )
+{
+    addPoint( start );
+    addPoint( end );
+    CADVector center;
+    double    dfRadius, dfStartAng, dfEndAng;
+    if( getBulgeArc( start, end, bulge, center, dfRadius, dfStartAng, dfEndAng ) )
+        addArc( center, dfRadius, dfStartAng, dfEndAng );
+}
+
+void CADBoundingBox::addPoints( const CADVertexArray& points )
+{
+    const vector<double>& xs = points.getXs();
+    const vector<double>& ys = points.getYs();
+    const vector<double>& zs = points.getZs();
+    for( size_t i = 0; i < xs.size(); ++i )
+        addPoint( xs[i], ys[i], zs.empty() ? 0.0 : zs[i] );
+}
+
+void CADBoundingBox::addRectangle( const CADVector& corner, const CADVector& sideA, const CADVector& sideB )
+{
+    for( int i = 0; i < 4; ++i )
+    {
+        double a = i & 1 ? 1.0 : 0.0, b = i & 2 ? 1.0 : 0.0;
+        addPoint( corner.getX() + a * sideA.getX() + b * sideB.getX(),
+                  corner.getY() + a * sideA.getY() + b * sideB.getY(),
+                  corner.getZ() + a * sideA.getZ() + b * sideB.getZ() );
+    }
+}
+
+void CADBoundingBox::addRay( const CADVector& origin, const CADVector& direction )
+{
+    addPoint( origin );
+    const double dfInfinity = numeric_limits<double>::infinity();
+    if( direction.getX() > 0.0 )
+        maxX = dfInfinity;
+    else if( direction.getX() < 0.0 )
+        minX = -dfInfinity;
+    if( direction.getY() > 0.0 )
+        maxY = dfInfinity;
+    else if( direction.getY() < 0.0 )
+        minY = -dfInfinity;
+    if( direction.getZ() > 0.0 )
+        maxZ = dfInfinity;
+    else if( direction.getZ() < 0.0 )
+        minZ = -dfInfinity;
+}
+
+bool CADBoundingBox::isUnbounded() const
+{
+    return !isEmpty() && !( std::isfinite( minX ) && std::isfinite( minY ) && std::isfinite( minZ ) &&
+                            std::isfinite( maxX ) && std::isfinite( maxY ) && std::isfinite( maxZ ) );
+}
+
+void CADBoundingBox::addPolyline( const CADVertexArray& vertexes, const vector<double>& bulges, bool bClosed )
+{
+    addPoints( vertexes );
+    size_t nCount = vertexes.size();
+    for( size_t i = 0; i < nCount && i < bulges.size(); ++i )
+    {
+        if( bulges[i] != 0.0 && ( bClosed || i + 1 < nCount ) )
+            addBulgeSegment( vertexes.get( i ), vertexes.get( ( i + 1 ) % nCount ), bulges[i] );
+    }
+}
+
+void CADBoundingBox::addPolyline( const CADVertexArray& vertexes, const vector<double>& bulges, bool bClosed,
+                                  const CADVector& extrusion )
+{
+    Matrix ocs = Matrix::ocsToWcs( extrusion );
+    if( ocs.isIdentity() )
+    {
+        addPolyline( vertexes, bulges, bClosed );
+        return;
+    }
+
+    // Bulge arcs are found in the polyline plane.
+    addPoints( vertexes );
+    CADVertexArray ocsVertexes( vertexes );
+    transformVertexes( Matrix::wcsToOcs( extrusion ), ocsVertexes );
+    size_t nCount = vertexes.size();
+    for( size_t i = 0; i < nCount && i < bulges.size(); ++i )
+    {
+        CADVector center;
+        double    dfRadius, dfStartAng, dfEndAng;
+        if( ( bClosed || i + 1 < nCount ) &&
+            getBulgeArc( ocsVertexes.get( i ), ocsVertexes.get( ( i + 1 ) % nCount ), bulges[i], center, dfRadius,
+                         dfStartAng, dfEndAng ) )
+            addArc( ocs.multiply( center ), dfRadius, dfStartAng, dfEndAng, extrusion );
+    }
+}
+
+bool CADBoundingBox::intersects( const CADBoundingBox& other ) const
+{
+    if( isEmpty() || other.isEmpty() )
+        return false;
+    return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+}
+
+CADBoundingBox CADBoundingBox::transform( const Matrix& matrix ) const
+{
+    CADBoundingBox out;
+    if( isEmpty() )
+        return out;
+    // Infinite bounds may go to any side
+    if( isUnbounded() )
+    {
+        const double dfInfinity = numeric_limits<double>::infinity();
+        out.addPoint( -dfInfinity, -dfInfinity, -dfInfinity );
+        out.addPoint( dfInfinity, dfInfinity, dfInfinity );
+        return out;
+    }
+    for( int i = 0; i < 8; ++i )
+    {
+        CADVector corner( i & 1 ? maxX : minX, i & 2 ? maxY : minY, i & 4 ? maxZ : minZ );
+        out.addPoint( matrix.multiply( corner ) );
+    }
     return out;
 }
 
@@ -100,7 +582,7 @@ CADVector Matrix::multiply( const CADVector& vector ) const
 // CADGeometry
 //------------------------------------------------------------------------------
 
-CADGeometry::CADGeometry() : geometryType( UNDEFINED ), thickness( 0 )
+CADGeometry::CADGeometry() : geometryType( UNDEFINED ), thickness( 0 ), bBoundingBoxValid( false )
 {
 
 }
@@ -155,6 +637,81 @@ void CADGeometry::setBlockAttributes( const vector<CADAttrib>& data )
     blockAttributes = data;
 }
 
+const CADBoundingBox& CADGeometry::getBoundingBox() const
+{
+    if( !bBoundingBoxValid )
+    {
+        boundingBox = CADBoundingBox();
+        computeBoundingBox( boundingBox );
+        bBoundingBoxValid = true;
+    }
+    return boundingBox;
+}
+
+void CADGeometry::transformFromOCS()
+{
+    // These entities are stored in OCS given by their extrusion, 2D ones have
+    // elevation as Z. Both are reset once applied, the extrusion becomes WCS
+    // normal of the entity plane after transform().
+    CADVector extrusion;
+    double    dfElevation = 0.0;
+    switch( getType() )
+    {
+        case CIRCLE:
+        case ARC:
+        case TEXT:
+        case ATTRIB:
+        case ATTDEF:
+        case SOLID:
+        {
+            CADPoint3D * poPoint = static_cast<CADPoint3D *>( this );
+            extrusion = poPoint->getExtrusion();
+            poPoint->setExtrusion( CADVector( 0.0, 0.0, 1.0 ) );
+            if( getType() == SOLID )
+            {
+                dfElevation = static_cast<CADSolid *>( this )->getElevation();
+                static_cast<CADSolid *>( this )->setElevation( 0.0 );
+            }
+            break;
+        }
+        case LWPOLYLINE:
+        {
+            CADLWPolyline * poPolyline = static_cast<CADLWPolyline *>( this );
+            extrusion   = poPolyline->getVectExtrusion();
+            dfElevation = poPolyline->getElevation();
+            poPolyline->setVectExtrusion( CADVector( 0.0, 0.0, 1.0 ) );
+            poPolyline->setElevation( 0.0 );
+            break;
+        }
+        case POLYLINE2D:
+        {
+            CADPolyline2D * poPolyline = static_cast<CADPolyline2D *>( this );
+            extrusion   = poPolyline->getVectExtrusion();
+            dfElevation = poPolyline->getElevation();
+            poPolyline->setVectExtrusion( CADVector( 0.0, 0.0, 1.0 ) );
+            poPolyline->setElevation( 0.0 );
+            break;
+        }
+        default:
+            return;
+    }
+
+    Matrix mat = Matrix::ocsToWcs( extrusion );
+    if( dfElevation != 0.0 )
+        mat.translate( CADVector( 0.0, 0.0, dfElevation ) );
+    if( !mat.isIdentity() )
+        transform( mat );
+}
+
+void CADGeometry::computeBoundingBox( CADBoundingBox& /*box*/ ) const
+{
+}
+
+void CADGeometry::invalidateBoundingBox()
+{
+    bBoundingBoxValid = false;
+}
+
 //------------------------------------------------------------------------------
 // CADUnknown
 //------------------------------------------------------------------------------
@@ -194,6 +751,7 @@ CADVector CADPoint3D::getPosition() const
 
 void CADPoint3D::setPosition( const CADVector& value )
 {
+    invalidateBoundingBox();
     position = value;
 }
 
@@ -204,6 +762,7 @@ CADVector CADPoint3D::getExtrusion() const
 
 void CADPoint3D::setExtrusion( const CADVector& value )
 {
+    invalidateBoundingBox();
     extrusion = value;
 }
 
@@ -223,9 +782,16 @@ void CADPoint3D::print() const
     "\t" << position.getZ() << "\n" << endl;
 }
 
+void CADPoint3D::computeBoundingBox( CADBoundingBox& box ) const
+{
+    box.addPoint( position );
+}
+
 void CADPoint3D::transform( const Matrix& matrix )
 {
-    position = matrix.multiply( position );
+    invalidateBoundingBox();
+    position  = matrix.multiply( position );
+    extrusion = transformNormal( matrix, extrusion );
 }
 
 //------------------------------------------------------------------------------
@@ -251,6 +817,7 @@ CADPoint3D CADLine::getStart() const
 
 void CADLine::setStart( const CADPoint3D& value )
 {
+    invalidateBoundingBox();
     start = value;
 }
 
@@ -261,6 +828,7 @@ CADPoint3D CADLine::getEnd() const
 
 void CADLine::setEnd( const CADPoint3D& value )
 {
+    invalidateBoundingBox();
     end = value;
 }
 
@@ -271,8 +839,15 @@ void CADLine::print() const
     end.getPosition().getX() << "\t" << end.getPosition().getY() << "\t" << end.getPosition().getZ() << "\n" << endl;
 }
 
+void CADLine::computeBoundingBox( CADBoundingBox& box ) const
+{
+    box.addPoint( start.getPosition() );
+    box.addPoint( end.getPosition() );
+}
+
 void CADLine::transform( const Matrix& matrix )
 {
+    invalidateBoundingBox();
     start.transform( matrix );
     end.transform( matrix );
 }
@@ -293,6 +868,7 @@ double CADCircle::getRadius() const
 
 void CADCircle::setRadius( double value )
 {
+    invalidateBoundingBox();
     radius = value;
 }
 
@@ -303,6 +879,18 @@ void CADCircle::print() const
 
 }
 
+void CADCircle::computeBoundingBox( CADBoundingBox& box ) const
+{
+    box.addArc( position, radius, 0.0, 0.0, extrusion );
+}
+
+void CADCircle::transform( const Matrix& matrix )
+{
+    CADVector axis = transformOCSAxis( matrix, extrusion, CADVector( 1.0, 0.0, 0.0 ) );
+    CADPoint3D::transform( matrix );
+    radius *= sqrt( dot( axis, axis ) );
+}
+
 //------------------------------------------------------------------------------
 // CADArc
 //------------------------------------------------------------------------------
@@ -319,6 +907,7 @@ double CADArc::getStartingAngle() const
 
 void CADArc::setStartingAngle( double value )
 {
+    invalidateBoundingBox();
     startingAngle = value;
 }
 
@@ -329,6 +918,7 @@ double CADArc::getEndingAngle() const
 
 void CADArc::setEndingAngle( double value )
 {
+    invalidateBoundingBox();
     endingAngle = value;
 }
 
@@ -339,6 +929,19 @@ void CADArc::print() const
     "\t" << endingAngle << "\n" << endl;
 }
 
+void CADArc::computeBoundingBox( CADBoundingBox& box ) const
+{
+    box.addArc( position, radius, startingAngle, endingAngle, extrusion );
+}
+
+void CADArc::transform( const Matrix& matrix )
+{
+    CADVector oldExtrusion = extrusion;
+    CADCircle::transform( matrix );
+    startingAngle = transformAngle( matrix, oldExtrusion, extrusion, startingAngle );
+    endingAngle   = transformAngle( matrix, oldExtrusion, extrusion, endingAngle );
+}
+
 //------------------------------------------------------------------------------
 // CADPolyline3D
 //------------------------------------------------------------------------------
@@ -350,7 +953,8 @@ CADPolyline3D::CADPolyline3D()
 
 void CADPolyline3D::addVertex( const CADVector& vertex )
 {
-    vertexes.push_back( vertex );
+    invalidateBoundingBox();
+    vertexes.add( vertex );
 }
 
 size_t CADPolyline3D::getVertexCount() const
@@ -358,9 +962,36 @@ size_t CADPolyline3D::getVertexCount() const
     return vertexes.size();
 }
 
-CADVector& CADPolyline3D::getVertex( size_t index )
+CADVector CADPolyline3D::getVertex( size_t index ) const
+{
+    return vertexes.get( index );
+}
+
+void CADPolyline3D::setVertex( size_t index, const CADVector& vertex )
 {
-    return vertexes[index];
+    invalidateBoundingBox();
+    vertexes.set( index, vertex );
+}
+
+void CADPolyline3D::setVertexes( CADVertexArray value )
+{
+    invalidateBoundingBox();
+    vertexes = std::move( value );
+}
+
+const vector<double>& CADPolyline3D::getXs() const
+{
+    return vertexes.getXs();
+}
+
+const vector<double>& CADPolyline3D::getYs() const
+{
+    return vertexes.getYs();
+}
+
+const vector<double>& CADPolyline3D::getZs() const
+{
+    return vertexes.getZs();
 }
 
 bool CADPolyline3D::isClosed() const
@@ -388,31 +1019,36 @@ void CADPolyline3D::print() const
     cout << "|------Polyline3D-----|" << endl;
     for( size_t i = 0; i < vertexes.size(); ++i )
     {
-		cout << "  #" << i << ". X: " << vertexes[i].getX() << ", Y: " << vertexes[i].getY() << ", Z: " << vertexes[i].getZ() << std::endl;
+		cout << "  #" << i << ". X: " << vertexes.get( i ).getX() << ", Y: " << vertexes.get( i ).getY() << ", Z: " << vertexes.get( i ).getZ() << std::endl;
     }
     cout << endl;
 }
 
+void CADPolyline3D::computeBoundingBox( CADBoundingBox& box ) const
+{
+    box.addPoints( vertexes );
+}
+
 void CADPolyline3D::transform( const Matrix& matrix )
 {
-    for( CADVector& vertex : vertexes )
-    {
-        vertex = matrix.multiply( vertex );
-    }
+    invalidateBoundingBox();
+    transformVertexes( matrix, vertexes );
 }
 
 //------------------------------------------------------------------------------
 // CADLWPolyline
 //------------------------------------------------------------------------------
 
-CADLWPolyline::CADLWPolyline()
+CADLWPolyline::CADLWPolyline() : bClosed( false ), constWidth( 0.0 ), elevation( 0.0 ),
+                                 vectExtrusion( 0.0, 0.0, 1.0 ), hasNonZeroBulges( false )
 {
     geometryType = CADGeometry::LWPOLYLINE;
 }
 
 void CADLWPolyline::addVertex(const CADVector& vertex)
 {
-	vertexes.push_back(vertex);
+	invalidateBoundingBox();
+	vertexes.add(vertex);
 }
 
 size_t CADLWPolyline::getVertexCount() const
@@ -420,14 +1056,41 @@ size_t CADLWPolyline::getVertexCount() const
 	return vertexes.size();
 }
 
-CADVector& CADLWPolyline::getVertex(size_t index)
+CADVector CADLWPolyline::getVertex(size_t index) const
+{
+	return vertexes.get(index);
+}
+
+void CADLWPolyline::setVertex(size_t index, const CADVector& vertex)
+{
+	invalidateBoundingBox();
+	vertexes.set(index, vertex);
+}
+
+void CADLWPolyline::setVertexes(CADVertexArray value)
+{
+	invalidateBoundingBox();
+	vertexes = std::move(value);
+}
+
+const CADVertexArray& CADLWPolyline::getVertexes() const
+{
+    return vertexes;
+}
+
+const vector<double>& CADLWPolyline::getXs() const
+{
+	return vertexes.getXs();
+}
+
+const vector<double>& CADLWPolyline::getYs() const
 {
-	return vertexes[index];
+	return vertexes.getYs();
 }
 
-const CADVector& CADLWPolyline::getVertex(size_t index) const
+const vector<double>& CADLWPolyline::getZs() const
 {
-    return vertexes[index];
+	return vertexes.getZs();
 }
 
 bool CADLWPolyline::isClosed() const
@@ -445,11 +1108,16 @@ void CADLWPolyline::print() const
     cout << "|------LWPolyline-----|" << endl;
     for( size_t i = 0; i < vertexes.size(); ++i )
     {
-        cout << "  #" << i << ". X: " << vertexes[i].getX() << ", Y: " << vertexes[i].getY() << std::endl;
+        cout << "  #" << i << ". X: " << vertexes.getXs()[i] << ", Y: " << vertexes.getYs()[i] << std::endl;
     }
     cout << endl;
 }
 
+void CADLWPolyline::computeBoundingBox( CADBoundingBox& box ) const
+{
+    box.addPolyline( vertexes, bulges, bClosed, vectExtrusion );
+}
+
 double CADLWPolyline::getConstWidth() const
 {
     return constWidth;
@@ -467,6 +1135,7 @@ double CADLWPolyline::getElevation() const
 
 void CADLWPolyline::setElevation( double value )
 {
+    invalidateBoundingBox();
     elevation = value;
 }
 
@@ -495,13 +1164,14 @@ bool CADLWPolyline::hasBulges() const
 	return hasNonZeroBulges;
 }
 
-vector<double> CADLWPolyline::getBulges() const
+const vector<double>& CADLWPolyline::getBulges() const
 {
     return bulges;
 }
 
 void CADLWPolyline::setBulges( const vector<double>& value )
 {
+    invalidateBoundingBox();
     bulges = value;
 	hasNonZeroBulges = false;
 	for ( size_t i = 0; i < bulges.size(); i++ )
@@ -516,23 +1186,24 @@ void CADLWPolyline::setBulges( const vector<double>& value )
 
 void CADLWPolyline::transform( const Matrix& matrix )
 {
-	for (CADVector& vertex : vertexes)
-	{
-		vertex = matrix.multiply(vertex);
-	}
+	invalidateBoundingBox();
+	transformVertexes(matrix, vertexes);
+	vectExtrusion = transformNormal(matrix, vectExtrusion);
 }
 
 //------------------------------------------------------------------------------
 // CADPolyline2D
 //------------------------------------------------------------------------------
-CADPolyline2D::CADPolyline2D()
+CADPolyline2D::CADPolyline2D() : bClosed( false ), bSplined( false ), dfStartWidth( 0.0 ), dfEndWidth( 0.0 ),
+                                 elevation( 0.0 ), vectExtrusion( 0.0, 0.0, 1.0 ), hasNonZeroBulges( false )
 {
 	geometryType = CADGeometry::POLYLINE2D;
 }
 
 void CADPolyline2D::addVertex( const CADVector& vertex )
 {
-	vertexes.push_back(vertex);
+	invalidateBoundingBox();
+	vertexes.add(vertex);
 }
 
 size_t CADPolyline2D::getVertexCount() const
@@ -540,9 +1211,41 @@ size_t CADPolyline2D::getVertexCount() const
 	return vertexes.size();
 }
 
-CADVector& CADPolyline2D::getVertex( size_t index )
+CADVector CADPolyline2D::getVertex( size_t index ) const
+{
+	return vertexes.get(index);
+}
+
+void CADPolyline2D::setVertex( size_t index, const CADVector& vertex )
+{
+	invalidateBoundingBox();
+	vertexes.set(index, vertex);
+}
+
+void CADPolyline2D::setVertexes( CADVertexArray value )
+{
+	invalidateBoundingBox();
+	vertexes = std::move(value);
+}
+
+const CADVertexArray& CADPolyline2D::getVertexes() const
+{
+	return vertexes;
+}
+
+const vector<double>& CADPolyline2D::getXs() const
+{
+	return vertexes.getXs();
+}
+
+const vector<double>& CADPolyline2D::getYs() const
+{
+	return vertexes.getYs();
+}
+
+const vector<double>& CADPolyline2D::getZs() const
 {
-	return vertexes[index];
+	return vertexes.getZs();
 }
 
 bool CADPolyline2D::isClosed() const
@@ -592,6 +1295,7 @@ double CADPolyline2D::getElevation() const
 
 void CADPolyline2D::setElevation( double value )
 {
+	invalidateBoundingBox();
 	elevation = value;
 }
 
@@ -620,13 +1324,14 @@ bool CADPolyline2D::hasBulges() const
 	return hasNonZeroBulges;
 }
 
-vector<double> CADPolyline2D::getBulges() const
+const vector<double>& CADPolyline2D::getBulges() const
 {
 	return bulges;
 }
 
 void CADPolyline2D::setBulges( const vector<double>& value )
 {
+	invalidateBoundingBox();
 	bulges = value;
 	hasNonZeroBulges = false;
 	for ( size_t i = 0; i < bulges.size(); i++ )
@@ -644,17 +1349,21 @@ void CADPolyline2D::print() const
 	cout << "|------Polyline2D-----|" << endl;
 	for (size_t i = 0; i < vertexes.size(); ++i)
 	{
-		cout << "  #" << i << ". X: " << vertexes[i].getX() << ", Y: " << vertexes[i].getY() << std::endl;
+		cout << "  #" << i << ". X: " << vertexes.getXs()[i] << ", Y: " << vertexes.getYs()[i] << std::endl;
 	}
 	cout << endl;
 }
 
+void CADPolyline2D::computeBoundingBox( CADBoundingBox& box ) const
+{
+	box.addPolyline( vertexes, bulges, bClosed, vectExtrusion );
+}
+
 void CADPolyline2D::transform( const Matrix& matrix )
 {
-	for (CADVector& vertex : vertexes)
-	{
-		vertex = matrix.multiply(vertex);
-	}
+	invalidateBoundingBox();
+	transformVertexes(matrix, vertexes);
+	vectExtrusion = transformNormal(matrix, vectExtrusion);
 }
 
 //------------------------------------------------------------------------------
@@ -673,6 +1382,7 @@ double CADEllipse::getAxisRatio() const
 
 void CADEllipse::setAxisRatio( double value )
 {
+    invalidateBoundingBox();
     axisRatio = value;
 }
 
@@ -683,6 +1393,7 @@ CADVector CADEllipse::getSMAxis() const
 
 void CADEllipse::setSMAxis( const CADVector& SMAxisVect )
 {
+    invalidateBoundingBox();
     vectSMAxis = SMAxisVect;
 }
 
@@ -693,6 +1404,18 @@ void CADEllipse::print() const
     endl;
 }
 
+void CADEllipse::computeBoundingBox( CADBoundingBox& box ) const
+{
+    box.addEllipse( position, vectSMAxis, axisRatio, startingAngle, endingAngle, extrusion );
+}
+
+void CADEllipse::transform( const Matrix& matrix )
+{
+    // Ellipse is stored in WCS, its parameters don't depend on the OCS.
+    CADPoint3D::transform( matrix );
+    vectSMAxis = matrix.multiplyDirection( vectSMAxis );
+}
+
 //------------------------------------------------------------------------------
 // CADText
 //------------------------------------------------------------------------------
@@ -719,6 +1442,7 @@ double CADText::getHeight() const
 
 void CADText::setHeight( double value )
 {
+    invalidateBoundingBox();
     height = value;
 }
 
@@ -729,6 +1453,7 @@ double CADText::getRotationAngle() const
 
 void CADText::setRotationAngle( double value )
 {
+    invalidateBoundingBox();
     rotationAngle = value;
 }
 
@@ -742,6 +1467,15 @@ void CADText::setObliqueAngle( double value )
     obliqueAngle = value;
 }
 
+void CADText::transform( const Matrix& matrix )
+{
+    CADVector oldExtrusion = extrusion;
+    CADVector axisY = transformOCSAxis( matrix, extrusion, CADVector( 0.0, 1.0, 0.0 ) );
+    CADPoint3D::transform( matrix );
+    rotationAngle = transformAngle( matrix, oldExtrusion, extrusion, rotationAngle );
+    height *= sqrt( dot( axisY, axisY ) );
+}
+
 void CADText::print() const
 {
     cout << "|---------Text---------|\n" << "Position:" << "\t" << position.getX() << "\t" << position.getY() << "\n" <<
@@ -767,6 +1501,18 @@ void CADRay::setVectVector( const CADVector& value )
     extrusion = value;
 }
 
+void CADRay::transform( const Matrix& matrix )
+{
+    invalidateBoundingBox();
+    position  = matrix.multiply( position );
+    extrusion = matrix.multiplyDirection( extrusion );
+}
+
+void CADRay::computeBoundingBox( CADBoundingBox& box ) const
+{
+    box.addRay( position, extrusion );
+}
+
 void CADRay::print() const
 {
     cout << "|---------Ray---------|\n" << "Position:" << "\t" << position.getX() << "\t" << position.getY() <<
@@ -786,7 +1532,8 @@ CADHatch::CADHatch()
 // CADSpline
 //------------------------------------------------------------------------------
 
-CADSpline::CADSpline()
+CADSpline::CADSpline() : scenario( 0 ), rational( false ), closed( false ), weight( false ), fitTollerance( 0.0 ),
+                         degree( 0 ), vectBegTangentDir( 0.0, 0.0, 0.0 ), vectEndTangentDir( 0.0, 0.0, 0.0 )
 {
     geometryType = CADGeometry::SPLINE;
 }
@@ -798,8 +1545,8 @@ void CADSpline::print() const
     "\n" << "Control pts count: " << avertCtrlPoints.size() << std::endl;
     for( size_t j = 0; j < avertCtrlPoints.size(); ++j )
     {
-        cout << "  #" << j << ".\t" << avertCtrlPoints[j].getX() << "\t" << avertCtrlPoints[j].getY() << "\t" <<
-        avertCtrlPoints[j].getZ() << "\t";
+        cout << "  #" << j << ".\t" << avertCtrlPoints.get( j ).getX() << "\t" << avertCtrlPoints.get( j ).getY() <<
+        "\t" << avertCtrlPoints.get( j ).getZ() << "\t";
         if( weight == true )
             cout << ctrlPointsWeight[j] << endl;
         else
@@ -809,18 +1556,26 @@ void CADSpline::print() const
     cout << "Fit pts count: " << averFitPoints.size() << endl;
     for( size_t j = 0; j < averFitPoints.size(); ++j )
     {
-        cout << "  #" << j << ".\t" << averFitPoints[j].getX() << "\t" << averFitPoints[j].getY() << "\t" <<
-        averFitPoints[j].getZ() << endl;
+        cout << "  #" << j << ".\t" << averFitPoints.get( j ).getX() << "\t" << averFitPoints.get( j ).getY() <<
+        "\t" << averFitPoints.get( j ).getZ() << endl;
     }
     cout << endl;
 }
 
+void CADSpline::computeBoundingBox( CADBoundingBox& box ) const
+{
+    // Curve lies in the convex hull of its control points.
+    box.addPoints( avertCtrlPoints );
+    box.addPoints( averFitPoints );
+}
+
 void CADSpline::transform( const Matrix& matrix )
 {
-    for( CADVector& pt : avertCtrlPoints )
-        pt = matrix.multiply( pt );
-    for( CADVector& pt : averFitPoints )
-        pt = matrix.multiply( pt );
+    invalidateBoundingBox();
+    transformVertexes( matrix, avertCtrlPoints );
+    transformVertexes( matrix, averFitPoints );
+    vectBegTangentDir = matrix.multiplyDirection( vectBegTangentDir );
+    vectEndTangentDir = matrix.multiplyDirection( vectEndTangentDir );
 }
 
 long CADSpline::getScenario() const
@@ -860,12 +1615,26 @@ void CADSpline::addControlPointsWeight( double p_weight )
 
 void CADSpline::addControlPoint( const CADVector& point )
 {
-    avertCtrlPoints.push_back( point );
+    invalidateBoundingBox();
+    avertCtrlPoints.add( point );
 }
 
 void CADSpline::addFitPoint( const CADVector& point )
 {
-    averFitPoints.push_back( point );
+    invalidateBoundingBox();
+    averFitPoints.add( point );
+}
+
+void CADSpline::setControlPoints( CADVertexArray value )
+{
+    invalidateBoundingBox();
+    avertCtrlPoints = std::move( value );
+}
+
+void CADSpline::setFitPoints( CADVertexArray value )
+{
+    invalidateBoundingBox();
+    averFitPoints = std::move( value );
 }
 
 bool CADSpline::getWeight() const
@@ -898,12 +1667,12 @@ void CADSpline::setDegree( long value )
     degree = value;
 }
 
-vector<CADVector>& CADSpline::getControlPoints()
+const CADVertexArray& CADSpline::getControlPoints() const
 {
     return avertCtrlPoints;
 }
 
-vector<CADVector>& CADSpline::getFitPoints()
+const CADVertexArray& CADSpline::getFitPoints() const
 {
     return averFitPoints;
 }
@@ -913,11 +1682,46 @@ vector<double>& CADSpline::getControlPointsWeights()
     return ctrlPointsWeight;
 }
 
+const vector<double>& CADSpline::getControlPointsWeights() const
+{
+    return ctrlPointsWeight;
+}
+
+const vector<double>& CADSpline::getKnots() const
+{
+    return knots;
+}
+
+void CADSpline::setKnots( vector<double> value )
+{
+    knots = std::move( value );
+}
+
+CADVector CADSpline::getBegTangentDir() const
+{
+    return vectBegTangentDir;
+}
+
+void CADSpline::setBegTangentDir( const CADVector& value )
+{
+    vectBegTangentDir = value;
+}
+
+CADVector CADSpline::getEndTangentDir() const
+{
+    return vectEndTangentDir;
+}
+
+void CADSpline::setEndTangentDir( const CADVector& value )
+{
+    vectEndTangentDir = value;
+}
+
 //------------------------------------------------------------------------------
 // CADSolid
 //------------------------------------------------------------------------------
 
-CADSolid::CADSolid()
+CADSolid::CADSolid() : elevation( 0.0 )
 {
     geometryType = CADGeometry::SOLID;
 }
@@ -933,8 +1737,15 @@ void CADSolid::print() const
     cout << endl;
 }
 
+void CADSolid::computeBoundingBox( CADBoundingBox& box ) const
+{
+    for( const CADVector& corner : avertCorners )
+        box.addPoint( corner );
+}
+
 void CADSolid::transform( const Matrix& matrix )
 {
+    invalidateBoundingBox();
     CADPoint3D::transform( matrix );
     for( CADVector& corner : avertCorners )
         corner = matrix.multiply( corner );
@@ -947,15 +1758,17 @@ double CADSolid::getElevation() const
 
 void CADSolid::setElevation( double value )
 {
+    invalidateBoundingBox();
     elevation = value;
 }
 
 void CADSolid::addCorner( const CADVector& corner )
 {
+    invalidateBoundingBox();
     avertCorners.push_back( corner );
 }
 
-vector<CADVector> CADSolid::getCorners()
+vector<CADVector> CADSolid::getCorners() const
 {
     return avertCorners;
 }
@@ -976,9 +1789,32 @@ CADVector CADImage::getVertInsertionPoint() const
 
 void CADImage::setVertInsertionPoint( const CADVector& value )
 {
+    invalidateBoundingBox();
     vertInsertionPoint = value;
 }
 
+CADVector CADImage::getVectUDirection() const
+{
+    return vectUDirection;
+}
+
+void CADImage::setVectUDirection( const CADVector& value )
+{
+    invalidateBoundingBox();
+    vectUDirection = value;
+}
+
+CADVector CADImage::getVectVDirection() const
+{
+    return vectVDirection;
+}
+
+void CADImage::setVectVDirection( const CADVector& value )
+{
+    invalidateBoundingBox();
+    vectVDirection = value;
+}
+
 CADVector CADImage::getImageSize() const
 {
     return imageSize;
@@ -986,6 +1822,7 @@ CADVector CADImage::getImageSize() const
 
 void CADImage::setImageSize( const CADVector& value )
 {
+    invalidateBoundingBox();
     imageSize = value;
 }
 
@@ -1061,15 +1898,28 @@ void CADImage::print() const
     cout << endl;
 }
 
+void CADImage::computeBoundingBox( CADBoundingBox& box ) const
+{
+    const CADVector& u = vectUDirection;
+    const CADVector& v = vectVDirection;
+    double dfWidth = imageSize.getX(), dfHeight = imageSize.getY();
+    box.addRectangle( vertInsertionPoint, CADVector( u.getX() * dfWidth, u.getY() * dfWidth, u.getZ() * dfWidth ),
+                      CADVector( v.getX() * dfHeight, v.getY() * dfHeight, v.getZ() * dfHeight ) );
+}
+
 void CADImage::transform( const Matrix& matrix )
 {
+    invalidateBoundingBox();
     vertInsertionPoint = matrix.multiply( vertInsertionPoint );
+    vectUDirection     = matrix.multiplyDirection( vectUDirection );
+    vectVDirection     = matrix.multiplyDirection( vectVDirection );
     for( CADVector& pt : avertClippingPolygon )
         pt             = matrix.multiply( pt );
 }
 
 void CADImage::addClippingPoint( const CADVector& pt )
 {
+    invalidateBoundingBox();
     avertClippingPolygon.push_back( pt );
 }
 
@@ -1077,7 +1927,7 @@ void CADImage::addClippingPoint( const CADVector& pt )
 // CADMText
 //------------------------------------------------------------------------------
 
-CADMText::CADMText()
+CADMText::CADMText() : rectWidth( 0.0 ), extents( 0.0 ), extentsWidth( 0.0 ), attachment( 1 )
 {
     geometryType = CADGeometry::MTEXT;
 }
@@ -1089,6 +1939,7 @@ double CADMText::getRectWidth() const
 
 void CADMText::setRectWidth( double value )
 {
+    invalidateBoundingBox();
     rectWidth = value;
 }
 
@@ -1099,6 +1950,7 @@ double CADMText::getExtents() const
 
 void CADMText::setExtents( double value )
 {
+    invalidateBoundingBox();
     extents = value;
 }
 
@@ -1109,9 +1961,50 @@ double CADMText::getExtentsWidth() const
 
 void CADMText::setExtentsWidth( double value )
 {
+    invalidateBoundingBox();
     extentsWidth = value;
 }
 
+short CADMText::getAttachment() const
+{
+    return attachment;
+}
+
+void CADMText::setAttachment( short value )
+{
+    invalidateBoundingBox();
+    attachment = value;
+}
+
+void CADMText::transform( const Matrix& matrix )
+{
+    CADVector axisX = transformOCSAxis( matrix, extrusion, CADVector( cos( rotationAngle ), sin( rotationAngle ), 0.0 ) );
+    CADVector axisY = transformOCSAxis( matrix, extrusion, CADVector( -sin( rotationAngle ), cos( rotationAngle ), 0.0 ) );
+    CADText::transform( matrix );
+    rectWidth *= sqrt( dot( axisX, axisX ) );
+    extentsWidth *= sqrt( dot( axisX, axisX ) );
+    extents *= sqrt( dot( axisY, axisY ) );
+}
+
+void CADMText::computeBoundingBox( CADBoundingBox& box ) const
+{
+    // Text rectangle is placed by the attachment corner at the position
+    double dfWidth  = max( rectWidth, extentsWidth );
+    double dfHeight = max( extents, height );
+    short  nIndex   = attachment >= 1 && attachment <= 9 ? attachment - 1 : 0;
+    double dfLeft   = -( nIndex % 3 ) * dfWidth / 2;
+    double dfBottom = -( 2 - nIndex / 3 ) * dfHeight / 2;
+
+    Matrix    ocs   = Matrix::ocsToWcs( extrusion );
+    CADVector axisX = ocs.multiplyDirection( CADVector( cos( rotationAngle ), sin( rotationAngle ), 0.0 ) );
+    CADVector axisY = ocs.multiplyDirection( CADVector( -sin( rotationAngle ), cos( rotationAngle ), 0.0 ) );
+    CADVector corner( position.getX() + dfLeft * axisX.getX() + dfBottom * axisY.getX(),
+                      position.getY() + dfLeft * axisX.getY() + dfBottom * axisY.getY(),
+                      position.getZ() + dfLeft * axisX.getZ() + dfBottom * axisY.getZ() );
+    box.addRectangle( corner, CADVector( dfWidth * axisX.getX(), dfWidth * axisX.getY(), dfWidth * axisX.getZ() ),
+                      CADVector( dfHeight * axisY.getX(), dfHeight * axisY.getY(), dfHeight * axisY.getZ() ) );
+}
+
 void CADMText::print() const
 {
     cout << "|---------MText---------|\n" << "Position: " << position.getX() << "\t" << position.getY() << "\t" <<
@@ -1129,14 +2022,20 @@ CADFace3D::CADFace3D()
 
 void CADFace3D::addCorner( const CADVector& corner )
 {
+    invalidateBoundingBox();
     avertCorners.push_back( corner );
 }
 
-CADVector CADFace3D::getCorner( size_t index )
+CADVector CADFace3D::getCorner( size_t index ) const
 {
     return avertCorners[index];
 }
 
+size_t CADFace3D::getCornerCount() const
+{
+    return avertCorners.size();
+}
+
 void CADFace3D::print() const
 {
     cout << "|---------3DFace---------|\n" << "Corners: " << "\n";
@@ -1148,8 +2047,15 @@ void CADFace3D::print() const
     cout << endl;
 }
 
+void CADFace3D::computeBoundingBox( CADBoundingBox& box ) const
+{
+    for( const CADVector& corner : avertCorners )
+        box.addPoint( corner );
+}
+
 void CADFace3D::transform( const Matrix& matrix )
 {
+    invalidateBoundingBox();
     for( CADVector& corner : avertCorners )
     {
         corner = matrix.multiply( corner );
@@ -1180,21 +2086,27 @@ void CADPolylinePFace::print() const
     cout << "|---------PolylinePface---------|\n";
     for( size_t i = 0; i < vertexes.size(); ++i )
     {
-        cout << "  #" << i << ".\t" << vertexes[i].getX() << "\t" << vertexes[i].getY() << "\t" << vertexes[i].getZ() <<
-        "\n";
+        CADVector vertex = vertexes.get( i );
+        cout << "  #" << i << ".\t" << vertex.getX() << "\t" << vertex.getY() << "\t" << vertex.getZ() << "\n";
     }
     cout << endl;
 }
 
+void CADPolylinePFace::computeBoundingBox( CADBoundingBox& box ) const
+{
+    box.addPoints( vertexes );
+}
+
 void CADPolylinePFace::transform( const Matrix& matrix )
 {
-    for( CADVector& vertex : vertexes )
-        vertex = matrix.multiply( vertex );
+    invalidateBoundingBox();
+    transformVertexes( matrix, vertexes );
 }
 
 void CADPolylinePFace::addVertex( const CADVector& vertex )
 {
-    vertexes.push_back( vertex );
+    invalidateBoundingBox();
+    vertexes.add( vertex );
 }
 
 //------------------------------------------------------------------------------
@@ -1206,6 +2118,12 @@ CADXLine::CADXLine()
     geometryType = CADGeometry::XLINE;
 }
 
+void CADXLine::computeBoundingBox( CADBoundingBox& box ) const
+{
+    box.addRay( position, extrusion );
+    box.addRay( position, CADVector( -extrusion.getX(), -extrusion.getY(), -extrusion.getZ() ) );
+}
+
 void CADXLine::print() const
 {
     cout << "|---------XLine---------|\n" << "Position: " << position.getX() << "\t" << position.getY() << "\t" <<
@@ -1234,8 +2152,15 @@ void CADMLine::print() const
     cout << endl;
 }
 
+void CADMLine::computeBoundingBox( CADBoundingBox& box ) const
+{
+    for( const CADVector& vertex : avertVertexes )
+        box.addPoint( vertex );
+}
+
 void CADMLine::transform( const Matrix& matrix )
 {
+    invalidateBoundingBox();
     CADPoint3D::transform( matrix );
     for( CADVector& vertex : avertVertexes )
     {
@@ -1265,6 +2190,7 @@ void CADMLine::setOpened( bool value )
 
 void CADMLine::addVertex( const CADVector& vertex )
 {
+    invalidateBoundingBox();
     avertVertexes.push_back( vertex );
 }
 
@@ -1283,8 +2209,15 @@ void CADAttrib::print() const
     position.getZ() << "\n" << "Tag: " << sTag << "\n" << "Text: " << textValue << "\n" << endl;
 }
 
+void CADAttrib::computeBoundingBox( CADBoundingBox& box ) const
+{
+    box.addPoint( position );
+    box.addPoint( vertAlignmentPoint );
+}
+
 void CADAttrib::transform( const Matrix& matrix )
 {
+    invalidateBoundingBox();
     CADText::transform( matrix );
     vertAlignmentPoint = matrix.multiply( vertAlignmentPoint );
 }
@@ -1316,6 +2249,7 @@ CADVector CADAttrib::getAlignmentPoint() const
 
 void CADAttrib::setAlignmentPoint( const CADVector& vect )
 {
+    invalidateBoundingBox();
     vertAlignmentPoint = vect;
 }
 
@@ -43,18 +43,110 @@ class CADAttdef;
 class CADAttrib;
 
 /**
- * @brief The Matrix class
+ * @brief 3D affine transformation. Stored as a row-major 4x4 matrix, the last
+ * row is always (0, 0, 0, 1). translate(), rotate() and scale() are applied to
+ * the points before the transformation already stored in the matrix.
  */
 class Matrix
 {
 public:
               Matrix();
     void      translate( const CADVector& vector );
-    void      rotate( double rotation );
-    void      scale( const CADVector& vector );
+    void      rotate( double rotation ); // around Z axis
+    void      scale( const CADVector& vector ); // Z scale is 1 for 2D vector
+    /**
+     * @brief Returns composition of the transformations, other is applied first.
+     */
+    Matrix    multiply( const Matrix& other ) const;
     CADVector multiply( const CADVector& vector ) const;
+    CADVector multiplyDirection( const CADVector& vector ) const; // no translation
+    bool      isIdentity() const;
+    /**
+     * @brief Batch version of multiply(). Input Z may be nullptr for 2D points,
+     * output arrays may be the input ones.
+     */
+    void      transformPoints( const double * padfX, const double * padfY, const double * padfZ,
+                               double * padfOutX, double * padfOutY, double * padfOutZ, size_t nCount ) const;
+
+    /**
+     * @brief Transformation from object coordinate system given by extrusion
+     * direction to WCS (arbitrary axis algorithm).
+     */
+    static Matrix ocsToWcs( const CADVector& extrusion );
+    /**
+     * @brief Inverse of ocsToWcs().
+     */
+    static Matrix wcsToOcs( const CADVector& extrusion );
+protected:
+    array<double, 16> matrix;
+};
+
+/**
+ * @brief Axis aligned bounding box. Empty until the first point is added.
+ */
+class CADBoundingBox
+{
+public:
+           CADBoundingBox();
+    bool   isEmpty() const;
+    double getMinX() const;
+    double getMinY() const;
+    double getMinZ() const;
+    double getMaxX() const;
+    double getMaxY() const;
+    double getMaxZ() const;
+
+    void addPoint( double x, double y, double z );
+    void addPoint( const CADVector& point );
+    void addBox( const CADBoundingBox& box );
+    /**
+     * @brief Add circle arc going counterclockwise from startAngle to endAngle
+     * (radians). Full circle is added if angles are equal.
+     */
+    void addArc( const CADVector& center, double radius, double startAngle, double endAngle );
+    /**
+     * @brief Add arc lying in the plane given by extrusion. Center is in WCS,
+     * angles are measured in object coordinate system of the extrusion.
+     */
+    void addArc( const CADVector& center, double radius, double startAngle, double endAngle,
+                 const CADVector& extrusion );
+    /**
+     * @brief Add elliptical arc between start and end parameters (radians).
+     * Minor axis is perpendicular to the major one in the plane given by extrusion.
+     */
+    void addEllipse( const CADVector& center, const CADVector& majorAxis, double axisRatio,
+                     double startParam, double endParam, const CADVector& extrusion );
+    /**
+     * @brief Add polyline segment with bulge (tangent of 1/4 of the arc angle).
+     */
+    void addBulgeSegment( const CADVector& start, const CADVector& end, double bulge );
+    void addPoints( const CADVertexArray& points );
+    /**
+     * @brief Add parallelogram with the corner and two sides going from it.
+     */
+    void addRectangle( const CADVector& corner, const CADVector& sideA, const CADVector& sideB );
+    /**
+     * @brief Add half line going from origin along direction. Bounds on the
+     * sides the direction goes to become infinite.
+     */
+    void addRay( const CADVector& origin, const CADVector& direction );
+    bool isUnbounded() const; // some bound is infinite
+    /**
+     * @brief Add polyline vertexes. Bulges may be empty if all segments are straight.
+     */
+    void addPolyline( const CADVertexArray& vertexes, const vector<double>& bulges, bool bClosed );
+    /**
+     * @brief Add polyline lying in the plane given by extrusion. Vertexes are
+     * in WCS, bulges are measured in object coordinate system of the extrusion.
+     */
+    void addPolyline( const CADVertexArray& vertexes, const vector<double>& bulges, bool bClosed,
+                      const CADVector& extrusion );
+
+    bool           intersects( const CADBoundingBox& other ) const; // in XY plane
+    CADBoundingBox transform( const Matrix& matrix ) const;
 protected:
-    array<double, 9> matrix;
+    double minX, minY, minZ;
+    double maxX, maxY, maxZ;
 };
 
 /**
@@ -106,8 +198,25 @@ public:
     vector<string> getEED() const;
     void           setEED( vector<string> eed );
 
+    /**
+     * @brief returns geometry bounding box. It is computed on the first call
+     * and kept until the geometry is changed.
+     */
+    const CADBoundingBox& getBoundingBox() const;
+
     virtual void print() const                     = 0;
     virtual void transform( const Matrix& matrix ) = 0;
+    /**
+     * @brief moves geometry stored in object coordinate system to WCS. Called
+     * once by the file reader, so geometries returned by CADFile::GetGeometry()
+     * are in WCS. Extrusion of a planar geometry is then the WCS normal of its
+     * plane, its angles and bulges are measured in OCS of that normal and
+     * elevation is 0.
+     */
+    void         transformFromOCS();
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const;
+    void         invalidateBoundingBox();
 protected:
     vector<CADAttrib> blockAttributes; // attributes of block reference this geometry is attached to.
 
@@ -115,6 +224,9 @@ protected:
     enum GeometryType geometryType;
     double            thickness;
     RGBColor          geometry_color;
+
+    mutable CADBoundingBox boundingBox;
+    mutable bool           bBoundingBoxValid;
 };
 
 /**
@@ -148,6 +260,8 @@ public:
 
     virtual void print() const override;
     virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     CADVector position;
     CADVector extrusion;
@@ -171,6 +285,8 @@ public:
 
     virtual void print() const override;
     virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     CADPoint3D start;
     CADPoint3D end;
@@ -184,9 +300,17 @@ class CADPolyline2D : public CADGeometry
 public:
 	CADPolyline2D();
 
-	void	   addVertex(const CADVector& vertex);
-	size_t	   getVertexCount() const;
-	CADVector& getVertex(size_t index);
+	void	  addVertex(const CADVector& vertex);
+	size_t	  getVertexCount() const;
+	CADVector getVertex(size_t index) const;
+	void      setVertex(size_t index, const CADVector& vertex);
+	void      setVertexes(CADVertexArray value);
+	const CADVertexArray& getVertexes() const;
+
+	// Vertexes coordinates as contiguous arrays. Z is empty for 2D vertexes.
+	const vector<double>& getXs() const;
+	const vector<double>& getYs() const;
+	const vector<double>& getZs() const;
 
 	bool isClosed() const;
 	void setClosed(bool state);
@@ -209,13 +333,15 @@ public:
 	vector<pair<double, double> > getWidths() const;
 	void                          setWidths(const vector<pair<double, double> >& value);
 
-	bool		   hasBulges() const; // true if any vertexes have non zero bulges
-	vector<double> getBulges() const;
-	void           setBulges(const vector<double>& value);
+	bool		          hasBulges() const; // true if any vertexes have non zero bulges
+	const vector<double>& getBulges() const;
+	void                  setBulges(const vector<double>& value);
 
 	virtual void print() const override;
 	virtual void transform( const Matrix& matrix ) override;
 
+protected:
+	virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
 	bool						  bClosed;
 	bool						  bSplined;
@@ -226,7 +352,7 @@ protected:
 	bool						  hasNonZeroBulges;
 	vector<double>				  bulges;
 	vector<pair<double, double> > widths; // start, end.
-	vector<CADVector>	          vertexes;
+	CADVertexArray	              vertexes;
 };
 
 
@@ -238,9 +364,16 @@ class CADPolyline3D : public CADGeometry
 public:
     CADPolyline3D();
 
-    void       addVertex( const CADVector& vertex );
-    size_t	   getVertexCount() const;
-    CADVector& getVertex( size_t index );
+    void      addVertex( const CADVector& vertex );
+    size_t	  getVertexCount() const;
+    CADVector getVertex( size_t index ) const;
+    void      setVertex( size_t index, const CADVector& vertex );
+    void      setVertexes( CADVertexArray value );
+
+    // Vertexes coordinates as contiguous arrays. Z is empty for 2D vertexes.
+    const vector<double>& getXs() const;
+    const vector<double>& getYs() const;
+    const vector<double>& getZs() const;
 
 	bool isClosed() const;
 	void setClosed( bool state );
@@ -251,10 +384,12 @@ public:
     virtual void print() const override;
     virtual void transform( const Matrix& matrix ) override;
 
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
 	bool			  bClosed;
 	bool			  bSplined;
-    vector<CADVector> vertexes;
+    CADVertexArray    vertexes;
 };
 
 /**
@@ -266,10 +401,17 @@ class CADLWPolyline : public CADGeometry
 public:
     CADLWPolyline();
 
-	void       addVertex(const CADVector& vertex);
-	size_t	   getVertexCount() const;
-	CADVector& getVertex(size_t index);
-	const CADVector& getVertex(size_t index) const;
+	void      addVertex(const CADVector& vertex);
+	size_t	  getVertexCount() const;
+	CADVector getVertex(size_t index) const;
+	void      setVertex(size_t index, const CADVector& vertex);
+	void      setVertexes(CADVertexArray value);
+	const CADVertexArray& getVertexes() const;
+
+	// Vertexes coordinates as contiguous arrays. Z is empty for 2D vertexes.
+	const vector<double>& getXs() const;
+	const vector<double>& getYs() const;
+	const vector<double>& getZs() const;
 
 	bool isClosed() const;
 	void setClosed(bool state);
@@ -286,13 +428,15 @@ public:
     vector<pair<double, double> > getWidths() const;
     void                          setWidths( const vector<pair<double, double> >& value );
 
-	bool		   hasBulges() const; // true if any vertexes have non zero bulges
-    vector<double> getBulges() const;
-    void           setBulges( const vector<double>& value );
+	bool		          hasBulges() const; // true if any vertexes have non zero bulges
+    const vector<double>& getBulges() const;
+    void                  setBulges( const vector<double>& value );
 
     virtual void print() const override;
 	virtual void transform(const Matrix& matrix) override;
 
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
 	bool						  bClosed;
     double                        constWidth;
@@ -301,7 +445,7 @@ protected:
 	bool						  hasNonZeroBulges;
     vector<double>                bulges;
     vector<pair<double, double> > widths; // start, end.
-	vector<CADVector>		      vertexes;
+	CADVertexArray		          vertexes;
 };
 
 /**
@@ -316,6 +460,9 @@ public:
     void   setRadius( double value );
 
     virtual void print() const override;
+    virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     double radius;
 };
@@ -341,6 +488,7 @@ public:
     void   setObliqueAngle( double value );
 
     virtual void print() const override;
+    virtual void transform( const Matrix& matrix ) override;
 protected:
     double obliqueAngle;
     double rotationAngle;
@@ -363,6 +511,9 @@ public:
     void   setEndingAngle( double value );
 
     virtual void print() const override;
+    virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     double startingAngle;
     double endingAngle;
@@ -383,6 +534,9 @@ public:
     void      setSMAxis( const CADVector& vectSMA );
 
     virtual void print() const override;
+    virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     CADVector vectSMAxis;
     double    axisRatio;
@@ -405,13 +559,26 @@ public:
     bool isClosed() const;
     void setClosed( bool value );
 
-    vector<CADVector>& getControlPoints();
-    vector<CADVector>& getFitPoints();
-    vector<double>   & getControlPointsWeights();
+    const CADVertexArray& getControlPoints() const;
+    const CADVertexArray& getFitPoints() const;
+    vector<double>      & getControlPointsWeights();
+    const vector<double>& getControlPointsWeights() const;
+
+    const vector<double>& getKnots() const;
+    void                  setKnots( vector<double> value );
+
+    // Tangent directions at the ends of a spline defined by fit points.
+    // Zero vector if not set.
+    CADVector getBegTangentDir() const;
+    void      setBegTangentDir( const CADVector& value );
+    CADVector getEndTangentDir() const;
+    void      setEndTangentDir( const CADVector& value );
 
     void addControlPointsWeight( double p_weight );
     void addControlPoint( const CADVector& point );
     void addFitPoint( const CADVector& point );
+    void setControlPoints( CADVertexArray value );
+    void setFitPoints( CADVertexArray value );
 
     bool getWeight() const;
     void setWeight( bool value );
@@ -424,6 +591,8 @@ public:
 
     virtual void print() const override;
     virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     long   scenario;
     bool   rational;
@@ -432,9 +601,12 @@ protected:
     double fitTollerance;
     long   degree;
 
-    vector<double>    ctrlPointsWeight;
-    vector<CADVector> avertCtrlPoints;
-    vector<CADVector> averFitPoints;
+    vector<double> ctrlPointsWeight;
+    vector<double> knots;
+    CADVertexArray avertCtrlPoints;
+    CADVertexArray averFitPoints;
+    CADVector      vectBegTangentDir;
+    CADVector      vectEndTangentDir;
 };
 
 /**
@@ -448,10 +620,12 @@ public:
     double getElevation() const;
     void   setElevation( double value );
     void   addCorner( const CADVector& corner );
-    vector<CADVector> getCorners();
+    vector<CADVector> getCorners() const;
 
     virtual void print() const override;
     virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     double            elevation;
     vector<CADVector> avertCorners;
@@ -469,6 +643,9 @@ public:
     void      setVectVector( const CADVector& value );
 
     virtual void print() const override;
+    virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 };
 
 /**
@@ -499,6 +676,13 @@ public:
     CADVector getVertInsertionPoint() const;
     void      setVertInsertionPoint( const CADVector& value );
 
+    // Sizes of one pixel along the image bottom and left sides in WCS
+    CADVector getVectUDirection() const;
+    void      setVectUDirection( const CADVector& value );
+
+    CADVector getVectVDirection() const;
+    void      setVectVDirection( const CADVector& value );
+
     CADVector getImageSize() const;
     void      setImageSize( const CADVector& value );
 
@@ -523,11 +707,13 @@ public:
 
     virtual void print() const override;
     virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     CADVector     vertInsertionPoint;
-    //CADVector vectUDirection;
-    //CADVector vectVDirection;
-    CADVector     imageSize;
+    CADVector     vectUDirection;
+    CADVector     vectVDirection;
+    CADVector     imageSize; // in pixels
     //bool bShow;
     //bool bShowWhenNotAlignedWithScreen;
     //bool bUseClippingBoundary;
@@ -565,11 +751,19 @@ public:
     double getExtentsWidth() const;
     void   setExtentsWidth( double value );
 
+    // 1 - 9 for top left, top center, ... bottom right corner of the text
+    short getAttachment() const;
+    void  setAttachment( short value );
+
     virtual void print() const override;
+    virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     double rectWidth;
     double extents;
     double extentsWidth;
+    short  attachment;
     // TODO: do we need this here?
     //short dDrawingDir;
     //short dLineSpacingStyle;
@@ -589,13 +783,16 @@ public:
     CADFace3D();
 
     void      addCorner( const CADVector& corner );
-    CADVector getCorner( size_t index );
+    CADVector getCorner( size_t index ) const;
+    size_t    getCornerCount() const;
 
     short getInvisFlags() const;
     void  setInvisFlags( short value );
 
     virtual void print() const override;
     virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     vector<CADVector> avertCorners;
     short             invisFlags;
@@ -614,7 +811,9 @@ public:
     virtual void print() const override;
     virtual void transform( const Matrix& matrix ) override;
 protected:
-    vector<CADVector> vertexes;
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
+protected:
+    CADVertexArray vertexes;
 };
 
 /**
@@ -626,6 +825,8 @@ public:
     CADXLine();
 
     virtual void print() const override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 };
 
 /**
@@ -646,6 +847,8 @@ public:
 
     virtual void print() const override;
     virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     double            scale;
     //char dJust;
@@ -676,6 +879,8 @@ public:
 
     virtual void print() const override;
     virtual void transform( const Matrix& matrix ) override;
+protected:
+    virtual void computeBoundingBox( CADBoundingBox& box ) const override;
 protected:
     CADVector vertAlignmentPoint;
     double    dfElevation;
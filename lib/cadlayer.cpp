@@ -34,10 +34,11 @@
 #include <cassert>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 
 CADLayer::CADLayer( CADFile * file ) : frozen( false ), on( true ), frozenByDefault( false ), locked( false ),
                                        plotting( false ), lineWeight( 1 ), color( 0 ), layerId( 0 ), layer_handle( 0 ),
-                                       pCADFile( file )
+                                       bBoundingBoxesRead( true ), pCADFile( file )
 {
 }
 
@@ -142,11 +143,20 @@ void CADLayer::setHandle( long value )
 }
 
 void CADLayer::addHandle( long handle, CADObject::ObjectType type, long cadinserthandle )
+{
+    addEntity( handle, type, cadinserthandle, 0 );
+}
+
+void CADLayer::addEntity( long handle, CADObject::ObjectType type, long cadinserthandle, size_t nMatrix )
 {
 #ifdef _DEBUG
     cout << "addHandle: " << handle << " type: " << type << endl;
 #endif //_DEBUG
-    if( type == CADObject::ATTRIB || type == CADObject::ATTDEF )
+    if( !pCADFile->getFilter().isObjectTypeAccepted( type ) )
+        return;
+
+    if( ( type == CADObject::ATTRIB || type == CADObject::ATTDEF ) &&
+        !( pCADFile->getFilter().getDecodeFlags() & CADFilter::SKIP_ATTRIBUTES ) )
     {
         unique_ptr<CADAttdef> attdef( static_cast< CADAttdef *>( pCADFile->GetGeometry( this->getId() - 1, handle ) ) );
 
@@ -155,8 +165,6 @@ void CADLayer::addHandle( long handle, CADObject::ObjectType type, long cadinser
 
     if( type == CADObject::INSERT )
     {
-        // TODO: transform insert to block of objects (do we need to transform
-        // coordinates according to insert point)?
         unique_ptr<CADObject> insert( pCADFile->GetObject( handle, false ) );
         CADInsertObject * pInsert = static_cast<CADInsertObject *>(insert.get());
         if( nullptr != pInsert )
@@ -178,6 +186,19 @@ void CADLayer::addHandle( long handle, CADObject::ObjectType type, long cadinser
                 if( dCurrentEntHandle == dLastEntHandle ) // Blocks can be empty (contain no objects)
                     return;
 
+                // Block entities are moved from the block base point, scaled,
+                // rotated and moved to the insertion point in the insert OCS.
+                // Nested inserts are applied on top of the parent one.
+                Matrix mat = nMatrix > 0 ? insertMatrices[nMatrix - 1] : Matrix();
+                mat = mat.multiply( Matrix::ocsToWcs( pInsert->vectExtrusion ) );
+                mat.translate( pInsert->vertInsertionPoint );
+                mat.rotate( pInsert->dfRotation );
+                mat.scale( pInsert->vertScales );
+                const CADVector& base = pBlockHeader->vertBasePoint;
+                mat.translate( CADVector( -base.getX(), -base.getY(), -base.getZ() ) );
+                insertMatrices.push_back( mat );
+                size_t nInsertMatrix = insertMatrices.size();
+
                 while( true )
                 {
                     unique_ptr<CADEntityObject> entity( static_cast< CADEntityObject * >(
@@ -187,12 +208,7 @@ void CADLayer::addHandle( long handle, CADObject::ObjectType type, long cadinser
                     {
                         if( entity != nullptr )
                         {
-                            addHandle( dCurrentEntHandle, entity->getType(), handle );
-                            Matrix mat;
-                            mat.translate( pInsert->vertInsertionPoint );
-                            mat.scale( pInsert->vertScales );
-                            mat.rotate( pInsert->dfRotation );
-                            transformations[dCurrentEntHandle] = mat;
+                            addEntity( dCurrentEntHandle, entity->getType(), handle, nInsertMatrix );
                             break;
                         } else
                         {
@@ -202,12 +218,7 @@ void CADLayer::addHandle( long handle, CADObject::ObjectType type, long cadinser
 
                     if( entity != nullptr )
                     {
-                        addHandle( dCurrentEntHandle, entity->getType(), handle );
-                        Matrix mat;
-                        mat.translate( pInsert->vertInsertionPoint );
-                        mat.scale( pInsert->vertScales );
-                        mat.rotate( pInsert->dfRotation );
-                        transformations[dCurrentEntHandle] = mat;
+                        addEntity( dCurrentEntHandle, entity->getType(), handle, nInsertMatrix );
 
                         if( entity->stCed.bNoLinks )
                             ++dCurrentEntHandle;
@@ -225,37 +236,62 @@ void CADLayer::addHandle( long handle, CADObject::ObjectType type, long cadinser
 
     if( isCommonEntityType( type ) )
     {
+        if( type != CADObject::IMAGE && !pCADFile->isReadingUnsupportedGeometries() &&
+            !isSupportedGeometryType( type ) )
+            return;
+
+        CADBoundingBox oBox;
+        bool bHasBox = pCADFile->getFilter().hasSpatialFilter();
+        if( bHasBox && !matchesSpatialFilter( handle, nMatrix, oBox ) )
+            return;
+
+        // Bounding boxes read by the spatial filter are kept, so extents and
+        // spatial index don't need to read them again.
+        if( bHasBox )
+        {
+            if( !oBox.isUnbounded() )
+                extents.addBox( oBox );
+        }
+        else
+            bBoundingBoxesRead = false;
+        if( spatialIndex.isBuilt() )
+            spatialIndex = CADSpatialIndex();
+        if( levelsOfDetail.isBuilt() )
+            levelsOfDetail.clear();
+
         if( type == CADObject::IMAGE )
+        {
             imageHandles.push_back( handle );
+            imageMatrices.push_back( nMatrix );
+        }
         else
         {
-            if( pCADFile->isReadingUnsupportedGeometries() == false )
-            {
-                if( isSupportedGeometryType( type ) )
-                {
-                    if( geometryTypes.size() == 0 ) geometryTypes.push_back( type );
-
-                    if( find( geometryTypes.begin(), geometryTypes.end(), type ) == geometryTypes.end() )
-                    {
-                        geometryTypes.push_back( type );
-                    }
-                    geometryHandles.push_back( make_pair( handle, cadinserthandle ) );
-                }
-            }
-            else
-            {
-                if( geometryTypes.size() == 0 ) geometryTypes.push_back( type );
-
-                if( find( geometryTypes.begin(), geometryTypes.end(), type ) == geometryTypes.end() )
-                {
-                    geometryTypes.push_back( type );
-                }
-                geometryHandles.push_back( make_pair( handle, cadinserthandle ) );
-            }
+            if( find( geometryTypes.begin(), geometryTypes.end(), type ) == geometryTypes.end() )
+                geometryTypes.push_back( type );
+            geometryHandles.push_back( make_pair( handle, cadinserthandle ) );
+            geometryMatrices.push_back( nMatrix );
+            if( bHasBox )
+                geometryBoxes.push_back( oBox );
         }
     }
 }
 
+bool CADLayer::matchesSpatialFilter( long handle, size_t nMatrix, CADBoundingBox& oBox )
+{
+    pCADFile->GetBoundingBoxes( this->getId() - 1, &handle, 1, &oBox );
+    if( nMatrix > 0 )
+        oBox = oBox.transform( insertMatrices[nMatrix - 1] );
+    return oBox.intersects( pCADFile->getFilter().getSpatialFilter() );
+}
+
+void CADLayer::transformToWCS( CADGeometry * pGeom, size_t nMatrix ) const
+{
+    // Reader has already moved the geometry from its OCS, only block
+    // reference transformation is left.
+    if( nMatrix > 0 )
+        pGeom->transform( insertMatrices[nMatrix - 1] );
+}
+
 size_t CADLayer::getGeometryCount() const
 {
     return geometryHandles.size();
@@ -268,12 +304,7 @@ CADGeometry * CADLayer::getGeometry( size_t index )
                                                  handleBlockRefPair.second );
     if( nullptr == pGeom )
         return nullptr;
-    auto iter = transformations.find( handleBlockRefPair.first );
-    if( iter != transformations.end() )
-    {
-        // transform geometry if nHandle is in transformations
-        pGeom->transform( iter->second );
-    }
+    transformToWCS( pGeom, geometryMatrices[index] );
     return pGeom;
 }
 
@@ -284,7 +315,89 @@ size_t CADLayer::getImageCount() const
 
 CADImage * CADLayer::getImage( size_t index )
 {
-    return static_cast<CADImage *>(pCADFile->GetGeometry( this->getId() - 1, imageHandles[index] ));
+    CADImage * pImage = static_cast<CADImage *>(pCADFile->GetGeometry( this->getId() - 1, imageHandles[index] ));
+    if( nullptr != pImage )
+        transformToWCS( pImage, imageMatrices[index] );
+    return pImage;
+}
+
+const CADBoundingBox& CADLayer::getGeometryBoundingBox( size_t index )
+{
+    readBoundingBoxes();
+    return geometryBoxes[index];
+}
+
+const CADBoundingBox& CADLayer::getExtents()
+{
+    readBoundingBoxes();
+    return extents;
+}
+
+void CADLayer::readBoundingBoxes()
+{
+    if( bBoundingBoxesRead )
+        return;
+
+    vector<long> adHandles;
+    adHandles.reserve( geometryHandles.size() + imageHandles.size() );
+    for( const auto& handleBlockRefPair : geometryHandles )
+        adHandles.push_back( handleBlockRefPair.first );
+    adHandles.insert( adHandles.end(), imageHandles.begin(), imageHandles.end() );
+
+    vector<CADBoundingBox> aoBoxes( adHandles.size() );
+    if( !adHandles.empty() )
+        pCADFile->GetBoundingBoxes( this->getId() - 1, adHandles.data(), adHandles.size(), aoBoxes.data() );
+
+    extents = CADBoundingBox();
+    for( size_t i = 0; i < aoBoxes.size(); ++i )
+    {
+        size_t nMatrix = i < geometryMatrices.size() ? geometryMatrices[i] :
+                         imageMatrices[i - geometryMatrices.size()];
+        if( nMatrix > 0 )
+            aoBoxes[i] = aoBoxes[i].transform( insertMatrices[nMatrix - 1] );
+        if( !aoBoxes[i].isUnbounded() )
+            extents.addBox( aoBoxes[i] );
+    }
+
+    aoBoxes.resize( geometryHandles.size() );
+    geometryBoxes.swap( aoBoxes );
+    bBoundingBoxesRead = true;
+    spatialIndex       = CADSpatialIndex();
+}
+
+void CADLayer::buildSpatialIndex()
+{
+    readBoundingBoxes();
+    if( !spatialIndex.isBuilt() )
+        spatialIndex.build( geometryBoxes );
+}
+
+void CADLayer::queryWindow( double minx, double miny, double maxx, double maxy,
+                            const function<void( size_t )>& callback )
+{
+    buildSpatialIndex();
+    spatialIndex.query( minx, miny, maxx, maxy, callback );
+}
+
+void CADLayer::buildLevelsOfDetail( const vector<double>& tolerances, enum CADLevelOfDetail::Method eMethod,
+                                    double dfCurveTolerance )
+{
+    // Curves are flattened finer than the finest level by default
+    if( dfCurveTolerance <= 0.0 )
+    {
+        dfCurveTolerance = HUGE_VAL;
+        for( double dfTolerance : tolerances )
+            if( dfTolerance > 0.0 )
+                dfCurveTolerance = min( dfCurveTolerance, dfTolerance / 4 );
+        if( dfCurveTolerance == HUGE_VAL )
+            dfCurveTolerance = CADTessellator().getTolerance();
+    }
+    levelsOfDetail.build( *this, tolerances, eMethod, CADTessellator( dfCurveTolerance ) );
+}
+
+const CADLevelOfDetail& CADLayer::getLevelsOfDetail() const
+{
+    return levelsOfDetail;
 }
 
 bool CADLayer::addAttribute( const CADObject * pObject )
@@ -32,6 +32,8 @@
 #define CADLAYER_H
 
 #include "cadgeometry.h"
+#include "cadlevelofdetail.h"
+#include "cadspatialindex.h"
 
 #include <memory>
 #include <unordered_set>
@@ -80,10 +82,52 @@ public:
     void addHandle( long handle, enum CADObject::ObjectType type, long cadinserthandle = 0 );
 
     size_t getGeometryCount() const;
+    /**
+     * @brief returns geometry in WCS, i.e. with entity object coordinate system
+     * and block references transformations applied
+     */
     CADGeometry * getGeometry( size_t index );
     size_t getImageCount() const;
     CADImage * getImage( size_t index );
 
+    /**
+     * @brief returns bounding box of the geometry with block reference
+     * transformation applied, without reading the whole geometry
+     */
+    const CADBoundingBox& getGeometryBoundingBox( size_t index );
+
+    /**
+     * @brief returns bounding box of all layer geometries and images. Rays
+     * and xlines are unbounded and not included.
+     */
+    const CADBoundingBox& getExtents();
+
+    /**
+     * @brief build spatial index of the layer geometries. It is built on the
+     * first queryWindow() call if not built yet.
+     */
+    void buildSpatialIndex();
+
+    /**
+     * @brief call callback with index of every geometry which bounding box
+     * intersects the window. Use getGeometry() to read the geometry.
+     */
+    void queryWindow( double minx, double miny, double maxx, double maxy,
+                      const function<void( size_t )>& callback );
+
+    /**
+     * @brief build simplified versions of the layer geometries for the
+     * tolerances. It is optional, levels are kept until the layer changes.
+     */
+    void buildLevelsOfDetail( const vector<double>& tolerances,
+                              enum CADLevelOfDetail::Method eMethod = CADLevelOfDetail::DOUGLAS_PEUCKER,
+                              double dfCurveTolerance = 0.0 );
+    /**
+     * @brief returns levels of detail, empty if they are not built. Use
+     * selectLevel() with the target resolution and getVertexes() of the level.
+     */
+    const CADLevelOfDetail& getLevelsOfDetail() const;
+
     /**
      * @brief returns a vector of presented geometries types
      */
@@ -91,6 +135,11 @@ public:
 
 protected:
     bool addAttribute( const CADObject * pObject );
+    // nMatrix is index of the block reference transformation + 1, 0 if none.
+    void addEntity( long handle, enum CADObject::ObjectType type, long cadinserthandle, size_t nMatrix );
+    void transformToWCS( CADGeometry * pGeom, size_t nMatrix ) const;
+    void readBoundingBoxes();
+    bool matchesSpatialFilter( long handle, size_t nMatrix, CADBoundingBox& oBox );
 protected:
     string layerName;
     bool   frozen;
@@ -106,9 +155,16 @@ protected:
     vector<CADObject::ObjectType>           geometryTypes; // FIXME: replace with hashset would be perfect
     unordered_set<string>                   attributesNames;
     vector<pair<long, long> >               geometryHandles; // second param is CADInsert handle, 0 if it's not a geometry in block ref.
+    vector<size_t>                          geometryMatrices; // same order as geometryHandles
     vector<long>                            imageHandles;
+    vector<size_t>                          imageMatrices; // same order as imageHandles
     vector<pair<long, map<string, long> > > geometryAttributes;
-    map<long, Matrix>                       transformations;
+    vector<Matrix>                          insertMatrices; // composite transformation of every block reference
+    vector<CADBoundingBox>                  geometryBoxes; // same order as geometryHandles
+    CADBoundingBox                          extents;
+    bool                                    bBoundingBoxesRead;
+    CADSpatialIndex                         spatialIndex;
+    CADLevelOfDetail                        levelsOfDetail;
 
     CADFile * pCADFile;
 };
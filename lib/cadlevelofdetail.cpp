@@ -0,0 +1,311 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadlevelofdetail.h"
+#include "cadlayer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+
+static const uint32_t REMOVED = 0xFFFFFFFF;
+
+// Twice the area of the triangle
+static double triangleArea( const double * padfX, const double * padfY, uint32_t a, uint32_t b, uint32_t c )
+{
+    return fabs( ( padfX[b] - padfX[a] ) * ( padfY[c] - padfY[a] ) -
+                 ( padfX[c] - padfX[a] ) * ( padfY[b] - padfY[a] ) );
+}
+
+CADLevelOfDetail::CADLevelOfDetail() : eMethod( DOUGLAS_PEUCKER ), bBuilt( false )
+{
+}
+
+void CADLevelOfDetail::build( CADLayer& layer, const vector<double>& tolerances, enum Method eMethodIn,
+                              const CADTessellator& tessellator )
+{
+    clear();
+    eMethod = eMethodIn;
+
+    vector<double> sortedTolerances;
+    for( double dfTolerance : tolerances )
+        if( dfTolerance > 0.0 )
+            sortedTolerances.push_back( dfTolerance );
+    sort( sortedTolerances.begin(), sortedTolerances.end() );
+    sortedTolerances.erase( unique( sortedTolerances.begin(), sortedTolerances.end() ), sortedTolerances.end() );
+    levels.resize( sortedTolerances.size() );
+    for( size_t i = 0; i < levels.size(); ++i )
+        levels[i].dfTolerance = sortedTolerances[i];
+
+    vector<double>                  weights;
+    vector<uint32_t>                links;
+    vector<pair<double, uint32_t> > heap;
+    anFirstVertexes.push_back( 0 );
+    for( size_t i = 0; i < layer.getGeometryCount(); ++i )
+    {
+        unique_ptr<CADGeometry> geometry( layer.getGeometry( i ) );
+        enum CADTessellator::SimpleFeature eType =
+            geometry == nullptr ? CADTessellator::NONE : tessellator.getSimpleFeature( geometry.get(), oVertexes );
+        anTypes.push_back( static_cast<uint8_t>( eType ) );
+        anFirstVertexes.push_back( oVertexes.size() );
+
+        size_t nCount = getVertexCount( i );
+        bool   bSimplify = eType != CADTessellator::POINT && nCount > 2;
+        if( bSimplify )
+            computeWeights( i, weights, links, heap );
+        for( Level& level : levels )
+        {
+            level.anStarts.push_back( level.anIndexes.size() );
+            if( !bSimplify )
+                continue;
+            double dfThreshold = getThreshold( level.dfTolerance );
+            size_t nKept = count_if( weights.begin(), weights.end(),
+                                     [dfThreshold]( double dfWeight ) { return dfWeight > dfThreshold; } );
+            if( nKept == nCount )
+                continue;
+            for( uint32_t j = 0; j < nCount; ++j )
+                if( weights[j] > dfThreshold )
+                    level.anIndexes.push_back( j );
+        }
+    }
+    for( Level& level : levels )
+    {
+        level.anStarts.push_back( level.anIndexes.size() );
+        level.anIndexes.shrink_to_fit();
+    }
+    bBuilt = true;
+}
+
+bool CADLevelOfDetail::isBuilt() const
+{
+    return bBuilt;
+}
+
+void CADLevelOfDetail::clear()
+{
+    bBuilt    = false;
+    oVertexes = CADVertexArray();
+    anFirstVertexes.clear();
+    anTypes.clear();
+    levels.clear();
+}
+
+size_t CADLevelOfDetail::getLevelCount() const
+{
+    return levels.size() + 1;
+}
+
+double CADLevelOfDetail::getTolerance( size_t nLevel ) const
+{
+    return nLevel == 0 || nLevel > levels.size() ? 0.0 : levels[nLevel - 1].dfTolerance;
+}
+
+size_t CADLevelOfDetail::selectLevel( double dfResolution ) const
+{
+    size_t nLevel = 0;
+    while( nLevel < levels.size() && levels[nLevel].dfTolerance <= dfResolution )
+        ++nLevel;
+    return nLevel;
+}
+
+size_t CADLevelOfDetail::getGeometryCount() const
+{
+    return anTypes.size();
+}
+
+enum CADTessellator::SimpleFeature CADLevelOfDetail::getType( size_t iGeometry ) const
+{
+    return static_cast<enum CADTessellator::SimpleFeature>( anTypes[iGeometry] );
+}
+
+const uint32_t * CADLevelOfDetail::getIndexes( size_t iGeometry, size_t nLevel, size_t& nCount ) const
+{
+    if( nLevel > 0 && nLevel <= levels.size() )
+    {
+        const Level& level  = levels[nLevel - 1];
+        size_t       nStart = level.anStarts[iGeometry];
+        nCount = level.anStarts[iGeometry + 1] - nStart;
+        if( nCount > 0 )
+            return &level.anIndexes[nStart];
+    }
+    nCount = getVertexCount( iGeometry );
+    return nullptr;
+}
+
+size_t CADLevelOfDetail::getVertexes( size_t iGeometry, size_t nLevel, CADVertexArray& out ) const
+{
+    size_t           nCount;
+    const uint32_t * panIndexes = getIndexes( iGeometry, nLevel, nCount );
+    size_t           nFirst     = anFirstVertexes[iGeometry];
+    const double *   padfX      = oVertexes.getXs().data() + nFirst;
+    const double *   padfY      = oVertexes.getYs().data() + nFirst;
+    const double *   padfZ      = oVertexes.hasZ() ? oVertexes.getZs().data() + nFirst : nullptr;
+    out.reserve( out.size() + nCount );
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        size_t j = panIndexes != nullptr ? panIndexes[i] : i;
+        if( padfZ != nullptr )
+            out.add( padfX[j], padfY[j], padfZ[j] );
+        else
+            out.add( padfX[j], padfY[j] );
+    }
+    return nCount;
+}
+
+const CADVertexArray& CADLevelOfDetail::getVertexes() const
+{
+    return oVertexes;
+}
+
+size_t CADLevelOfDetail::getFirstVertex( size_t iGeometry ) const
+{
+    return anFirstVertexes[iGeometry];
+}
+
+size_t CADLevelOfDetail::getVertexCount( size_t iGeometry ) const
+{
+    return anFirstVertexes[iGeometry + 1] - anFirstVertexes[iGeometry];
+}
+
+void CADLevelOfDetail::computeWeights( size_t iGeometry, vector<double>& weights, vector<uint32_t>& links,
+                                       vector<pair<double, uint32_t> >& heap ) const
+{
+    uint32_t       nCount = static_cast<uint32_t>( getVertexCount( iGeometry ) );
+    const double * padfX  = oVertexes.getXs().data() + anFirstVertexes[iGeometry];
+    const double * padfY  = oVertexes.getYs().data() + anFirstVertexes[iGeometry];
+    weights.assign( nCount, 0.0 );
+    weights[0]          = HUGE_VAL;
+    weights[nCount - 1] = HUGE_VAL;
+
+    if( eMethod == DOUGLAS_PEUCKER )
+    {
+        // Vertex weight is its distance to the range chord, but not more than
+        // the weight of the range ends, so the vertex is kept at a tolerance
+        // only if its range is split at that tolerance too.
+        links.clear();
+        links.push_back( nCount - 1 );
+        links.push_back( 0 );
+        while( !links.empty() )
+        {
+            uint32_t nFirst = links.back();
+            links.pop_back();
+            uint32_t nLast = links.back();
+            links.pop_back();
+            if( nLast - nFirst < 2 )
+                continue;
+
+            double   dx        = padfX[nLast] - padfX[nFirst];
+            double   dy        = padfY[nLast] - padfY[nFirst];
+            double   dfLength2 = dx * dx + dy * dy;
+            double   dfMax     = -1.0;
+            uint32_t nMax      = nFirst + 1;
+            for( uint32_t i = nFirst + 1; i < nLast; ++i )
+            {
+                double px = padfX[i] - padfX[nFirst];
+                double py = padfY[i] - padfY[nFirst];
+                double t  = dfLength2 > 0.0 ? min( max( ( px * dx + py * dy ) / dfLength2, 0.0 ), 1.0 ) : 0.0;
+                double ex = px - t * dx;
+                double ey = py - t * dy;
+                double dfDistance2 = ex * ex + ey * ey;
+                if( dfDistance2 > dfMax )
+                {
+                    dfMax = dfDistance2;
+                    nMax  = i;
+                }
+            }
+            weights[nMax] = min( sqrt( dfMax ), min( weights[nFirst], weights[nLast] ) );
+            links.push_back( nLast );
+            links.push_back( nMax );
+            links.push_back( nMax );
+            links.push_back( nFirst );
+        }
+    }
+    else
+    {
+        // Vertexes are removed by increasing effective area. Weight of a
+        // vertex is not less than the weights of those removed before it.
+        links.resize( 2 * nCount ); // previous and next vertex
+        heap.clear();
+        for( uint32_t i = 1; i + 1 < nCount; ++i )
+        {
+            links[2 * i]     = i - 1;
+            links[2 * i + 1] = i + 1;
+            weights[i]       = triangleArea( padfX, padfY, i - 1, i, i + 1 ) / 2;
+            heap.push_back( make_pair( weights[i], i ) );
+        }
+        auto compare = greater<pair<double, uint32_t> >();
+        make_heap( heap.begin(), heap.end(), compare );
+        double dfLastArea = 0.0;
+        while( !heap.empty() )
+        {
+            pair<double, uint32_t> item = heap.front();
+            pop_heap( heap.begin(), heap.end(), compare );
+            heap.pop_back();
+            uint32_t i = item.second;
+            if( links[2 * i + 1] == REMOVED || item.first != weights[i] )
+                continue; // removed or updated later
+
+            dfLastArea = max( dfLastArea, item.first );
+            weights[i] = dfLastArea;
+            uint32_t nPrev = links[2 * i];
+            uint32_t nNext = links[2 * i + 1];
+            links[2 * i + 1] = REMOVED;
+            links[2 * nNext] = nPrev;
+            links[2 * nPrev + 1] = nNext;
+            for( uint32_t j : { nPrev, nNext } )
+            {
+                if( j == 0 || j == nCount - 1 )
+                    continue;
+                weights[j] = triangleArea( padfX, padfY, links[2 * j], j, links[2 * j + 1] ) / 2;
+                heap.push_back( make_pair( weights[j], j ) );
+                push_heap( heap.begin(), heap.end(), compare );
+            }
+        }
+    }
+
+    // Polygon keeps at least a triangle
+    if( getType( iGeometry ) == CADTessellator::POLYGON && nCount > 3 )
+    {
+        for( int nPass = 0; nPass < 2; ++nPass )
+        {
+            uint32_t nBest = 0;
+            for( uint32_t i = 1; i + 1 < nCount; ++i )
+                if( weights[i] != HUGE_VAL && ( nBest == 0 || weights[i] > weights[nBest] ) )
+                    nBest = i;
+            weights[nBest] = HUGE_VAL;
+        }
+    }
+}
+
+double CADLevelOfDetail::getThreshold( double dfTolerance ) const
+{
+    return eMethod == DOUGLAS_PEUCKER ? dfTolerance : dfTolerance * dfTolerance;
+}
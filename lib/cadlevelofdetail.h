@@ -0,0 +1,118 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADLEVELOFDETAIL_H
+#define CADLEVELOFDETAIL_H
+
+#include "cadtessellator.h"
+
+#include <cstdint>
+
+class CADLayer;
+
+/**
+ * @brief Simplified versions of the layer geometries at several tolerances.
+ * Geometries are flattened once and every level keeps only indexes of the
+ * flattened vertexes, so coordinates are not duplicated. Level 0 is the full
+ * detail, the next levels have growing tolerances.
+ */
+class OCAD_EXTERN CADLevelOfDetail
+{
+public:
+    enum Method
+    {
+        DOUGLAS_PEUCKER = 0, // tolerance is the maximum distance to the original line
+        VISVALINGAM     = 1  // square of the tolerance is the minimum triangle area
+    };
+
+    CADLevelOfDetail();
+
+    /**
+     * @brief Flatten the layer geometries and simplify them at the
+     * tolerances, in drawing units. Geometry index is the same as in the
+     * layer, geometries without simple feature representation have no
+     * vertexes.
+     */
+    void build( CADLayer& layer, const vector<double>& tolerances, enum Method eMethod,
+                const CADTessellator& tessellator );
+    bool isBuilt() const;
+    void clear();
+
+    size_t getLevelCount() const; // including the full detail level
+    double getTolerance( size_t nLevel ) const;
+
+    /**
+     * @brief The coarsest level which tolerance doesn't exceed the
+     * resolution (drawing units per pixel), 0 if there is no such level.
+     */
+    size_t selectLevel( double dfResolution ) const;
+
+    size_t                              getGeometryCount() const;
+    enum CADTessellator::SimpleFeature getType( size_t iGeometry ) const;
+
+    /**
+     * @brief Indexes of the geometry vertexes kept at the level. They are
+     * relative to the first geometry vertex.
+     * @return nullptr if all vertexes are kept
+     */
+    const uint32_t * getIndexes( size_t iGeometry, size_t nLevel, size_t& nCount ) const;
+
+    /**
+     * @brief Append the geometry vertexes kept at the level to out.
+     * @return number of added vertexes
+     */
+    size_t getVertexes( size_t iGeometry, size_t nLevel, CADVertexArray& out ) const;
+
+    const CADVertexArray& getVertexes() const; // all flattened vertexes
+    size_t                getFirstVertex( size_t iGeometry ) const;
+    size_t                getVertexCount( size_t iGeometry ) const;
+protected:
+    struct Level
+    {
+        double           dfTolerance;
+        vector<uint32_t> anIndexes;
+        vector<size_t>   anStarts; // geometry count + 1 items, empty range if all vertexes are kept
+    };
+
+    // Significance of every vertex: a vertex is kept at the tolerance if
+    // its weight is greater than the threshold of the tolerance.
+    void   computeWeights( size_t iGeometry, vector<double>& weights, vector<uint32_t>& links,
+                           vector<pair<double, uint32_t> >& heap ) const;
+    double getThreshold( double dfTolerance ) const;
+protected:
+    enum Method     eMethod;
+    bool            bBuilt;
+    CADVertexArray  oVertexes;
+    vector<size_t>  anFirstVertexes; // geometry count + 1 items
+    vector<uint8_t> anTypes;
+    vector<Level>   levels; // without the full detail level
+};
+
+#endif // CADLEVELOFDETAIL_H
@@ -32,6 +32,7 @@
 #include "cadobjects.h"
 
 #include <math.h>
+#include <limits>
 #include <algorithm>
 
 //------------------------------------------------------------------------------
@@ -123,11 +124,144 @@ CADVector::CADVector() : X( .0 ), Y( .0 ), Z( .0 ), bHasZ( true )
 
 }
 
+//------------------------------------------------------------------------------
+// CADVertexArray
+//------------------------------------------------------------------------------
+
+CADVertexArray::CADVertexArray()
+{
+}
+
+size_t CADVertexArray::size() const
+{
+    return adfX.size();
+}
+
+bool CADVertexArray::empty() const
+{
+    return adfX.empty();
+}
+
+bool CADVertexArray::hasZ() const
+{
+    return !adfZ.empty();
+}
+
+void CADVertexArray::reserve( size_t nCount )
+{
+    adfX.reserve( nCount );
+    adfY.reserve( nCount );
+    if( !adfZ.empty() )
+        adfZ.reserve( nCount );
+}
+
+void CADVertexArray::resize( size_t nCount )
+{
+    adfX.resize( nCount, 0.0 );
+    adfY.resize( nCount, 0.0 );
+    if( !adfZ.empty() )
+        adfZ.resize( nCount, 0.0 );
+}
+
+void CADVertexArray::clear()
+{
+    adfX.clear();
+    adfY.clear();
+    adfZ.clear();
+}
+
+void CADVertexArray::addZ()
+{
+    adfZ.reserve( adfX.capacity() );
+    adfZ.resize( adfX.size(), 0.0 );
+}
+
+void CADVertexArray::add( const CADVector& vertex )
+{
+    if( vertex.getBHasZ() && !hasZ() )
+        addZ();
+    adfX.push_back( vertex.getX() );
+    adfY.push_back( vertex.getY() );
+    if( !adfZ.empty() || vertex.getBHasZ() )
+        adfZ.push_back( vertex.getZ() );
+}
+
+void CADVertexArray::add( double x, double y )
+{
+    adfX.push_back( x );
+    adfY.push_back( y );
+    if( !adfZ.empty() )
+        adfZ.push_back( 0.0 );
+}
+
+void CADVertexArray::add( double x, double y, double z )
+{
+    if( !hasZ() )
+        addZ();
+    adfX.push_back( x );
+    adfY.push_back( y );
+    adfZ.push_back( z );
+}
+
+CADVector CADVertexArray::get( size_t index ) const
+{
+    if( adfZ.empty() )
+        return CADVector( adfX[index], adfY[index] );
+    return CADVector( adfX[index], adfY[index], adfZ[index] );
+}
+
+void CADVertexArray::set( size_t index, const CADVector& vertex )
+{
+    adfX[index] = vertex.getX();
+    adfY[index] = vertex.getY();
+    if( vertex.getBHasZ() && adfZ.empty() )
+        addZ();
+    if( !adfZ.empty() )
+        adfZ[index] = vertex.getZ();
+}
+
+void CADVertexArray::assign( vector<double> xs, vector<double> ys, vector<double> zs )
+{
+    adfX = std::move( xs );
+    adfY = std::move( ys );
+    adfZ = std::move( zs );
+}
+
+const vector<double>& CADVertexArray::getXs() const
+{
+    return adfX;
+}
+
+const vector<double>& CADVertexArray::getYs() const
+{
+    return adfY;
+}
+
+const vector<double>& CADVertexArray::getZs() const
+{
+    return adfZ;
+}
+
+double * CADVertexArray::getXData()
+{
+    return adfX.data();
+}
+
+double * CADVertexArray::getYData()
+{
+    return adfY.data();
+}
+
+double * CADVertexArray::getZData()
+{
+    return adfZ.empty() ? nullptr : adfZ.data();
+}
+
 //------------------------------------------------------------------------------
 // CADText
 //------------------------------------------------------------------------------
 
-CADTextObject::CADTextObject()
+CADTextObject::CADTextObject() : dfElevation( 0.0 )
 {
     type = TEXT;
 }
@@ -145,7 +279,7 @@ CADAttdefObject::CADAttdefObject()
 // CADAttribObject
 //------------------------------------------------------------------------------
 
-CADAttribObject::CADAttribObject()
+CADAttribObject::CADAttribObject() : dfElevation( 0.0 )
 {
     type = ATTRIB;
 }
@@ -398,7 +532,8 @@ CADDictionaryObject::CADDictionaryObject()
 // CADLWPolylineObject
 //------------------------------------------------------------------------------
 
-CADLWPolylineObject::CADLWPolylineObject()
+CADLWPolylineObject::CADLWPolylineObject() : bClosed( false ), dfConstWidth( 0.0 ), dfElevation( 0.0 ),
+                                             dfThickness( 0.0 ), vectExtrusion( 0.0, 0.0, 1.0 )
 {
     type = LWPOLYLINE;
 }
@@ -414,128 +549,135 @@ CADSplineObject::CADSplineObject() : nNumFitPts( 0 ), nNumKnots( 0 ), nNumCtrlPt
 
 //------------------------------------------------------------------------------
 
-const vector<char> CADCommonEntityObjectTypes{
-        CADObject::POINT, CADObject::ARC, CADObject::TEXT, CADObject::ELLIPSE, CADObject::CIRCLE, CADObject::LINE,
-        CADObject::LWPOLYLINE, CADObject::POLYLINE3D, CADObject::MLINE, CADObject::SPLINE, CADObject::SOLID,
-        CADObject::MTEXT, CADObject::IMAGE, CADObject::XLINE, CADObject::RAY, CADObject::MLINE, CADObject::FACE3D,
-        CADObject::POLYLINE_PFACE, CADObject::ATTRIB, CADObject::ATTDEF, CADObject::POLYLINE2D, CADObject::HATCH,
-        CADObject::INSERT, CADObject::VERTEX3D, CADObject::VERTEX2D, CADObject::VERTEX_MESH, CADObject::VERTEX_PFACE,
-        CADObject::VERTEX_PFACE_FACE, CADObject::TOLERANCE, CADObject::SOLID3D, CADObject::WIPEOUT, CADObject::TRACE,
-        CADObject::DIMENSION_ALIGNED, CADObject::OLE2FRAME
-};
-
-const vector<char> CADSupportedGeometryTypes{
-        CADObject::POINT, CADObject::ARC, CADObject::TEXT, CADObject::ELLIPSE, CADObject::CIRCLE, CADObject::LINE,
-        CADObject::LWPOLYLINE, CADObject::POLYLINE3D, CADObject::MLINE, CADObject::ATTRIB, CADObject::ATTDEF,
-        CADObject::RAY, CADObject::SPLINE, CADObject::SOLID, CADObject::IMAGE, CADObject::MTEXT,
-        CADObject::POLYLINE_PFACE, CADObject::XLINE, CADObject::FACE3D
+// Indexed by CADObject::ObjectType.
+const CADObjectTypeTraits CADObjectTypeTraitsTable[CADObject::WIPEOUT + 1] = {
+        // name, common entity, supported geometry
+        { "UNUSED",              false, false }, // UNUSED
+        { "TEXT",                true,  true  }, // TEXT
+        { "ATTRIB",              true,  true  }, // ATTRIB
+        { "ATTDEF",              true,  true  }, // ATTDEF
+        { "BLOCK",               false, false }, // BLOCK
+        { "ENDBLK",              false, false }, // ENDBLK
+        { "SEQEND",              false, false }, // SEQEND
+        { "INSERT",              true,  false }, // INSERT
+        { "MINSERT",             false, false }, // MINSERT1
+        { "MINSERT",             false, false }, // MINSERT2
+        { "VERTEX 2D",           true,  false }, // VERTEX2D
+        { "VERTEX 3D",           true,  false }, // VERTEX3D
+        { "VERTEX MESH",         true,  false }, // VERTEX_MESH
+        { "VERTEX PFACE",        true,  false }, // VERTEX_PFACE
+        { "VERTEX PFACE FACE",   true,  false }, // VERTEX_PFACE_FACE
+        { "POLYLINE 2D",         true,  false }, // POLYLINE2D
+        { "POLYLINE 3D",         true,  true  }, // POLYLINE3D
+        { "ARC",                 true,  true  }, // ARC
+        { "CIRCLE",              true,  true  }, // CIRCLE
+        { "LINE",                true,  true  }, // LINE
+        { "DIMENSION ORDINATE",  false, false }, // DIMENSION_ORDINATE
+        { "DIMENSION LINEAR",    false, false }, // DIMENSION_LINEAR
+        { "DIMENSION ALIGNED",   true,  false }, // DIMENSION_ALIGNED
+        { "DIMENSION ANG 3PT",   false, false }, // DIMENSION_ANG_3PT
+        { "DIMENSION AND 2LN",   false, false }, // DIMENSION_ANG_2LN
+        { "DIMENSION RADIUS",    false, false }, // DIMENSION_RADIUS
+        { "DIMENSION DIAMETER",  false, false }, // DIMENSION_DIAMETER
+        { "POINT",               true,  true  }, // POINT
+        { "3DFACE",              true,  true  }, // FACE3D
+        { "POLYLINE PFACE",      true,  true  }, // POLYLINE_PFACE
+        { "POLYLINE MESH",       false, false }, // POLYLINE_MESH
+        { "SOLID",               true,  true  }, // SOLID
+        { "TRACE",               true,  false }, // TRACE
+        { "SHAPE",               false, false }, // SHAPE
+        { "VIEWPORT",            false, false }, // VIEWPORT
+        { "ELLIPSE",             true,  true  }, // ELLIPSE
+        { "SPLINE",              true,  true  }, // SPLINE
+        { "REGION",              false, false }, // REGION
+        { "3DSOLID",             true,  false }, // SOLID3D
+        { "BODY",                false, false }, // BODY
+        { "RAY",                 true,  true  }, // RAY
+        { "XLINE",               true,  true  }, // XLINE
+        { "DICTIONARY",          false, false }, // DICTIONARY
+        { "OLEFRAME",            false, false }, // OLEFRAME
+        { "MTEXT",               true,  true  }, // MTEXT
+        { "LEADER",              false, false }, // LEADER
+        { "TOLERANCE",           true,  false }, // TOLERANCE
+        { "MLINE",               true,  true  }, // MLINE
+        { "BLOCK CONTROL OBJ",   false, false }, // BLOCK_CONTROL_OBJ
+        { "BLOCK HEADER",        false, false }, // BLOCK_HEADER
+        { "LAYER CONTROL OBJ",   false, false }, // LAYER_CONTROL_OBJ
+        { "LAYER",               false, false }, // LAYER
+        { "STYLE CONTROL OBJ",   false, false }, // STYLE_CONTROL_OBJ
+        { "STYLE1",              false, false }, // STYLE1
+        { "STYLE2",              false, false }, // STYLE2
+        { "STYLE3",              false, false }, // STYLE3
+        { "LTYPE CONTROL OBJ",   false, false }, // LTYPE_CONTROL_OBJ
+        { "LTYPE1",              false, false }, // LTYPE1
+        { "LTYPE2",              false, false }, // LTYPE2
+        { "LTYPE3",              false, false }, // LTYPE3
+        { "VIEW CONTROL OBJ",    false, false }, // VIEW_CONTROL_OBJ
+        { "VIEW",                false, false }, // VIEW
+        { "UCS CONTROL OBJ",     false, false }, // UCS_CONTROL_OBJ
+        { "UCS",                 false, false }, // UCS
+        { "VPORT CONTROL OBJ",   false, false }, // VPORT_CONTROL_OBJ
+        { "VPORT",               false, false }, // VPORT
+        { "APPID CONTROL OBJ",   false, false }, // APPID_CONTROL_OBJ
+        { "APPID",               false, false }, // APPID
+        { "DIMSTYLE CONTROL OBJ", false, false }, // DIMSTYLE_CONTROL_OBJ
+        { "DIMSTYLE",            false, false }, // DIMSTYLE
+        { "VP ENT HDR CTRL OBJ", false, false }, // VP_ENT_HDR_CTRL_OBJ
+        { "VP ENT HDR",          false, false }, // VP_ENT_HDR
+        { "GROUP",               false, false }, // GROUP
+        { "MLINESTYLE",          false, false }, // MLINESTYLE
+        { "OLE2FRAME",           true,  false }, // OLE2FRAME
+        { "DUMMY",               false, false }, // DUMMY
+        { "LONG TRANSACTION",    false, false }, // LONG_TRANSACTION
+        { "LWPOLYLINE",          true,  true  }, // LWPOLYLINE
+        { "HATCH",               true,  false }, // HATCH
+        { "XRECORD",             false, false }, // XRECORD
+        { "ACDBPLACEHOLDER",     false, false }, // ACDBPLACEHOLDER
+        { "VBA PROJECT",         false, false }, // VBA_PROJECT
+        { "LAYOUT",              false, false }, // LAYOUT
+        { "CELLSTYLEMAP",        false, false }, // CELLSTYLEMAP
+        { "DBCOLOR",             false, false }, // DBCOLOR
+        { "DICTIONARYVAR",       false, false }, // DICTIONARYVAR
+        { "DICTIONARYWDFLT",     false, false }, // DICTIONARYWDFLT
+        { "FIELD",               false, false }, // FIELD
+        { "GROUP",               false, false }, // GROUP_UNFIXED
+        { "HATCH",               false, false }, // HATCH_UNFIXED
+        { "IDBUFFER",            false, false }, // IDBUFFER
+        { "IMAGE",               true,  true  }, // IMAGE
+        { "IMAGEDEF",            false, false }, // IMAGEDEF
+        { "IMAGEDEFREACTOR",     false, false }, // IMAGEDEFREACTOR
+        { "LAYER INDEX",         false, false }, // LAYER_INDEX
+        { "LAYOUT",              false, false }, // LAYOUT_UNFIXED
+        { "LWPOLYLINE",          false, false }, // LWPOLYLINE_UNFIXED
+        { "MATERIAL",            false, false }, // MATERIAL
+        { "MLEADER",             false, false }, // MLEADER
+        { "MLEADERSTYLE",        false, false }, // MLEADERSTYLE
+        { "OLE2FRAME",           false, false }, // OLE2FRAME_UNFIXED
+        { "PLACEHOLDER",         false, false }, // PLACEHOLDER
+        { "PLOTSETTINGS",        false, false }, // PLOTSETTINGS
+        { "RASTERVARIABLES",     false, false }, // RASTERVARIABLES
+        { "SCALE",               false, false }, // SCALE
+        { "SORTENTSTABLE",       false, false }, // SORTENTSTABLE
+        { "SPATIAL FILTER",      false, false }, // SPATIAL_FILTER
+        { "SPATIAL INDEX",       false, false }, // SPATIAL_INDEX
+        { "TABLEGEOMETRY",       false, false }, // TABLEGEOMETRY
+        { "TABLESTYLES",         false, false }, // TABLESTYLES
+        { "VBA PROJECT",         false, false }, // VBA_PROJECT_UNFIXED
+        { "VISUALSTYLE",         false, false }, // VISUALSTYLE
+        { "WIPEOUTVARIABLE",     false, false }, // WIPEOUTVARIABLE
+        { "XRECORD",             false, false }, // XRECORD_UNFIXED
+        { "WIPEOUT",             true,  false }  // WIPEOUT
 };
 
-bool isCommonEntityType( short nType )
-{
-    return std::find( CADCommonEntityObjectTypes.begin(), CADCommonEntityObjectTypes.end(), ( nType ) ) !=
-           CADCommonEntityObjectTypes.end();
-}
-
-bool isSupportedGeometryType( short nType )
-{
-    return std::find( CADSupportedGeometryTypes.begin(), CADSupportedGeometryTypes.end(), ( nType ) ) !=
-            CADSupportedGeometryTypes.end();
-}
-
-const map<char, string> CADObjectNames{
-        { CADObject::UNUSED,               "UNUSED" },
-        { CADObject::TEXT,                 "TEXT" },
-        { CADObject::ATTRIB,               "ATTRIB" },
-        { CADObject::ATTDEF,               "ATTDEF" },
-        { CADObject::BLOCK,                "BLOCK" },
-        { CADObject::ENDBLK,               "ENDBLK" },
-        { CADObject::SEQEND,               "SEQEND" },
-        { CADObject::INSERT,               "INSERT" },
-        { CADObject::MINSERT1,             "MINSERT" },
-        { CADObject::MINSERT2,             "MINSERT" },
-        { CADObject::VERTEX2D,             "VERTEX 2D" },
-        { CADObject::VERTEX3D,             "VERTEX 3D" },
-        { CADObject::VERTEX_MESH,          "VERTEX MESH" },
-        { CADObject::VERTEX_PFACE,         "VERTEX PFACE" },
-        { CADObject::VERTEX_PFACE_FACE,    "VERTEX PFACE FACE" },
-        { CADObject::POLYLINE2D,           "POLYLINE 2D" },
-        { CADObject::POLYLINE3D,           "POLYLINE 3D" },
-        { CADObject::ARC,                  "ARC" },
-        { CADObject::CIRCLE,               "CIRCLE" },
-        { CADObject::LINE,                 "LINE" },
-        { CADObject::DIMENSION_ORDINATE,   "DIMENSION ORDINATE" },
-        { CADObject::DIMENSION_LINEAR,     "DIMENSION LINEAR" },
-        { CADObject::DIMENSION_ALIGNED,    "DIMENSION ALIGNED" },
-        { CADObject::DIMENSION_ANG_3PT,    "DIMENSION ANG 3PT" },
-        { CADObject::DIMENSION_ANG_2LN,    "DIMENSION AND 2LN" },
-        { CADObject::DIMENSION_RADIUS,     "DIMENSION RADIUS" },
-        { CADObject::DIMENSION_DIAMETER,   "DIMENSION DIAMETER" },
-        { CADObject::POINT,                "POINT" },
-        { CADObject::FACE3D,               "3DFACE" },
-        { CADObject::POLYLINE_PFACE,       "POLYLINE PFACE" },
-        { CADObject::POLYLINE_MESH,        "POLYLINE MESH" },
-        { CADObject::SOLID,                "SOLID" },
-        { CADObject::TRACE,                "TRACE" },
-        { CADObject::SHAPE,                "SHAPE" },
-        { CADObject::VIEWPORT,             "VIEWPORT" },
-        { CADObject::ELLIPSE,              "ELLIPSE" },
-        { CADObject::SPLINE,               "SPLINE" },
-        { CADObject::REGION,               "REGION" },
-        { CADObject::SOLID3D,              "3DSOLID" },
-        { CADObject::BODY,                 "BODY" },
-        { CADObject::RAY,                  "RAY" },
-        { CADObject::XLINE,                "XLINE" },
-        { CADObject::DICTIONARY,           "DICTIONARY" },
-        { CADObject::OLEFRAME,             "OLEFRAME" },
-        { CADObject::MTEXT,                "MTEXT" },
-        { CADObject::LEADER,               "LEADER" },
-        { CADObject::TOLERANCE,            "TOLERANCE" },
-        { CADObject::MLINE,                "MLINE" },
-        { CADObject::BLOCK_CONTROL_OBJ,    "BLOCK CONTROL OBJ" },
-        { CADObject::BLOCK_HEADER,         "BLOCK HEADER" },
-        { CADObject::LAYER_CONTROL_OBJ,    "LAYER CONTROL OBJ" },
-        { CADObject::LAYER,                "LAYER" },
-        { CADObject::STYLE_CONTROL_OBJ,    "STYLE CONTROL OBJ" },
-        { CADObject::STYLE1,               "STYLE1" },
-        { CADObject::STYLE2,               "STYLE2" },
-        { CADObject::STYLE3,               "STYLE3" },
-        { CADObject::LTYPE_CONTROL_OBJ,    "LTYPE CONTROL OBJ" },
-        { CADObject::LTYPE1,               "LTYPE1" },
-        { CADObject::LTYPE2,               "LTYPE2" },
-        { CADObject::LTYPE3,               "LTYPE3" },
-        { CADObject::VIEW_CONTROL_OBJ,     "VIEW CONTROL OBJ" },
-        { CADObject::VIEW,                 "VIEW" },
-        { CADObject::UCS_CONTROL_OBJ,      "UCS CONTROL OBJ" },
-        { CADObject::UCS,                  "UCS" },
-        { CADObject::VPORT_CONTROL_OBJ,    "VPORT CONTROL OBJ" },
-        { CADObject::VPORT,                "VPORT" },
-        { CADObject::APPID_CONTROL_OBJ,    "APPID CONTROL OBJ" },
-        { CADObject::APPID,                "APPID" },
-        { CADObject::DIMSTYLE_CONTROL_OBJ, "DIMSTYLE CONTROL OBJ" },
-        { CADObject::DIMSTYLE,             "DIMSTYLE" },
-        { CADObject::VP_ENT_HDR_CTRL_OBJ,  "VP ENT HDR CTRL OBJ" },
-        { CADObject::VP_ENT_HDR,           "VP ENT HDR" },
-        { CADObject::GROUP,                "GROUP" },
-        { CADObject::MLINESTYLE,           "MLINESTYLE" },
-        { CADObject::OLE2FRAME,            "OLE2FRAME" },
-        { CADObject::DUMMY,                "DUMMY" },
-        { CADObject::LONG_TRANSACTION,     "LONG TRANSACTION" },
-        { CADObject::LWPOLYLINE,           "LWPOLYLINE" },
-        { CADObject::HATCH,                "HATCH" },
-        { CADObject::XRECORD,              "XRECORD" },
-        { CADObject::ACDBPLACEHOLDER,      "ACDBPLACEHOLDER" },
-        { CADObject::VBA_PROJECT,          "VBA PROJECT" },
-        { CADObject::LAYOUT,               "LAYOUT" }
-};
+const char * getObjectTypeName( short nType )
+{
+    const CADObjectTypeTraits * pTraits = getObjectTypeTraits( nType );
+    return nullptr == pTraits ? "" : pTraits->pszName;
+}
 
 string getNameByType( CADObject::ObjectType eType )
 {
-    auto it = CADObjectNames.find( eType );
-    if( it == CADObjectNames.end() )
-        return "";
-
-    return it->second;
+    return getObjectTypeName( eType );
 }
 //------------------------------------------------------------------------------
 // CADObject
@@ -69,6 +69,48 @@ protected:
     bool   bHasZ;
 };
 
+/**
+ * @brief Vertexes stored as contiguous X, Y and Z arrays. Z array stays empty
+ * until a vertex with Z is added, so 2D vertexes don't waste memory.
+ */
+class CADVertexArray
+{
+public:
+    CADVertexArray();
+
+    size_t size() const;
+    bool   empty() const;
+    bool   hasZ() const;
+    void   reserve( size_t nCount );
+    void   resize( size_t nCount ); // new vertexes are zeroed
+    void   clear();
+
+    void      add( const CADVector& vertex );
+    void      add( double x, double y ); // Z is 0 if the array has Z
+    void      add( double x, double y, double z );
+    CADVector get( size_t index ) const;
+    void      set( size_t index, const CADVector& vertex );
+    /**
+     * @brief Replace all vertexes. zs may be empty, otherwise all three arrays
+     * must have the same size.
+     */
+    void      assign( vector<double> xs, vector<double> ys, vector<double> zs = vector<double>() );
+
+    const vector<double>& getXs() const;
+    const vector<double>& getYs() const;
+    const vector<double>& getZs() const; // empty if there is no Z
+
+    // Raw arrays for in place batch processing. Z is nullptr if there is no Z.
+    double * getXData();
+    double * getYData();
+    double * getZData();
+    void     addZ(); // Z of 2D vertexes becomes 0
+protected:
+    vector<double> adfX;
+    vector<double> adfY;
+    vector<double> adfZ;
+};
+
 typedef struct _Eed
 {
     short                 dLength = 0;
@@ -221,9 +263,42 @@ protected:
     short      CRC;
 };
 
-string getNameByType( CADObject::ObjectType eType );
-bool   isCommonEntityType( short nType );
-bool   isSupportedGeometryType( short nType );
+/**
+ * @brief Object type properties, known at compile time
+ */
+struct CADObjectTypeTraits
+{
+    const char * pszName;
+    bool         bCommonEntity;      /**< object data starts with common entity data */
+    bool         bSupportedGeometry; /**< object can be read as CADGeometry */
+};
+
+extern const CADObjectTypeTraits CADObjectTypeTraitsTable[CADObject::WIPEOUT + 1];
+
+/**
+ * @brief returns traits of the object type or nullptr if type is unknown
+ */
+inline const CADObjectTypeTraits * getObjectTypeTraits( short nType )
+{
+    if( nType < 0 || nType > CADObject::WIPEOUT )
+        return nullptr;
+    return & CADObjectTypeTraitsTable[nType];
+}
+
+inline bool isCommonEntityType( short nType )
+{
+    const CADObjectTypeTraits * pTraits = getObjectTypeTraits( nType );
+    return nullptr != pTraits && pTraits->bCommonEntity;
+}
+
+inline bool isSupportedGeometryType( short nType )
+{
+    const CADObjectTypeTraits * pTraits = getObjectTypeTraits( nType );
+    return nullptr != pTraits && pTraits->bSupportedGeometry;
+}
+
+const char * getObjectTypeName( short nType );
+string       getNameByType( CADObject::ObjectType eType );
 
 /**
  * @brief The CADCommonED struct
@@ -862,7 +937,7 @@ public:
     double                       dfElevation;
     double                       dfThickness;
     CADVector                    vectExtrusion;
-    vector<CADVector>            avertVertexes;
+    CADVertexArray               avertVertexes;
     vector<double>               adfBulges;
     vector<short>                adVertexesID;
     vector<pair<double, double>> astWidths; // start, end.
@@ -895,10 +970,10 @@ public:
     long   nNumCtrlPts;
     bool   bWeight;
 
-    vector<double>    adfKnots;
-    vector<double>    adfCtrlPointsWeight;
-    vector<CADVector> avertCtrlPoints;
-    vector<CADVector> averFitPoints;
+    vector<double> adfKnots;
+    vector<double> adfCtrlPointsWeight;
+    CADVertexArray avertCtrlPoints;
+    CADVertexArray averFitPoints;
 };
 
 /**
@@ -0,0 +1,624 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadrasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+// Image is drawn by square tiles of this size
+static const int TILE_SIZE = 128;
+
+static const uint8_t PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+static bool isSameColor( RGBColor a, RGBColor b )
+{
+    return a.R == b.R && a.G == b.G && a.B == b.B;
+}
+
+/**
+ * @brief Pixel writer of one tile. Coordinates are in pixels of the whole
+ * image, pixel (i, j) covers [i, i + 1) x [j, j + 1). Pixels outside the tile
+ * are never written, so tiles can be drawn in parallel.
+ */
+class TilePainter
+{
+public:
+    TilePainter( int nLeftIn, int nTopIn, int nRightIn, int nBottomIn, unsigned nWidthIn, vector<uint8_t>& rgba ) :
+        nLeft( nLeftIn ), nTop( nTopIn ), nRight( nRightIn ), nBottom( nBottomIn ), nWidth( nWidthIn ),
+        pabyImage( rgba.data() )
+    {
+        color = { 0, 0, 0 };
+    }
+
+    void setColor( RGBColor value )
+    {
+        color = value;
+    }
+
+    void plot( int x, int y )
+    {
+        if( x >= nLeft && x < nRight && y >= nTop && y < nBottom )
+            put( x, y );
+    }
+
+    // Segment of one pixel width, the pixel in every column (or row for steep
+    // segments) is the one the segment crosses at the column center.
+    void line( double x0, double y0, double x1, double y1 )
+    {
+        plot( clampToInt( floor( x1 ) ), clampToInt( floor( y1 ) ) );
+        double dx = x1 - x0;
+        double dy = y1 - y0;
+        if( fabs( dx ) >= fabs( dy ) )
+        {
+            if( dx == 0.0 )
+                return;
+            if( x0 > x1 )
+            {
+                swap( x0, x1 );
+                swap( y0, y1 );
+            }
+            int i0 = clampToInt( ceil( max( x0 - 0.5, static_cast<double>( nLeft ) ) ) );
+            int i1 = clampToInt( floor( min( x1 - 0.5, static_cast<double>( nRight - 1 ) ) ) );
+            double dfSlope = dy / dx;
+            for( int i = i0; i <= i1; ++i )
+            {
+                int j = clampToInt( floor( y0 + ( i + 0.5 - x0 ) * dfSlope ) );
+                if( j >= nTop && j < nBottom )
+                    put( i, j );
+            }
+        }
+        else
+        {
+            if( y0 > y1 )
+            {
+                swap( x0, x1 );
+                swap( y0, y1 );
+            }
+            int j0 = clampToInt( ceil( max( y0 - 0.5, static_cast<double>( nTop ) ) ) );
+            int j1 = clampToInt( floor( min( y1 - 0.5, static_cast<double>( nBottom - 1 ) ) ) );
+            double dfSlope = dx / dy;
+            for( int j = j0; j <= j1; ++j )
+            {
+                int i = clampToInt( floor( x0 + ( j + 0.5 - y0 ) * dfSlope ) );
+                if( i >= nLeft && i < nRight )
+                    put( i, j );
+            }
+        }
+    }
+
+    // Even-odd fill of pixels which centers are inside the ring
+    void polygon( const double * padfX, const double * padfY, size_t nCount )
+    {
+        double minY = *min_element( padfY, padfY + nCount );
+        double maxY = *max_element( padfY, padfY + nCount );
+        int    j0   = clampToInt( ceil( max( minY - 0.5, static_cast<double>( nTop ) ) ) );
+        int    j1   = clampToInt( floor( min( maxY - 0.5, static_cast<double>( nBottom - 1 ) ) ) );
+        for( int j = j0; j <= j1; ++j )
+        {
+            double yc = j + 0.5;
+            adfCrossings.clear();
+            for( size_t a = 0, b = nCount - 1; a < nCount; b = a++ )
+            {
+                if( ( padfY[a] <= yc ) != ( padfY[b] <= yc ) )
+                    adfCrossings.push_back( padfX[a] +
+                                            ( yc - padfY[a] ) * ( padfX[b] - padfX[a] ) / ( padfY[b] - padfY[a] ) );
+            }
+            sort( adfCrossings.begin(), adfCrossings.end() );
+            for( size_t k = 0; k + 1 < adfCrossings.size(); k += 2 )
+            {
+                int i0 = clampToInt( ceil( max( adfCrossings[k] - 0.5, static_cast<double>( nLeft ) ) ) );
+                int i1 = clampToInt( ceil( min( adfCrossings[k + 1] - 0.5, static_cast<double>( nRight ) ) ) ) - 1;
+                for( int i = i0; i <= i1; ++i )
+                    put( i, j );
+            }
+        }
+    }
+
+    // Segment of the width with square caps
+    void wideLine( double x0, double y0, double x1, double y1, double dfWidth )
+    {
+        double dfLength = hypot( x1 - x0, y1 - y0 );
+        double ux = dfLength > 0.0 ? ( x1 - x0 ) / dfLength : 1.0;
+        double uy = dfLength > 0.0 ? ( y1 - y0 ) / dfLength : 0.0;
+        double h  = dfWidth / 2;
+        double adfX[4] = { x0 - h * ux + h * uy, x0 - h * ux - h * uy, x1 + h * ux - h * uy, x1 + h * ux + h * uy };
+        double adfY[4] = { y0 - h * uy - h * ux, y0 - h * uy + h * ux, y1 + h * uy + h * ux, y1 + h * uy - h * ux };
+        polygon( adfX, adfY, 4 );
+    }
+protected:
+    static int clampToInt( double dfValue )
+    {
+        return static_cast<int>( min( max( dfValue, -1e9 ), 1e9 ) );
+    }
+
+    void put( int x, int y )
+    {
+        uint8_t * pabyPixel = pabyImage + ( static_cast<size_t>( y ) * nWidth + x ) * 4;
+        pabyPixel[0] = color.R;
+        pabyPixel[1] = color.G;
+        pabyPixel[2] = color.B;
+        pabyPixel[3] = 255;
+    }
+protected:
+    int            nLeft, nTop, nRight, nBottom;
+    unsigned       nWidth;
+    uint8_t *      pabyImage;
+    RGBColor       color;
+    vector<double> adfCrossings;
+};
+
+/**
+ * @brief Deflate stream with fixed Huffman codes. Only repeats of the
+ * previous pixel and of the row above are searched, which is what flat
+ * drawing previews mostly consist of.
+ */
+class DeflateWriter
+{
+public:
+    explicit DeflateWriter( vector<uint8_t>& outIn ) : out( outIn ), nBits( 0 ), nBitCount( 0 )
+    {
+    }
+
+    void compress( const uint8_t * pabyData, size_t nSize, size_t nPixelSize, size_t nRowSize )
+    {
+        putBits( 1, 1 ); // final block
+        putBits( 1, 2 ); // fixed Huffman codes
+        const size_t anDistances[2] = { nPixelSize, nRowSize };
+        for( size_t i = 0; i < nSize; )
+        {
+            size_t nBestLength = 0, nBestDistance = 0;
+            for( size_t nDistance : anDistances )
+            {
+                if( nDistance == 0 || nDistance > 32768 || i < nDistance )
+                    continue;
+                size_t nMax    = min<size_t>( 258, nSize - i );
+                size_t nLength = 0;
+                while( nLength < nMax && pabyData[i + nLength] == pabyData[i + nLength - nDistance] )
+                    ++nLength;
+                if( nLength > nBestLength )
+                {
+                    nBestLength   = nLength;
+                    nBestDistance = nDistance;
+                }
+            }
+            if( nBestLength >= 3 )
+            {
+                putMatch( nBestLength, nBestDistance );
+                i += nBestLength;
+            }
+            else
+            {
+                putSymbol( pabyData[i++] );
+            }
+        }
+        putSymbol( 256 );
+        if( nBitCount > 0 )
+            out.push_back( static_cast<uint8_t>( nBits ) );
+        nBits     = 0;
+        nBitCount = 0;
+    }
+protected:
+    void putBits( uint32_t nValue, int nCount )
+    {
+        nBits |= nValue << nBitCount;
+        nBitCount += nCount;
+        while( nBitCount >= 8 )
+        {
+            out.push_back( static_cast<uint8_t>( nBits ) );
+            nBits >>= 8;
+            nBitCount -= 8;
+        }
+    }
+
+    // Huffman codes go most significant bit first
+    void putCode( uint32_t nCode, int nLength )
+    {
+        uint32_t nReversed = 0;
+        for( int i = 0; i < nLength; ++i )
+            nReversed |= ( ( nCode >> i ) & 1 ) << ( nLength - 1 - i );
+        putBits( nReversed, nLength );
+    }
+
+    void putSymbol( int nSymbol )
+    {
+        if( nSymbol < 144 )
+            putCode( 0x30 + nSymbol, 8 );
+        else if( nSymbol < 256 )
+            putCode( 0x190 + nSymbol - 144, 9 );
+        else if( nSymbol < 280 )
+            putCode( nSymbol - 256, 7 );
+        else
+            putCode( 0xC0 + nSymbol - 280, 8 );
+    }
+
+    void putMatch( size_t nLength, size_t nDistance )
+    {
+        static const uint16_t anLengthBase[29]  = { 3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                                    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const uint8_t  anLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                                    2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const uint16_t anDistanceBase[30] = { 1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                                     33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                                     1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const uint8_t anDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                                     6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+        int nCode = 28;
+        while( anLengthBase[nCode] > nLength )
+            --nCode;
+        putSymbol( 257 + nCode );
+        putBits( static_cast<uint32_t>( nLength - anLengthBase[nCode] ), anLengthExtra[nCode] );
+
+        nCode = 29;
+        while( anDistanceBase[nCode] > nDistance )
+            --nCode;
+        putCode( nCode, 5 );
+        putBits( static_cast<uint32_t>( nDistance - anDistanceBase[nCode] ), anDistanceExtra[nCode] );
+    }
+protected:
+    vector<uint8_t>& out;
+    uint32_t         nBits;
+    int              nBitCount;
+};
+
+static uint32_t crc32( const uint8_t * pabyData, size_t nSize, uint32_t nCRC = 0 )
+{
+    static const vector<uint32_t> anTable = []() {
+        vector<uint32_t> table( 256 );
+        for( uint32_t n = 0; n < 256; ++n )
+        {
+            uint32_t c = n;
+            for( int k = 0; k < 8; ++k )
+                c = c & 1 ? 0xEDB88320 ^ ( c >> 1 ) : c >> 1;
+            table[n] = c;
+        }
+        return table;
+    }();
+    nCRC = ~nCRC;
+    for( size_t i = 0; i < nSize; ++i )
+        nCRC = anTable[( nCRC ^ pabyData[i] ) & 0xFF] ^ ( nCRC >> 8 );
+    return ~nCRC;
+}
+
+static void putUInt32BE( vector<uint8_t>& out, uint32_t nValue )
+{
+    out.push_back( static_cast<uint8_t>( nValue >> 24 ) );
+    out.push_back( static_cast<uint8_t>( nValue >> 16 ) );
+    out.push_back( static_cast<uint8_t>( nValue >> 8 ) );
+    out.push_back( static_cast<uint8_t>( nValue ) );
+}
+
+static void writeChunk( ostream& stream, const char * pszType, const vector<uint8_t>& data )
+{
+    vector<uint8_t> header;
+    putUInt32BE( header, static_cast<uint32_t>( data.size() ) );
+    header.insert( header.end(), pszType, pszType + 4 );
+    uint32_t nCRC = crc32( header.data() + 4, 4 );
+    nCRC = crc32( data.data(), data.size(), nCRC );
+    vector<uint8_t> footer;
+    putUInt32BE( footer, nCRC );
+    stream.write( reinterpret_cast<const char *>( header.data() ), static_cast<streamsize>( header.size() ) );
+    stream.write( reinterpret_cast<const char *>( data.data() ), static_cast<streamsize>( data.size() ) );
+    stream.write( reinterpret_cast<const char *>( footer.data() ), static_cast<streamsize>( footer.size() ) );
+}
+
+CADRasterizer::CADRasterizer( unsigned nThreads ) :
+    nBackgroundAlpha( 255 ), eColorMode( ENTITY_COLOR ), dfLineWidth( 1.0 ), bUserBounds( false ), dfScale( 1.0 ),
+    dfOffsetX( 0.0 ), dfOffsetY( 0.0 ), oPool( nThreads )
+{
+    background = { 255, 255, 255 };
+}
+
+CADTessellator& CADRasterizer::getTessellator()
+{
+    return oTessellator;
+}
+
+RGBColor CADRasterizer::getBackground() const
+{
+    return background;
+}
+
+unsigned char CADRasterizer::getBackgroundAlpha() const
+{
+    return nBackgroundAlpha;
+}
+
+void CADRasterizer::setBackground( RGBColor color, unsigned char alpha )
+{
+    background       = color;
+    nBackgroundAlpha = alpha;
+}
+
+enum CADRasterizer::ColorMode CADRasterizer::getColorMode() const
+{
+    return eColorMode;
+}
+
+void CADRasterizer::setColorMode( enum ColorMode value )
+{
+    eColorMode = value;
+}
+
+double CADRasterizer::getLineWidth() const
+{
+    return dfLineWidth;
+}
+
+void CADRasterizer::setLineWidth( double value )
+{
+    dfLineWidth = max( value, 1.0 );
+}
+
+void CADRasterizer::setBounds( double dfMinX, double dfMinY, double dfMaxX, double dfMaxY )
+{
+    bounds = CADBoundingBox();
+    bounds.addPoint( dfMinX, dfMinY, 0.0 );
+    bounds.addPoint( dfMaxX, dfMaxY, 0.0 );
+    bUserBounds = true;
+}
+
+size_t CADRasterizer::addFile( CADFile& file )
+{
+    size_t nCount = 0;
+    for( size_t i = 0; i < file.GetLayersCount(); ++i )
+        nCount += addLayer( file.GetLayer( i ) );
+    return nCount;
+}
+
+size_t CADRasterizer::addLayer( CADLayer& layer )
+{
+    if( !layer.getOn() || layer.getFrozen() )
+        return 0;
+
+    // Negative color means the layer is off
+    RGBColor layerColor = CADACIColors[abs( layer.getColor() ) % 256];
+    size_t   nCount     = 0;
+    for( size_t i = 0; i < layer.getGeometryCount(); ++i )
+    {
+        unique_ptr<CADGeometry> geometry( layer.getGeometry( i ) );
+        if( geometry == nullptr )
+            continue;
+        oPoints.clear();
+        enum CADTessellator::SimpleFeature eType = oTessellator.getSimpleFeature( geometry.get(), oPoints );
+        if( eType == CADTessellator::NONE )
+            continue;
+
+        Feature feature;
+        feature.nType  = static_cast<uint8_t>( eType );
+        feature.color  = eColorMode == LAYER_COLOR ? layerColor : geometry->getColor();
+        feature.nFirst = adfX.size();
+        feature.nCount = static_cast<uint32_t>( oPoints.size() );
+        adfX.insert( adfX.end(), oPoints.getXs().begin(), oPoints.getXs().end() );
+        adfY.insert( adfY.end(), oPoints.getYs().begin(), oPoints.getYs().end() );
+        auto xRange  = minmax_element( oPoints.getXs().begin(), oPoints.getXs().end() );
+        auto yRange  = minmax_element( oPoints.getYs().begin(), oPoints.getYs().end() );
+        feature.minX = *xRange.first;
+        feature.maxX = *xRange.second;
+        feature.minY = *yRange.first;
+        feature.maxY = *yRange.second;
+        extents.addPoint( feature.minX, feature.minY, 0.0 );
+        extents.addPoint( feature.maxX, feature.maxY, 0.0 );
+        features.push_back( feature );
+        ++nCount;
+    }
+    return nCount;
+}
+
+void CADRasterizer::clear()
+{
+    features.clear();
+    adfX.clear();
+    adfY.clear();
+    extents = CADBoundingBox();
+}
+
+void CADRasterizer::render( unsigned nWidth, unsigned nHeight, vector<uint8_t>& rgba )
+{
+    rgba.resize( static_cast<size_t>( nWidth ) * nHeight * 4 );
+    const uint8_t abyBackground[4] = { background.R, background.G, background.B, nBackgroundAlpha };
+    for( size_t i = 0; i < rgba.size(); i += 4 )
+        memcpy( &rgba[i], abyBackground, 4 );
+
+    const CADBoundingBox& area = bUserBounds ? bounds : extents;
+    if( nWidth == 0 || nHeight == 0 || area.isEmpty() || features.empty() )
+        return;
+
+    double dfAreaWidth  = area.getMaxX() - area.getMinX();
+    double dfAreaHeight = area.getMaxY() - area.getMinY();
+    if( dfAreaWidth > 0.0 && dfAreaHeight > 0.0 )
+        dfScale = min( nWidth / dfAreaWidth, nHeight / dfAreaHeight );
+    else if( dfAreaWidth > 0.0 || dfAreaHeight > 0.0 )
+        dfScale = dfAreaWidth > 0.0 ? nWidth / dfAreaWidth : nHeight / dfAreaHeight;
+    else
+        dfScale = 1.0;
+    dfOffsetX = ( nWidth - dfAreaWidth * dfScale ) / 2 - area.getMinX() * dfScale;
+    dfOffsetY = ( nHeight - dfAreaHeight * dfScale ) / 2 + area.getMaxY() * dfScale;
+
+    // Features go to the tiles their boxes touch, lines by segments
+    int    nTilesX  = static_cast<int>( ( nWidth + TILE_SIZE - 1 ) / TILE_SIZE );
+    int    nTilesY  = static_cast<int>( ( nHeight + TILE_SIZE - 1 ) / TILE_SIZE );
+    double dfMargin = dfLineWidth / 2 + 1.0;
+    vector<pair<uint32_t, uint32_t> > tileFeatures; // tile index and feature index
+    auto addBox = [&]( double minX, double minY, double maxX, double maxY, uint32_t iFeature ) {
+        double dfX0 = floor( ( minX * dfScale + dfOffsetX - dfMargin ) / TILE_SIZE );
+        double dfX1 = floor( ( maxX * dfScale + dfOffsetX + dfMargin ) / TILE_SIZE );
+        double dfY0 = floor( ( dfOffsetY - maxY * dfScale - dfMargin ) / TILE_SIZE );
+        double dfY1 = floor( ( dfOffsetY - minY * dfScale + dfMargin ) / TILE_SIZE );
+        if( dfX1 < 0.0 || dfY1 < 0.0 || dfX0 >= nTilesX || dfY0 >= nTilesY )
+            return;
+        int nX1 = static_cast<int>( min( dfX1, nTilesX - 1.0 ) );
+        int nY1 = static_cast<int>( min( dfY1, nTilesY - 1.0 ) );
+        for( int y = static_cast<int>( max( dfY0, 0.0 ) ); y <= nY1; ++y )
+            for( int x = static_cast<int>( max( dfX0, 0.0 ) ); x <= nX1; ++x )
+                tileFeatures.push_back( make_pair( static_cast<uint32_t>( y * nTilesX + x ), iFeature ) );
+    };
+    for( size_t i = 0; i < features.size(); ++i )
+    {
+        const Feature& feature = features[i];
+        if( feature.nType != CADTessellator::LINESTRING )
+        {
+            addBox( feature.minX, feature.minY, feature.maxX, feature.maxY, static_cast<uint32_t>( i ) );
+            continue;
+        }
+        const double * padfX = &adfX[feature.nFirst];
+        const double * padfY = &adfY[feature.nFirst];
+        for( uint32_t j = 0; j + 1 < feature.nCount; ++j )
+            addBox( min( padfX[j], padfX[j + 1] ), min( padfY[j], padfY[j + 1] ), max( padfX[j], padfX[j + 1] ),
+                    max( padfY[j], padfY[j + 1] ), static_cast<uint32_t>( i ) );
+    }
+    sort( tileFeatures.begin(), tileFeatures.end() );
+    tileFeatures.erase( unique( tileFeatures.begin(), tileFeatures.end() ), tileFeatures.end() );
+
+    vector<uint32_t> featureIds( tileFeatures.size() );
+    vector<size_t>   tileStarts;
+    for( size_t i = 0; i < tileFeatures.size(); ++i )
+    {
+        if( i == 0 || tileFeatures[i].first != tileFeatures[i - 1].first )
+            tileStarts.push_back( i );
+        featureIds[i] = tileFeatures[i].second;
+    }
+    tileStarts.push_back( tileFeatures.size() );
+
+    oPool.parallelFor( tileStarts.size() - 1, [&]( size_t iTile ) {
+        size_t nStart = tileStarts[iTile];
+        int    nIndex = static_cast<int>( tileFeatures[nStart].first );
+        Tile   tile;
+        tile.nLeft   = ( nIndex % nTilesX ) * TILE_SIZE;
+        tile.nTop    = ( nIndex / nTilesX ) * TILE_SIZE;
+        tile.nRight  = min( tile.nLeft + TILE_SIZE, static_cast<int>( nWidth ) );
+        tile.nBottom = min( tile.nTop + TILE_SIZE, static_cast<int>( nHeight ) );
+        drawTile( tile, &featureIds[nStart], tileStarts[iTile + 1] - nStart, nWidth, rgba );
+    } );
+}
+
+void CADRasterizer::drawTile( const Tile& tile, const uint32_t * panFeatures, size_t nFeatureCount, unsigned nWidth,
+                              vector<uint8_t>& rgba ) const
+{
+    TilePainter painter( tile.nLeft, tile.nTop, tile.nRight, tile.nBottom, nWidth, rgba );
+    bool bLightBackground = background.R * 299 + background.G * 587 + background.B * 114 > 128 * 1000;
+    const RGBColor white = { 255, 255, 255 };
+    const RGBColor black = { 0, 0, 0 };
+    vector<double> adfPixelX, adfPixelY;
+    for( size_t iFeature = 0; iFeature < nFeatureCount; ++iFeature )
+    {
+        const Feature& feature = features[panFeatures[iFeature]];
+        // ACI 7 is the foreground color
+        painter.setColor( bLightBackground && isSameColor( feature.color, white ) ? black : feature.color );
+
+        adfPixelX.resize( feature.nCount );
+        adfPixelY.resize( feature.nCount );
+        for( uint32_t i = 0; i < feature.nCount; ++i )
+        {
+            adfPixelX[i] = adfX[feature.nFirst + i] * dfScale + dfOffsetX;
+            adfPixelY[i] = dfOffsetY - adfY[feature.nFirst + i] * dfScale;
+        }
+
+        switch( feature.nType )
+        {
+            case CADTessellator::POINT:
+                if( dfLineWidth > 1.0 )
+                    painter.wideLine( adfPixelX[0], adfPixelY[0], adfPixelX[0], adfPixelY[0], dfLineWidth );
+                else
+                    painter.plot( static_cast<int>( floor( adfPixelX[0] ) ), static_cast<int>( floor( adfPixelY[0] ) ) );
+                break;
+            case CADTessellator::LINESTRING:
+                for( uint32_t i = 0; i + 1 < feature.nCount; ++i )
+                {
+                    if( dfLineWidth > 1.0 )
+                        painter.wideLine( adfPixelX[i], adfPixelY[i], adfPixelX[i + 1], adfPixelY[i + 1],
+                                          dfLineWidth );
+                    else
+                        painter.line( adfPixelX[i], adfPixelY[i], adfPixelX[i + 1], adfPixelY[i + 1] );
+                }
+                break;
+            default:
+                painter.polygon( adfPixelX.data(), adfPixelY.data(), feature.nCount - 1 );
+                for( uint32_t i = 0; i + 1 < feature.nCount; ++i )
+                    painter.line( adfPixelX[i], adfPixelY[i], adfPixelX[i + 1], adfPixelY[i + 1] );
+                break;
+        }
+    }
+}
+
+bool CADRasterizer::writePPM( ostream& stream, const vector<uint8_t>& rgba, unsigned nWidth, unsigned nHeight )
+{
+    if( rgba.size() < static_cast<size_t>( nWidth ) * nHeight * 4 )
+        return false;
+    stream << "P6\n" << nWidth << " " << nHeight << "\n255\n";
+    vector<uint8_t> row( static_cast<size_t>( nWidth ) * 3 );
+    for( unsigned y = 0; y < nHeight; ++y )
+    {
+        const uint8_t * pabyRow = &rgba[static_cast<size_t>( y ) * nWidth * 4];
+        for( unsigned x = 0; x < nWidth; ++x )
+            memcpy( &row[x * 3], pabyRow + x * 4, 3 );
+        stream.write( reinterpret_cast<const char *>( row.data() ), static_cast<streamsize>( row.size() ) );
+    }
+    return !stream.fail();
+}
+
+bool CADRasterizer::writePNG( ostream& stream, const vector<uint8_t>& rgba, unsigned nWidth, unsigned nHeight )
+{
+    if( nWidth == 0 || nHeight == 0 || rgba.size() < static_cast<size_t>( nWidth ) * nHeight * 4 )
+        return false;
+    stream.write( reinterpret_cast<const char *>( PNG_SIGNATURE ), sizeof( PNG_SIGNATURE ) );
+
+    // 8 bit RGBA, no interlace
+    vector<uint8_t> header;
+    putUInt32BE( header, nWidth );
+    putUInt32BE( header, nHeight );
+    const uint8_t abyFormat[5] = { 8, 6, 0, 0, 0 };
+    header.insert( header.end(), abyFormat, abyFormat + 5 );
+    writeChunk( stream, "IHDR", header );
+
+    // Rows start with filter type 0 (none)
+    size_t          nRowSize = static_cast<size_t>( nWidth ) * 4 + 1;
+    vector<uint8_t> raw( nRowSize * nHeight );
+    for( unsigned y = 0; y < nHeight; ++y )
+    {
+        raw[y * nRowSize] = 0;
+        memcpy( &raw[y * nRowSize + 1], &rgba[static_cast<size_t>( y ) * nWidth * 4], nRowSize - 1 );
+    }
+
+    vector<uint8_t> data = { 0x78, 0x01 }; // zlib header
+    DeflateWriter( data ).compress( raw.data(), raw.size(), 4, nRowSize );
+    uint32_t a = 1, b = 0;
+    for( size_t i = 0; i < raw.size(); ++i )
+    {
+        a = ( a + raw[i] ) % 65521;
+        b = ( b + a ) % 65521;
+    }
+    putUInt32BE( data, ( b << 16 ) | a );
+    writeChunk( stream, "IDAT", data );
+    writeChunk( stream, "IEND", vector<uint8_t>() );
+    return !stream.fail();
+}
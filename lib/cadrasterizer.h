@@ -0,0 +1,130 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADRASTERIZER_H
+#define CADRASTERIZER_H
+
+#include "cadfile.h"
+#include "cadtessellator.h"
+#include "cadthreadpool.h"
+
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Renders layers to an RGBA image on the CPU. Geometries are read and
+ * flattened once by addLayer(), so one set of layers can be rendered at many
+ * sizes. The image is split into tiles which are drawn in the thread pool.
+ * Lines and points use the entity or the layer ACI color, 3D faces and
+ * solids are filled. Color 7 is drawn black on a light background.
+ */
+class OCAD_EXTERN CADRasterizer
+{
+public:
+    enum ColorMode
+    {
+        ENTITY_COLOR = 0, // color of the geometry, by layer colors are resolved by the reader
+        LAYER_COLOR  = 1  // CADACIColors[layer.getColor()] for all layer geometries
+    };
+
+    explicit CADRasterizer( unsigned nThreads = 0 ); // 0 means hardware concurrency
+
+    CADTessellator& getTessellator(); // set the tolerance before addLayer()
+
+    RGBColor      getBackground() const;
+    unsigned char getBackgroundAlpha() const;
+    void          setBackground( RGBColor color, unsigned char alpha = 255 ); // white by default
+
+    enum ColorMode getColorMode() const;
+    void           setColorMode( enum ColorMode value ); // applies to the next addLayer() calls
+
+    double getLineWidth() const;
+    void   setLineWidth( double value ); // in pixels, 1 by default
+
+    /**
+     * @brief Set the drawing area to render. Extents of the added layers are
+     * used by default.
+     */
+    void setBounds( double dfMinX, double dfMinY, double dfMaxX, double dfMaxY );
+
+    size_t addLayer( CADLayer& layer ); // layers which are off or frozen are skipped
+    size_t addFile( CADFile& file );
+    void   clear();
+
+    /**
+     * @brief Draw the added layers. The area is fitted into the image keeping
+     * its aspect ratio and centered. rgba gets nWidth * nHeight * 4 bytes,
+     * rows go from the top.
+     */
+    void render( unsigned nWidth, unsigned nHeight, vector<uint8_t>& rgba );
+
+    static bool writePPM( ostream& stream, const vector<uint8_t>& rgba, unsigned nWidth, unsigned nHeight );
+    static bool writePNG( ostream& stream, const vector<uint8_t>& rgba, unsigned nWidth, unsigned nHeight );
+protected:
+    struct Feature
+    {
+        uint8_t  nType; // CADTessellator::SimpleFeature
+        RGBColor color;
+        size_t   nFirst; // coordinates in adfX and adfY
+        uint32_t nCount;
+        double   minX, minY, maxX, maxY;
+    };
+
+    // Pixel rectangle of a tile, right and bottom are exclusive
+    struct Tile
+    {
+        int nLeft, nTop, nRight, nBottom;
+    };
+
+    void drawTile( const Tile& tile, const uint32_t * panFeatures, size_t nFeatureCount, unsigned nWidth,
+                   vector<uint8_t>& rgba ) const;
+protected:
+    RGBColor       background;
+    unsigned char  nBackgroundAlpha;
+    enum ColorMode eColorMode;
+    double         dfLineWidth;
+    bool           bUserBounds;
+    CADBoundingBox bounds;
+    CADBoundingBox extents;
+
+    // Transformation to pixels of the current render() call
+    double dfScale;
+    double dfOffsetX;
+    double dfOffsetY;
+
+    vector<Feature> features;
+    vector<double>  adfX;
+    vector<double>  adfY;
+    CADTessellator  oTessellator;
+    CADVertexArray  oPoints;
+    CADThreadPool   oPool;
+};
+
+#endif // CADRASTERIZER_H
@@ -0,0 +1,159 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadspatialindex.h"
+
+#include <algorithm>
+#include <cmath>
+
+CADSpatialIndex::CADSpatialIndex( size_t nNodeSizeIn ) : nNodeSize( std::max( nNodeSizeIn, size_t( 2 ) ) ),
+                                                         bBuilt( false ), nItemCount( 0 )
+{
+}
+
+void CADSpatialIndex::build( const vector<CADBoundingBox>& aoBoxes )
+{
+    aoNodes.clear();
+    anLevelEnds.clear();
+    nItemCount = 0;
+    bBuilt     = true;
+
+    for( size_t i = 0; i < aoBoxes.size(); ++i )
+    {
+        const CADBoundingBox& box = aoBoxes[i];
+        if( box.isEmpty() )
+            continue;
+        Node stLeaf = { box.getMinX(), box.getMinY(), box.getMaxX(), box.getMaxY(), i };
+        aoNodes.push_back( stLeaf );
+    }
+    nItemCount = aoNodes.size();
+    if( nItemCount == 0 )
+        return;
+
+    size_t nLevelStart = 0;
+    size_t nLevelEnd   = aoNodes.size();
+    while( true )
+    {
+        packLevel( aoNodes.begin() + nLevelStart, aoNodes.begin() + nLevelEnd );
+        anLevelEnds.push_back( nLevelEnd );
+        if( nLevelEnd - nLevelStart == 1 )
+            break;
+
+        // Every nNodeSize neighbour nodes of the packed level get a parent.
+        for( size_t i = nLevelStart; i < nLevelEnd; i += nNodeSize )
+        {
+            Node stParent = aoNodes[i];
+            stParent.nIndex = i;
+            for( size_t j = i + 1; j < std::min( i + nNodeSize, nLevelEnd ); ++j )
+            {
+                stParent.minX = std::min( stParent.minX, aoNodes[j].minX );
+                stParent.minY = std::min( stParent.minY, aoNodes[j].minY );
+                stParent.maxX = std::max( stParent.maxX, aoNodes[j].maxX );
+                stParent.maxY = std::max( stParent.maxY, aoNodes[j].maxY );
+            }
+            aoNodes.push_back( stParent );
+        }
+        nLevelStart = nLevelEnd;
+        nLevelEnd   = aoNodes.size();
+    }
+}
+
+// Sort key of the node center. Infinite sides of unbounded boxes are left out.
+static double getCenter( double dfMin, double dfMax )
+{
+    if( std::isfinite( dfMin ) && std::isfinite( dfMax ) )
+        return ( dfMin + dfMax ) / 2;
+    if( std::isfinite( dfMin ) )
+        return dfMin;
+    return std::isfinite( dfMax ) ? dfMax : 0.0;
+}
+
+void CADSpatialIndex::packLevel( vector<Node>::iterator begin, vector<Node>::iterator end )
+{
+    // Sort-Tile-Recursive: sort by X, cut into vertical slices of
+    // sqrt(parent count) nodes, then sort every slice by Y.
+    size_t nCount       = static_cast<size_t>( end - begin );
+    size_t nParentCount = ( nCount + nNodeSize - 1 ) / nNodeSize;
+    size_t nSliceCount  = static_cast<size_t>( ceil( sqrt( static_cast<double>( nParentCount ) ) ) );
+    size_t nSliceSize   = nSliceCount * nNodeSize;
+
+    std::sort( begin, end, []( const Node& a, const Node& b )
+    {
+        return getCenter( a.minX, a.maxX ) < getCenter( b.minX, b.maxX );
+    } );
+    for( size_t i = 0; i < nCount; i += nSliceSize )
+    {
+        std::sort( begin + i, begin + std::min( i + nSliceSize, nCount ), []( const Node& a, const Node& b )
+        {
+            return getCenter( a.minY, a.maxY ) < getCenter( b.minY, b.maxY );
+        } );
+    }
+}
+
+bool CADSpatialIndex::isBuilt() const
+{
+    return bBuilt;
+}
+
+size_t CADSpatialIndex::getItemCount() const
+{
+    return nItemCount;
+}
+
+void CADSpatialIndex::query( double minx, double miny, double maxx, double maxy,
+                             const function<void( size_t )>& callback ) const
+{
+    if( aoNodes.empty() )
+        return;
+
+    // node index, level
+    vector<pair<size_t, size_t> > aoStack;
+    aoStack.push_back( make_pair( aoNodes.size() - 1, anLevelEnds.size() - 1 ) );
+    while( !aoStack.empty() )
+    {
+        size_t iNode  = aoStack.back().first;
+        size_t nLevel = aoStack.back().second;
+        aoStack.pop_back();
+
+        const Node& stNode = aoNodes[iNode];
+        if( stNode.maxX < minx || stNode.minX > maxx || stNode.maxY < miny || stNode.minY > maxy )
+            continue;
+
+        if( nLevel == 0 )
+        {
+            callback( stNode.nIndex );
+            continue;
+        }
+
+        size_t iChildEnd = std::min( stNode.nIndex + nNodeSize, anLevelEnds[nLevel - 1] );
+        for( size_t i = iChildEnd; i > stNode.nIndex; --i )
+            aoStack.push_back( make_pair( i - 1, nLevel - 1 ) );
+    }
+}
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADSPATIALINDEX_H
+#define CADSPATIALINDEX_H
+
+#include "cadgeometry.h"
+
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Static packed R-tree over item bounding boxes. The tree is built at
+ * once with Sort-Tile-Recursive packing, so nodes are filled completely and
+ * stored level by level in one array.
+ */
+class OCAD_EXTERN CADSpatialIndex
+{
+public:
+    explicit CADSpatialIndex( size_t nNodeSize = 16 );
+
+    /**
+     * @brief Build the tree. Item index is its position in the boxes vector.
+     * Empty boxes are not indexed.
+     */
+    void   build( const vector<CADBoundingBox>& aoBoxes );
+    bool   isBuilt() const;
+    size_t getItemCount() const;
+
+    /**
+     * @brief Call callback with index of every item which box intersects the
+     * window in XY plane. Items are reported in the tree order.
+     */
+    void query( double minx, double miny, double maxx, double maxy,
+                const function<void( size_t )>& callback ) const;
+protected:
+    struct Node
+    {
+        double minX, minY, maxX, maxY;
+        size_t nIndex; // item index for leaves, first child node for the rest
+    };
+
+    void packLevel( vector<Node>::iterator begin, vector<Node>::iterator end );
+protected:
+    size_t         nNodeSize;
+    bool           bBuilt;
+    size_t         nItemCount;
+    vector<Node>   aoNodes;
+    vector<size_t> anLevelEnds; // leaves level goes first, root is the last node
+};
+
+#endif // CADSPATIALINDEX_H
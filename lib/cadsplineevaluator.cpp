@@ -0,0 +1,431 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadsplineevaluator.h"
+
+#include <algorithm>
+#include <cmath>
+
+// de Boor work buffer is on the stack up to this degree
+static const size_t MAX_STACK_DEGREE = 7;
+// Halving limit of the initial parts in tessellate()
+static const int MAX_SUBDIVISION_DEPTH = 12;
+
+CADSplineEvaluator::CADSplineEvaluator() : nDegree( 0 ), b3D( false )
+{
+}
+
+bool CADSplineEvaluator::init( const CADSpline& spline )
+{
+    if( spline.getControlPoints().size() >= 2 )
+    {
+        static const vector<double> adfNoWeights;
+        return init( spline.getDegree(), spline.getControlPoints(),
+                     spline.isRational() ? spline.getControlPointsWeights() : adfNoWeights, spline.getKnots() );
+    }
+    return initFromFitPoints( spline.getFitPoints(), spline.getBegTangentDir(), spline.getEndTangentDir() );
+}
+
+bool CADSplineEvaluator::init( long degree, const CADVertexArray& ctrlPoints, const vector<double>& weights,
+                               const vector<double>& knots )
+{
+    nDegree = 0;
+    b3D     = false;
+    adfKnots.clear();
+    adfCtrlPoints.clear();
+
+    size_t nCount = ctrlPoints.size();
+    if( degree < 1 || nCount < 2 )
+        return false;
+    size_t nP = std::min( static_cast<size_t>( degree ), nCount - 1 );
+
+    const vector<double>& adfX = ctrlPoints.getXs();
+    const vector<double>& adfY = ctrlPoints.getYs();
+    const vector<double>& adfZ = ctrlPoints.getZs();
+    adfCtrlPoints.resize( nCount * 4 );
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        double w = i < weights.size() && weights[i] > 0.0 ? weights[i] : 1.0;
+        double z = adfZ.empty() ? 0.0 : adfZ[i];
+        if( z != 0.0 )
+            b3D = true;
+        adfCtrlPoints[i * 4]     = adfX[i] * w;
+        adfCtrlPoints[i * 4 + 1] = adfY[i] * w;
+        adfCtrlPoints[i * 4 + 2] = z * w;
+        adfCtrlPoints[i * 4 + 3] = w;
+    }
+
+    bool bKnotsValid = knots.size() == nCount + nP + 1 && knots[nP] < knots[nCount] &&
+                       std::is_sorted( knots.begin(), knots.end() );
+    if( bKnotsValid )
+    {
+        adfKnots = knots;
+    }
+    else
+    {
+        adfKnots.assign( nP + 1, 0.0 );
+        for( size_t i = 1; i < nCount - nP; ++i )
+            adfKnots.push_back( static_cast<double>( i ) / ( nCount - nP ) );
+        adfKnots.resize( nCount + nP + 1, 1.0 );
+    }
+    nDegree = nP;
+    return true;
+}
+
+bool CADSplineEvaluator::initFromFitPoints( const CADVertexArray& fitPoints, const CADVector& begTangentDir,
+                                            const CADVector& endTangentDir )
+{
+    nDegree = 0;
+    b3D     = false;
+    adfKnots.clear();
+    adfCtrlPoints.clear();
+
+    // Coincident fit points would give equal parameters and singular system
+    vector<CADVector> aoQ;
+    for( size_t i = 0; i < fitPoints.size(); ++i )
+    {
+        CADVector point = fitPoints.get( i );
+        if( aoQ.empty() || point.getX() != aoQ.back().getX() || point.getY() != aoQ.back().getY() ||
+            point.getZ() != aoQ.back().getZ() )
+            aoQ.push_back( CADVector( point.getX(), point.getY(), point.getZ() ) );
+    }
+    if( aoQ.size() < 2 )
+        return false;
+    size_t n = aoQ.size() - 1;
+
+    auto sub = []( const CADVector& a, const CADVector& b )
+    {
+        return CADVector( a.getX() - b.getX(), a.getY() - b.getY(), a.getZ() - b.getZ() );
+    };
+    auto length = []( const CADVector& a )
+    {
+        return sqrt( a.getX() * a.getX() + a.getY() * a.getY() + a.getZ() * a.getZ() );
+    };
+    auto axpy = []( double a, const CADVector& x, const CADVector& y )
+    {
+        return CADVector( a * x.getX() + y.getX(), a * x.getY() + y.getY(), a * x.getZ() + y.getZ() );
+    };
+
+    vector<double> adfU( n + 1, 0.0 );
+    for( size_t i = 1; i <= n; ++i )
+        adfU[i] = adfU[i - 1] + length( sub( aoQ[i], aoQ[i - 1] ) );
+    double dfLength = adfU[n];
+    for( size_t i = 1; i < n; ++i )
+        adfU[i] /= dfLength;
+    adfU[n] = 1.0;
+
+    // Derivatives by the normalized parameter. Its speed is about the total
+    // chord length.
+    CADVector D0 = sub( aoQ[1], aoQ[0] );
+    double    dfD0 = 1.0 / adfU[1];
+    if( length( begTangentDir ) > 0.0 )
+    {
+        D0   = begTangentDir;
+        dfD0 = dfLength / length( begTangentDir );
+    }
+    CADVector Dn = sub( aoQ[n], aoQ[n - 1] );
+    double    dfDn = 1.0 / ( 1.0 - adfU[n - 1] );
+    if( length( endTangentDir ) > 0.0 )
+    {
+        Dn   = endTangentDir;
+        dfDn = dfLength / length( endTangentDir );
+    }
+
+    // Clamped cubic with fit points parameters as inner knots has n + 3
+    // control points. The end ones are set by the end points and derivatives.
+    adfKnots.assign( 4, 0.0 );
+    adfKnots.insert( adfKnots.end(), adfU.begin() + 1, adfU.end() - 1 );
+    adfKnots.resize( adfKnots.size() + 4, 1.0 );
+
+    vector<CADVector> aoP( n + 3 );
+    aoP[0]     = aoQ[0];
+    aoP[1]     = axpy( dfD0 * adfU[1] / 3, D0, aoQ[0] );
+    aoP[n + 1] = axpy( -dfDn * ( 1.0 - adfU[n - 1] ) / 3, Dn, aoQ[n] );
+    aoP[n + 2] = aoQ[n];
+
+    // Curve passes through inner fit point k at u[k]:
+    // N[k](u[k]) * P[k] + N[k+1](u[k]) * P[k+1] + N[k+2](u[k]) * P[k+2] = Q[k].
+    // The tridiagonal system for P[2] .. P[n] is solved by Thomas algorithm.
+    nDegree = 3;
+    if( n > 1 )
+    {
+        size_t            nRows = n - 1;
+        vector<double>    adfC( nRows );
+        vector<CADVector> aoD( nRows );
+        double            adfN[4];
+        for( size_t r = 0; r < nRows; ++r )
+        {
+            size_t k = r + 1;
+            basisFunctions( k + 3, adfU[k], adfN );
+            double a = adfN[0], b = adfN[1], c = adfN[2];
+            CADVector rhs = aoQ[k];
+            if( r == 0 )
+                rhs = axpy( -a, aoP[1], rhs );
+            if( r == nRows - 1 )
+                rhs = axpy( -c, aoP[n + 1], rhs );
+
+            double dfDen = b;
+            if( r > 0 )
+            {
+                dfDen -= a * adfC[r - 1];
+                rhs = axpy( -a, aoD[r - 1], rhs );
+            }
+            adfC[r] = c / dfDen;
+            aoD[r]  = CADVector( rhs.getX() / dfDen, rhs.getY() / dfDen, rhs.getZ() / dfDen );
+        }
+        aoP[n] = aoD[nRows - 1];
+        for( size_t r = nRows - 1; r > 0; --r )
+            aoP[r + 1] = axpy( -adfC[r - 1], aoP[r + 2], aoD[r - 1] );
+    }
+
+    adfCtrlPoints.resize( aoP.size() * 4 );
+    for( size_t i = 0; i < aoP.size(); ++i )
+    {
+        if( aoP[i].getZ() != 0.0 )
+            b3D = true;
+        adfCtrlPoints[i * 4]     = aoP[i].getX();
+        adfCtrlPoints[i * 4 + 1] = aoP[i].getY();
+        adfCtrlPoints[i * 4 + 2] = aoP[i].getZ();
+        adfCtrlPoints[i * 4 + 3] = 1.0;
+    }
+    return true;
+}
+
+bool CADSplineEvaluator::isValid() const
+{
+    return nDegree > 0;
+}
+
+bool CADSplineEvaluator::is3D() const
+{
+    return b3D;
+}
+
+size_t CADSplineEvaluator::getDegree() const
+{
+    return nDegree;
+}
+
+double CADSplineEvaluator::getStartParam() const
+{
+    return adfKnots[nDegree];
+}
+
+double CADSplineEvaluator::getEndParam() const
+{
+    return adfKnots[adfKnots.size() - nDegree - 1];
+}
+
+const vector<double>& CADSplineEvaluator::getKnots() const
+{
+    return adfKnots;
+}
+
+size_t CADSplineEvaluator::findSpan( double t ) const
+{
+    // Span i is [knots[i], knots[i + 1]), valid ones are degree .. count - 1.
+    size_t nLast = adfKnots.size() - nDegree - 2;
+    auto   it    = std::upper_bound( adfKnots.begin() + nDegree, adfKnots.begin() + nLast + 1, t );
+    size_t nSpan = static_cast<size_t>( it - adfKnots.begin() );
+    if( nSpan <= nDegree )
+        return nDegree;
+    --nSpan;
+    // End parameter belongs to the last non empty span
+    while( nSpan > nDegree && adfKnots[nSpan] == adfKnots[nSpan + 1] )
+        --nSpan;
+    return nSpan;
+}
+
+void CADSplineEvaluator::deBoor( size_t nSpan, double t, double * padfWork, double adfOut[3] ) const
+{
+    const double * padfP = adfCtrlPoints.data() + ( nSpan - nDegree ) * 4;
+    std::copy( padfP, padfP + ( nDegree + 1 ) * 4, padfWork );
+
+    for( size_t r = 1; r <= nDegree; ++r )
+    {
+        for( size_t j = nDegree; j >= r; --j )
+        {
+            size_t i     = nSpan - nDegree + j;
+            double dfDen = adfKnots[i + nDegree - r + 1] - adfKnots[i];
+            double alpha = dfDen != 0.0 ? ( t - adfKnots[i] ) / dfDen : 0.0;
+            double * d   = padfWork + j * 4;
+            const double * prev = d - 4;
+            d[0] = ( 1.0 - alpha ) * prev[0] + alpha * d[0];
+            d[1] = ( 1.0 - alpha ) * prev[1] + alpha * d[1];
+            d[2] = ( 1.0 - alpha ) * prev[2] + alpha * d[2];
+            d[3] = ( 1.0 - alpha ) * prev[3] + alpha * d[3];
+        }
+    }
+
+    const double * d = padfWork + nDegree * 4;
+    adfOut[0] = d[0] / d[3];
+    adfOut[1] = d[1] / d[3];
+    adfOut[2] = d[2] / d[3];
+}
+
+void CADSplineEvaluator::basisFunctions( size_t nSpan, double t, double * padfN ) const
+{
+    vector<double> adfLeft( nDegree + 1 ), adfRight( nDegree + 1 );
+    padfN[0] = 1.0;
+    for( size_t j = 1; j <= nDegree; ++j )
+    {
+        adfLeft[j]  = t - adfKnots[nSpan + 1 - j];
+        adfRight[j] = adfKnots[nSpan + j] - t;
+        double dfSaved = 0.0;
+        for( size_t r = 0; r < j; ++r )
+        {
+            double dfTemp = padfN[r] / ( adfRight[r + 1] + adfLeft[j - r] );
+            padfN[r] = dfSaved + adfRight[r + 1] * dfTemp;
+            dfSaved  = adfLeft[j - r] * dfTemp;
+        }
+        padfN[j] = dfSaved;
+    }
+}
+
+CADVector CADSplineEvaluator::evaluate( double t ) const
+{
+    double adfOut[3];
+    evaluate( &t, 1, adfOut, adfOut + 1, adfOut + 2 );
+    return CADVector( adfOut[0], adfOut[1], adfOut[2] );
+}
+
+void CADSplineEvaluator::evaluate( const double * padfParams, size_t nCount, double * padfX, double * padfY,
+                                   double * padfZ ) const
+{
+    if( !isValid() || nCount == 0 )
+        return;
+
+    double         adfStack[( MAX_STACK_DEGREE + 1 ) * 4];
+    vector<double> adfHeap;
+    double       * padfWork = adfStack;
+    if( nDegree > MAX_STACK_DEGREE )
+    {
+        adfHeap.resize( ( nDegree + 1 ) * 4 );
+        padfWork = adfHeap.data();
+    }
+
+    double dfStart = getStartParam(), dfEnd = getEndParam();
+    size_t nSpan   = findSpan( dfStart );
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        double t = std::min( std::max( padfParams[i], dfStart ), dfEnd );
+        if( t < adfKnots[nSpan] || t >= adfKnots[nSpan + 1] )
+            nSpan = findSpan( t );
+
+        double adfPoint[3];
+        deBoor( nSpan, t, padfWork, adfPoint );
+        padfX[i] = adfPoint[0];
+        padfY[i] = adfPoint[1];
+        if( padfZ )
+            padfZ[i] = adfPoint[2];
+    }
+}
+
+size_t CADSplineEvaluator::tessellate( double dfTolerance, CADVertexArray& out ) const
+{
+    if( !isValid() )
+        return 0;
+
+    double         adfStack[( MAX_STACK_DEGREE + 1 ) * 4];
+    vector<double> adfHeap;
+    double       * padfWork = adfStack;
+    if( nDegree > MAX_STACK_DEGREE )
+    {
+        adfHeap.resize( ( nDegree + 1 ) * 4 );
+        padfWork = adfHeap.data();
+    }
+
+    size_t nStart = out.size();
+    bool   bZ     = b3D || out.hasZ();
+    auto   append = [&]( const double adfP[3] )
+    {
+        if( bZ )
+            out.add( adfP[0], adfP[1], adfP[2] );
+        else
+            out.add( adfP[0], adfP[1] );
+    };
+
+    double t0 = getStartParam();
+    double adfP0[3];
+    deBoor( findSpan( t0 ), t0, padfWork, adfP0 );
+    append( adfP0 );
+
+    size_t nLastSpan = adfKnots.size() - nDegree - 2;
+    for( size_t nSpan = nDegree; nSpan <= nLastSpan; ++nSpan )
+    {
+        double dfSpanStart = adfKnots[nSpan], dfSpanEnd = adfKnots[nSpan + 1];
+        if( dfSpanStart == dfSpanEnd )
+            continue;
+        for( size_t i = 1; i <= nDegree + 1; ++i )
+        {
+            double t1 = i == nDegree + 1 ? dfSpanEnd :
+                        dfSpanStart + ( dfSpanEnd - dfSpanStart ) * i / ( nDegree + 1 );
+            double adfP1[3];
+            deBoor( nSpan, t1, padfWork, adfP1 );
+            subdivide( t0, adfP0, t1, adfP1, dfTolerance, 0, padfWork, out );
+            append( adfP1 );
+            t0 = t1;
+            std::copy( adfP1, adfP1 + 3, adfP0 );
+        }
+    }
+    return out.size() - nStart;
+}
+
+void CADSplineEvaluator::subdivide( double t0, const double adfP0[3], double t1, const double adfP1[3],
+                                    double dfTolerance, int nDepth, double * padfWork,
+                                    CADVertexArray& out ) const
+{
+    if( dfTolerance <= 0.0 || nDepth >= MAX_SUBDIVISION_DEPTH )
+        return;
+
+    double tm = ( t0 + t1 ) / 2;
+    double adfM[3];
+    deBoor( findSpan( tm ), tm, padfWork, adfM );
+
+    // Distance from the middle point to the chord
+    double adfChord[3] = { adfP1[0] - adfP0[0], adfP1[1] - adfP0[1], adfP1[2] - adfP0[2] };
+    double adfToM[3]   = { adfM[0] - adfP0[0], adfM[1] - adfP0[1], adfM[2] - adfP0[2] };
+    double dfChord2    = adfChord[0] * adfChord[0] + adfChord[1] * adfChord[1] + adfChord[2] * adfChord[2];
+    double dfProj      = dfChord2 > 0.0 ? ( adfToM[0] * adfChord[0] + adfToM[1] * adfChord[1] +
+                                            adfToM[2] * adfChord[2] ) / dfChord2 : 0.0;
+    dfProj = std::min( std::max( dfProj, 0.0 ), 1.0 );
+    double dfDX = adfToM[0] - dfProj * adfChord[0];
+    double dfDY = adfToM[1] - dfProj * adfChord[1];
+    double dfDZ = adfToM[2] - dfProj * adfChord[2];
+    if( dfDX * dfDX + dfDY * dfDY + dfDZ * dfDZ <= dfTolerance * dfTolerance )
+        return;
+
+    subdivide( t0, adfP0, tm, adfM, dfTolerance, nDepth + 1, padfWork, out );
+    if( b3D || out.hasZ() )
+        out.add( adfM[0], adfM[1], adfM[2] );
+    else
+        out.add( adfM[0], adfM[1] );
+    subdivide( tm, adfM, t1, adfP1, dfTolerance, nDepth + 1, padfWork, out );
+}
@@ -0,0 +1,109 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADSPLINEEVALUATOR_H
+#define CADSPLINEEVALUATOR_H
+
+#include "cadgeometry.h"
+
+/**
+ * @brief Evaluates points of a non-uniform rational B-spline with de Boor
+ * algorithm. Control points are kept in homogeneous coordinates, so rational
+ * and non-rational splines share the same code. Evaluation doesn't allocate
+ * memory for splines of degree below 8.
+ */
+class OCAD_EXTERN CADSplineEvaluator
+{
+public:
+    CADSplineEvaluator();
+
+    /**
+     * @brief Set up from control points and knots, or from fit points if the
+     * spline has no control points.
+     * @return false if the spline has not enough points
+     */
+    bool init( const CADSpline& spline );
+
+    /**
+     * @brief Set up from control points. Weights are ignored if empty. Knots
+     * are replaced by clamped uniform ones if they don't match the control
+     * points count and degree.
+     */
+    bool init( long degree, const CADVertexArray& ctrlPoints, const vector<double>& weights,
+               const vector<double>& knots );
+
+    /**
+     * @brief Set up cubic spline interpolating fit points, parametrized by
+     * chord length. End tangent directions are estimated from the nearest fit
+     * points if they are zero.
+     */
+    bool initFromFitPoints( const CADVertexArray& fitPoints, const CADVector& begTangentDir,
+                            const CADVector& endTangentDir );
+
+    bool   isValid() const;
+    bool   is3D() const; // false if all control points have zero Z
+    size_t getDegree() const;
+    double getStartParam() const;
+    double getEndParam() const;
+
+    const vector<double>& getKnots() const;
+
+    CADVector evaluate( double t ) const;
+
+    /**
+     * @brief Evaluate points at many parameters. Sorted parameters are the
+     * fastest, as the knot span is searched only when t leaves the current
+     * one. padfZ may be nullptr.
+     */
+    void evaluate( const double * padfParams, size_t nCount, double * padfX, double * padfY,
+                   double * padfZ ) const;
+
+    /**
+     * @brief Append points of the curve to out. Every knot span is split into
+     * degree + 1 parts at first, then each part is halved until the middle
+     * point is not farther than tolerance from the chord. Parts are not
+     * split if tolerance is not positive.
+     * @return number of added points
+     */
+    size_t tessellate( double dfTolerance, CADVertexArray& out ) const;
+protected:
+    size_t findSpan( double t ) const;
+    void   deBoor( size_t nSpan, double t, double * padfWork, double adfOut[3] ) const;
+    void   basisFunctions( size_t nSpan, double t, double * padfN ) const; // degree + 1 values
+    void   subdivide( double t0, const double adfP0[3], double t1, const double adfP1[3], double dfTolerance,
+                      int nDepth, double * padfWork, CADVertexArray& out ) const;
+protected:
+    size_t         nDegree;
+    bool           b3D;
+    vector<double> adfKnots;
+    vector<double> adfCtrlPoints; // x * w, y * w, z * w, w for each point
+};
+
+#endif // CADSPLINEEVALUATOR_H
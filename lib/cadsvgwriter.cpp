@@ -0,0 +1,665 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadsvgwriter.h"
+#include "cadmath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+
+// Buffer is written to the stream once it is longer, paths are split by it
+static const size_t FLUSH_SIZE = 64 * 1024;
+
+static bool isSameColor( RGBColor a, RGBColor b )
+{
+    return a.R == b.R && a.G == b.G && a.B == b.B;
+}
+
+CADSVGWriter::CADSVGWriter( ostream& stream, int nPrecisionIn ) :
+    oStream( stream ), nPrecision( 0 ), dfScale( 1.0 ), bUserBounds( false ), bStarted( false ),
+    bFinished( false ), bPathFill( false ), chLastCommand( '\0' ), bExplicitStart( false ), nX( 0 ), nY( 0 ),
+    nStartX( 0 ), nStartY( 0 )
+{
+    layerColor = { 0, 0, 0 };
+    pathColor  = { 0, 0, 0 };
+    setPrecision( nPrecisionIn );
+    osBuffer.reserve( FLUSH_SIZE + FLUSH_SIZE / 4 );
+}
+
+CADSVGWriter::~CADSVGWriter()
+{
+    finish();
+}
+
+CADTessellator& CADSVGWriter::getTessellator()
+{
+    return oTessellator;
+}
+
+int CADSVGWriter::getPrecision() const
+{
+    return nPrecision;
+}
+
+void CADSVGWriter::setPrecision( int value )
+{
+    // Quantized path coordinates are relative, so it is fixed for the document
+    if( bStarted )
+        return;
+    nPrecision = min( max( value, 0 ), 9 );
+    dfScale    = pow( 10.0, nPrecision );
+}
+
+void CADSVGWriter::setBounds( double dfMinX, double dfMinY, double dfMaxX, double dfMaxY )
+{
+    bounds = CADBoundingBox();
+    bounds.addPoint( dfMinX, dfMinY, 0.0 );
+    bounds.addPoint( dfMaxX, dfMaxY, 0.0 );
+    bUserBounds = true;
+}
+
+size_t CADSVGWriter::writeFile( CADFile& file )
+{
+    if( !bStarted && !bFinished )
+        start( bUserBounds ? bounds : file.computeExtents() );
+    size_t nCount = 0;
+    for( size_t i = 0; i < file.GetLayersCount(); ++i )
+        nCount += writeLayer( file.GetLayer( i ) );
+    return nCount;
+}
+
+size_t CADSVGWriter::writeLayer( CADLayer& layer )
+{
+    if( bFinished )
+        return 0;
+    if( !bStarted )
+        start( bUserBounds ? bounds : layer.getExtents() );
+
+    layerColor = CADACIColors[abs( layer.getColor() ) % 256];
+    osBuffer += "<g id=\"";
+    appendText( layer.getName() );
+    osBuffer += "\" stroke=\"";
+    appendColor( layerColor );
+    osBuffer += '"';
+    if( !layer.getOn() || layer.getFrozen() )
+        osBuffer += " display=\"none\"";
+    osBuffer += ">\n";
+
+    size_t nCount = 0;
+    for( size_t i = 0; i < layer.getGeometryCount(); ++i )
+    {
+        unique_ptr<CADGeometry> geometry( layer.getGeometry( i ) );
+        if( geometry != nullptr && writeGeometry( geometry.get() ) )
+            ++nCount;
+        if( osPath.size() >= FLUSH_SIZE )
+            flushPath();
+        flush( false );
+    }
+    flushPath();
+    osBuffer += "</g>\n";
+    flush( false );
+    return nCount;
+}
+
+void CADSVGWriter::finish()
+{
+    if( bFinished )
+        return;
+    if( !bStarted )
+        start( bounds );
+    flushPath();
+    osBuffer += "</g>\n</svg>\n";
+    bFinished = true;
+    flush( true );
+    oStream.flush();
+}
+
+void CADSVGWriter::start( const CADBoundingBox& box )
+{
+    bStarted = true;
+    double dfMinX = 0.0, dfMaxY = 1.0, dfWidth = 1.0, dfHeight = 1.0;
+    if( !box.isEmpty() )
+    {
+        dfMinX   = box.getMinX();
+        dfMaxY   = box.getMaxY();
+        dfWidth  = max( box.getMaxX() - dfMinX, 1.0 / dfScale );
+        dfHeight = max( dfMaxY - box.getMinY(), 1.0 / dfScale );
+    }
+
+    // Drawing Y goes up, the root group flips it
+    osBuffer += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"";
+    appendNumber( dfMinX );
+    osBuffer += ' ';
+    appendNumber( -dfMaxY );
+    osBuffer += ' ';
+    appendNumber( dfWidth );
+    osBuffer += ' ';
+    appendNumber( dfHeight );
+    osBuffer += "\">\n<style>path,circle,ellipse{vector-effect:non-scaling-stroke}</style>\n"
+                "<g transform=\"scale(1 -1)\" fill=\"none\" stroke-width=\"1\" stroke-linecap=\"round\" "
+                "stroke-linejoin=\"round\">\n";
+}
+
+bool CADSVGWriter::writeGeometry( const CADGeometry * pGeom )
+{
+    switch( pGeom->getType() )
+    {
+        case CADGeometry::LINE:
+        {
+            auto      poLine = static_cast<const CADLine *>( pGeom );
+            CADVector start  = poLine->getStart().getPosition();
+            CADVector end    = poLine->getEnd().getPosition();
+            startPath( pGeom->getColor(), false );
+            moveTo( start.getX(), start.getY() );
+            lineTo( end.getX(), end.getY() );
+            return true;
+        }
+
+        case CADGeometry::CIRCLE:
+        case CADGeometry::ARC:
+        {
+            auto   poCircle = static_cast<const CADCircle *>( pGeom );
+            double dfStart = 0.0, dfEnd = 0.0;
+            if( pGeom->getType() == CADGeometry::ARC )
+            {
+                dfStart = static_cast<const CADArc *>( pGeom )->getStartingAngle();
+                dfEnd   = static_cast<const CADArc *>( pGeom )->getEndingAngle();
+            }
+            // Center is in WCS, angles are measured in OCS of the normal
+            double dfRadius = poCircle->getRadius();
+            Matrix ocs      = Matrix::ocsToWcs( poCircle->getExtrusion() );
+            return writeConic( pGeom, poCircle->getPosition(),
+                               ocs.multiplyDirection( CADVector( dfRadius, 0.0, 0.0 ) ),
+                               ocs.multiplyDirection( CADVector( 0.0, dfRadius, 0.0 ) ), dfStart, dfEnd );
+        }
+
+        case CADGeometry::ELLIPSE:
+        {
+            // Minor axis is ratio * (N x A), the same as in the tessellator
+            auto      poEllipse = static_cast<const CADEllipse *>( pGeom );
+            CADVector N         = poEllipse->getExtrusion();
+            double    dfLength  = sqrt( N.getX() * N.getX() + N.getY() * N.getY() + N.getZ() * N.getZ() );
+            if( dfLength == 0.0 )
+            {
+                N        = CADVector( 0.0, 0.0, 1.0 );
+                dfLength = 1.0;
+            }
+            CADVector A       = poEllipse->getSMAxis();
+            double    dfRatio = poEllipse->getAxisRatio() / dfLength;
+            CADVector B( dfRatio * ( N.getY() * A.getZ() - N.getZ() * A.getY() ),
+                         dfRatio * ( N.getZ() * A.getX() - N.getX() * A.getZ() ),
+                         dfRatio * ( N.getX() * A.getY() - N.getY() * A.getX() ) );
+            return writeConic( pGeom, poEllipse->getPosition(), A, B, poEllipse->getStartingAngle(),
+                               poEllipse->getEndingAngle() );
+        }
+
+        case CADGeometry::LWPOLYLINE:
+        {
+            auto poPolyline = static_cast<const CADLWPolyline *>( pGeom );
+            return writePolyline( pGeom, poPolyline->getVertexes(), poPolyline->getBulges(), poPolyline->isClosed(),
+                                  poPolyline->getVectExtrusion() );
+        }
+
+        case CADGeometry::POLYLINE2D:
+        {
+            auto poPolyline = static_cast<const CADPolyline2D *>( pGeom );
+            return writePolyline( pGeom, poPolyline->getVertexes(), poPolyline->getBulges(), poPolyline->isClosed(),
+                                  poPolyline->getVectExtrusion() );
+        }
+
+        case CADGeometry::TEXT:
+        case CADGeometry::MTEXT:
+        case CADGeometry::ATTRIB:
+        case CADGeometry::ATTDEF:
+            return writeText( static_cast<const CADText *>( pGeom ) );
+
+        default:
+            return writeSimpleFeature( pGeom );
+    }
+}
+
+bool CADSVGWriter::writeConic( const CADGeometry * pGeom, const CADVector& center, const CADVector& axisA,
+                               const CADVector& axisB, double dfStart, double dfEnd )
+{
+    // Point at parameter t is center + A * cos(t) + B * sin(t), its XY
+    // projection is an ellipse unless the curve is seen edge on
+    double ax = axisA.getX(), ay = axisA.getY();
+    double bx = axisB.getX(), by = axisB.getY();
+    double dfDet = ax * by - ay * bx;
+    if( fabs( dfDet ) <= 1e-12 * ( ax * ax + ay * ay + bx * bx + by * by ) )
+        return writeSimpleFeature( pGeom );
+
+    // Axes are conjugate diameters, the principal ones are at the parameter
+    // where |A cos(t) + B sin(t)| is extreme
+    double dfTheta    = atan2( 2 * ( ax * bx + ay * by ), ax * ax + ay * ay - bx * bx - by * by ) / 2;
+    double dfMajorX   = ax * cos( dfTheta ) + bx * sin( dfTheta );
+    double dfMajorY   = ay * cos( dfTheta ) + by * sin( dfTheta );
+    double dfRX       = hypot( dfMajorX, dfMajorY );
+    double dfRY       = fabs( dfDet ) / dfRX;
+    bool   bCircle    = fabs( dfRX - dfRY ) <= 1e-9 * dfRX;
+    double dfRotation = bCircle ? 0.0 : atan2( dfMajorY, dfMajorX ) * 180.0 / M_PI;
+
+    const double dfTwoPi = 2 * M_PI;
+    double dfSweep = fmod( dfEnd - dfStart, dfTwoPi );
+    if( dfSweep <= 0.0 )
+        dfSweep += dfTwoPi;
+
+    if( dfSweep == dfTwoPi )
+    {
+        if( bCircle )
+        {
+            osBuffer += "<circle cx=\"";
+            appendNumber( center.getX() );
+            osBuffer += "\" cy=\"";
+            appendNumber( center.getY() );
+            osBuffer += "\" r=\"";
+            appendNumber( dfRX );
+        }
+        else
+        {
+            osBuffer += "<ellipse cx=\"";
+            appendNumber( center.getX() );
+            osBuffer += "\" cy=\"";
+            appendNumber( center.getY() );
+            osBuffer += "\" rx=\"";
+            appendNumber( dfRX );
+            osBuffer += "\" ry=\"";
+            appendNumber( dfRY );
+            if( quantize( dfRotation ) != 0 )
+            {
+                osBuffer += "\" transform=\"rotate(";
+                appendNumber( dfRotation );
+                osBuffer += ' ';
+                appendNumber( center.getX() );
+                osBuffer += ' ';
+                appendNumber( center.getY() );
+                osBuffer += ')';
+            }
+        }
+        osBuffer += '"';
+        appendStrokeColor( pGeom->getColor() );
+        osBuffer += "/>\n";
+        return true;
+    }
+
+    // Positive determinant means counterclockwise in the drawing, i.e. the
+    // positive angle direction of the flipped root group
+    startPath( pGeom->getColor(), false );
+    moveTo( center.getX() + ax * cos( dfStart ) + bx * sin( dfStart ),
+            center.getY() + ay * cos( dfStart ) + by * sin( dfStart ) );
+    arcTo( dfRX, dfRY, dfRotation, dfSweep > M_PI, dfDet > 0.0, center.getX() + ax * cos( dfEnd ) + bx * sin( dfEnd ),
+           center.getY() + ay * cos( dfEnd ) + by * sin( dfEnd ) );
+    return true;
+}
+
+bool CADSVGWriter::writePolyline( const CADGeometry * pGeom, const CADVertexArray& vertexes,
+                                  const vector<double>& bulges, bool bClosed, const CADVector& extrusion )
+{
+    // Vertexes are in WCS, bulges are measured in OCS of the normal. Arcs
+    // stay circular only if the polyline plane is parallel to XY.
+    size_t    nCount = vertexes.size();
+    Matrix    ocs    = Matrix::ocsToWcs( extrusion );
+    CADVector xAxis  = ocs.multiplyDirection( CADVector( 1.0, 0.0, 0.0 ) );
+    CADVector yAxis  = ocs.multiplyDirection( CADVector( 0.0, 1.0, 0.0 ) );
+    if( nCount < 2 || fabs( xAxis.getZ() ) > 1e-9 || fabs( yAxis.getZ() ) > 1e-9 )
+        return writeSimpleFeature( pGeom );
+    bool bMirrored = xAxis.getX() * yAxis.getY() - xAxis.getY() * yAxis.getX() < 0.0;
+
+    const double * padfX = vertexes.getXs().data();
+    const double * padfY = vertexes.getYs().data();
+    startPath( pGeom->getColor(), false );
+    moveTo( padfX[0], padfY[0] );
+    size_t nSegments = bClosed ? nCount : nCount - 1;
+    for( size_t i = 0; i < nSegments; ++i )
+    {
+        size_t j      = ( i + 1 ) % nCount;
+        double dfBulge = i < bulges.size() ? bulges[i] : 0.0;
+        double cx, cy, dfRadius, dfStartAngle, dfEndAngle;
+        if( CADTessellator::getBulgeArc( padfX[i], padfY[i], padfX[j], padfY[j], dfBulge, cx, cy, dfRadius,
+                                         dfStartAngle, dfEndAngle ) )
+            arcTo( dfRadius, dfRadius, 0.0, fabs( dfBulge ) > 1.0, ( dfBulge > 0.0 ) != bMirrored, padfX[j],
+                   padfY[j] );
+        else if( j != 0 )
+            lineTo( padfX[j], padfY[j] );
+    }
+    if( bClosed )
+        closePath();
+    return true;
+}
+
+bool CADSVGWriter::writeText( const CADText * pText )
+{
+    string value = pText->getTextValue();
+    if( value.empty() )
+        return false;
+
+    CADVector position = pText->getPosition();
+    osBuffer += "<text transform=\"translate(";
+    appendNumber( position.getX() );
+    osBuffer += ' ';
+    appendNumber( position.getY() );
+    osBuffer += ")scale(1 -1)";
+    double dfRotation = -pText->getRotationAngle() * 180.0 / M_PI;
+    if( quantize( dfRotation ) != 0 )
+    {
+        osBuffer += "rotate(";
+        appendNumber( dfRotation );
+        osBuffer += ')';
+    }
+    osBuffer += "\" font-size=\"";
+    appendNumber( pText->getHeight() );
+    osBuffer += "\" fill=\"";
+    appendColor( pText->getColor() );
+    osBuffer += "\" stroke=\"none\">";
+    appendText( value );
+    osBuffer += "</text>\n";
+    return true;
+}
+
+bool CADSVGWriter::writeSimpleFeature( const CADGeometry * pGeom )
+{
+    oPoints.clear();
+    enum CADTessellator::SimpleFeature eType = oTessellator.getSimpleFeature( pGeom, oPoints );
+    if( eType == CADTessellator::NONE )
+        return false;
+
+    const double * padfX = oPoints.getXData();
+    const double * padfY = oPoints.getYData();
+    startPath( pGeom->getColor(), eType == CADTessellator::POLYGON );
+    moveTo( padfX[0], padfY[0] );
+    if( eType == CADTessellator::POINT )
+    {
+        // Zero length segment is drawn as a dot by the round cap
+        osPath += "h0";
+        chLastCommand = 'h';
+    }
+    else if( eType == CADTessellator::LINESTRING )
+    {
+        for( size_t i = 1; i < oPoints.size(); ++i )
+            lineTo( padfX[i], padfY[i] );
+    }
+    else
+    {
+        // The ring is closed, the last point repeats the first one
+        for( size_t i = 1; i + 1 < oPoints.size(); ++i )
+            lineTo( padfX[i], padfY[i] );
+        closePath();
+        flushPath();
+    }
+    return true;
+}
+
+void CADSVGWriter::startPath( RGBColor color, bool bFill )
+{
+    if( !osPath.empty() && ( bFill || bPathFill || !isSameColor( color, pathColor ) ) )
+        flushPath();
+    pathColor = color;
+    bPathFill = bFill;
+}
+
+void CADSVGWriter::moveTo( double x, double y )
+{
+    long long nNewX = quantize( x );
+    long long nNewY = quantize( y );
+    if( osPath.empty() )
+    {
+        osPath += 'M';
+        appendPathValue( nNewX );
+        appendPathValue( nNewY );
+        chLastCommand = 'M';
+    }
+    else if( nNewX != nX || nNewY != nY )
+    {
+        osPath += 'm';
+        appendPathValue( nNewX - nX );
+        appendPathValue( nNewY - nY );
+        chLastCommand = 'm';
+    }
+    else
+    {
+        // Continue from the current point, lines of connected geometries
+        // join without moveto
+        bExplicitStart = false;
+        nStartX        = nNewX;
+        nStartY        = nNewY;
+        return;
+    }
+    bExplicitStart = true;
+    nX = nStartX = nNewX;
+    nY = nStartY = nNewY;
+}
+
+void CADSVGWriter::lineTo( double x, double y )
+{
+    long long nNewX = quantize( x );
+    long long nNewY = quantize( y );
+    if( nNewX == nX && nNewY == nY )
+        return;
+    // Coordinate pairs after moveto are implicit linetos
+    if( chLastCommand != 'l' && chLastCommand != 'm' )
+    {
+        osPath += 'l';
+        chLastCommand = 'l';
+    }
+    appendPathValue( nNewX - nX );
+    appendPathValue( nNewY - nY );
+    nX = nNewX;
+    nY = nNewY;
+}
+
+void CADSVGWriter::arcTo( double rx, double ry, double dfRotation, bool bLargeArc, bool bSweep, double x,
+                          double y )
+{
+    long long nNewX = quantize( x );
+    long long nNewY = quantize( y );
+    if( nNewX == nX && nNewY == nY )
+        return;
+    if( chLastCommand != 'a' )
+    {
+        osPath += 'a';
+        chLastCommand = 'a';
+    }
+    appendPathValue( quantize( rx ) );
+    appendPathValue( quantize( ry ) );
+    appendPathValue( quantize( dfRotation ) );
+    osPath += bLargeArc ? " 1" : " 0";
+    osPath += bSweep ? " 1" : " 0";
+    appendPathValue( nNewX - nX );
+    appendPathValue( nNewY - nY );
+    nX = nNewX;
+    nY = nNewY;
+}
+
+void CADSVGWriter::closePath()
+{
+    // Closepath goes to the start of the SVG subpath, which isn't the start
+    // of the geometry if its moveto was skipped
+    if( !bExplicitStart )
+    {
+        if( nX != nStartX || nY != nStartY )
+        {
+            if( chLastCommand != 'l' && chLastCommand != 'm' )
+                osPath += 'l';
+            chLastCommand = 'l';
+            appendPathValue( nStartX - nX );
+            appendPathValue( nStartY - nY );
+            nX = nStartX;
+            nY = nStartY;
+        }
+        return;
+    }
+    osPath += 'z';
+    chLastCommand = 'z';
+    nX = nStartX;
+    nY = nStartY;
+}
+
+void CADSVGWriter::flushPath()
+{
+    if( osPath.empty() )
+        return;
+    osBuffer += "<path";
+    if( bPathFill )
+    {
+        osBuffer += " fill=\"";
+        appendColor( pathColor );
+        osBuffer += "\" stroke=\"none\"";
+    }
+    else
+    {
+        appendStrokeColor( pathColor );
+    }
+    osBuffer += " d=\"";
+    osBuffer += osPath;
+    osBuffer += "\"/>\n";
+    osPath.clear();
+    chLastCommand = '\0';
+}
+
+void CADSVGWriter::appendPathValue( long long nValue )
+{
+    // Minus sign separates numbers itself
+    char chLast = osPath.empty() ? '\0' : osPath.back();
+    if( nValue >= 0 && ( ( chLast >= '0' && chLast <= '9' ) || chLast == '.' ) )
+        osPath += ' ';
+    appendFixed( nValue, osPath );
+}
+
+long long CADSVGWriter::quantize( double dfValue ) const
+{
+    double dfScaled = dfValue * dfScale;
+    if( !std::isfinite( dfScaled ) )
+        return 0;
+    return llround( min( max( dfScaled, -9e15 ), 9e15 ) );
+}
+
+void CADSVGWriter::appendFixed( long long nValue, string& out ) const
+{
+    unsigned long long nAbs = nValue < 0 ? 0ULL - static_cast<unsigned long long>( nValue )
+                                         : static_cast<unsigned long long>( nValue );
+    unsigned long long nDivisor  = static_cast<unsigned long long>( dfScale );
+    unsigned long long nInteger  = nAbs / nDivisor;
+    unsigned long long nFraction = nAbs % nDivisor;
+
+    // Digits are written from the end: fraction without trailing zeros,
+    // point, integer part without the leading zero
+    char   szBuffer[32];
+    char * pszEnd   = szBuffer + sizeof( szBuffer );
+    char * pszStart = pszEnd;
+    if( nFraction != 0 )
+    {
+        int nDigits = nPrecision;
+        while( nFraction % 10 == 0 )
+        {
+            nFraction /= 10;
+            --nDigits;
+        }
+        for( ; nDigits > 0; --nDigits, nFraction /= 10 )
+            *--pszStart = static_cast<char>( '0' + nFraction % 10 );
+        *--pszStart = '.';
+    }
+    if( nInteger != 0 || pszStart == pszEnd )
+    {
+        do
+        {
+            *--pszStart = static_cast<char>( '0' + nInteger % 10 );
+            nInteger /= 10;
+        } while( nInteger != 0 );
+    }
+    if( nValue < 0 )
+        *--pszStart = '-';
+    out.append( pszStart, pszEnd );
+}
+
+void CADSVGWriter::appendNumber( double dfValue )
+{
+    appendFixed( quantize( dfValue ), osBuffer );
+}
+
+void CADSVGWriter::appendColor( RGBColor color )
+{
+    char szColor[8];
+    formatHexColor( color, szColor );
+    // #rgb form if every component has equal digits
+    if( color.R % 17 == 0 && color.G % 17 == 0 && color.B % 17 == 0 )
+    {
+        szColor[2] = szColor[3];
+        szColor[3] = szColor[5];
+        szColor[4] = '\0';
+    }
+    osBuffer += szColor;
+}
+
+void CADSVGWriter::appendStrokeColor( RGBColor color )
+{
+    if( isSameColor( color, layerColor ) )
+        return;
+    osBuffer += " stroke=\"";
+    appendColor( color );
+    osBuffer += '"';
+}
+
+void CADSVGWriter::appendText( const string& value )
+{
+    for( char ch : value )
+    {
+        switch( ch )
+        {
+            case '&':
+                osBuffer += "&amp;";
+                break;
+            case '<':
+                osBuffer += "&lt;";
+                break;
+            case '>':
+                osBuffer += "&gt;";
+                break;
+            case '"':
+                osBuffer += "&quot;";
+                break;
+            default:
+                // Control characters are not allowed in XML
+                if( static_cast<unsigned char>( ch ) >= 0x20 || ch == '\t' || ch == '\n' )
+                    osBuffer += ch;
+                break;
+        }
+    }
+}
+
+void CADSVGWriter::flush( bool bForce )
+{
+    if( osBuffer.empty() || ( !bForce && osBuffer.size() < FLUSH_SIZE ) )
+        return;
+    oStream.write( osBuffer.data(), static_cast<streamsize>( osBuffer.size() ) );
+    osBuffer.clear();
+}
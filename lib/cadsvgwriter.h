@@ -0,0 +1,119 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADSVGWRITER_H
+#define CADSVGWRITER_H
+
+#include "cadfile.h"
+#include "cadtessellator.h"
+
+#include <ostream>
+
+/**
+ * @brief Writes layers to a stream as an SVG document, each layer is a group
+ * with the layer color as stroke. Circles and full ellipses are written as
+ * elements, arcs, elliptical arcs and bulged polyline segments as path arcs,
+ * splines are flattened with the tessellator. Consecutive lines of one color
+ * are merged into one path with relative coordinates rounded to the
+ * precision. Drawing units are kept, Y goes up.
+ */
+class OCAD_EXTERN CADSVGWriter
+{
+public:
+    explicit CADSVGWriter( ostream& stream, int nPrecision = 3 );
+    ~CADSVGWriter(); // calls finish()
+
+    CADTessellator& getTessellator();
+
+    int  getPrecision() const;
+    void setPrecision( int value ); // decimal digits of coordinates, 0 - 9
+
+    /**
+     * @brief Set the viewBox area. Extents of the written file or of the
+     * first layer are used by default. Has no effect after the first write.
+     */
+    void setBounds( double dfMinX, double dfMinY, double dfMaxX, double dfMaxY );
+
+    size_t writeLayer( CADLayer& layer ); // returns number of written geometries
+    size_t writeFile( CADFile& file );
+
+    /**
+     * @brief Close the document and flush the stream. Nothing can be written
+     * after it.
+     */
+    void finish();
+protected:
+    void start( const CADBoundingBox& box );
+    bool writeGeometry( const CADGeometry * pGeom );
+    bool writeConic( const CADGeometry * pGeom, const CADVector& center, const CADVector& axisA,
+                     const CADVector& axisB, double dfStart, double dfEnd );
+    bool writePolyline( const CADGeometry * pGeom, const CADVertexArray& vertexes, const vector<double>& bulges,
+                        bool bClosed, const CADVector& extrusion );
+    bool writeText( const CADText * pText );
+    bool writeSimpleFeature( const CADGeometry * pGeom );
+
+    // Path commands go to osPath, lines of the same stroke color are merged
+    void startPath( RGBColor color, bool bFill );
+    void moveTo( double x, double y );
+    void lineTo( double x, double y );
+    void arcTo( double rx, double ry, double dfRotation, bool bLargeArc, bool bSweep, double x, double y );
+    void closePath();
+    void flushPath();
+    void appendPathValue( long long nValue );
+
+    long long quantize( double dfValue ) const;
+    void      appendFixed( long long nValue, string& out ) const;
+    void      appendNumber( double dfValue );
+    void      appendColor( RGBColor color );
+    void      appendStrokeColor( RGBColor color ); // only if it isn't the layer color
+    void      appendText( const string& value );
+    void      flush( bool bForce );
+protected:
+    ostream&       oStream;
+    int            nPrecision;
+    double         dfScale; // 10 ^ nPrecision
+    bool           bUserBounds;
+    CADBoundingBox bounds;
+    bool           bStarted;
+    bool           bFinished;
+    RGBColor       layerColor;
+    string         osBuffer; // output is collected here and written by big blocks
+    string         osPath;
+    RGBColor       pathColor;
+    bool           bPathFill;
+    char           chLastCommand;
+    bool           bExplicitStart; // subpath was started by moveto
+    long long      nX, nY;           // current point of the path, quantized
+    long long      nStartX, nStartY; // start of the subpath
+    CADTessellator oTessellator;
+    CADVertexArray oPoints;
+};
+
+#endif // CADSVGWRITER_H
@@ -89,28 +89,43 @@ int CADTables::ReadLayersTable( CADFile * const pCADFile, long dLayerControlHand
     if( spLayerControl == nullptr )
         return CADErrorCodes::TABLE_READ_FAILED;
 
+    // Layer handles are known in advance, so read all layer objects at once.
+    vector<long> adLayerHandles;
+    adLayerHandles.reserve( spLayerControl->hLayers.size() );
     for( size_t i = 0; i < spLayerControl->hLayers.size(); ++i )
     {
         if( !spLayerControl->hLayers[i].isNull() )
-        {
-            CADLayer oCADLayer( pCADFile );
-
-            // Init CADLayer from CADLayerObject properties
-            unique_ptr<CADLayerObject> oCADLayerObj(
-                    static_cast<CADLayerObject *>(pCADFile->GetObject( spLayerControl->hLayers[i].getAsLong() )) );
-
-            oCADLayer.setName( oCADLayerObj->sLayerName );
-            oCADLayer.setFrozen( oCADLayerObj->bFrozen );
-            oCADLayer.setOn( oCADLayerObj->bOn );
-            oCADLayer.setFrozenByDefault( oCADLayerObj->bFrozenInNewVPORT );
-            oCADLayer.setLocked( oCADLayerObj->bLocked );
-            oCADLayer.setLineWeight( oCADLayerObj->dLineWeight );
-            oCADLayer.setColor( oCADLayerObj->dCMColor );
-            oCADLayer.setId( aLayers.size() + 1 );
-            oCADLayer.setHandle( oCADLayerObj->hObjectHandle.getAsLong() );
-
-            aLayers.push_back( oCADLayer );
-        }
+            adLayerHandles.push_back( spLayerControl->hLayers[i].getAsLong() );
+    }
+
+    vector<CADObject *> apoLayerObjects( adLayerHandles.size(), nullptr );
+    pCADFile->GetObjects( adLayerHandles.data(), adLayerHandles.size(), apoLayerObjects.data() );
+
+    for( size_t i = 0; i < apoLayerObjects.size(); ++i )
+    {
+        CADLayer oCADLayer( pCADFile );
+
+        // Init CADLayer from CADLayerObject properties
+        unique_ptr<CADLayerObject> oCADLayerObj( static_cast<CADLayerObject *>( apoLayerObjects[i] ) );
+        if( oCADLayerObj == nullptr )
+            continue;
+
+        // Entities of the skipped layers find no layer in FillLayer() and are dropped.
+        if( !pCADFile->getFilter().isLayerAccepted( oCADLayerObj->sLayerName ) )
+            continue;
+
+        oCADLayer.setName( oCADLayerObj->sLayerName );
+        oCADLayer.setFrozen( oCADLayerObj->bFrozen );
+        oCADLayer.setOn( oCADLayerObj->bOn );
+        oCADLayer.setFrozenByDefault( oCADLayerObj->bFrozenInNewVPORT );
+        oCADLayer.setLocked( oCADLayerObj->bLocked );
+        oCADLayer.setLineWeight( oCADLayerObj->dLineWeight );
+        oCADLayer.setColor( oCADLayerObj->dCMColor );
+        oCADLayer.setId( aLayers.size() + 1 );
+        oCADLayer.setHandle( oCADLayerObj->hObjectHandle.getAsLong() );
+
+        mapLayers[oCADLayer.getHandle()] = aLayers.size();
+        aLayers.push_back( oCADLayer );
     }
 
     auto iterBlockMS = mapTables.find( BlockRecordModelSpace );
@@ -133,11 +148,11 @@ int CADTables::ReadLayersTable( CADFile * const pCADFile, long dLayerControlHand
         }
         else if(dCurrentEntHandle == dLastEntHandle)
         {
-            FillLayer( spEntityObj.get() );
+            FillLayer( pCADFile, spEntityObj.get() );
             break;
         }
 
-        FillLayer(spEntityObj.get());
+        FillLayer( pCADFile, spEntityObj.get() );
 
         if(spEntityObj->stCed.bNoLinks)
         {
@@ -154,17 +169,18 @@ int CADTables::ReadLayersTable( CADFile * const pCADFile, long dLayerControlHand
     return CADErrorCodes::SUCCESS;
 }
 
-void CADTables::FillLayer( const CADEntityObject * pEntityObject )
+void CADTables::FillLayer( CADFile * const pCADFile, const CADEntityObject * pEntityObject )
 {
-    for( CADLayer& oLayer : aLayers )
-    {
-        if( pEntityObject->stChed.hLayer.getAsLong( pEntityObject->stCed.hObjectHandle ) == oLayer.getHandle() )
-        {
-            DebugMsg( "Object with type: %s is attached to layer named: %s\n",
-                      getNameByType( pEntityObject->getType() ).c_str(), oLayer.getName().c_str() );
+    if( !pCADFile->getFilter().isObjectTypeAccepted( pEntityObject->getType() ) )
+        return;
 
-            oLayer.addHandle( pEntityObject->stCed.hObjectHandle.getAsLong(), pEntityObject->getType() );
-            break;
-        }
-    }
+    auto iterLayer = mapLayers.find( pEntityObject->stChed.hLayer.getAsLong( pEntityObject->stCed.hObjectHandle ) );
+    if( iterLayer == mapLayers.end() )
+        return;
+
+    CADLayer& oLayer = aLayers[iterLayer->second];
+    DebugMsg( "Object with type: %s is attached to layer named: %s\n",
+              getObjectTypeName( pEntityObject->getType() ), oLayer.getName().c_str() );
+
+    oLayer.addHandle( pEntityObject->stCed.hObjectHandle.getAsLong(), pEntityObject->getType() );
 }
\ No newline at end of file
@@ -79,10 +79,11 @@ public:
 
 protected:
     int  ReadLayersTable( CADFile * const pCADFile, long dLayerControlHandle );
-    void FillLayer( const CADEntityObject * pEntityObject );
+    void FillLayer( CADFile * const pCADFile, const CADEntityObject * pEntityObject );
 protected:
     map<enum TableType, CADHandle> mapTables;
     vector<CADLayer>               aLayers;
+    map<long, size_t>              mapLayers; // layer handle, index in aLayers
 };
 
 #endif // CADTABLES_H
\ No newline at end of file
@@ -0,0 +1,504 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadtessellator.h"
+#include "cadmath.h"
+#include "cadsplineevaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Bulges below it are straight segments
+static const double BULGE_EPSILON = std::numeric_limits<double>::epsilon() * 16;
+
+// Transform points appended to out starting from nStart.
+static void transformPoints( const Matrix& matrix, size_t nStart, CADVertexArray& out )
+{
+    if( nStart == out.size() )
+        return;
+    out.addZ();
+    double * padfX = out.getXData() + nStart;
+    double * padfY = out.getYData() + nStart;
+    double * padfZ = out.getZData() + nStart;
+    matrix.transformPoints( padfX, padfY, padfZ, padfX, padfY, padfZ, out.size() - nStart );
+}
+
+CADTessellator::CADTessellator( double dfToleranceIn, size_t nMaxSegmentsIn ) : dfTolerance( dfToleranceIn ),
+                                                                                nMaxSegments( nMaxSegmentsIn )
+{
+}
+
+double CADTessellator::getTolerance() const
+{
+    return dfTolerance;
+}
+
+void CADTessellator::setTolerance( double value )
+{
+    dfTolerance = value;
+}
+
+size_t CADTessellator::getMaxSegments() const
+{
+    return nMaxSegments;
+}
+
+void CADTessellator::setMaxSegments( size_t value )
+{
+    nMaxSegments = value;
+}
+
+size_t CADTessellator::getSegmentCount( double radius, double sweep ) const
+{
+    const double dfTwoPi = 2 * M_PI;
+    // At least four segments per turn, so the shape of the curve is kept.
+    double dfStep = M_PI / 2;
+    if( dfTolerance > 0.0 )
+    {
+        // Chord deviation of the step a is radius * (1 - cos(a / 2)).
+        if( radius > dfTolerance )
+            dfStep = std::min( dfStep, 2 * acos( 1.0 - dfTolerance / radius ) );
+    }
+    else if( nMaxSegments > 0 )
+    {
+        dfStep = std::min( dfStep, dfTwoPi / nMaxSegments );
+    }
+    if( nMaxSegments > 0 )
+        dfStep = std::max( dfStep, dfTwoPi / nMaxSegments );
+
+    // Rounding errors of the step should not add the extra segment.
+    double dfCount = ceil( sweep / dfStep - 1e-9 );
+    return dfCount < 1.0 ? 1 : static_cast<size_t>( dfCount );
+}
+
+bool CADTessellator::tessellate( const CADGeometry * pGeom, CADVertexArray& out ) const
+{
+    switch( pGeom->getType() )
+    {
+        case CADGeometry::CIRCLE:
+            tessellate( *static_cast<const CADCircle *>( pGeom ), out );
+            return true;
+        case CADGeometry::ARC:
+            tessellate( *static_cast<const CADArc *>( pGeom ), out );
+            return true;
+        case CADGeometry::ELLIPSE:
+            tessellate( *static_cast<const CADEllipse *>( pGeom ), out );
+            return true;
+        case CADGeometry::SPLINE:
+            tessellate( *static_cast<const CADSpline *>( pGeom ), out );
+            return true;
+        case CADGeometry::LWPOLYLINE:
+            tessellate( *static_cast<const CADLWPolyline *>( pGeom ), out );
+            return true;
+        case CADGeometry::POLYLINE2D:
+            tessellate( *static_cast<const CADPolyline2D *>( pGeom ), out );
+            return true;
+        default:
+            return false;
+    }
+}
+
+enum CADTessellator::SimpleFeature CADTessellator::getSimpleFeature( const CADGeometry * pGeom,
+                                                                     CADVertexArray& out ) const
+{
+    size_t nStart = out.size();
+    switch( pGeom->getType() )
+    {
+        case CADGeometry::POINT:
+        case CADGeometry::TEXT:
+        case CADGeometry::MTEXT:
+        case CADGeometry::ATTRIB:
+        case CADGeometry::ATTDEF:
+            out.add( static_cast<const CADPoint3D *>( pGeom )->getPosition() );
+            return POINT;
+
+        case CADGeometry::LINE:
+        {
+            auto poLine = static_cast<const CADLine *>( pGeom );
+            out.add( poLine->getStart().getPosition() );
+            out.add( poLine->getEnd().getPosition() );
+            return LINESTRING;
+        }
+
+        case CADGeometry::POLYLINE3D:
+        {
+            auto poPolyline = static_cast<const CADPolyline3D *>( pGeom );
+            if( poPolyline->getVertexCount() < 2 )
+                return NONE;
+            const vector<double>& xs = poPolyline->getXs();
+            const vector<double>& ys = poPolyline->getYs();
+            const vector<double>& zs = poPolyline->getZs();
+            out.reserve( nStart + xs.size() );
+            for( size_t i = 0; i < xs.size(); ++i )
+            {
+                if( zs.empty() )
+                    out.add( xs[i], ys[i] );
+                else
+                    out.add( xs[i], ys[i], zs[i] );
+            }
+            return LINESTRING;
+        }
+
+        case CADGeometry::LWPOLYLINE:
+        case CADGeometry::POLYLINE2D:
+        case CADGeometry::CIRCLE:
+        case CADGeometry::ARC:
+        case CADGeometry::ELLIPSE:
+        case CADGeometry::SPLINE:
+            tessellate( pGeom, out );
+            if( out.size() - nStart < 2 )
+            {
+                out.resize( nStart );
+                return NONE;
+            }
+            return LINESTRING;
+
+        case CADGeometry::FACE3D:
+        case CADGeometry::SOLID:
+        {
+            vector<CADVector> corners;
+            if( pGeom->getType() == CADGeometry::FACE3D )
+            {
+                auto poFace = static_cast<const CADFace3D *>( pGeom );
+                for( size_t i = 0; i < poFace->getCornerCount(); ++i )
+                    corners.push_back( poFace->getCorner( i ) );
+            }
+            else
+            {
+                // Solid corners go in Z order
+                vector<CADVector> solidCorners = static_cast<const CADSolid *>( pGeom )->getCorners();
+                if( solidCorners.size() != 4 )
+                    return NONE;
+                corners = { solidCorners[0], solidCorners[1], solidCorners[3], solidCorners[2] };
+            }
+
+            // Repeated corners make triangles
+            CADVector last;
+            for( const CADVector& corner : corners )
+            {
+                if( out.size() == nStart || corner.getX() != last.getX() || corner.getY() != last.getY() ||
+                    corner.getZ() != last.getZ() )
+                    out.add( corner );
+                last = corner;
+            }
+            if( out.size() - nStart < 3 )
+            {
+                out.resize( nStart );
+                return NONE;
+            }
+            out.add( corners[0] );
+            return POLYGON;
+        }
+
+        default:
+            return NONE;
+    }
+}
+
+size_t CADTessellator::tessellate( const CADCircle& circle, CADVertexArray& out ) const
+{
+    return tessellateArc( circle.getPosition(), circle.getRadius(), 0.0, 0.0, circle.getExtrusion(), out );
+}
+
+size_t CADTessellator::tessellate( const CADArc& arc, CADVertexArray& out ) const
+{
+    return tessellateArc( arc.getPosition(), arc.getRadius(), arc.getStartingAngle(), arc.getEndingAngle(),
+                          arc.getExtrusion(), out );
+}
+
+size_t CADTessellator::tessellate( const CADEllipse& ellipse, CADVertexArray& out ) const
+{
+    return tessellateEllipse( ellipse.getPosition(), ellipse.getSMAxis(), ellipse.getAxisRatio(),
+                              ellipse.getStartingAngle(), ellipse.getEndingAngle(), ellipse.getExtrusion(),
+                              out );
+}
+
+size_t CADTessellator::tessellate( const CADSpline& spline, CADVertexArray& out ) const
+{
+    CADSplineEvaluator evaluator;
+    if( !evaluator.init( spline ) )
+        return 0;
+    if( dfTolerance > 0.0 || nMaxSegments == 0 )
+        return evaluator.tessellate( dfTolerance, out );
+
+    double dfStart = evaluator.getStartParam();
+    double dfStep  = ( evaluator.getEndParam() - dfStart ) / nMaxSegments;
+    vector<double> adfParams( nMaxSegments + 1 );
+    for( size_t i = 0; i < nMaxSegments; ++i )
+        adfParams[i] = dfStart + i * dfStep;
+    adfParams[nMaxSegments] = evaluator.getEndParam();
+
+    size_t nStart = out.size();
+    out.resize( nStart + adfParams.size() );
+    if( !out.hasZ() && evaluator.is3D() )
+        out.addZ();
+    evaluator.evaluate( adfParams.data(), adfParams.size(), out.getXData() + nStart, out.getYData() + nStart,
+                        out.hasZ() ? out.getZData() + nStart : nullptr );
+    return adfParams.size();
+}
+
+size_t CADTessellator::tessellate( const CADLWPolyline& polyline, CADVertexArray& out ) const
+{
+    return tessellatePolyline( polyline.getVertexes(), polyline.getBulges(), polyline.isClosed(),
+                               polyline.getVectExtrusion(), out );
+}
+
+size_t CADTessellator::tessellate( const CADPolyline2D& polyline, CADVertexArray& out ) const
+{
+    return tessellatePolyline( polyline.getVertexes(), polyline.getBulges(), polyline.isClosed(),
+                               polyline.getVectExtrusion(), out );
+}
+
+bool CADTessellator::getBulgeArc( double x1, double y1, double x2, double y2, double bulge, double& cx,
+                                  double& cy, double& radius, double& startAngle, double& endAngle )
+{
+    double dfChord = sqrt( ( x2 - x1 ) * ( x2 - x1 ) + ( y2 - y1 ) * ( y2 - y1 ) );
+    if( fabs( bulge ) < BULGE_EPSILON || dfChord == 0.0 )
+        return false;
+
+    // Center is on the chord bisector, to the left of the chord for
+    // counterclockwise arc.
+    double dfOffset = ( 1.0 / bulge - bulge ) / 2;
+    cx         = ( x1 + x2 - dfOffset * ( y2 - y1 ) ) / 2;
+    cy         = ( y1 + y2 + dfOffset * ( x2 - x1 ) ) / 2;
+    radius     = fabs( dfChord * ( bulge + 1.0 / bulge ) / 4 );
+    startAngle = atan2( y1 - cy, x1 - cx );
+    endAngle   = atan2( y2 - cy, x2 - cx );
+    return true;
+}
+
+size_t CADTessellator::getBulgeSegmentCount( double x1, double y1, double x2, double y2, double bulge ) const
+{
+    double dfChord = sqrt( ( x2 - x1 ) * ( x2 - x1 ) + ( y2 - y1 ) * ( y2 - y1 ) );
+    if( fabs( bulge ) < BULGE_EPSILON || dfChord == 0.0 )
+        return 1;
+    double dfRadius = dfChord * ( 1.0 + bulge * bulge ) / ( 4 * fabs( bulge ) );
+    return getSegmentCount( dfRadius, 4 * atan( fabs( bulge ) ) );
+}
+
+size_t CADTessellator::tessellatePolyline( const CADVertexArray& vertexes, const vector<double>& bulges,
+                                           bool bClosed, CADVertexArray& out ) const
+{
+    size_t nCount = vertexes.size();
+    if( nCount == 0 )
+        return 0;
+
+    const double * padfVX = vertexes.getXs().data();
+    const double * padfVY = vertexes.getYs().data();
+    const double * padfVZ = vertexes.hasZ() ? vertexes.getZs().data() : nullptr;
+    size_t nSegments = bClosed && nCount > 1 ? nCount : nCount - 1;
+    size_t nBulges   = std::min( bulges.size(), nSegments );
+
+    // Output is sized at once, the first pass counts points of bulged
+    // segments. Straight runs are plain copies.
+    size_t nPoints = nSegments + 1;
+    for( size_t i = 0; i < nBulges; ++i )
+    {
+        size_t j = i + 1 < nCount ? i + 1 : 0;
+        nPoints += getBulgeSegmentCount( padfVX[i], padfVY[i], padfVX[j], padfVY[j], bulges[i] ) - 1;
+    }
+
+    size_t nStart = out.size();
+    out.resize( nStart + nPoints );
+    if( padfVZ && !out.hasZ() )
+        out.addZ();
+    double * padfX = out.getXData() + nStart;
+    double * padfY = out.getYData() + nStart;
+    double * padfZ = out.hasZ() ? out.getZData() + nStart : nullptr;
+
+    size_t k = 0;
+    for( size_t i = 0; i < nSegments; ++i )
+    {
+        padfX[k] = padfVX[i];
+        padfY[k] = padfVY[i];
+        if( padfZ )
+            padfZ[k] = padfVZ ? padfVZ[i] : 0.0;
+        ++k;
+
+        if( i >= nBulges )
+            continue;
+        size_t j      = i + 1 < nCount ? i + 1 : 0;
+        double bulge  = bulges[i];
+        size_t nSteps = getBulgeSegmentCount( padfVX[i], padfVY[i], padfVX[j], padfVY[j], bulge );
+        if( nSteps < 2 )
+            continue;
+
+        double cx, cy, dfRadius, dfStartAng, dfEndAng;
+        getBulgeArc( padfVX[i], padfVY[i], padfVX[j], padfVY[j], bulge, cx, cy, dfRadius, dfStartAng, dfEndAng );
+
+        // Radius vector is rotated by the step, sign of the bulge is the
+        // direction. The end point is the next vertex.
+        double dfStep = 4 * atan( bulge ) / nSteps;
+        double dfCos = cos( dfStep ), dfSin = sin( dfStep );
+        double vx = padfVX[i] - cx, vy = padfVY[i] - cy;
+        double z  = padfVZ ? padfVZ[i] : 0.0;
+        for( size_t m = 1; m < nSteps; ++m, ++k )
+        {
+            double dfNextX = vx * dfCos - vy * dfSin;
+            vy = vx * dfSin + vy * dfCos;
+            vx = dfNextX;
+            padfX[k] = cx + vx;
+            padfY[k] = cy + vy;
+            if( padfZ )
+                padfZ[k] = z;
+        }
+    }
+
+    size_t nLast = bClosed ? 0 : nCount - 1;
+    padfX[k] = padfVX[nLast];
+    padfY[k] = padfVY[nLast];
+    if( padfZ )
+        padfZ[k] = padfVZ ? padfVZ[nLast] : 0.0;
+    return nPoints;
+}
+
+size_t CADTessellator::tessellatePolyline( const CADVertexArray& vertexes, const vector<double>& bulges,
+                                           bool bClosed, const CADVector& extrusion, CADVertexArray& out ) const
+{
+    Matrix ocs = Matrix::ocsToWcs( extrusion );
+    bool bHasBulges = std::any_of( bulges.begin(), bulges.end(),
+                                   []( double bulge ) { return fabs( bulge ) >= BULGE_EPSILON; } );
+    if( ocs.isIdentity() || !bHasBulges )
+        return tessellatePolyline( vertexes, bulges, bClosed, out );
+
+    // Arcs are flattened in the polyline plane and moved back to WCS.
+    CADVertexArray ocsVertexes( vertexes );
+    transformPoints( Matrix::wcsToOcs( extrusion ), 0, ocsVertexes );
+    size_t nStart = out.size();
+    size_t nAdded = tessellatePolyline( ocsVertexes, bulges, bClosed, out );
+    transformPoints( ocs, nStart, out );
+    return nAdded;
+}
+
+size_t CADTessellator::tessellateArc( const CADVector& center, double radius, double startAngle,
+                                      double endAngle, const CADVector& extrusion, CADVertexArray& out ) const
+{
+    Matrix    ocs   = Matrix::ocsToWcs( extrusion );
+    CADVector xAxis = ocs.multiplyDirection( CADVector( radius, 0.0, 0.0 ) );
+    CADVector yAxis = ocs.multiplyDirection( CADVector( 0.0, radius, 0.0 ) );
+
+    double C[3] = { center.getX(), center.getY(), center.getZ() };
+    double A[3] = { xAxis.getX(), xAxis.getY(), xAxis.getZ() };
+    double B[3] = { yAxis.getX(), yAxis.getY(), yAxis.getZ() };
+    return tessellateConic( C, A, B, startAngle, endAngle, out );
+}
+
+size_t CADTessellator::tessellateEllipse( const CADVector& center, const CADVector& majorAxis, double axisRatio,
+                                          double startParam, double endParam, const CADVector& extrusion,
+                                          CADVertexArray& out ) const
+{
+    // Minor axis is ratio * (N x A), the same as in CADBoundingBox::addEllipse().
+    double N[3] = { extrusion.getX(), extrusion.getY(), extrusion.getZ() };
+    double dfNLength = sqrt( N[0] * N[0] + N[1] * N[1] + N[2] * N[2] );
+    if( dfNLength == 0.0 )
+    {
+        N[0] = 0.0; N[1] = 0.0; N[2] = 1.0;
+        dfNLength = 1.0;
+    }
+    double A[3] = { majorAxis.getX(), majorAxis.getY(), majorAxis.getZ() };
+    double B[3] = { axisRatio * ( N[1] * A[2] - N[2] * A[1] ) / dfNLength,
+                    axisRatio * ( N[2] * A[0] - N[0] * A[2] ) / dfNLength,
+                    axisRatio * ( N[0] * A[1] - N[1] * A[0] ) / dfNLength };
+    double C[3] = { center.getX(), center.getY(), center.getZ() };
+    return tessellateConic( C, A, B, startParam, endParam, out );
+}
+
+size_t CADTessellator::tessellateConic( const double C[3], const double A[3], const double B[3],
+                                        double startParam, double endParam, CADVertexArray& out ) const
+{
+    const double dfTwoPi = 2 * M_PI;
+    double dfSweep = fmod( endParam - startParam, dfTwoPi );
+    if( dfSweep <= 0.0 )
+        dfSweep += dfTwoPi;
+    bool bFullTurn = dfSweep == dfTwoPi;
+
+    // Chord deviation for the parameter step h is about |P''(t)| * h^2 / 8,
+    // and |P''(t)| never exceeds the longer axis, so it is used as radius.
+    double dfRadius = std::max( sqrt( A[0] * A[0] + A[1] * A[1] + A[2] * A[2] ),
+                                sqrt( B[0] * B[0] + B[1] * B[1] + B[2] * B[2] ) );
+    size_t nSegments = getSegmentCount( dfRadius, dfSweep );
+    double dfStep    = dfSweep / nSegments;
+
+    size_t nStart = out.size();
+    out.resize( nStart + nSegments + 1 );
+    // Planar curves at zero elevation don't need Z
+    if( !out.hasZ() && ( C[2] != 0.0 || A[2] != 0.0 || B[2] != 0.0 ) )
+        out.addZ();
+    double * padfX = out.getXData() + nStart;
+    double * padfY = out.getYData() + nStart;
+    double * padfZ = out.hasZ() ? out.getZData() + nStart : nullptr;
+
+    // cos and sin of the next parameter are got by rotating the current ones
+    // by the step. They are recomputed periodically so rounding errors don't
+    // accumulate on long runs.
+    const size_t nReseed = 64;
+    const double dfCosStep = cos( dfStep ), dfSinStep = sin( dfStep );
+    double c = cos( startParam ), s = sin( startParam );
+    for( size_t i = 0; i < nSegments; ++i )
+    {
+        padfX[i] = C[0] + A[0] * c + B[0] * s;
+        padfY[i] = C[1] + A[1] * c + B[1] * s;
+        if( padfZ )
+            padfZ[i] = C[2] + A[2] * c + B[2] * s;
+
+        if( ( i + 1 ) % nReseed == 0 )
+        {
+            c = cos( startParam + ( i + 1 ) * dfStep );
+            s = sin( startParam + ( i + 1 ) * dfStep );
+        }
+        else
+        {
+            double dfNextCos = c * dfCosStep - s * dfSinStep;
+            s = s * dfCosStep + c * dfSinStep;
+            c = dfNextCos;
+        }
+    }
+
+    // Closing point is exact: the start point for full turn, the end
+    // parameter for arcs.
+    if( bFullTurn )
+    {
+        padfX[nSegments] = padfX[0];
+        padfY[nSegments] = padfY[0];
+        if( padfZ )
+            padfZ[nSegments] = padfZ[0];
+    }
+    else
+    {
+        c = cos( startParam + dfSweep );
+        s = sin( startParam + dfSweep );
+        padfX[nSegments] = C[0] + A[0] * c + B[0] * s;
+        padfY[nSegments] = C[1] + A[1] * c + B[1] * s;
+        if( padfZ )
+            padfZ[nSegments] = C[2] + A[2] * c + B[2] * s;
+    }
+    return nSegments + 1;
+}
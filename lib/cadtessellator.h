@@ -0,0 +1,152 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADTESSELLATOR_H
+#define CADTESSELLATOR_H
+
+#include "cadgeometry.h"
+
+/**
+ * @brief Converts curves to polylines. Number of segments is chosen so the
+ * distance between a chord and the curve doesn't exceed the tolerance.
+ * Points are appended to the caller buffer, so one buffer can be reused for
+ * many geometries.
+ */
+class OCAD_EXTERN CADTessellator
+{
+public:
+    enum SimpleFeature
+    {
+        NONE       = 0,
+        POINT      = 1,
+        LINESTRING = 2,
+        POLYGON    = 3
+    };
+
+    /**
+     * @param dfTolerance maximum chord deviation, in drawing units. If it is
+     * not positive the curve is split into nMaxSegments per full turn. Writers
+     * start with the default one, it can be changed by their getTessellator().
+     * @param nMaxSegments maximum number of segments per full turn, 0 means
+     * no limit. Splines are split into nMaxSegments parts of equal parameter
+     * range if the tolerance is not positive.
+     */
+    explicit CADTessellator( double dfTolerance = 0.01, size_t nMaxSegments = 0 );
+
+    double getTolerance() const;
+    void   setTolerance( double value );
+
+    size_t getMaxSegments() const;
+    void   setMaxSegments( size_t value );
+
+    /**
+     * @brief Number of segments for the curve of the radius, sweep is in
+     * radians.
+     */
+    size_t getSegmentCount( double radius, double sweep ) const;
+
+    /**
+     * @brief Append points of the curve geometry to out. Returns false if the
+     * geometry type is not supported.
+     */
+    bool tessellate( const CADGeometry * pGeom, CADVertexArray& out ) const;
+
+    /**
+     * @brief Append coordinates of the geometry as a simple feature: position
+     * of points and texts, line of linear geometries and curves, closed
+     * outline of 3D faces and solids.
+     * @return feature type, NONE if the geometry has no such representation
+     * or is degenerate, out is not changed in this case
+     */
+    enum SimpleFeature getSimpleFeature( const CADGeometry * pGeom, CADVertexArray& out ) const;
+
+    // Points are in WCS, first and last points of a full circle are equal.
+    size_t tessellate( const CADCircle& circle, CADVertexArray& out ) const;
+    size_t tessellate( const CADArc& arc, CADVertexArray& out ) const;
+    size_t tessellate( const CADEllipse& ellipse, CADVertexArray& out ) const;
+    size_t tessellate( const CADSpline& spline, CADVertexArray& out ) const;
+    size_t tessellate( const CADLWPolyline& polyline, CADVertexArray& out ) const;
+    size_t tessellate( const CADPolyline2D& polyline, CADVertexArray& out ) const;
+
+    /**
+     * @brief Append polyline vertexes with bulged segments replaced by arc
+     * points. Points stay in the coordinate system of vertexes, closed
+     * polyline ends with its first vertex.
+     * @return number of added points
+     */
+    size_t tessellatePolyline( const CADVertexArray& vertexes, const vector<double>& bulges, bool bClosed,
+                               CADVertexArray& out ) const;
+    /**
+     * @brief Same as above for polyline lying in the plane given by extrusion.
+     * Vertexes are in WCS, bulges are measured in object coordinate system of
+     * the extrusion.
+     */
+    size_t tessellatePolyline( const CADVertexArray& vertexes, const vector<double>& bulges, bool bClosed,
+                               const CADVector& extrusion, CADVertexArray& out ) const;
+
+    /**
+     * @brief Arc of the polyline segment with the bulge, i.e. tangent of the
+     * quarter of the arc angle. For positive bulge the arc goes
+     * counterclockwise from startAngle to endAngle, for negative one it goes
+     * clockwise.
+     * @return false if the segment is straight
+     */
+    static bool getBulgeArc( double x1, double y1, double x2, double y2, double bulge, double& cx, double& cy,
+                             double& radius, double& startAngle, double& endAngle );
+
+    /**
+     * @brief Append arc going counterclockwise around extrusion from
+     * startAngle to endAngle. Center is in WCS, angles are measured in
+     * object coordinate system given by extrusion, the same as CADArc ones.
+     * Full circle is added if angles are equal.
+     * @return number of added points
+     */
+    size_t tessellateArc( const CADVector& center, double radius, double startAngle, double endAngle,
+                          const CADVector& extrusion, CADVertexArray& out ) const;
+
+    /**
+     * @brief Append elliptical arc, center and major axis are in WCS.
+     * Parameters are the same as CADEllipse ones.
+     * @return number of added points
+     */
+    size_t tessellateEllipse( const CADVector& center, const CADVector& majorAxis, double axisRatio,
+                              double startParam, double endParam, const CADVector& extrusion,
+                              CADVertexArray& out ) const;
+protected:
+    // Point at parameter t is center + A * cos(t) + B * sin(t).
+    size_t tessellateConic( const double C[3], const double A[3], const double B[3],
+                            double startParam, double endParam, CADVertexArray& out ) const;
+    size_t getBulgeSegmentCount( double x1, double y1, double x2, double y2, double bulge ) const;
+protected:
+    double dfTolerance;
+    size_t nMaxSegments;
+};
+
+#endif // CADTESSELLATOR_H
@@ -0,0 +1,106 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadthreadpool.h"
+
+CADThreadPool::CADThreadPool( unsigned nThreads ) : pTask( nullptr ), nTaskCount( 0 ), nNextTask( 0 ),
+                                                    nBusyWorkers( 0 ), nGeneration( 0 ), bStop( false )
+{
+    if( nThreads == 0 )
+        nThreads = max( 1u, thread::hardware_concurrency() );
+    for( unsigned i = 1; i < nThreads; ++i )
+        workers.push_back( thread( &CADThreadPool::workerLoop, this ) );
+}
+
+CADThreadPool::~CADThreadPool()
+{
+    {
+        lock_guard<mutex> lock( oMutex );
+        bStop = true;
+    }
+    oStart.notify_all();
+    for( thread& worker : workers )
+        worker.join();
+}
+
+unsigned CADThreadPool::getThreadCount() const
+{
+    return static_cast<unsigned>( workers.size() + 1 );
+}
+
+void CADThreadPool::parallelFor( size_t nCount, const function<void( size_t )>& task )
+{
+    if( workers.empty() || nCount < 2 )
+    {
+        for( size_t i = 0; i < nCount; ++i )
+            task( i );
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock( oMutex );
+        pTask        = &task;
+        nTaskCount   = nCount;
+        nNextTask    = 0;
+        nBusyWorkers = workers.size();
+        ++nGeneration;
+    }
+    oStart.notify_all();
+    runTasks();
+
+    unique_lock<mutex> lock( oMutex );
+    oDone.wait( lock, [this]() { return nBusyWorkers == 0; } );
+    pTask = nullptr;
+}
+
+void CADThreadPool::workerLoop()
+{
+    unsigned long long nSeenGeneration = 0;
+    unique_lock<mutex> lock( oMutex );
+    for( ;; )
+    {
+        oStart.wait( lock, [this, nSeenGeneration]() { return bStop || nGeneration != nSeenGeneration; } );
+        if( bStop )
+            return;
+        nSeenGeneration = nGeneration;
+
+        lock.unlock();
+        runTasks();
+        lock.lock();
+        if( --nBusyWorkers == 0 )
+            oDone.notify_one();
+    }
+}
+
+void CADThreadPool::runTasks()
+{
+    for( size_t i = nNextTask++; i < nTaskCount; i = nNextTask++ )
+        ( *pTask )( i );
+}
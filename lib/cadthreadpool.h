@@ -0,0 +1,79 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADTHREADPOOL_H
+#define CADTHREADPOOL_H
+
+#include "opencad.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Fixed set of worker threads for data parallel loops. Workers wait
+ * between loops, so a pool can be reused for many short loops.
+ */
+class OCAD_EXTERN CADThreadPool
+{
+public:
+    explicit CADThreadPool( unsigned nThreads = 0 ); // 0 means hardware concurrency
+    ~CADThreadPool();
+
+    unsigned getThreadCount() const; // the calling thread included
+
+    /**
+     * @brief Call task for every index from 0 to nCount - 1 and return when
+     * all calls are done. Indexes are taken one by one by the calling thread
+     * and the workers, so a task should do a reasonable amount of work.
+     */
+    void parallelFor( size_t nCount, const function<void( size_t )>& task );
+protected:
+    void workerLoop();
+    void runTasks();
+protected:
+    vector<thread>                   workers;
+    mutex                            oMutex;
+    condition_variable               oStart;
+    condition_variable               oDone;
+    const function<void( size_t )> * pTask;
+    size_t                           nTaskCount;
+    atomic<size_t>                   nNextTask;
+    size_t                           nBusyWorkers;
+    unsigned long long               nGeneration; // loop counter, wakes the workers
+    bool                             bStop;
+};
+
+#endif // CADTHREADPOOL_H
@@ -0,0 +1,920 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadvectortilewriter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Geometry commands of the tile encoding
+static const uint32_t CMD_MOVE_TO    = 1;
+static const uint32_t CMD_LINE_TO    = 2;
+static const uint32_t CMD_CLOSE_PATH = 7;
+
+static const int MAX_ZOOM = 24;
+
+// Features simplified by one pool task
+static const size_t SIMPLIFY_CHUNK = 1024;
+
+// Tiles encoded before they are passed to the callback
+static const size_t TILE_BATCH = 4096;
+
+static const char   FLAT_FILE_MAGIC[8] = { 'O', 'C', 'A', 'D', 'M', 'V', 'T', '1' };
+static const size_t FLAT_FILE_ENTRY_SIZE = 24;
+
+static void putVarint( string& out, uint64_t nValue )
+{
+    while( nValue >= 0x80 )
+    {
+        out += static_cast<char>( ( nValue & 0x7F ) | 0x80 );
+        nValue >>= 7;
+    }
+    out += static_cast<char>( nValue );
+}
+
+static size_t getVarintSize( uint64_t nValue )
+{
+    size_t nSize = 1;
+    while( nValue >= 0x80 )
+    {
+        nValue >>= 7;
+        ++nSize;
+    }
+    return nSize;
+}
+
+static void putKey( string& out, uint32_t nField, uint32_t nWireType )
+{
+    putVarint( out, ( nField << 3 ) | nWireType );
+}
+
+static void putBytes( string& out, uint32_t nField, const string& value )
+{
+    putKey( out, nField, 2 );
+    putVarint( out, value.size() );
+    out += value;
+}
+
+static void putPacked( string& out, uint32_t nField, const vector<uint32_t>& values )
+{
+    size_t nLength = 0;
+    for( uint32_t nValue : values )
+        nLength += getVarintSize( nValue );
+    putKey( out, nField, 2 );
+    putVarint( out, nLength );
+    for( uint32_t nValue : values )
+        putVarint( out, nValue );
+}
+
+static uint32_t command( uint32_t nId, size_t nCount )
+{
+    return ( nId & 0x7 ) | static_cast<uint32_t>( nCount << 3 );
+}
+
+static uint32_t zigzag( int32_t nValue )
+{
+    return ( static_cast<uint32_t>( nValue ) << 1 ) ^ static_cast<uint32_t>( nValue >> 31 );
+}
+
+static bool makeDirectory( const string& path )
+{
+#ifdef _WIN32
+    return _mkdir( path.c_str() ) == 0 || errno == EEXIST;
+#else
+    return mkdir( path.c_str(), 0755 ) == 0 || errno == EEXIST;
+#endif
+}
+
+/**
+ * @brief Quantized parts of one feature in tile coordinates: lines of a line
+ * feature or rings of a polygon. Repeated points are dropped.
+ */
+class TileGeometry
+{
+public:
+    void clear()
+    {
+        anX.clear();
+        anY.clear();
+        anPartStart.clear();
+    }
+
+    bool empty() const
+    {
+        return anPartStart.empty();
+    }
+
+    void startPart()
+    {
+        anPartStart.push_back( anX.size() );
+    }
+
+    void add( double x, double y )
+    {
+        int32_t nX = static_cast<int32_t>( lround( x ) );
+        int32_t nY = static_cast<int32_t>( lround( y ) );
+        if( anX.size() > anPartStart.back() && anX.back() == nX && anY.back() == nY )
+            return;
+        anX.push_back( nX );
+        anY.push_back( nY );
+    }
+
+    // Part shorter than nMinCount is dropped
+    void endPart( size_t nMinCount )
+    {
+        if( anX.size() - anPartStart.back() < nMinCount )
+            dropPart();
+    }
+
+    // Closing point is dropped, exterior ring goes clockwise (positive area in y down coordinates)
+    void endRing()
+    {
+        size_t nStart = anPartStart.back();
+        if( anX.size() - nStart > 1 && anX.back() == anX[nStart] && anY.back() == anY[nStart] )
+        {
+            anX.pop_back();
+            anY.pop_back();
+        }
+        int64_t nArea = 0;
+        for( size_t i = nStart; i < anX.size(); ++i )
+        {
+            size_t j = i + 1 < anX.size() ? i + 1 : nStart;
+            nArea += static_cast<int64_t>( anX[i] ) * anY[j] - static_cast<int64_t>( anX[j] ) * anY[i];
+        }
+        if( anX.size() - nStart < 3 || nArea == 0 )
+        {
+            dropPart();
+            return;
+        }
+        if( nArea < 0 )
+        {
+            reverse( anX.begin() + nStart + 1, anX.end() );
+            reverse( anY.begin() + nStart + 1, anY.end() );
+        }
+    }
+
+    void encode( bool bPolygon, vector<uint32_t>& commands ) const
+    {
+        int32_t nX = 0, nY = 0;
+        for( size_t iPart = 0; iPart < anPartStart.size(); ++iPart )
+        {
+            size_t nStart = anPartStart[iPart];
+            size_t nEnd   = iPart + 1 < anPartStart.size() ? anPartStart[iPart + 1] : anX.size();
+            for( size_t i = nStart; i < nEnd; ++i )
+            {
+                if( i == nStart )
+                    commands.push_back( command( CMD_MOVE_TO, 1 ) );
+                else if( i == nStart + 1 )
+                    commands.push_back( command( CMD_LINE_TO, nEnd - nStart - 1 ) );
+                commands.push_back( zigzag( anX[i] - nX ) );
+                commands.push_back( zigzag( anY[i] - nY ) );
+                nX = anX[i];
+                nY = anY[i];
+            }
+            if( bPolygon )
+                commands.push_back( command( CMD_CLOSE_PATH, 1 ) );
+        }
+    }
+protected:
+    void dropPart()
+    {
+        anX.resize( anPartStart.back() );
+        anY.resize( anPartStart.back() );
+        anPartStart.pop_back();
+    }
+protected:
+    vector<int32_t> anX;
+    vector<int32_t> anY;
+    vector<size_t>  anPartStart;
+};
+
+// Liang-Barsky clipping of the segment by the square, t0 and t1 get the parameters of the clipped ends
+static bool clipSegment( double& x0, double& y0, double& x1, double& y1, double dfMin, double dfMax,
+                         double& t0, double& t1 )
+{
+    double       dx   = x1 - x0;
+    double       dy   = y1 - y0;
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { x0 - dfMin, dfMax - x0, y0 - dfMin, dfMax - y0 };
+    t0 = 0.0;
+    t1 = 1.0;
+    for( int i = 0; i < 4; ++i )
+    {
+        if( p[i] == 0.0 )
+        {
+            if( q[i] < 0.0 )
+                return false;
+            continue;
+        }
+        double r = q[i] / p[i];
+        if( p[i] < 0.0 )
+        {
+            if( r > t1 )
+                return false;
+            t0 = max( t0, r );
+        }
+        else
+        {
+            if( r < t0 )
+                return false;
+            t1 = min( t1, r );
+        }
+    }
+    double dfStartX = x0, dfStartY = y0;
+    x0 = dfStartX + t0 * dx;
+    y0 = dfStartY + t0 * dy;
+    x1 = dfStartX + t1 * dx;
+    y1 = dfStartY + t1 * dy;
+    return true;
+}
+
+// Parts of the line inside the square
+static void clipLine( const double * padfX, const double * padfY, size_t nCount, double dfMin, double dfMax,
+                      TileGeometry& out )
+{
+    bool bOpen = false;
+    for( size_t i = 0; i + 1 < nCount; ++i )
+    {
+        double x0 = padfX[i], y0 = padfY[i], x1 = padfX[i + 1], y1 = padfY[i + 1];
+        double t0, t1;
+        if( !clipSegment( x0, y0, x1, y1, dfMin, dfMax, t0, t1 ) )
+        {
+            if( bOpen )
+                out.endPart( 2 );
+            bOpen = false;
+            continue;
+        }
+        if( !bOpen )
+        {
+            out.startPart();
+            out.add( x0, y0 );
+            bOpen = true;
+        }
+        out.add( x1, y1 );
+        if( t1 < 1.0 )
+        {
+            out.endPart( 2 );
+            bOpen = false;
+        }
+    }
+    if( bOpen )
+        out.endPart( 2 );
+}
+
+// Sutherland-Hodgman clipping of the ring (without closing point) by the square
+static void clipRing( vector<double>& xs, vector<double>& ys, vector<double>& tmpX, vector<double>& tmpY,
+                      double dfMin, double dfMax )
+{
+    for( int nEdge = 0; nEdge < 4 && !xs.empty(); ++nEdge )
+    {
+        // Edges are x >= min, x <= max, y >= min, y <= max
+        bool   bX     = nEdge < 2;
+        double dfBound = nEdge % 2 == 0 ? dfMin : dfMax;
+        double dfSign  = nEdge % 2 == 0 ? 1.0 : -1.0;
+        tmpX.clear();
+        tmpY.clear();
+        size_t nCount = xs.size();
+        for( size_t i = 0; i < nCount; ++i )
+        {
+            size_t j     = i == 0 ? nCount - 1 : i - 1;
+            double dfCur  = dfSign * ( ( bX ? xs[i] : ys[i] ) - dfBound );
+            double dfPrev = dfSign * ( ( bX ? xs[j] : ys[j] ) - dfBound );
+            if( ( dfCur >= 0.0 ) != ( dfPrev >= 0.0 ) )
+            {
+                double t = dfPrev / ( dfPrev - dfCur );
+                tmpX.push_back( xs[j] + t * ( xs[i] - xs[j] ) );
+                tmpY.push_back( ys[j] + t * ( ys[i] - ys[j] ) );
+            }
+            if( dfCur >= 0.0 )
+            {
+                tmpX.push_back( xs[i] );
+                tmpY.push_back( ys[i] );
+            }
+        }
+        xs.swap( tmpX );
+        ys.swap( tmpY );
+    }
+}
+
+CADVectorTileWriter::CADVectorTileWriter( unsigned nThreads ) :
+    nMinZoom( 0 ), nMaxZoom( 10 ), nExtent( 4096 ), nBuffer( 64 ), dfSimplification( 1.0 ),
+    bUserBounds( false ), dfOriginX( 0.0 ), dfOriginY( 0.0 ), dfSize( 1.0 ), oPool( nThreads )
+{
+}
+
+CADTessellator& CADVectorTileWriter::getTessellator()
+{
+    return oTessellator;
+}
+
+int CADVectorTileWriter::getMinZoom() const
+{
+    return nMinZoom;
+}
+
+int CADVectorTileWriter::getMaxZoom() const
+{
+    return nMaxZoom;
+}
+
+void CADVectorTileWriter::setZoomRange( int nMinZoomIn, int nMaxZoomIn )
+{
+    nMinZoom = min( max( nMinZoomIn, 0 ), MAX_ZOOM );
+    nMaxZoom = min( max( nMaxZoomIn, nMinZoom ), MAX_ZOOM );
+}
+
+unsigned CADVectorTileWriter::getExtent() const
+{
+    return nExtent;
+}
+
+void CADVectorTileWriter::setExtent( unsigned value )
+{
+    nExtent = max( value, 1u );
+}
+
+unsigned CADVectorTileWriter::getBuffer() const
+{
+    return nBuffer;
+}
+
+void CADVectorTileWriter::setBuffer( unsigned value )
+{
+    nBuffer = value;
+}
+
+double CADVectorTileWriter::getSimplification() const
+{
+    return dfSimplification;
+}
+
+void CADVectorTileWriter::setSimplification( double value )
+{
+    dfSimplification = max( value, 0.0 );
+}
+
+void CADVectorTileWriter::setBounds( double dfMinX, double dfMinY, double dfSizeIn )
+{
+    bUserBounds = dfSizeIn > 0.0;
+    dfOriginX   = dfMinX;
+    dfOriginY   = dfMinY + dfSizeIn;
+    dfSize      = dfSizeIn;
+}
+
+size_t CADVectorTileWriter::addFile( CADFile& file )
+{
+    size_t nCount = 0;
+    for( size_t i = 0; i < file.GetLayersCount(); ++i )
+        nCount += addLayer( file.GetLayer( i ) );
+    return nCount;
+}
+
+size_t CADVectorTileWriter::addLayer( CADLayer& layer )
+{
+    uint32_t nLayer = static_cast<uint32_t>( layerNames.size() );
+    layerNames.push_back( layer.getName() );
+
+    uint32_t nColorKey = addString( "color", keys, keyIndex );
+    uint32_t nTextKey  = addString( "text", keys, keyIndex );
+    size_t   nCount    = 0;
+    for( size_t i = 0; i < layer.getGeometryCount(); ++i )
+    {
+        unique_ptr<CADGeometry> geometry( layer.getGeometry( i ) );
+        if( geometry == nullptr )
+            continue;
+        oPoints.clear();
+        enum CADTessellator::SimpleFeature eType = oTessellator.getSimpleFeature( geometry.get(), oPoints );
+        if( eType == CADTessellator::NONE )
+            continue;
+
+        Feature feature;
+        feature.nLayer    = nLayer;
+        feature.nId       = i + 1;
+        feature.nType     = static_cast<uint8_t>( eType );
+        feature.nFirst    = adfX.size();
+        feature.nCount    = static_cast<uint32_t>( oPoints.size() );
+        feature.nFirstTag = static_cast<uint32_t>( anTags.size() );
+        adfX.insert( adfX.end(), oPoints.getXs().begin(), oPoints.getXs().end() );
+        adfY.insert( adfY.end(), oPoints.getYs().begin(), oPoints.getYs().end() );
+        auto xRange  = minmax_element( oPoints.getXs().begin(), oPoints.getXs().end() );
+        auto yRange  = minmax_element( oPoints.getYs().begin(), oPoints.getYs().end() );
+        feature.minX = *xRange.first;
+        feature.maxX = *xRange.second;
+        feature.minY = *yRange.first;
+        feature.maxY = *yRange.second;
+        extents.addPoint( feature.minX, feature.minY, 0.0 );
+        extents.addPoint( feature.maxX, feature.maxY, 0.0 );
+
+        char szColor[8];
+        formatHexColor( geometry->getColor(), szColor );
+        anTags.push_back( nColorKey );
+        anTags.push_back( addString( szColor, values, valueIndex ) );
+        switch( geometry->getType() )
+        {
+            case CADGeometry::TEXT:
+            case CADGeometry::MTEXT:
+            case CADGeometry::ATTRIB:
+            case CADGeometry::ATTDEF:
+                anTags.push_back( nTextKey );
+                anTags.push_back( addString( static_cast<const CADText *>( geometry.get() )->getTextValue(),
+                                             values, valueIndex ) );
+                break;
+            default:
+                break;
+        }
+        for( const CADAttrib& attribute : geometry->getBlockAttributes() )
+        {
+            anTags.push_back( addString( attribute.getTag(), keys, keyIndex ) );
+            anTags.push_back( addString( attribute.getTextValue(), values, valueIndex ) );
+        }
+        feature.nTagCount = static_cast<uint32_t>( ( anTags.size() - feature.nFirstTag ) / 2 );
+
+        features.push_back( feature );
+        ++nCount;
+    }
+    return nCount;
+}
+
+void CADVectorTileWriter::clear()
+{
+    layerNames.clear();
+    features.clear();
+    adfX.clear();
+    adfY.clear();
+    anTags.clear();
+    keys.clear();
+    values.clear();
+    keyIndex.clear();
+    valueIndex.clear();
+    extents = CADBoundingBox();
+}
+
+size_t CADVectorTileWriter::generate( const TileCallback& callback )
+{
+    updateBounds();
+    if( features.empty() )
+        return 0;
+
+    ZoomGeometry zoom;
+    zoom.adfX.resize( adfX.size() );
+    zoom.adfY.resize( adfY.size() );
+    zoom.anCount.resize( features.size() );
+
+    size_t nTiles = 0;
+    vector<string> tiles;
+    vector<pair<uint64_t, uint32_t> > tileFeatures; // tile key (x << 32 | y) and feature index
+    vector<uint32_t> featureIds;
+    vector<size_t>   tileStarts;
+    for( int z = nMinZoom; z <= nMaxZoom; ++z )
+    {
+        size_t nChunks = ( features.size() + SIMPLIFY_CHUNK - 1 ) / SIMPLIFY_CHUNK;
+        oPool.parallelFor( nChunks, [&]( size_t iChunk ) {
+            vector<uint32_t> stack;
+            size_t nEnd = min( features.size(), ( iChunk + 1 ) * SIMPLIFY_CHUNK );
+            for( size_t i = iChunk * SIMPLIFY_CHUNK; i < nEnd; ++i )
+                simplify( z, i, zoom, stack );
+        } );
+
+        // Lines go to the tiles of their segments, others to the tiles of their boxes
+        double dfTileSize = getTileSize( z );
+        double dfMargin   = dfTileSize * nBuffer / nExtent;
+        double dfTiles    = ldexp( 1.0, z );
+        tileFeatures.clear();
+        auto addTiles = [&]( double minX, double maxX, double dfY0, double dfY1, uint32_t iFeature ) {
+            double dfX0 = floor( ( minX - dfMargin - dfOriginX ) / dfTileSize );
+            double dfX1 = floor( ( maxX + dfMargin - dfOriginX ) / dfTileSize );
+            if( dfX1 < 0.0 || dfY1 < 0.0 || dfX0 >= dfTiles || dfY0 >= dfTiles )
+                return;
+            uint64_t nX1 = static_cast<uint64_t>( min( dfX1, dfTiles - 1 ) );
+            uint64_t nY1 = static_cast<uint64_t>( min( dfY1, dfTiles - 1 ) );
+            for( uint64_t x = static_cast<uint64_t>( max( dfX0, 0.0 ) ); x <= nX1; ++x )
+                for( uint64_t y = static_cast<uint64_t>( max( dfY0, 0.0 ) ); y <= nY1; ++y )
+                {
+                    // Consecutive segments mostly stay in the same tile
+                    auto entry = make_pair( ( x << 32 ) | y, iFeature );
+                    if( tileFeatures.empty() || tileFeatures.back() != entry )
+                        tileFeatures.push_back( entry );
+                }
+        };
+        auto addBox = [&]( double minX, double minY, double maxX, double maxY, uint32_t iFeature ) {
+            addTiles( minX, maxX, floor( ( dfOriginY - maxY - dfMargin ) / dfTileSize ),
+                      floor( ( dfOriginY - minY + dfMargin ) / dfTileSize ), iFeature );
+        };
+        // Row by row, the part of the segment within the row and its margins
+        // gives the tiles, so long segments don't take every tile of their box.
+        auto addSegment = [&]( double x0, double y0, double x1, double y1, uint32_t iFeature ) {
+            double dfRow0 = max( floor( ( dfOriginY - max( y0, y1 ) - dfMargin ) / dfTileSize ), 0.0 );
+            double dfRow1 = min( floor( ( dfOriginY - min( y0, y1 ) + dfMargin ) / dfTileSize ), dfTiles - 1 );
+            for( double dfRow = dfRow0; dfRow <= dfRow1; ++dfRow )
+            {
+                double dfTop    = dfOriginY - dfRow * dfTileSize + dfMargin;
+                double dfBottom = dfTop - dfTileSize - 2 * dfMargin;
+                double t0 = 0.0, t1 = 1.0;
+                if( y0 != y1 )
+                {
+                    t0 = max( 0.0, min( ( dfTop - y0 ) / ( y1 - y0 ), ( dfBottom - y0 ) / ( y1 - y0 ) ) );
+                    t1 = min( 1.0, max( ( dfTop - y0 ) / ( y1 - y0 ), ( dfBottom - y0 ) / ( y1 - y0 ) ) );
+                }
+                double dfXa = x0 + t0 * ( x1 - x0 ), dfXb = x0 + t1 * ( x1 - x0 );
+                addTiles( min( dfXa, dfXb ), max( dfXa, dfXb ), dfRow, dfRow, iFeature );
+            }
+        };
+        for( size_t i = 0; i < features.size(); ++i )
+        {
+            const Feature& feature = features[i];
+            uint32_t       nCount  = zoom.anCount[i];
+            if( nCount == 0 )
+                continue;
+            if( feature.nType != CADTessellator::LINESTRING )
+            {
+                addBox( feature.minX, feature.minY, feature.maxX, feature.maxY, static_cast<uint32_t>( i ) );
+                continue;
+            }
+            const double * padfX = &zoom.adfX[feature.nFirst];
+            const double * padfY = &zoom.adfY[feature.nFirst];
+            for( uint32_t j = 0; j + 1 < nCount; ++j )
+                addSegment( padfX[j], padfY[j], padfX[j + 1], padfY[j + 1], static_cast<uint32_t>( i ) );
+        }
+        sort( tileFeatures.begin(), tileFeatures.end() );
+        tileFeatures.erase( unique( tileFeatures.begin(), tileFeatures.end() ), tileFeatures.end() );
+
+        featureIds.resize( tileFeatures.size() );
+        tileStarts.clear();
+        for( size_t i = 0; i < tileFeatures.size(); ++i )
+        {
+            if( i == 0 || tileFeatures[i].first != tileFeatures[i - 1].first )
+                tileStarts.push_back( i );
+            featureIds[i] = tileFeatures[i].second;
+        }
+        tileStarts.push_back( tileFeatures.size() );
+
+        // Tiles are encoded in parallel by batches and passed to the callback
+        // in z/x/y order, so the output doesn't depend on the threads.
+        size_t nTileCount = tileStarts.size() - 1;
+        for( size_t iBatch = 0; iBatch < nTileCount; iBatch += TILE_BATCH )
+        {
+            size_t nBatch = min( TILE_BATCH, nTileCount - iBatch );
+            tiles.resize( nBatch );
+            oPool.parallelFor( nBatch, [&]( size_t i ) {
+                size_t   nStart = tileStarts[iBatch + i];
+                uint64_t nKey   = tileFeatures[nStart].first;
+                if( !encodeTile( z, static_cast<int>( nKey >> 32 ), static_cast<int>( nKey & 0xFFFFFFFF ),
+                                 &featureIds[nStart], tileStarts[iBatch + i + 1] - nStart, zoom, tiles[i] ) )
+                    tiles[i].clear();
+            } );
+            for( size_t i = 0; i < nBatch; ++i )
+            {
+                if( tiles[i].empty() )
+                    continue;
+                uint64_t nKey = tileFeatures[tileStarts[iBatch + i]].first;
+                callback( z, static_cast<int>( nKey >> 32 ), static_cast<int>( nKey & 0xFFFFFFFF ), tiles[i] );
+                ++nTiles;
+            }
+        }
+    }
+    return nTiles;
+}
+
+size_t CADVectorTileWriter::writeDirectory( const string& path )
+{
+    if( !makeDirectory( path ) )
+        return 0;
+
+    bool bFailed = false;
+    unordered_set<string> directories;
+    size_t nTiles = generate( [&]( int z, int x, int y, const string& tile ) {
+        if( bFailed )
+            return;
+        string osDirectory = path + "/" + to_string( z ) + "/" + to_string( x );
+        if( directories.insert( osDirectory ).second )
+            bFailed = !makeDirectory( path + "/" + to_string( z ) ) || !makeDirectory( osDirectory );
+        ofstream file( osDirectory + "/" + to_string( y ) + ".mvt", ios::out | ios::binary );
+        file.write( tile.data(), static_cast<streamsize>( tile.size() ) );
+        bFailed = bFailed || !file;
+    } );
+    return bFailed ? 0 : nTiles;
+}
+
+size_t CADVectorTileWriter::writeFlatFile( ostream& stream )
+{
+    string   osDirectory;
+    uint64_t nOffset = 0;
+    size_t   nTiles  = generate( [&]( int z, int x, int y, const string& tile ) {
+        stream.write( tile.data(), static_cast<streamsize>( tile.size() ) );
+
+        char     achEntry[FLAT_FILE_ENTRY_SIZE];
+        uint32_t anTile[3] = { static_cast<uint32_t>( z ), static_cast<uint32_t>( x ), static_cast<uint32_t>( y ) };
+        uint32_t nSize     = static_cast<uint32_t>( tile.size() );
+        memcpy( achEntry, anTile, sizeof( anTile ) );
+        memcpy( achEntry + 12, &nOffset, sizeof( nOffset ) );
+        memcpy( achEntry + 20, &nSize, sizeof( nSize ) );
+        osDirectory.append( achEntry, FLAT_FILE_ENTRY_SIZE );
+        nOffset += tile.size();
+    } );
+
+    uint64_t nCount = nTiles;
+    stream.write( osDirectory.data(), static_cast<streamsize>( osDirectory.size() ) );
+    stream.write( reinterpret_cast<const char *>( &nOffset ), sizeof( nOffset ) );
+    stream.write( reinterpret_cast<const char *>( &nCount ), sizeof( nCount ) );
+    stream.write( FLAT_FILE_MAGIC, sizeof( FLAT_FILE_MAGIC ) );
+    return nTiles;
+}
+
+bool CADVectorTileWriter::writeTile( int z, int x, int y, string& tile )
+{
+    tile.clear();
+    updateBounds();
+    if( z < 0 || z > MAX_ZOOM || x < 0 || y < 0 || x >= ( 1 << z ) || y >= ( 1 << z ) )
+        return false;
+
+    double dfTileSize = getTileSize( z );
+    double dfMargin   = dfTileSize * nBuffer / nExtent;
+    double dfMinX     = dfOriginX + x * dfTileSize - dfMargin;
+    double dfMaxX     = dfOriginX + ( x + 1 ) * dfTileSize + dfMargin;
+    double dfMaxY     = dfOriginY - y * dfTileSize + dfMargin;
+    double dfMinY     = dfOriginY - ( y + 1 ) * dfTileSize - dfMargin;
+
+    ZoomGeometry zoom;
+    zoom.adfX.resize( adfX.size() );
+    zoom.adfY.resize( adfY.size() );
+    zoom.anCount.resize( features.size() );
+    vector<uint32_t> featureIds;
+    vector<uint32_t> stack;
+    for( size_t i = 0; i < features.size(); ++i )
+    {
+        const Feature& feature = features[i];
+        if( feature.maxX < dfMinX || feature.minX > dfMaxX || feature.maxY < dfMinY || feature.minY > dfMaxY )
+            continue;
+        simplify( z, i, zoom, stack );
+        featureIds.push_back( static_cast<uint32_t>( i ) );
+    }
+    return !featureIds.empty() && encodeTile( z, x, y, featureIds.data(), featureIds.size(), zoom, tile );
+}
+
+uint32_t CADVectorTileWriter::addString( const string& value, vector<string>& strings,
+                                         unordered_map<string, uint32_t>& index )
+{
+    auto it = index.find( value );
+    if( it != index.end() )
+        return it->second;
+    uint32_t nIndex = static_cast<uint32_t>( strings.size() );
+    strings.push_back( value );
+    index[value] = nIndex;
+    return nIndex;
+}
+
+void CADVectorTileWriter::updateBounds()
+{
+    if( bUserBounds || extents.isEmpty() )
+        return;
+    dfSize = max( extents.getMaxX() - extents.getMinX(), extents.getMaxY() - extents.getMinY() );
+    if( dfSize <= 0.0 )
+        dfSize = 1.0;
+    dfOriginX = extents.getMinX();
+    dfOriginY = extents.getMaxY();
+}
+
+double CADVectorTileWriter::getTileSize( int z ) const
+{
+    return ldexp( dfSize, -z );
+}
+
+void CADVectorTileWriter::simplify( int z, size_t iFeature, ZoomGeometry& zoom, vector<uint32_t>& stack ) const
+{
+    const Feature& feature = features[iFeature];
+    const double * padfX   = &adfX[feature.nFirst];
+    const double * padfY   = &adfY[feature.nFirst];
+    double *       padfOutX = &zoom.adfX[feature.nFirst];
+    double *       padfOutY = &zoom.adfY[feature.nFirst];
+    double dfTolerance = dfSimplification * getTileSize( z ) / nExtent;
+    if( feature.nType == CADTessellator::POINT || dfTolerance <= 0.0 || feature.nCount <= 2 )
+    {
+        copy( padfX, padfX + feature.nCount, padfOutX );
+        copy( padfY, padfY + feature.nCount, padfOutY );
+        zoom.anCount[iFeature] = feature.nCount;
+        return;
+    }
+
+    // Douglas-Peucker. Ranges are split left part first, so the kept points
+    // come out in order.
+    double   dfTolerance2 = dfTolerance * dfTolerance;
+    uint32_t nOut         = 1;
+    padfOutX[0] = padfX[0];
+    padfOutY[0] = padfY[0];
+    stack.clear();
+    stack.push_back( feature.nCount - 1 );
+    stack.push_back( 0 );
+    while( !stack.empty() )
+    {
+        uint32_t nFirst = stack.back();
+        stack.pop_back();
+        uint32_t nLast = stack.back();
+        stack.pop_back();
+
+        double   dx = padfX[nLast] - padfX[nFirst];
+        double   dy = padfY[nLast] - padfY[nFirst];
+        double   dfLength2 = dx * dx + dy * dy;
+        double   dfMax = 0.0;
+        uint32_t nMax  = nFirst;
+        for( uint32_t i = nFirst + 1; i < nLast; ++i )
+        {
+            double px = padfX[i] - padfX[nFirst];
+            double py = padfY[i] - padfY[nFirst];
+            double t  = dfLength2 > 0.0 ? min( max( ( px * dx + py * dy ) / dfLength2, 0.0 ), 1.0 ) : 0.0;
+            double ex = px - t * dx;
+            double ey = py - t * dy;
+            double dfDistance2 = ex * ex + ey * ey;
+            if( dfDistance2 > dfMax )
+            {
+                dfMax = dfDistance2;
+                nMax  = i;
+            }
+        }
+
+        if( dfMax > dfTolerance2 )
+        {
+            stack.push_back( nLast );
+            stack.push_back( nMax );
+            stack.push_back( nMax );
+            stack.push_back( nFirst );
+        }
+        else
+        {
+            padfOutX[nOut] = padfX[nLast];
+            padfOutY[nOut] = padfY[nLast];
+            ++nOut;
+        }
+    }
+
+    // Collapsed ring is dropped at this zoom
+    zoom.anCount[iFeature] = feature.nType == CADTessellator::POLYGON && nOut < 4 ? 0 : nOut;
+}
+
+bool CADVectorTileWriter::encodeTile( int z, int x, int y, const uint32_t * panFeatureIds, size_t nFeatureCount,
+                                      const ZoomGeometry& zoom, string& tile ) const
+{
+    double dfTileSize = getTileSize( z );
+    double dfTileMinX = dfOriginX + x * dfTileSize;
+    double dfTileMaxY = dfOriginY - y * dfTileSize;
+    double dfScale    = nExtent / dfTileSize;
+    double dfMin      = -static_cast<double>( nBuffer );
+    double dfMax      = static_cast<double>( nExtent ) + nBuffer;
+
+    tile.clear();
+    string           osLayer, osFeature;
+    vector<double>   adfTileX, adfTileY, adfTmpX, adfTmpY;
+    vector<uint32_t> commands, tags;
+    TileGeometry     geometry;
+
+    // Keys and values of the current layer
+    vector<uint32_t>                       layerKeys, layerValues;
+    unordered_map<uint32_t, uint32_t>      keyMap, valueMap;
+    size_t   nLayerFeatures = 0;
+    uint32_t nLayer         = 0;
+
+    auto flushLayer = [&]() {
+        if( nLayerFeatures == 0 )
+            return;
+        string osMessage;
+        putKey( osMessage, 15, 0 );
+        putVarint( osMessage, 2 );
+        putBytes( osMessage, 1, layerNames[nLayer] );
+        osMessage += osLayer;
+        for( uint32_t nKey : layerKeys )
+            putBytes( osMessage, 3, keys[nKey] );
+        for( uint32_t nValue : layerValues )
+        {
+            string osValue;
+            putBytes( osValue, 1, values[nValue] );
+            putBytes( osMessage, 4, osValue );
+        }
+        putKey( osMessage, 5, 0 );
+        putVarint( osMessage, nExtent );
+        putBytes( tile, 3, osMessage );
+
+        osLayer.clear();
+        layerKeys.clear();
+        layerValues.clear();
+        keyMap.clear();
+        valueMap.clear();
+        nLayerFeatures = 0;
+    };
+
+    // Features are ordered by layers
+    for( size_t iFeature = 0; iFeature < nFeatureCount; ++iFeature )
+    {
+        const Feature& feature = features[panFeatureIds[iFeature]];
+        uint32_t       nCount  = zoom.anCount[panFeatureIds[iFeature]];
+        if( nCount == 0 )
+            continue;
+
+        adfTileX.resize( nCount );
+        adfTileY.resize( nCount );
+        for( uint32_t i = 0; i < nCount; ++i )
+        {
+            adfTileX[i] = ( zoom.adfX[feature.nFirst + i] - dfTileMinX ) * dfScale;
+            adfTileY[i] = ( dfTileMaxY - zoom.adfY[feature.nFirst + i] ) * dfScale;
+        }
+
+        geometry.clear();
+        switch( feature.nType )
+        {
+            case CADTessellator::POINT:
+                if( adfTileX[0] >= dfMin && adfTileX[0] <= dfMax && adfTileY[0] >= dfMin && adfTileY[0] <= dfMax )
+                {
+                    geometry.startPart();
+                    geometry.add( adfTileX[0], adfTileY[0] );
+                }
+                break;
+            case CADTessellator::LINESTRING:
+                clipLine( adfTileX.data(), adfTileY.data(), nCount, dfMin, dfMax, geometry );
+                break;
+            default:
+                adfTileX.pop_back();
+                adfTileY.pop_back();
+                clipRing( adfTileX, adfTileY, adfTmpX, adfTmpY, dfMin, dfMax );
+                if( adfTileX.empty() )
+                    break;
+                geometry.startPart();
+                for( size_t i = 0; i < adfTileX.size(); ++i )
+                    geometry.add( adfTileX[i], adfTileY[i] );
+                geometry.endRing();
+                break;
+        }
+        if( geometry.empty() )
+            continue;
+
+        if( feature.nLayer != nLayer )
+            flushLayer();
+        nLayer = feature.nLayer;
+
+        tags.clear();
+        for( uint32_t i = 0; i < feature.nTagCount; ++i )
+        {
+            uint32_t nKey   = anTags[feature.nFirstTag + 2 * i];
+            uint32_t nValue = anTags[feature.nFirstTag + 2 * i + 1];
+            auto     key    = keyMap.insert( make_pair( nKey, static_cast<uint32_t>( layerKeys.size() ) ) );
+            if( key.second )
+                layerKeys.push_back( nKey );
+            auto value = valueMap.insert( make_pair( nValue, static_cast<uint32_t>( layerValues.size() ) ) );
+            if( value.second )
+                layerValues.push_back( nValue );
+            tags.push_back( key.first->second );
+            tags.push_back( value.first->second );
+        }
+
+        commands.clear();
+        geometry.encode( feature.nType == CADTessellator::POLYGON, commands );
+
+        osFeature.clear();
+        putKey( osFeature, 1, 0 );
+        putVarint( osFeature, feature.nId );
+        if( !tags.empty() )
+            putPacked( osFeature, 2, tags );
+        putKey( osFeature, 3, 0 );
+        putVarint( osFeature, feature.nType );
+        putPacked( osFeature, 4, commands );
+        putBytes( osLayer, 2, osFeature );
+        ++nLayerFeatures;
+    }
+    flushLayer();
+    return !tile.empty();
+}
@@ -0,0 +1,164 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADVECTORTILEWRITER_H
+#define CADVECTORTILEWRITER_H
+
+#include "cadfile.h"
+#include "cadtessellator.h"
+#include "cadthreadpool.h"
+
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+
+/**
+ * @brief Generates Mapbox Vector Tiles (MVT 2.1) from layer geometries.
+ * Geometries are read and flattened once by addLayer(). For every zoom they
+ * are simplified, then every tile is clipped, quantized and encoded in the
+ * thread pool. Tiles use the XYZ scheme: zoom 0 is one square tile over the
+ * bounds and y goes down. Each CAD layer becomes a tile layer, features have
+ * color, text and block attribute properties.
+ */
+class OCAD_EXTERN CADVectorTileWriter
+{
+public:
+    typedef function<void( int z, int x, int y, const string& tile )> TileCallback;
+
+    explicit CADVectorTileWriter( unsigned nThreads = 0 ); // 0 means hardware concurrency
+
+    CADTessellator& getTessellator();
+
+    int  getMinZoom() const;
+    int  getMaxZoom() const;
+    void setZoomRange( int nMinZoom, int nMaxZoom ); // from 0 to 24
+
+    unsigned getExtent() const;
+    void     setExtent( unsigned value ); // tile coordinates range, 4096 by default
+
+    unsigned getBuffer() const;
+    void     setBuffer( unsigned value ); // clipping margin in tile coordinates, 64 by default
+
+    double getSimplification() const;
+    void   setSimplification( double value ); // in tile coordinates, 1 by default, 0 disables
+
+    /**
+     * @brief Set the square covered by zoom 0 tile. Extents of the added
+     * layers are used by default.
+     */
+    void setBounds( double dfMinX, double dfMinY, double dfSize );
+
+    size_t addLayer( CADLayer& layer ); // returns number of added features
+    size_t addFile( CADFile& file );
+    void   clear();
+
+    /**
+     * @brief Encode all non empty tiles of the zoom range. Tiles are made in
+     * parallel, the callback is called by the calling thread in z/x/y order.
+     * @return number of tiles
+     */
+    size_t generate( const TileCallback& callback );
+
+    /**
+     * @brief Write tiles as path/z/x/y.mvt, directories are created.
+     * @return number of tiles, 0 if a file could not be written
+     */
+    size_t writeDirectory( const string& path );
+
+    /**
+     * @brief Write tiles to one file: tiles data, then the directory of
+     * 24 byte entries (uint32 z, x, y, uint64 offset and uint32 size), then
+     * uint64 directory offset, uint64 entry count and "OCADMVT1". Numbers
+     * are in the host byte order.
+     * @return number of tiles
+     */
+    size_t writeFlatFile( ostream& stream );
+
+    /**
+     * @brief Encode one tile. generate() is faster for many tiles.
+     * @return false if the tile is empty
+     */
+    bool writeTile( int z, int x, int y, string& tile );
+protected:
+    struct Feature
+    {
+        uint32_t nLayer;
+        uint64_t nId;       // geometry index in the layer + 1
+        uint8_t  nType;     // CADTessellator::SimpleFeature
+        size_t   nFirst;    // coordinates in adfX and adfY
+        uint32_t nCount;
+        uint32_t nFirstTag; // key and value index pairs in anTags
+        uint32_t nTagCount;
+        double   minX, minY, maxX, maxY;
+    };
+
+    // Simplified coordinates of a zoom, indexed as the original ones
+    struct ZoomGeometry
+    {
+        vector<double>   adfX;
+        vector<double>   adfY;
+        vector<uint32_t> anCount;
+    };
+
+    uint32_t addString( const string& value, vector<string>& strings, unordered_map<string, uint32_t>& index );
+    void     updateBounds();
+    double   getTileSize( int z ) const;
+    // stack is reused between calls
+    void     simplify( int z, size_t iFeature, ZoomGeometry& zoom, vector<uint32_t>& stack ) const;
+    bool     encodeTile( int z, int x, int y, const uint32_t * panFeatureIds, size_t nFeatureCount,
+                         const ZoomGeometry& zoom, string& tile ) const;
+protected:
+    int      nMinZoom;
+    int      nMaxZoom;
+    unsigned nExtent;
+    unsigned nBuffer;
+    double   dfSimplification;
+    bool     bUserBounds;
+    double   dfOriginX; // top left corner of the zoom 0 tile
+    double   dfOriginY;
+    double   dfSize;
+
+    vector<string>                   layerNames;
+    vector<Feature>                  features;
+    vector<double>                   adfX;
+    vector<double>                   adfY;
+    vector<uint32_t>                 anTags;
+    vector<string>                   keys;
+    vector<string>                   values;
+    unordered_map<string, uint32_t>  keyIndex;
+    unordered_map<string, uint32_t>  valueIndex;
+    CADBoundingBox                   extents;
+
+    CADTessellator oTessellator;
+    CADVertexArray oPoints;
+    CADThreadPool  oPool;
+};
+
+#endif // CADVECTORTILEWRITER_H
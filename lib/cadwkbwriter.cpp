@@ -0,0 +1,220 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadwkbwriter.h"
+
+#include <cstring>
+
+static const uint32_t WKB_POINT      = 1;
+static const uint32_t WKB_LINESTRING = 2;
+static const uint32_t WKB_POLYGON    = 3;
+
+static const uint32_t ISO_Z_OFFSET = 1000;
+static const uint32_t EWKB_Z_FLAG    = 0x80000000;
+static const uint32_t EWKB_SRID_FLAG = 0x20000000;
+
+static bool isLittleEndianHost()
+{
+    const uint16_t nOne = 1;
+    uint8_t        nFirstByte;
+    memcpy( &nFirstByte, &nOne, 1 );
+    return nFirstByte == 1;
+}
+
+static uint8_t * putUInt32( uint8_t * pabyOut, uint32_t nValue )
+{
+    memcpy( pabyOut, &nValue, sizeof( nValue ) );
+    return pabyOut + sizeof( nValue );
+}
+
+static uint8_t * putDouble( uint8_t * pabyOut, double dfValue )
+{
+    memcpy( pabyOut, &dfValue, sizeof( dfValue ) );
+    return pabyOut + sizeof( dfValue );
+}
+
+CADWKBWriter::CADWKBWriter( enum Flavor eFlavorIn, bool bZIn ) : eFlavor( eFlavorIn ), bZ( bZIn ), nSRID( 0 )
+{
+}
+
+enum CADWKBWriter::Flavor CADWKBWriter::getFlavor() const
+{
+    return eFlavor;
+}
+
+void CADWKBWriter::setFlavor( enum Flavor value )
+{
+    eFlavor = value;
+}
+
+bool CADWKBWriter::getZ() const
+{
+    return bZ;
+}
+
+void CADWKBWriter::setZ( bool value )
+{
+    bZ = value;
+}
+
+int CADWKBWriter::getSRID() const
+{
+    return nSRID;
+}
+
+void CADWKBWriter::setSRID( int value )
+{
+    nSRID = value;
+}
+
+CADTessellator& CADWKBWriter::getTessellator()
+{
+    return oTessellator;
+}
+
+bool CADWKBWriter::write( const CADGeometry * pGeom, vector<uint8_t>& out )
+{
+    switch( pGeom->getType() )
+    {
+        case CADGeometry::POINT:
+        case CADGeometry::TEXT:
+        case CADGeometry::MTEXT:
+        case CADGeometry::ATTRIB:
+        case CADGeometry::ATTDEF:
+            writePoint( static_cast<const CADPoint3D *>( pGeom )->getPosition(), out );
+            return true;
+
+        case CADGeometry::LINE:
+        {
+            auto      poLine = static_cast<const CADLine *>( pGeom );
+            CADVector start  = poLine->getStart().getPosition();
+            CADVector end    = poLine->getEnd().getPosition();
+            double    adfX[2] = { start.getX(), end.getX() };
+            double    adfY[2] = { start.getY(), end.getY() };
+            double    adfZ[2] = { start.getZ(), end.getZ() };
+            return writeLineString( adfX, adfY, adfZ, 2, out );
+        }
+
+        case CADGeometry::POLYLINE3D:
+        {
+            auto poPolyline = static_cast<const CADPolyline3D *>( pGeom );
+            const vector<double>& adfZ = poPolyline->getZs();
+            return writeLineString( poPolyline->getXs().data(), poPolyline->getYs().data(),
+                                    adfZ.empty() ? nullptr : adfZ.data(), poPolyline->getVertexCount(), out );
+        }
+
+        case CADGeometry::LWPOLYLINE:
+        case CADGeometry::POLYLINE2D:
+        case CADGeometry::CIRCLE:
+        case CADGeometry::ARC:
+        case CADGeometry::ELLIPSE:
+        case CADGeometry::SPLINE:
+        {
+            oPoints.clear();
+            oTessellator.tessellate( pGeom, oPoints );
+            return writeLineString( oPoints.getXData(), oPoints.getYData(), oPoints.getZData(), oPoints.size(),
+                                    out );
+        }
+
+        case CADGeometry::FACE3D:
+        case CADGeometry::SOLID:
+        {
+            oPoints.clear();
+            if( oTessellator.getSimpleFeature( pGeom, oPoints ) != CADTessellator::POLYGON )
+                return false;
+            return writePolygon( oPoints.getXData(), oPoints.getYData(), oPoints.getZData(), oPoints.size(), out );
+        }
+
+        default:
+            return false;
+    }
+}
+
+uint8_t * CADWKBWriter::writeHeader( uint32_t nType, size_t nBodySize, vector<uint8_t>& out ) const
+{
+    bool bSRID = eFlavor == EWKB && nSRID != 0;
+    if( bZ )
+        nType = eFlavor == EWKB ? nType | EWKB_Z_FLAG : nType + ISO_Z_OFFSET;
+    if( bSRID )
+        nType |= EWKB_SRID_FLAG;
+
+    size_t nStart = out.size();
+    out.resize( nStart + 1 + 4 + ( bSRID ? 4 : 0 ) + nBodySize );
+    uint8_t * pabyOut = out.data() + nStart;
+    *pabyOut++ = isLittleEndianHost() ? 1 : 0;
+    pabyOut = putUInt32( pabyOut, nType );
+    if( bSRID )
+        pabyOut = putUInt32( pabyOut, static_cast<uint32_t>( nSRID ) );
+    return pabyOut;
+}
+
+uint8_t * CADWKBWriter::writeCoordinates( uint8_t * pabyOut, const double * padfX, const double * padfY,
+                                          const double * padfZ, size_t nCount ) const
+{
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        pabyOut = putDouble( pabyOut, padfX[i] );
+        pabyOut = putDouble( pabyOut, padfY[i] );
+        if( bZ )
+            pabyOut = putDouble( pabyOut, padfZ ? padfZ[i] : 0.0 );
+    }
+    return pabyOut;
+}
+
+void CADWKBWriter::writePoint( const CADVector& point, vector<uint8_t>& out ) const
+{
+    double x = point.getX(), y = point.getY(), z = point.getZ();
+    uint8_t * pabyOut = writeHeader( WKB_POINT, ( bZ ? 3 : 2 ) * sizeof( double ), out );
+    writeCoordinates( pabyOut, &x, &y, &z, 1 );
+}
+
+bool CADWKBWriter::writeLineString( const double * padfX, const double * padfY, const double * padfZ,
+                                    size_t nCount, vector<uint8_t>& out ) const
+{
+    if( nCount < 2 )
+        return false;
+    uint8_t * pabyOut = writeHeader( WKB_LINESTRING, 4 + nCount * ( bZ ? 3 : 2 ) * sizeof( double ), out );
+    pabyOut = putUInt32( pabyOut, static_cast<uint32_t>( nCount ) );
+    writeCoordinates( pabyOut, padfX, padfY, padfZ, nCount );
+    return true;
+}
+
+bool CADWKBWriter::writePolygon( const double * padfX, const double * padfY, const double * padfZ,
+                                 size_t nCount, vector<uint8_t>& out ) const
+{
+    // Single closed ring
+    if( nCount < 4 )
+        return false;
+    uint8_t * pabyOut = writeHeader( WKB_POLYGON, 4 + 4 + nCount * ( bZ ? 3 : 2 ) * sizeof( double ), out );
+    pabyOut = putUInt32( pabyOut, 1 );
+    pabyOut = putUInt32( pabyOut, static_cast<uint32_t>( nCount ) );
+    writeCoordinates( pabyOut, padfX, padfY, padfZ, nCount );
+    return true;
+}
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADWKBWRITER_H
+#define CADWKBWRITER_H
+
+#include "cadtessellator.h"
+
+#include <cstdint>
+
+/**
+ * @brief Encodes geometries as OGC Well Known Binary or PostGIS extended WKB.
+ * Points are written as Point, linear geometries and curves as LineString,
+ * 3D faces and solids as Polygon. Curves and bulged polyline segments are
+ * flattened with the tessellator. Output is appended to the caller buffer in
+ * the host byte order, so one buffer can be reused for many features.
+ */
+class OCAD_EXTERN CADWKBWriter
+{
+public:
+    enum Flavor
+    {
+        ISO  = 0, // Z geometries have type + 1000
+        EWKB = 1  // PostGIS: Z and SRID are flags of the type
+    };
+
+    explicit CADWKBWriter( enum Flavor eFlavor = ISO, bool bZ = true );
+
+    enum Flavor getFlavor() const;
+    void        setFlavor( enum Flavor value );
+
+    bool getZ() const;
+    void setZ( bool value ); // 2D output drops Z
+
+    int  getSRID() const;
+    void setSRID( int value ); // written to EWKB only, 0 means no SRID
+
+    CADTessellator& getTessellator();
+
+    /**
+     * @brief Append WKB of the geometry to out.
+     * @return false if the geometry type can't be encoded, out is not changed
+     * in this case
+     */
+    bool write( const CADGeometry * pGeom, vector<uint8_t>& out );
+protected:
+    uint8_t * writeHeader( uint32_t nType, size_t nBodySize, vector<uint8_t>& out ) const;
+    uint8_t * writeCoordinates( uint8_t * pabyOut, const double * padfX, const double * padfY,
+                                const double * padfZ, size_t nCount ) const;
+    void      writePoint( const CADVector& point, vector<uint8_t>& out ) const;
+    bool      writeLineString( const double * padfX, const double * padfY, const double * padfZ,
+                               size_t nCount, vector<uint8_t>& out ) const;
+    bool      writePolygon( const double * padfX, const double * padfY, const double * padfZ,
+                            size_t nCount, vector<uint8_t>& out ) const;
+protected:
+    enum Flavor    eFlavor;
+    bool           bZ;
+    int            nSRID;
+    CADTessellator oTessellator;
+    CADVertexArray oPoints; // reused between geometries
+};
+
+#endif // CADWKBWRITER_H
@@ -0,0 +1,54 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef DWG_CODEPAGE_H
+#define DWG_CODEPAGE_H
+
+#include <string>
+
+/**
+ * @brief Returns the table of unicode code points for bytes 0x80-0xFF of the
+ *        DWG code page (value of $DWGCODEPAGE header variable)
+ * @param nDWGCodePage DWG code page index
+ * @return table of 128 code points or nullptr if code page is unknown or not
+ *         single-byte. Strings in such code pages are left untouched.
+ */
+const unsigned short * GetCodePageTable( short nDWGCodePage );
+
+/**
+ * @brief Transcodes the whole string from single-byte code page to UTF-8 in
+ *        place. Pure ASCII strings are detected and left as is.
+ * @param sValue string to transcode
+ * @param panCodePageTable table returned by GetCodePageTable, nullptr means
+ *        no transcoding
+ */
+void TranscodeToUTF8( std::string& sValue, const unsigned short * panCodePageTable );
+
+#endif // DWG_CODEPAGE_H
@@ -32,6 +32,10 @@
 
 #include <iostream>
 #include <cstring>
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
 
 unsigned short CalculateCRC8( unsigned short initialVal, const char * ptr, int num )
 {
@@ -340,17 +344,42 @@ unsigned char ReadCHAR( const char * pabyInput, size_t& nBitOffsetFromStart )
 
 std::string ReadTV( const char * pabyInput, size_t& nBitOffsetFromStart )
 {
-    // TODO: due to CLion issues with copying text from output window, all
-    //       string readed are now not zero-terminated. Will fix soon.
     short stringLength = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
+    if( stringLength <= 0 )
+        return std::string();
 
-    std::string result;
+    size_t nByteOffset      = nBitOffsetFromStart / 8;
+    size_t nBitOffsetInByte = nBitOffsetFromStart % 8;
 
-    for( short i = 0; i < stringLength; ++i )
+    // Read the whole string at once instead of char by char.
+    std::string result( static_cast<size_t>( stringLength ), '\0' );
+    const unsigned char * pabyFirstByte = reinterpret_cast<const unsigned char *>( pabyInput + nByteOffset );
+    if( nBitOffsetInByte == 0 )
     {
-        result += static_cast<char>(ReadCHAR( pabyInput, nBitOffsetFromStart ));
+        memcpy( & result[0], pabyFirstByte, stringLength );
     }
+    else
+    {
+        for( short i = 0; i < stringLength; ++i )
+        {
+            result[i] = static_cast<char>( ( pabyFirstByte[i] << nBitOffsetInByte ) |
+                                           ( pabyFirstByte[i + 1] >> ( 8 - nBitOffsetInByte ) ) );
+        }
+    }
+
+    nBitOffsetFromStart += static_cast<size_t>( stringLength ) * 8;
+
+    // Length includes the terminating zero, it isn't a part of the value.
+    size_t nZero = result.find( '\0' );
+    if( nZero != std::string::npos )
+        result.resize( nZero );
+    return result;
+}
 
+std::string ReadTV( const char * pabyInput, size_t& nBitOffsetFromStart, const unsigned short * panCodePageTable )
+{
+    std::string result = ReadTV( pabyInput, nBitOffsetFromStart );
+    TranscodeToUTF8( result, panCodePageTable );
     return result;
 }
 
@@ -863,3 +892,151 @@ CADVector ReadRAWVector( const char * pabyInput, size_t& nBitOffsetFromStart )
 
     return CADVector( x, y );
 }
+
+static inline uint64_t SwapBytes64( uint64_t nValue )
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64( nValue );
+#elif defined(_MSC_VER)
+    return _byteswap_uint64( nValue );
+#else
+    nValue = ( ( nValue & 0x00000000FFFFFFFFULL ) << 32 ) | ( nValue >> 32 );
+    nValue = ( ( nValue & 0x0000FFFF0000FFFFULL ) << 16 ) | ( ( nValue & 0xFFFF0000FFFF0000ULL ) >> 16 );
+    nValue = ( ( nValue & 0x00FF00FF00FF00FFULL ) << 8 ) | ( ( nValue & 0xFF00FF00FF00FF00ULL ) >> 8 );
+    return nValue;
+#endif
+}
+
+// Returns 64 bits starting at nBitOffset in the order they are stored, so the
+// result may be copied into a double as is. Reads 9 bytes like ReadRAWDOUBLE.
+static inline uint64_t Peek64Bits( const char * pabyInput, size_t nBitOffset )
+{
+    const unsigned char * pabyData = reinterpret_cast<const unsigned char *>( pabyInput ) + nBitOffset / 8;
+    size_t nShift = nBitOffset % 8;
+
+    uint64_t nWord;
+    memcpy( & nWord, pabyData, 8 );
+    if( nShift == 0 )
+        return nWord;
+
+    nWord = SwapBytes64( nWord );
+    nWord = ( nWord << nShift ) | ( pabyData[8] >> ( 8 - nShift ) );
+    return SwapBytes64( nWord );
+}
+
+static inline unsigned char Peek2Bits( const char * pabyInput, size_t nBitOffset )
+{
+    const unsigned char * pabyData = reinterpret_cast<const unsigned char *>( pabyInput ) + nBitOffset / 8;
+    unsigned int nPair = ( static_cast<unsigned int>( pabyData[0] ) << 8 ) | pabyData[1];
+    return static_cast<unsigned char>( ( nPair >> ( 14 - nBitOffset % 8 ) ) & binary(11) );
+}
+
+void ReadRAWDOUBLEs( const char * pabyInput, size_t& nBitOffsetFromStart, double * padfValues, size_t nCount )
+{
+    if( nCount == 0 )
+        return;
+
+    const unsigned char * pabyData = reinterpret_cast<const unsigned char *>( pabyInput ) +
+                                     nBitOffsetFromStart / 8;
+    size_t nShift = nBitOffsetFromStart % 8;
+    nBitOffsetFromStart += nCount * 64;
+
+    // Byte aligned run is just a copy of little endian doubles.
+    if( nShift == 0 )
+    {
+        memcpy( padfValues, pabyData, nCount * 8 );
+        return;
+    }
+
+    // Each value takes the tail of the current word and the head of the next
+    // one, so every input word is loaded only once.
+    uint64_t nCurrent;
+    memcpy( & nCurrent, pabyData, 8 );
+    nCurrent = SwapBytes64( nCurrent );
+    for( size_t i = 0; i + 1 < nCount; ++i )
+    {
+        uint64_t nNext;
+        memcpy( & nNext, pabyData + ( i + 1 ) * 8, 8 );
+        nNext = SwapBytes64( nNext );
+
+        uint64_t nValue = SwapBytes64( ( nCurrent << nShift ) | ( nNext >> ( 64 - nShift ) ) );
+        memcpy( padfValues + i, & nValue, 8 );
+        nCurrent = nNext;
+    }
+    // Last value must not read past its 9th byte.
+    uint64_t nValue = SwapBytes64( ( nCurrent << nShift ) | ( pabyData[nCount * 8] >> ( 8 - nShift ) ) );
+    memcpy( padfValues + nCount - 1, & nValue, 8 );
+}
+
+static inline double DecodeBITDOUBLE( const char * pabyInput, size_t& nBitOffsetFromStart )
+{
+    unsigned char nCode = Peek2Bits( pabyInput, nBitOffsetFromStart );
+    nBitOffsetFromStart += 2;
+
+    switch( nCode )
+    {
+        case BITDOUBLE_NORMAL:
+        {
+            uint64_t nValue = Peek64Bits( pabyInput, nBitOffsetFromStart );
+            nBitOffsetFromStart += 64;
+            double dfValue;
+            memcpy( & dfValue, & nValue, 8 );
+            return dfValue;
+        }
+        case BITDOUBLE_ONE_VALUE:
+            return 1.0;
+        default:
+            return 0.0;
+    }
+}
+
+void ReadBITDOUBLEs( const char * pabyInput, size_t& nBitOffsetFromStart, double * padfValues, size_t nCount )
+{
+    for( size_t i = 0; i < nCount; ++i )
+        padfValues[i] = DecodeBITDOUBLE( pabyInput, nBitOffsetFromStart );
+}
+
+static inline double DecodeBITDOUBLEWD( const char * pabyInput, size_t& nBitOffsetFromStart, double dfDefault )
+{
+    unsigned char nCode = Peek2Bits( pabyInput, nBitOffsetFromStart );
+    nBitOffsetFromStart += 2;
+    if( nCode == BITDOUBLEWD_DEFAULT_VALUE )
+        return dfDefault;
+
+    uint64_t nValue;
+    memcpy( & nValue, & dfDefault, 8 );
+    uint64_t nPatch = Peek64Bits( pabyInput, nBitOffsetFromStart );
+
+    switch( nCode )
+    {
+        case BITDOUBLEWD_4BYTES_PATCHED:
+            // Patch bytes 0-3.
+            nValue = ( nValue & 0xFFFFFFFF00000000ULL ) | ( nPatch & 0xFFFFFFFFULL );
+            nBitOffsetFromStart += 32;
+            break;
+        case BITDOUBLEWD_6BYTES_PATCHED:
+            // Patch bytes 4-5, then bytes 0-3.
+            nValue = ( nValue & 0xFFFF000000000000ULL ) | ( ( nPatch & 0xFFFFULL ) << 32 ) |
+                     ( ( nPatch >> 16 ) & 0xFFFFFFFFULL );
+            nBitOffsetFromStart += 48;
+            break;
+        default:
+            nValue = nPatch;
+            nBitOffsetFromStart += 64;
+            break;
+    }
+
+    double dfValue;
+    memcpy( & dfValue, & nValue, 8 );
+    return dfValue;
+}
+
+void ReadBITDOUBLEWDPoints( const char * pabyInput, size_t& nBitOffsetFromStart, double * padfX, double * padfY,
+                            size_t nCount )
+{
+    for( size_t i = 1; i < nCount; ++i )
+    {
+        padfX[i] = DecodeBITDOUBLEWD( pabyInput, nBitOffsetFromStart, padfX[i - 1] );
+        padfY[i] = DecodeBITDOUBLEWD( pabyInput, nBitOffsetFromStart, padfY[i - 1] );
+    }
+}
@@ -33,6 +33,7 @@
 
 #include "cadheader.h"
 #include "cadobjects.h"
+#include "codepage.h"
 
 #include <string>
 #include <algorithm>
@@ -150,6 +151,7 @@ long          ReadMCHAR( const char * pabyInput, size_t& nBitOffsetFromStart );
 long          ReadUMCHAR( const char * pabyInput, size_t& nBitOffsetFromStart );
 unsigned int  ReadMSHORT( const char * pabyInput, size_t& nBitOffsetFromStart );
 std::string   ReadTV( const char * pabyInput, size_t& nBitOffsetFromStart );
+std::string   ReadTV( const char * pabyInput, size_t& nBitOffsetFromStart, const unsigned short * panCodePageTable );
 void          SkipTV( const char * pabyInput, size_t& nBitOffsetFromStart );
 void          SkipBITLONG( const char * pabyInput, size_t& nBitOffsetFromStart );
 void          SkipBITSHORT( const char * pabyInput, size_t& nBitOffsetFromStart );
@@ -157,4 +159,16 @@ void          SkipBITSHORT( const char * pabyInput, size_t& nBitOffsetFromStart
 CADVector ReadVector( const char * pabyInput, size_t& nBitOffsetFromStart );
 CADVector ReadRAWVector( const char * pabyInput, size_t& nBitOffsetFromStart );
 
+/*
+ * Bulk decoders. They produce the same values as the scalar ones above, but
+ * shift the stream a 64-bit word at a time instead of byte by byte.
+ * Output arrays must have room for nCount values.
+ */
+void ReadRAWDOUBLEs( const char * pabyInput, size_t& nBitOffsetFromStart, double * padfValues, size_t nCount );
+void ReadBITDOUBLEs( const char * pabyInput, size_t& nBitOffsetFromStart, double * padfValues, size_t nCount );
+// Reads points 1..nCount-1 stored as BITDOUBLEWD pairs, each one defaulting to
+// the previous point. The first point must be set by the caller.
+void ReadBITDOUBLEWDPoints( const char * pabyInput, size_t& nBitOffsetFromStart, double * padfX, double * padfY,
+                            size_t nCount );
+
 #endif // DWG_IO_H
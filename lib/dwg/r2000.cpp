@@ -39,6 +39,7 @@
 #include <cassert>
 #include <memory>
 #include <cmath>
+#include <algorithm>
 
 #ifdef __APPLE__
 
@@ -91,10 +92,10 @@ int DWGFileR2000::ReadHeader( OpenOptions eOptions )
         oHeader.addValue( UNKNOWN2, ReadBITDOUBLE( pabyBuf, nBitOffsetFromStart ) );
         oHeader.addValue( UNKNOWN3, ReadBITDOUBLE( pabyBuf, nBitOffsetFromStart ) );
         oHeader.addValue( UNKNOWN4, ReadBITDOUBLE( pabyBuf, nBitOffsetFromStart ) );
-        oHeader.addValue( UNKNOWN5, ReadTV( pabyBuf, nBitOffsetFromStart ) );
-        oHeader.addValue( UNKNOWN6, ReadTV( pabyBuf, nBitOffsetFromStart ) );
-        oHeader.addValue( UNKNOWN7, ReadTV( pabyBuf, nBitOffsetFromStart ) );
-        oHeader.addValue( UNKNOWN8, ReadTV( pabyBuf, nBitOffsetFromStart ) );
+        oHeader.addValue( UNKNOWN5, ReadTV( pabyBuf, nBitOffsetFromStart, panCodePageTable ) );
+        oHeader.addValue( UNKNOWN6, ReadTV( pabyBuf, nBitOffsetFromStart, panCodePageTable ) );
+        oHeader.addValue( UNKNOWN7, ReadTV( pabyBuf, nBitOffsetFromStart, panCodePageTable ) );
+        oHeader.addValue( UNKNOWN8, ReadTV( pabyBuf, nBitOffsetFromStart, panCodePageTable ) );
         oHeader.addValue( UNKNOWN9, ReadBITLONG( pabyBuf, nBitOffsetFromStart ) );
         oHeader.addValue( UNKNOWN10, ReadBITLONG( pabyBuf, nBitOffsetFromStart ) );
     } else
@@ -210,7 +211,7 @@ int DWGFileR2000::ReadHeader( OpenOptions eOptions )
         oHeader.addValue( CADHeader::CMLSCALE, ReadBITDOUBLE( pabyBuf, nBitOffsetFromStart ) ); // 11
         oHeader.addValue( CADHeader::CELTSCALE, ReadBITDOUBLE( pabyBuf, nBitOffsetFromStart ) );// 12
 
-        oHeader.addValue( CADHeader::MENU, ReadTV( pabyBuf, nBitOffsetFromStart ) );
+        oHeader.addValue( CADHeader::MENU, ReadTV( pabyBuf, nBitOffsetFromStart, panCodePageTable ) );
     } else
     {
         for( char i = 0; i < 12; ++i )
@@ -377,8 +378,8 @@ int DWGFileR2000::ReadHeader( OpenOptions eOptions )
 
     if( eOptions == OpenOptions::READ_ALL )
     {
-        oHeader.addValue( CADHeader::DIMPOST, ReadTV( pabyBuf, nBitOffsetFromStart ) );
-        oHeader.addValue( CADHeader::DIMAPOST, ReadTV( pabyBuf, nBitOffsetFromStart ) );
+        oHeader.addValue( CADHeader::DIMPOST, ReadTV( pabyBuf, nBitOffsetFromStart, panCodePageTable ) );
+        oHeader.addValue( CADHeader::DIMAPOST, ReadTV( pabyBuf, nBitOffsetFromStart, panCodePageTable ) );
 
         oHeader.addValue( CADHeader::DIMSCALE, ReadBITDOUBLE( pabyBuf, nBitOffsetFromStart ) ); // 1
         oHeader.addValue( CADHeader::DIMASZ, ReadBITDOUBLE( pabyBuf, nBitOffsetFromStart ) );   // 2
@@ -549,8 +550,8 @@ int DWGFileR2000::ReadHeader( OpenOptions eOptions )
         SkipBITSHORT( pabyBuf, nBitOffsetFromStart );
     }
 
-    oHeader.addValue( CADHeader::HYPERLINKBASE, ReadTV( pabyBuf, nBitOffsetFromStart ) );
-    oHeader.addValue( CADHeader::STYLESHEET, ReadTV( pabyBuf, nBitOffsetFromStart ) );
+    oHeader.addValue( CADHeader::HYPERLINKBASE, ReadTV( pabyBuf, nBitOffsetFromStart, panCodePageTable ) );
+    oHeader.addValue( CADHeader::STYLESHEET, ReadTV( pabyBuf, nBitOffsetFromStart, panCodePageTable ) );
 
     CADHandle stLayoutsDict = ReadHANDLE( pabyBuf, nBitOffsetFromStart );
     oTables.AddTable( CADTables::LayoutsDict, stLayoutsDict );
@@ -584,8 +585,8 @@ int DWGFileR2000::ReadHeader( OpenOptions eOptions )
     if( nCEPSNTYPE == 3 )
         oHeader.addValue( CADHeader::CEPSNID, ReadHANDLE( pabyBuf, nBitOffsetFromStart ) );
 
-    oHeader.addValue( CADHeader::FINGERPRINTGUID, ReadTV( pabyBuf, nBitOffsetFromStart ) );
-    oHeader.addValue( CADHeader::VERSIONGUID, ReadTV( pabyBuf, nBitOffsetFromStart ) );
+    oHeader.addValue( CADHeader::FINGERPRINTGUID, ReadTV( pabyBuf, nBitOffsetFromStart, panCodePageTable ) );
+    oHeader.addValue( CADHeader::VERSIONGUID, ReadTV( pabyBuf, nBitOffsetFromStart, panCodePageTable ) );
 
 
 
@@ -669,9 +670,9 @@ int DWGFileR2000::ReadClasses( enum OpenOptions eOptions )
             CADClass stClass;
             stClass.dClassNum        = ReadBITSHORT( pabySectionContent, nBitOffsetFromStart );
             stClass.dProxyCapFlag    = ReadBITSHORT( pabySectionContent, nBitOffsetFromStart );
-            stClass.sApplicationName = ReadTV( pabySectionContent, nBitOffsetFromStart );
-            stClass.sCppClassName    = ReadTV( pabySectionContent, nBitOffsetFromStart );
-            stClass.sDXFRecordName   = ReadTV( pabySectionContent, nBitOffsetFromStart );
+            stClass.sApplicationName = ReadTV( pabySectionContent, nBitOffsetFromStart, panCodePageTable );
+            stClass.sCppClassName    = ReadTV( pabySectionContent, nBitOffsetFromStart, panCodePageTable );
+            stClass.sDXFRecordName   = ReadTV( pabySectionContent, nBitOffsetFromStart, panCodePageTable );
             stClass.bWasZombie       = ReadBIT( pabySectionContent, nBitOffsetFromStart );
             stClass.bIsEntity        = ReadBITSHORT( pabySectionContent, nBitOffsetFromStart ) == 0x1F2 ? true : false;
 
@@ -762,23 +763,45 @@ int DWGFileR2000::CreateFileMap()
     return CADErrorCodes::SUCCESS;
 }
 
+bool DWGFileR2000::fillObjectBuffer( long nOffset, size_t nSize )
+{
+    if( nObjectBufferSize > 0 && nOffset >= nObjectBufferOffset &&
+        static_cast<size_t>( nOffset - nObjectBufferOffset ) + nSize <= nObjectBufferSize )
+        return true;
+
+    size_t nReadSize = std::max( nSize, static_cast<size_t>( DWG_OBJECT_READ_AHEAD ) );
+    // Bit readers may look a few bytes beyond the end of the object.
+    if( abyObjectBuffer.size() < nReadSize + 8 )
+        abyObjectBuffer.resize( nReadSize + 8 );
+
+    nObjectBufferSize = 0;
+    if( pFileIO->Seek( nOffset, CADFileIO::SeekOrigin::BEG ) != 0 )
+        return false;
+    nObjectBufferOffset = nOffset;
+    nObjectBufferSize   = pFileIO->Read( abyObjectBuffer.data(), nReadSize );
+
+    return nObjectBufferSize >= nSize;
+}
+
 CADObject * DWGFileR2000::GetObject( long dHandle, bool bHandlesOnly )
 {
     CADObject * readed_object  = nullptr;
 
-    char   pabyObjectSize[8];
+    // Object is read speculatively with a single read of DWG_OBJECT_READ_AHEAD
+    // bytes, the second read happens only for objects which don't fit in it.
+    // Sequential objects are often served from the buffer without any I/O.
+    long   nObjectOffset       = mapObjects[dHandle];
     size_t nBitOffsetFromStart = 0;
-    pFileIO->Seek( mapObjects[dHandle], CADFileIO::SeekOrigin::BEG );
-    pFileIO->Read( pabyObjectSize, 8 );
-    unsigned int dObjectSize = ReadMSHORT( pabyObjectSize, nBitOffsetFromStart );
+    if( !fillObjectBuffer( nObjectOffset, 8 ) )
+        return nullptr;
+    const char * pabySectionContent = abyObjectBuffer.data() + ( nObjectOffset - nObjectBufferOffset );
+    unsigned int dObjectSize = ReadMSHORT( pabySectionContent, nBitOffsetFromStart );
 
-    // And read whole data chunk into memory for future parsing.
     // + nBitOffsetFromStart/8 + 2 is because dObjectSize doesn't cover CRC and itself.
-    size_t             nSectionSize = dObjectSize + nBitOffsetFromStart / 8 + 2;
-    unique_ptr<char[]> sectionContentPtr( new char[nSectionSize + 4] );
-    char * pabySectionContent = sectionContentPtr.get();
-    pFileIO->Seek( mapObjects[dHandle], CADFileIO::SeekOrigin::BEG );
-    pFileIO->Read( pabySectionContent, nSectionSize );
+    size_t nSectionSize = dObjectSize + nBitOffsetFromStart / 8 + 2;
+    if( !fillObjectBuffer( nObjectOffset, nSectionSize ) )
+        return nullptr;
+    pabySectionContent = abyObjectBuffer.data() + ( nObjectOffset - nObjectBufferOffset );
 
     nBitOffsetFromStart = 0;
     dObjectSize         = ReadMSHORT( pabySectionContent, nBitOffsetFromStart );
@@ -811,19 +834,27 @@ CADObject * DWGFileR2000::GetObject( long dHandle, bool bHandlesOnly )
         stCommonEntityData.nObjectSizeInBits = ReadRAWLONG( pabySectionContent, nBitOffsetFromStart );
         stCommonEntityData.hObjectHandle     = ReadHANDLE( pabySectionContent, nBitOffsetFromStart );
 
-        short  dEEDSize;
-        CADEed dwgEed;
+        short dEEDSize;
+        bool  bSkipEED = ( oFilter.getDecodeFlags() & CADFilter::SKIP_EED ) != 0;
         while( ( dEEDSize = ReadBITSHORT( pabySectionContent, nBitOffsetFromStart ) ) != 0 )
         {
+            if( bSkipEED )
+            {
+                SkipHANDLE( pabySectionContent, nBitOffsetFromStart );
+                nBitOffsetFromStart += dEEDSize * 8;
+                continue;
+            }
+
+            stCommonEntityData.aEED.push_back( CADEed() );
+            CADEed& dwgEed = stCommonEntityData.aEED.back();
             dwgEed.dLength      = dEEDSize;
             dwgEed.hApplication = ReadHANDLE( pabySectionContent, nBitOffsetFromStart );
 
+            dwgEed.acData.reserve( dEEDSize );
             for( short i = 0; i < dEEDSize; ++i )
             {
                 dwgEed.acData.push_back( ReadCHAR( pabySectionContent, nBitOffsetFromStart ) );
             }
-
-            stCommonEntityData.aEED.push_back( dwgEed );
         }
 
         stCommonEntityData.bGraphicsPresented = ReadBIT( pabySectionContent, nBitOffsetFromStart );
@@ -986,6 +1017,289 @@ CADObject * DWGFileR2000::GetObject( long dHandle, bool bHandlesOnly )
     return readed_object;
 }
 
+void DWGFileR2000::GetObjects( const long * padHandles, size_t nCount, CADObject ** papoObjects, bool bHandlesOnly )
+{
+    // Sort objects by file offset, and read every run of neighbour objects
+    // with one request. All requests are queued at once, objects are decoded
+    // as soon as their range is read.
+    std::vector<std::pair<long, size_t> > aObjectOffsets; // file offset, index in padHandles
+    std::multimap<long, size_t>           mapWanted; // handle, index in padHandles
+    aObjectOffsets.reserve( nCount );
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        papoObjects[i] = nullptr;
+        auto iterObject = mapObjects.find( padHandles[i] );
+        if( iterObject != mapObjects.end() )
+        {
+            aObjectOffsets.push_back( make_pair( iterObject->second, i ) );
+            mapWanted.insert( make_pair( padHandles[i], i ) );
+        }
+    }
+    std::sort( aObjectOffsets.begin(), aObjectOffsets.end() );
+
+    size_t iFirst = 0;
+    while( iFirst < aObjectOffsets.size() )
+    {
+        long   nRangeStart = aObjectOffsets[iFirst].first;
+        size_t iLast       = iFirst;
+        while( iLast + 1 < aObjectOffsets.size() &&
+               aObjectOffsets[iLast + 1].first - aObjectOffsets[iLast].first <= DWG_OBJECT_READ_AHEAD &&
+               aObjectOffsets[iLast + 1].first - nRangeStart < DWG_OBJECTS_BATCH_MAX_SIZE )
+        {
+            ++iLast;
+        }
+
+        std::vector<long> adRangeHandles;
+        for( size_t i = iFirst; i <= iLast; ++i )
+            adRangeHandles.push_back( padHandles[aObjectOffsets[i].second] );
+
+        // Size of the last object is unknown yet, so read ahead for it as GetObject() does.
+        size_t nRangeSize = static_cast<size_t>( aObjectOffsets[iLast].first - nRangeStart ) +
+                            DWG_OBJECT_READ_AHEAD;
+        submitAsyncRead( nRangeStart, nRangeSize, adRangeHandles, bHandlesOnly );
+
+        iFirst = iLast + 1;
+    }
+
+    // Objects queued by GetObjectAsync() may complete meanwhile, keep them.
+    std::deque<std::pair<long, CADObject *> > aForeignObjects;
+    long        dHandle;
+    CADObject * poObject;
+    while( !mapWanted.empty() && GetCompletedObject( dHandle, poObject ) )
+    {
+        auto iterWanted = mapWanted.find( dHandle );
+        if( iterWanted == mapWanted.end() )
+        {
+            aForeignObjects.push_back( make_pair( dHandle, poObject ) );
+            continue;
+        }
+        papoObjects[iterWanted->second] = poObject;
+        mapWanted.erase( iterWanted );
+    }
+    aCompletedObjects.insert( aCompletedObjects.begin(), aForeignObjects.begin(), aForeignObjects.end() );
+}
+
+bool DWGFileR2000::GetObjectAsync( long dHandle, bool bHandlesOnly )
+{
+    auto iterObject = mapObjects.find( dHandle );
+    if( iterObject == mapObjects.end() )
+    {
+        aCompletedObjects.push_back( make_pair( dHandle, static_cast<CADObject *>( nullptr ) ) );
+        return true;
+    }
+
+    submitAsyncRead( iterObject->second, DWG_OBJECT_READ_AHEAD, std::vector<long>( 1, dHandle ), bHandlesOnly );
+    return true;
+}
+
+bool DWGFileR2000::GetCompletedObject( long& dHandle, CADObject *& poObject )
+{
+    while( aCompletedObjects.empty() )
+    {
+        if( mapAsyncReads.empty() || !completeAsyncRead() )
+            return false;
+    }
+
+    dHandle  = aCompletedObjects.front().first;
+    poObject = aCompletedObjects.front().second;
+    aCompletedObjects.pop_front();
+    return true;
+}
+
+void DWGFileR2000::submitAsyncRead( long nOffset, size_t nSize, const std::vector<long>& adHandles,
+                                    bool bHandlesOnly )
+{
+    size_t nRequestId = nNextAsyncReadId++;
+    DWGAsyncRead& stRead = mapAsyncReads[nRequestId];
+    stRead.nOffset      = nOffset;
+    stRead.bHandlesOnly = bHandlesOnly;
+    stRead.adHandles    = adHandles;
+    // Bit readers may look a few bytes beyond the end of the object.
+    stRead.abyData.resize( nSize + 8 );
+
+    if( !pFileIO->SubmitRead( nOffset, stRead.abyData.data(), nSize, nRequestId ) )
+    {
+        // Fall back to synchronous reading.
+        mapAsyncReads.erase( nRequestId );
+        for( long dHandle : adHandles )
+            aCompletedObjects.push_back( make_pair( dHandle, GetObject( dHandle, bHandlesOnly ) ) );
+    }
+}
+
+bool DWGFileR2000::completeAsyncRead()
+{
+    size_t nRequestId;
+    size_t nReaded;
+    if( !pFileIO->WaitRead( nRequestId, nReaded ) )
+        return false;
+
+    auto iterRead = mapAsyncReads.find( nRequestId );
+    if( iterRead == mapAsyncReads.end() )
+        return true;
+
+    // Readed range becomes the object buffer, GetObject() decodes objects
+    // from it and reads again only objects which don't fit.
+    abyObjectBuffer.swap( iterRead->second.abyData );
+    nObjectBufferOffset = iterRead->second.nOffset;
+    nObjectBufferSize   = nReaded;
+
+    for( long dHandle : iterRead->second.adHandles )
+        aCompletedObjects.push_back( make_pair( dHandle, GetObject( dHandle, iterRead->second.bHandlesOnly ) ) );
+
+    mapAsyncReads.erase( iterRead );
+    return true;
+}
+
+// Transformation of the planar entity coordinates to WCS. Elevation is Z in
+// the object coordinate system.
+static Matrix getOCSMatrix( const CADVector& extrusion, double elevation )
+{
+    Matrix ocs = Matrix::ocsToWcs( extrusion );
+    if( elevation != 0.0 )
+        ocs.translate( CADVector( 0.0, 0.0, elevation ) );
+    return ocs;
+}
+
+/**
+ * @brief Compute bounding box right from the entity object for types which
+ * geometry is a plain copy of object coordinates.
+ * @return false if the whole geometry has to be read
+ */
+static bool getEntityBoundingBox( const CADObject * poObject, CADBoundingBox& oBox )
+{
+    switch( poObject->getType() )
+    {
+        case CADObject::POINT:
+            oBox.addPoint( static_cast<const CADPointObject *>( poObject )->vertPosition );
+            return true;
+        case CADObject::LINE:
+        {
+            auto poLine = static_cast<const CADLineObject *>( poObject );
+            oBox.addPoint( poLine->vertStart );
+            oBox.addPoint( poLine->vertEnd );
+            return true;
+        }
+        case CADObject::CIRCLE:
+        {
+            auto poCircle = static_cast<const CADCircleObject *>( poObject );
+            oBox.addArc( Matrix::ocsToWcs( poCircle->vectExtrusion ).multiply( poCircle->vertPosition ),
+                         poCircle->dfRadius, 0.0, 0.0, poCircle->vectExtrusion );
+            return true;
+        }
+        case CADObject::ARC:
+        {
+            auto poArc = static_cast<const CADArcObject *>( poObject );
+            oBox.addArc( Matrix::ocsToWcs( poArc->vectExtrusion ).multiply( poArc->vertPosition ),
+                         poArc->dfRadius, poArc->dfStartAngle, poArc->dfEndAngle, poArc->vectExtrusion );
+            return true;
+        }
+        case CADObject::ELLIPSE:
+        {
+            auto poEllipse = static_cast<const CADEllipseObject *>( poObject );
+            oBox.addEllipse( poEllipse->vertPosition, poEllipse->vectSMAxis, poEllipse->dfAxisRatio,
+                             poEllipse->dfBegAngle, poEllipse->dfEndAngle, poEllipse->vectExtrusion );
+            return true;
+        }
+        case CADObject::LWPOLYLINE:
+        {
+            auto poPolyline = static_cast<const CADLWPolylineObject *>( poObject );
+            CADBoundingBox oOCSBox;
+            oOCSBox.addPolyline( poPolyline->avertVertexes, poPolyline->adfBulges, poPolyline->bClosed );
+            oBox.addBox( oOCSBox.transform( getOCSMatrix( poPolyline->vectExtrusion, poPolyline->dfElevation ) ) );
+            return true;
+        }
+        case CADObject::SOLID:
+        {
+            auto poSolid = static_cast<const CADSolidObject *>( poObject );
+            CADBoundingBox oOCSBox;
+            for( const CADVector& corner : poSolid->avertCorners )
+                oOCSBox.addPoint( corner );
+            oBox.addBox( oOCSBox.transform( getOCSMatrix( poSolid->vectExtrusion, poSolid->dfElevation ) ) );
+            return true;
+        }
+        case CADObject::FACE3D:
+            for( const CADVector& corner : static_cast<const CAD3DFaceObject *>( poObject )->avertCorners )
+                oBox.addPoint( corner );
+            return true;
+        case CADObject::SPLINE:
+        {
+            auto poSpline = static_cast<const CADSplineObject *>( poObject );
+            oBox.addPoints( poSpline->avertCtrlPoints );
+            oBox.addPoints( poSpline->averFitPoints );
+            return true;
+        }
+        case CADObject::TEXT:
+        {
+            auto poText = static_cast<const CADTextObject *>( poObject );
+            Matrix ocs = getOCSMatrix( poText->vectExtrusion, poText->dfElevation );
+            oBox.addPoint( ocs.multiply( poText->vertInsetionPoint ) );
+            return true;
+        }
+        case CADObject::ATTRIB:
+        case CADObject::ATTDEF:
+        {
+            auto poAttrib = static_cast<const CADAttribObject *>( poObject );
+            Matrix ocs = getOCSMatrix( poAttrib->vectExtrusion, poAttrib->dfElevation );
+            oBox.addPoint( ocs.multiply( poAttrib->vertInsetionPoint ) );
+            oBox.addPoint( ocs.multiply( poAttrib->vertAlignmentPoint ) );
+            return true;
+        }
+        case CADObject::RAY:
+        {
+            auto poRay = static_cast<const CADRayObject *>( poObject );
+            oBox.addRay( poRay->vertPosition, poRay->vectVector );
+            return true;
+        }
+        case CADObject::XLINE:
+        {
+            auto      poXLine = static_cast<const CADXLineObject *>( poObject );
+            CADVector back( -poXLine->vectVector.getX(), -poXLine->vectVector.getY(), -poXLine->vectVector.getZ() );
+            oBox.addRay( poXLine->vertPosition, poXLine->vectVector );
+            oBox.addRay( poXLine->vertPosition, back );
+            return true;
+        }
+        case CADObject::IMAGE:
+        {
+            auto      poImage = static_cast<const CADImageObject *>( poObject );
+            CADVector u       = poImage->vectUDirection, v = poImage->vectVDirection;
+            double    dfWidth = poImage->dfSizeX, dfHeight = poImage->dfSizeY;
+            oBox.addRectangle( poImage->vertInsertion,
+                               CADVector( u.getX() * dfWidth, u.getY() * dfWidth, u.getZ() * dfWidth ),
+                               CADVector( v.getX() * dfHeight, v.getY() * dfHeight, v.getZ() * dfHeight ) );
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void DWGFileR2000::GetBoundingBoxes( size_t iLayerIndex, const long * padHandles, size_t nCount,
+                                     CADBoundingBox * paoBoxes )
+{
+    // Objects are read in chunks to keep memory usage low on huge layers.
+    const size_t nChunkSize = 4096;
+    std::vector<CADObject *> apoObjects( std::min( nCount, nChunkSize ) );
+    for( size_t iChunk = 0; iChunk < nCount; iChunk += nChunkSize )
+    {
+        size_t nChunkCount = std::min( nChunkSize, nCount - iChunk );
+        GetObjects( padHandles + iChunk, nChunkCount, apoObjects.data() );
+        for( size_t i = 0; i < nChunkCount; ++i )
+        {
+            unique_ptr<CADObject> poObject( apoObjects[i] );
+            if( nullptr == poObject )
+                continue;
+            if( !getEntityBoundingBox( poObject.get(), paoBoxes[iChunk + i] ) )
+            {
+                // Polylines with separate vertex objects and so on.
+                poObject.reset();
+                unique_ptr<CADGeometry> poGeometry( GetGeometry( iLayerIndex, padHandles[iChunk + i] ) );
+                if( nullptr != poGeometry )
+                    paoBoxes[iChunk + i] = poGeometry->getBoundingBox();
+            }
+        }
+    }
+}
+
 CADGeometry * DWGFileR2000::GetGeometry( size_t iLayerIndex, long dHandle, long dBlockRefHandle )
 {
     CADGeometry * poGeometry = nullptr;
@@ -1085,8 +1399,7 @@ CADGeometry * DWGFileR2000::GetGeometry( size_t iLayerIndex, long dHandle, long
             lwPolyline->setClosed(cadlwPolyline->bClosed );
             lwPolyline->setConstWidth(cadlwPolyline->dfConstWidth );
             lwPolyline->setElevation(cadlwPolyline->dfElevation );
-            for( const CADVector& vertex : cadlwPolyline->avertVertexes )
-                lwPolyline->addVertex(vertex );
+            lwPolyline->setVertexes( std::move( cadlwPolyline->avertVertexes ) );
             lwPolyline->setVectExtrusion(cadlwPolyline->vectExtrusion );
             lwPolyline->setWidths( cadlwPolyline->astWidths );
 
@@ -1180,10 +1493,12 @@ CADGeometry * DWGFileR2000::GetGeometry( size_t iLayerIndex, long dHandle, long
             CADAttribObject * cadAttrib = static_cast<CADAttribObject *>(
                     readedObject.get() );
 
-            attrib->setPosition( cadAttrib->vertInsetionPoint );
+            attrib->setPosition( CADVector( cadAttrib->vertInsetionPoint.getX(),
+                                        cadAttrib->vertInsetionPoint.getY(), cadAttrib->dfElevation ) );
             attrib->setExtrusion( cadAttrib->vectExtrusion );
             attrib->setRotationAngle( cadAttrib->dfRotationAng );
-            attrib->setAlignmentPoint( cadAttrib->vertAlignmentPoint );
+            attrib->setAlignmentPoint( CADVector( cadAttrib->vertAlignmentPoint.getX(),
+                                              cadAttrib->vertAlignmentPoint.getY(), cadAttrib->dfElevation ) );
             attrib->setElevation( cadAttrib->dfElevation );
             attrib->setHeight( cadAttrib->dfHeight );
             attrib->setObliqueAngle( cadAttrib->dfObliqueAng );
@@ -1202,10 +1517,12 @@ CADGeometry * DWGFileR2000::GetGeometry( size_t iLayerIndex, long dHandle, long
             CADAttdefObject * cadAttrib = static_cast<CADAttdefObject *>(
                     readedObject.get() );
 
-            attdef->setPosition( cadAttrib->vertInsetionPoint );
+            attdef->setPosition( CADVector( cadAttrib->vertInsetionPoint.getX(),
+                                        cadAttrib->vertInsetionPoint.getY(), cadAttrib->dfElevation ) );
             attdef->setExtrusion( cadAttrib->vectExtrusion );
             attdef->setRotationAngle( cadAttrib->dfRotationAng );
-            attdef->setAlignmentPoint( cadAttrib->vertAlignmentPoint );
+            attdef->setAlignmentPoint( CADVector( cadAttrib->vertAlignmentPoint.getX(),
+                                              cadAttrib->vertAlignmentPoint.getY(), cadAttrib->dfElevation ) );
             attdef->setElevation( cadAttrib->dfElevation );
             attdef->setHeight( cadAttrib->dfHeight );
             attdef->setObliqueAngle( cadAttrib->dfObliqueAng );
@@ -1227,6 +1544,7 @@ CADGeometry * DWGFileR2000::GetGeometry( size_t iLayerIndex, long dHandle, long
 
             ellipse->setPosition( cadEllipse->vertPosition );
             ellipse->setSMAxis( cadEllipse->vectSMAxis );
+            ellipse->setExtrusion( cadEllipse->vectExtrusion );
             ellipse->setAxisRatio( cadEllipse->dfAxisRatio );
             ellipse->setEndingAngle( cadEllipse->dfEndAngle );
             ellipse->setStartingAngle( cadEllipse->dfBegAngle );
@@ -1273,20 +1591,20 @@ CADGeometry * DWGFileR2000::GetGeometry( size_t iLayerIndex, long dHandle, long
             if( spline->getScenario() == 2 )
             {
                 spline->setFitTollerance( cadSpline->dfFitTol );
+                spline->setBegTangentDir( cadSpline->vectBegTangDir );
+                spline->setEndTangentDir( cadSpline->vectEndTangDir );
             } else if( spline->getScenario() == 1 )
             {
                 spline->setRational( cadSpline->bRational );
                 spline->setClosed( cadSpline->bClosed );
                 spline->setWeight( cadSpline->bWeight );
+                spline->setKnots( std::move( cadSpline->adfKnots ) );
             }
             for( double weight : cadSpline->adfCtrlPointsWeight )
                 spline->addControlPointsWeight( weight );
 
-            for( const CADVector& pt : cadSpline->averFitPoints )
-                spline->addFitPoint( pt );
-
-            for( const CADVector& pt : cadSpline->avertCtrlPoints )
-                spline->addControlPoint( pt );
+            spline->setFitPoints( std::move( cadSpline->averFitPoints ) );
+            spline->setControlPoints( std::move( cadSpline->avertCtrlPoints ) );
 
             poGeometry = spline;
             break;
@@ -1298,12 +1616,14 @@ CADGeometry * DWGFileR2000::GetGeometry( size_t iLayerIndex, long dHandle, long
             CADTextObject * cadText = static_cast<CADTextObject *>(
                     readedObject.get());
 
-            text->setPosition( cadText->vertInsetionPoint );
+            text->setPosition( CADVector( cadText->vertInsetionPoint.getX(),
+                                          cadText->vertInsetionPoint.getY(), cadText->dfElevation ) );
+            text->setExtrusion( cadText->vectExtrusion );
             text->setTextValue( cadText->sTextValue );
             text->setRotationAngle( cadText->dfRotationAng );
             text->setObliqueAngle( cadText->dfObliqueAng );
             text->setThickness( cadText->dfThickness );
-            text->setHeight( cadText->dfElevation );
+            text->setHeight( cadText->dfHeight );
 
             poGeometry = text;
             break;
@@ -1338,6 +1658,8 @@ CADGeometry * DWGFileR2000::GetGeometry( size_t iLayerIndex, long dHandle, long
             image->setClippingBoundaryType( cadImage->dClipBoundaryType );
             image->setFilePath( cadImageDef->sFilePath );
             image->setVertInsertionPoint( cadImage->vertInsertion );
+            image->setVectUDirection( cadImage->vectUDirection );
+            image->setVectVDirection( cadImage->vectVDirection );
             CADVector imageSize( cadImage->dfSizeX, cadImage->dfSizeY );
             image->setImageSize( imageSize );
             CADVector imageSizeInPx( cadImageDef->dfXImageSizeInPx, cadImageDef->dfYImageSizeInPx );
@@ -1382,6 +1704,11 @@ CADGeometry * DWGFileR2000::GetGeometry( size_t iLayerIndex, long dHandle, long
 
             mtext->setPosition( cadmText->vertInsertionPoint );
             mtext->setExtrusion( cadmText->vectExtrusion );
+            // Text direction is in WCS, the rotation is measured in OCS.
+            CADVector direction = Matrix::wcsToOcs( cadmText->vectExtrusion ).multiplyDirection(
+                    cadmText->vectXAxisDir );
+            mtext->setRotationAngle( atan2( direction.getY(), direction.getX() ) );
+            mtext->setAttachment( cadmText->dAttachment );
 
             mtext->setHeight( cadmText->dfTextHeight );
             mtext->setRectWidth( cadmText->dfRectWidth );
@@ -1480,6 +1807,8 @@ CADGeometry * DWGFileR2000::GetGeometry( size_t iLayerIndex, long dHandle, long
     if( poGeometry == nullptr )
         return nullptr;
 
+    poGeometry->transformFromOCS();
+
     // Applying color
     if( readedObject->stCed.nCMColor == 256 ) // BYLAYER CASE
     {
@@ -1604,7 +1933,7 @@ CADGeometry * DWGFileR2000::GetGeometry( size_t iLayerIndex, long dHandle, long
     }
 
     // Getting block reference attributes.
-    if( dBlockRefHandle != 0 )
+    if( dBlockRefHandle != 0 && !( oFilter.getDecodeFlags() & CADFilter::SKIP_ATTRIBUTES ) )
     {
         vector<CADAttrib>           blockRefAttributes;
         unique_ptr<CADInsertObject> spoBlockRef( static_cast<CADInsertObject *>( GetObject( dBlockRefHandle ) ) );
@@ -1674,7 +2003,7 @@ CADBlockObject * DWGFileR2000::getBlock( long dObjectSize, struct CADCommonED st
     pBlock->setSize( dObjectSize );
     pBlock->stCed = stCommonEntityData;
 
-    pBlock->sBlockName = ReadTV( pabyInput, nBitOffsetFromStart );
+    pBlock->sBlockName = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
 
     fillCommonEntityHandleData( pBlock, pabyInput, nBitOffsetFromStart );
 
@@ -1736,8 +2065,7 @@ CADSolidObject * DWGFileR2000::getSolid( long dObjectSize, CADCommonED stCommonE
     solid->setSize( dObjectSize );
     solid->stCed = stCommonEntityData;
 
-    solid->dfThickness = ReadBIT( pabyInput, nBitOffsetFromStart ) ? 0.0f : ReadBITDOUBLE( pabyInput,
-                                                                                           nBitOffsetFromStart );
+    solid->dfThickness = readBitThickness( pabyInput, nBitOffsetFromStart );
 
     solid->dfElevation = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
 
@@ -1749,14 +2077,7 @@ CADSolidObject * DWGFileR2000::getSolid( long dObjectSize, CADCommonED stCommonE
         solid->avertCorners.push_back( oCorner );
     }
 
-    if( ReadBIT( pabyInput, nBitOffsetFromStart ) )
-    {
-        solid->vectExtrusion = CADVector( 0.0f, 0.0f, 1.0f );
-    } else
-    {
-        CADVector vectExtrusion = ReadVector( pabyInput, nBitOffsetFromStart );
-        solid->vectExtrusion = vectExtrusion;
-    }
+    solid->vectExtrusion = readBitExtrusion( pabyInput, nBitOffsetFromStart );
 
 
     fillCommonEntityHandleData( solid, pabyInput, nBitOffsetFromStart );
@@ -1785,17 +2106,9 @@ CADPointObject * DWGFileR2000::getPoint( long dObjectSize, CADCommonED stCommonE
 
     point->vertPosition = vertPosition;
 
-    point->dfThickness = ReadBIT( pabyInput, nBitOffsetFromStart ) ? 0.0f : ReadBITDOUBLE( pabyInput,
-                                                                                           nBitOffsetFromStart );
+    point->dfThickness = readBitThickness( pabyInput, nBitOffsetFromStart );
 
-    if( ReadBIT( pabyInput, nBitOffsetFromStart ) )
-    {
-        point->vectExtrusion = CADVector( 0.0f, 0.0f, 1.0f );
-    } else
-    {
-        CADVector vectExtrusion = ReadVector( pabyInput, nBitOffsetFromStart );
-        point->vectExtrusion = vectExtrusion;
-    }
+    point->vectExtrusion = readBitExtrusion( pabyInput, nBitOffsetFromStart );
 
     point->dfXAxisAng = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
 
@@ -1935,17 +2248,9 @@ CADLineObject * DWGFileR2000::getLine( long dObjectSize, CADCommonED stCommonEnt
     line->vertStart = vertStart;
     line->vertEnd   = vertEnd;
 
-    line->dfThickness = ReadBIT( pabyInput, nBitOffsetFromStart ) ? 0.0f : ReadBITDOUBLE( pabyInput,
-                                                                                          nBitOffsetFromStart );
+    line->dfThickness = readBitThickness( pabyInput, nBitOffsetFromStart );
 
-    if( ReadBIT( pabyInput, nBitOffsetFromStart ) )
-    {
-        line->vectExtrusion = CADVector( 0.0f, 0.0f, 1.0f );
-    } else
-    {
-        CADVector vectExtrusion = ReadVector( pabyInput, nBitOffsetFromStart );
-        line->vectExtrusion = vectExtrusion;
-    }
+    line->vectExtrusion = readBitExtrusion( pabyInput, nBitOffsetFromStart );
 
     fillCommonEntityHandleData( line, pabyInput, nBitOffsetFromStart );
 
@@ -1986,17 +2291,9 @@ CADTextObject * DWGFileR2000::getText( long dObjectSize, CADCommonED stCommonEnt
         text->vertAlignmentPoint = vertAlignmentPoint;
     }
 
-    if( ReadBIT( pabyInput, nBitOffsetFromStart ) )
-    {
-        text->vectExtrusion = CADVector( 0.0f, 0.0f, 1.0f );
-    } else
-    {
-        CADVector vectExtrusion = ReadVector( pabyInput, nBitOffsetFromStart );
-        text->vectExtrusion = vectExtrusion;
-    }
+    text->vectExtrusion = readBitExtrusion( pabyInput, nBitOffsetFromStart );
 
-    text->dfThickness = ReadBIT( pabyInput, nBitOffsetFromStart ) ? 0.0f : ReadBITDOUBLE( pabyInput,
-                                                                                          nBitOffsetFromStart );
+    text->dfThickness = readBitThickness( pabyInput, nBitOffsetFromStart );
 
     if( !( text->DataFlags & 0x04 ) )
         text->dfObliqueAng  = ReadRAWDOUBLE( pabyInput, nBitOffsetFromStart );
@@ -2008,7 +2305,7 @@ CADTextObject * DWGFileR2000::getText( long dObjectSize, CADCommonED stCommonEnt
     if( !( text->DataFlags & 0x10 ) )
         text->dfWidthFactor = ReadRAWDOUBLE( pabyInput, nBitOffsetFromStart );
 
-    text->sTextValue = ReadTV( pabyInput, nBitOffsetFromStart );
+    text->sTextValue = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
 
     if( !( text->DataFlags & 0x20 ) )
         text->dGeneration = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
@@ -2110,17 +2407,9 @@ CADCircleObject * DWGFileR2000::getCircle( long dObjectSize, CADCommonED stCommo
     CADVector vertPosition = ReadVector( pabyInput, nBitOffsetFromStart );
     circle->vertPosition = vertPosition;
     circle->dfRadius     = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
-    circle->dfThickness  = ReadBIT( pabyInput, nBitOffsetFromStart ) ? 0.0f : ReadBITDOUBLE( pabyInput,
-                                                                                             nBitOffsetFromStart );
+    circle->dfThickness  = readBitThickness( pabyInput, nBitOffsetFromStart );
 
-    if( ReadBIT( pabyInput, nBitOffsetFromStart ) )
-    {
-        circle->vectExtrusion = CADVector( 0.0f, 0.0f, 1.0f );
-    } else
-    {
-        CADVector vectExtrusion = ReadVector( pabyInput, nBitOffsetFromStart );
-        circle->vectExtrusion = vectExtrusion;
-    }
+    circle->vectExtrusion = readBitExtrusion( pabyInput, nBitOffsetFromStart );
 
     fillCommonEntityHandleData( circle, pabyInput, nBitOffsetFromStart );
 
@@ -2181,19 +2470,11 @@ CADPolyline2DObject * DWGFileR2000::getPolyline2D( long dObjectSize, CADCommonED
     polyline->dfStartWidth = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
     polyline->dfEndWidth   = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
 
-    polyline->dfThickness = ReadBIT( pabyInput, nBitOffsetFromStart ) ? 0.0f : ReadBITDOUBLE( pabyInput,
-                                                                                              nBitOffsetFromStart );
+    polyline->dfThickness = readBitThickness( pabyInput, nBitOffsetFromStart );
 
     polyline->dfElevation = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
 
-    if( ReadBIT( pabyInput, nBitOffsetFromStart ) )
-    {
-        polyline->vectExtrusion = CADVector( 0.0f, 0.0f, 1.0f );
-    } else
-    {
-        CADVector vectExtrusion = ReadVector( pabyInput, nBitOffsetFromStart );
-        polyline->vectExtrusion = vectExtrusion;
-    }
+    polyline->vectExtrusion = readBitExtrusion( pabyInput, nBitOffsetFromStart );
 
     fillCommonEntityHandleData( polyline, pabyInput, nBitOffsetFromStart );
 
@@ -2238,17 +2519,9 @@ CADAttribObject * DWGFileR2000::getAttributes( long dObjectSize, CADCommonED stC
         attrib->vertAlignmentPoint = vertAlignmentPoint;
     }
 
-    if( ReadBIT( pabyInput, nBitOffsetFromStart ) )
-    {
-        attrib->vectExtrusion = CADVector( 0.0f, 0.0f, 1.0f );
-    } else
-    {
-        CADVector vectExtrusion = ReadVector( pabyInput, nBitOffsetFromStart );
-        attrib->vectExtrusion = vectExtrusion;
-    }
+    attrib->vectExtrusion = readBitExtrusion( pabyInput, nBitOffsetFromStart );
 
-    attrib->dfThickness = ReadBIT( pabyInput, nBitOffsetFromStart ) ? 0.0f : ReadBITDOUBLE( pabyInput,
-                                                                                            nBitOffsetFromStart );
+    attrib->dfThickness = readBitThickness( pabyInput, nBitOffsetFromStart );
 
     if( !( attrib->DataFlags & 0x04 ) )
         attrib->dfObliqueAng  = ReadRAWDOUBLE( pabyInput, nBitOffsetFromStart );
@@ -2257,7 +2530,7 @@ CADAttribObject * DWGFileR2000::getAttributes( long dObjectSize, CADCommonED stC
     attrib->dfHeight          = ReadRAWDOUBLE( pabyInput, nBitOffsetFromStart );
     if( !( attrib->DataFlags & 0x10 ) )
         attrib->dfWidthFactor = ReadRAWDOUBLE( pabyInput, nBitOffsetFromStart );
-    attrib->sTextValue        = ReadTV( pabyInput, nBitOffsetFromStart );
+    attrib->sTextValue        = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     if( !( attrib->DataFlags & 0x20 ) )
         attrib->dGeneration   = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
     if( !( attrib->DataFlags & 0x40 ) )
@@ -2265,7 +2538,7 @@ CADAttribObject * DWGFileR2000::getAttributes( long dObjectSize, CADCommonED stC
     if( !( attrib->DataFlags & 0x80 ) )
         attrib->dVertAlign    = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
 
-    attrib->sTag         = ReadTV( pabyInput, nBitOffsetFromStart );
+    attrib->sTag         = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     attrib->nFieldLength = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
     attrib->nFlags       = ReadCHAR( pabyInput, nBitOffsetFromStart );
 
@@ -2307,17 +2580,9 @@ CADAttdefObject * DWGFileR2000::getAttributesDefn( long dObjectSize, CADCommonED
         attdef->vertAlignmentPoint = vertAlignmentPoint;
     }
 
-    if( ReadBIT( pabyInput, nBitOffsetFromStart ) )
-    {
-        attdef->vectExtrusion = CADVector( 0.0f, 0.0f, 1.0f );
-    } else
-    {
-        CADVector vectExtrusion = ReadVector( pabyInput, nBitOffsetFromStart );
-        attdef->vectExtrusion = vectExtrusion;
-    }
+    attdef->vectExtrusion = readBitExtrusion( pabyInput, nBitOffsetFromStart );
 
-    attdef->dfThickness = ReadBIT( pabyInput, nBitOffsetFromStart ) ? 0.0f : ReadBITDOUBLE( pabyInput,
-                                                                                            nBitOffsetFromStart );
+    attdef->dfThickness = readBitThickness( pabyInput, nBitOffsetFromStart );
 
     if( !( attdef->DataFlags & 0x04 ) )
         attdef->dfObliqueAng  = ReadRAWDOUBLE( pabyInput, nBitOffsetFromStart );
@@ -2326,7 +2591,7 @@ CADAttdefObject * DWGFileR2000::getAttributesDefn( long dObjectSize, CADCommonED
     attdef->dfHeight          = ReadRAWDOUBLE( pabyInput, nBitOffsetFromStart );
     if( !( attdef->DataFlags & 0x10 ) )
         attdef->dfWidthFactor = ReadRAWDOUBLE( pabyInput, nBitOffsetFromStart );
-    attdef->sTextValue        = ReadTV( pabyInput, nBitOffsetFromStart );
+    attdef->sTextValue        = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     if( !( attdef->DataFlags & 0x20 ) )
         attdef->dGeneration   = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
     if( !( attdef->DataFlags & 0x40 ) )
@@ -2334,11 +2599,11 @@ CADAttdefObject * DWGFileR2000::getAttributesDefn( long dObjectSize, CADCommonED
     if( !( attdef->DataFlags & 0x80 ) )
         attdef->dVertAlign    = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
 
-    attdef->sTag         = ReadTV( pabyInput, nBitOffsetFromStart );
+    attdef->sTag         = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     attdef->nFieldLength = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
     attdef->nFlags       = ReadCHAR( pabyInput, nBitOffsetFromStart );
 
-    attdef->sPrompt = ReadTV( pabyInput, nBitOffsetFromStart );
+    attdef->sPrompt = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
 
     fillCommonEntityHandleData( attdef, pabyInput, nBitOffsetFromStart );
 
@@ -2362,7 +2627,6 @@ CADLWPolylineObject * DWGFileR2000::getLWPolyLine( long dObjectSize, CADCommonED
     polyline->setSize( dObjectSize );
     polyline->stCed = stCommonEntityData;
 
-    double x             = 0.0, y = 0.0;
     int    vertixesCount = 0, nBulges = 0, nNumWidths = 0;
     short  dataFlag      = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
     if( dataFlag & 4 )
@@ -2378,20 +2642,12 @@ CADLWPolylineObject * DWGFileR2000::getLWPolyLine( long dObjectSize, CADCommonED
     }
 
     vertixesCount = ReadBITLONG( pabyInput, nBitOffsetFromStart );
-    polyline->avertVertexes.reserve( vertixesCount );
-
     if( dataFlag & 16 )
-    {
         nBulges = ReadBITLONG( pabyInput, nBitOffsetFromStart );
-        polyline->adfBulges.reserve( nBulges );
-    }
 
     // TODO: tell ODA that R2000 contains nNumWidths flag
     if( dataFlag & 32 )
-    {
         nNumWidths = ReadBITLONG( pabyInput, nBitOffsetFromStart );
-        polyline->astWidths.reserve( nNumWidths );
-    }
 
     if( dataFlag & 512 )
     {
@@ -2399,34 +2655,32 @@ CADLWPolylineObject * DWGFileR2000::getLWPolyLine( long dObjectSize, CADCommonED
     } else
         polyline->bClosed = false;
 
-    // First of all, read first vertex.
-    CADVector vertex = ReadRAWVector( pabyInput, nBitOffsetFromStart );
-    polyline->avertVertexes.push_back( vertex );
-
-    // All the others are not raw doubles; bitdoubles with default instead,
-    // where default is previous point coords.
-    size_t   prev;
-    for( int i       = 1; i < vertixesCount; ++i )
+    // First vertex is a pair of raw doubles. All the others are bitdoubles
+    // with default, where default is previous point coords.
+    if( vertixesCount > 0 )
     {
-        prev = size_t( i - 1 );
-        x    = ReadBITDOUBLEWD( pabyInput, nBitOffsetFromStart, polyline->avertVertexes[prev].getX() );
-        y    = ReadBITDOUBLEWD( pabyInput, nBitOffsetFromStart, polyline->avertVertexes[prev].getY() );
-        vertex.setX( x );
-        vertex.setY( y );
-        polyline->avertVertexes.push_back( vertex );
+        vector<double> adfX( vertixesCount ), adfY( vertixesCount );
+        double adfFirst[2];
+        ReadRAWDOUBLEs( pabyInput, nBitOffsetFromStart, adfFirst, 2 );
+        adfX[0] = adfFirst[0];
+        adfY[0] = adfFirst[1];
+        ReadBITDOUBLEWDPoints( pabyInput, nBitOffsetFromStart, adfX.data(), adfY.data(), vertixesCount );
+        polyline->avertVertexes.assign( std::move( adfX ), std::move( adfY ) );
     }
 
-    for( int i = 0; i < nBulges; ++i )
+    if( nBulges > 0 )
     {
-        double dfBulgeValue = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
-        polyline->adfBulges.push_back( dfBulgeValue );
+        polyline->adfBulges.resize( nBulges );
+        ReadBITDOUBLEs( pabyInput, nBitOffsetFromStart, polyline->adfBulges.data(), nBulges );
     }
 
-    for( int i = 0; i < nNumWidths; ++i )
+    if( nNumWidths > 0 )
     {
-        double dfStartWidth = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
-        double dfEndWidth   = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
-        polyline->astWidths.push_back( make_pair( dfStartWidth, dfEndWidth ) );
+        vector<double> adfWidths( nNumWidths * 2 );
+        ReadBITDOUBLEs( pabyInput, nBitOffsetFromStart, adfWidths.data(), adfWidths.size() );
+        polyline->astWidths.reserve( nNumWidths );
+        for( int i = 0; i < nNumWidths; ++i )
+            polyline->astWidths.push_back( make_pair( adfWidths[i * 2], adfWidths[i * 2 + 1] ) );
     }
 
     fillCommonEntityHandleData( polyline, pabyInput, nBitOffsetFromStart );
@@ -2453,17 +2707,9 @@ CADArcObject * DWGFileR2000::getArc( long dObjectSize, CADCommonED stCommonEntit
     CADVector vertPosition = ReadVector( pabyInput, nBitOffsetFromStart );
     arc->vertPosition = vertPosition;
     arc->dfRadius     = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
-    arc->dfThickness  = ReadBIT( pabyInput, nBitOffsetFromStart ) ? 0.0f : ReadBITDOUBLE( pabyInput,
-                                                                                          nBitOffsetFromStart );
+    arc->dfThickness  = readBitThickness( pabyInput, nBitOffsetFromStart );
 
-    if( ReadBIT( pabyInput, nBitOffsetFromStart ) )
-    {
-        arc->vectExtrusion = CADVector( 0.0f, 0.0f, 1.0f );
-    } else
-    {
-        CADVector vectExtrusion = ReadVector( pabyInput, nBitOffsetFromStart );
-        arc->vectExtrusion = vectExtrusion;
-    }
+    arc->vectExtrusion = readBitExtrusion( pabyInput, nBitOffsetFromStart );
 
     arc->dfStartAngle = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
     arc->dfEndAngle   = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
@@ -2498,7 +2744,6 @@ CADSplineObject * DWGFileR2000::getSpline( long dObjectSize, CADCommonED stCommo
         spline->vectEndTangDir = vectEndTangDir;
 
         spline->nNumFitPts = ReadBITLONG( pabyInput, nBitOffsetFromStart );
-        spline->averFitPoints.reserve( spline->nNumFitPts );
     } else if( spline->dScenario == 1 )
     {
         spline->bRational = ReadBIT( pabyInput, nBitOffsetFromStart );
@@ -2507,14 +2752,9 @@ CADSplineObject * DWGFileR2000::getSpline( long dObjectSize, CADCommonED stCommo
         spline->dfKnotTol = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
         spline->dfCtrlTol = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
 
-        spline->nNumKnots = ReadBITLONG( pabyInput, nBitOffsetFromStart );
-        spline->adfKnots.reserve( spline->nNumKnots );
-
+        spline->nNumKnots   = ReadBITLONG( pabyInput, nBitOffsetFromStart );
         spline->nNumCtrlPts = ReadBITLONG( pabyInput, nBitOffsetFromStart );
-        spline->avertCtrlPoints.reserve( spline->nNumCtrlPts );
-        if( spline->bWeight ) spline->adfCtrlPointsWeight.reserve( spline->nNumCtrlPts );
-
-        spline->bWeight = ReadBIT( pabyInput, nBitOffsetFromStart );
+        spline->bWeight     = ReadBIT( pabyInput, nBitOffsetFromStart );
     }
 #ifdef _DEBUG
     else
@@ -2522,19 +2762,49 @@ CADSplineObject * DWGFileR2000::getSpline( long dObjectSize, CADCommonED stCommo
         DebugMsg( "Spline scenario != {1,2} readed: error." );
     }
 #endif
-    for( long i = 0; i < spline->nNumKnots; ++i )
-        spline->adfKnots.push_back( ReadBITDOUBLE( pabyInput, nBitOffsetFromStart ) );
-    for( long i = 0; i < spline->nNumCtrlPts; ++i )
+    if( spline->nNumKnots > 0 )
+    {
+        spline->adfKnots.resize( spline->nNumKnots );
+        ReadBITDOUBLEs( pabyInput, nBitOffsetFromStart, spline->adfKnots.data(), spline->adfKnots.size() );
+    }
+
+    // Control points are 3BD followed by BD weight for rational splines,
+    // fit points are 3BD. Each run is decoded at once and split into X, Y, Z.
+    vector<double> adfValues;
+    if( spline->nNumCtrlPts > 0 )
     {
-        CADVector vertex = ReadVector( pabyInput, nBitOffsetFromStart );
-        spline->avertCtrlPoints.push_back( vertex );
+        size_t nCount  = spline->nNumCtrlPts;
+        size_t nStride = spline->bWeight ? 4 : 3;
+        adfValues.resize( nCount * nStride );
+        ReadBITDOUBLEs( pabyInput, nBitOffsetFromStart, adfValues.data(), adfValues.size() );
+
+        vector<double> adfX( nCount ), adfY( nCount ), adfZ( nCount );
         if( spline->bWeight )
-            spline->adfCtrlPointsWeight.push_back( ReadBITDOUBLE( pabyInput, nBitOffsetFromStart ) );
+            spline->adfCtrlPointsWeight.resize( nCount );
+        for( size_t i = 0; i < nCount; ++i )
+        {
+            adfX[i] = adfValues[i * nStride];
+            adfY[i] = adfValues[i * nStride + 1];
+            adfZ[i] = adfValues[i * nStride + 2];
+            if( spline->bWeight )
+                spline->adfCtrlPointsWeight[i] = adfValues[i * nStride + 3];
+        }
+        spline->avertCtrlPoints.assign( std::move( adfX ), std::move( adfY ), std::move( adfZ ) );
     }
-    for( long i = 0; i < spline->nNumFitPts; ++i )
+    if( spline->nNumFitPts > 0 )
     {
-        CADVector vertex = ReadVector( pabyInput, nBitOffsetFromStart );
-        spline->averFitPoints.push_back( vertex );
+        size_t nCount = spline->nNumFitPts;
+        adfValues.resize( nCount * 3 );
+        ReadBITDOUBLEs( pabyInput, nBitOffsetFromStart, adfValues.data(), adfValues.size() );
+
+        vector<double> adfX( nCount ), adfY( nCount ), adfZ( nCount );
+        for( size_t i = 0; i < nCount; ++i )
+        {
+            adfX[i] = adfValues[i * 3];
+            adfY[i] = adfValues[i * 3 + 1];
+            adfZ[i] = adfValues[i * 3 + 2];
+        }
+        spline->averFitPoints.assign( std::move( adfX ), std::move( adfY ), std::move( adfZ ) );
     }
 
     fillCommonEntityHandleData( spline, pabyInput, nBitOffsetFromStart );
@@ -2666,7 +2936,7 @@ CADDictionaryObject * DWGFileR2000::getDictionary( long dObjectSize, const char
     dictionary->dHardOwnerFlag = ReadCHAR( pabyInput, nBitOffsetFromStart );
 
     for( long i = 0; i < dictionary->nNumItems; ++i )
-        dictionary->sItemNames.push_back( ReadTV( pabyInput, nBitOffsetFromStart ) );
+        dictionary->sItemNames.push_back( ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable ) );
 
     dictionary->hParentHandle = ReadHANDLE( pabyInput, nBitOffsetFromStart );
 
@@ -2711,7 +2981,7 @@ CADLayerObject * DWGFileR2000::getLayerObject( long dObjectSize, const char * pa
     }
 
     layer->nNumReactors = ReadBITLONG( pabyInput, nBitOffsetFromStart );
-    layer->sLayerName   = ReadTV( pabyInput, nBitOffsetFromStart );
+    layer->sLayerName   = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     layer->b64Flag      = ReadBIT( pabyInput, nBitOffsetFromStart );
     layer->dXRefIndex   = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
     layer->bXDep        = ReadBIT( pabyInput, nBitOffsetFromStart );
@@ -2863,7 +3133,7 @@ CADBlockHeaderObject * DWGFileR2000::getBlockHeader( long dObjectSize, const cha
     }
 
     blockHeader->nNumReactors  = ReadBITLONG( pabyInput, nBitOffsetFromStart );
-    blockHeader->sEntryName    = ReadTV( pabyInput, nBitOffsetFromStart );
+    blockHeader->sEntryName    = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     blockHeader->b64Flag       = ReadBIT( pabyInput, nBitOffsetFromStart );
     blockHeader->dXRefIndex    = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
     blockHeader->bXDep         = ReadBIT( pabyInput, nBitOffsetFromStart );
@@ -2875,7 +3145,7 @@ CADBlockHeaderObject * DWGFileR2000::getBlockHeader( long dObjectSize, const cha
 
     CADVector vertBasePoint = ReadVector( pabyInput, nBitOffsetFromStart );
     blockHeader->vertBasePoint = vertBasePoint;
-    blockHeader->sXRefPName    = ReadTV( pabyInput, nBitOffsetFromStart );
+    blockHeader->sXRefPName    = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     unsigned char Tmp;
     do
     {
@@ -2883,7 +3153,7 @@ CADBlockHeaderObject * DWGFileR2000::getBlockHeader( long dObjectSize, const cha
         blockHeader->adInsertCount.push_back( Tmp );
     } while( Tmp != 0 );
 
-    blockHeader->sBlockDescription  = ReadTV( pabyInput, nBitOffsetFromStart );
+    blockHeader->sBlockDescription  = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     blockHeader->nSizeOfPreviewData = ReadBITLONG( pabyInput, nBitOffsetFromStart );
     for( long i = 0; i < blockHeader->nSizeOfPreviewData; ++i )
         blockHeader->abyBinaryPreviewData.push_back( ReadCHAR( pabyInput, nBitOffsetFromStart ) );
@@ -2982,11 +3252,11 @@ CADLineTypeObject * DWGFileR2000::getLineType1( long dObjectSize, const char * p
     }
 
     ltype->nNumReactors = ReadBITLONG( pabyInput, nBitOffsetFromStart );
-    ltype->sEntryName   = ReadTV( pabyInput, nBitOffsetFromStart );
+    ltype->sEntryName   = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     ltype->b64Flag      = ReadBIT( pabyInput, nBitOffsetFromStart );
     ltype->dXRefIndex   = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
     ltype->bXDep        = ReadBIT( pabyInput, nBitOffsetFromStart );
-    ltype->sDescription = ReadTV( pabyInput, nBitOffsetFromStart );
+    ltype->sDescription = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     ltype->dfPatternLen = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
     ltype->dAlignment   = ReadCHAR( pabyInput, nBitOffsetFromStart );
     ltype->nNumDashes   = ReadCHAR( pabyInput, nBitOffsetFromStart );
@@ -3319,7 +3589,7 @@ CADMTextObject * DWGFileR2000::getMText( long dObjectSize, CADCommonED stCommonE
     text->dDrawingDir        = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
     text->dfExtents          = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
     text->dfExtentsWidth     = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
-    text->sTextValue         = ReadTV( pabyInput, nBitOffsetFromStart );
+    text->sTextValue         = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     text->dLineSpacingStyle  = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
     text->dLineSpacingFactor = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
     text->bUnknownBit        = ReadBIT( pabyInput, nBitOffsetFromStart );
@@ -3350,7 +3620,7 @@ CADDimensionObject * DWGFileR2000::getDimension( short dObjectType, long dObject
     stCDD.dfElevation = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
     stCDD.dFlags      = ReadCHAR( pabyInput, nBitOffsetFromStart );
 
-    stCDD.sUserText      = ReadTV( pabyInput, nBitOffsetFromStart );
+    stCDD.sUserText      = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     stCDD.dfTextRotation = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
     stCDD.dfHorizDir     = ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
 
@@ -3639,7 +3909,7 @@ CADImageDefObject * DWGFileR2000::getImageDef( long dObjectSize, const char * pa
     imagedef->dfXImageSizeInPx = ReadRAWDOUBLE( pabyInput, nBitOffsetFromStart );
     imagedef->dfYImageSizeInPx = ReadRAWDOUBLE( pabyInput, nBitOffsetFromStart );
 
-    imagedef->sFilePath = ReadTV( pabyInput, nBitOffsetFromStart );
+    imagedef->sFilePath = ReadTV( pabyInput, nBitOffsetFromStart, panCodePageTable );
     imagedef->bIsLoaded = ReadBIT( pabyInput, nBitOffsetFromStart );
 
     imagedef->dResUnits = ReadCHAR( pabyInput, nBitOffsetFromStart );
@@ -3788,16 +4058,52 @@ CADXRecordObject * DWGFileR2000::getXRecord( long dObjectSize, const char * paby
     return xrecord;
 }
 
+double DWGFileR2000::readBitThickness( const char * pabyInput, size_t& nBitOffsetFromStart )
+{
+    if( ReadBIT( pabyInput, nBitOffsetFromStart ) )
+        return 0.0;
+    if( oFilter.getDecodeFlags() & CADFilter::SKIP_EXTRUSION )
+    {
+        SkipBITDOUBLE( pabyInput, nBitOffsetFromStart );
+        return 0.0;
+    }
+    return ReadBITDOUBLE( pabyInput, nBitOffsetFromStart );
+}
+
+CADVector DWGFileR2000::readBitExtrusion( const char * pabyInput, size_t& nBitOffsetFromStart )
+{
+    if( !ReadBIT( pabyInput, nBitOffsetFromStart ) )
+    {
+        if( !( oFilter.getDecodeFlags() & CADFilter::SKIP_EXTRUSION ) )
+            return ReadVector( pabyInput, nBitOffsetFromStart );
+        SkipBITDOUBLE( pabyInput, nBitOffsetFromStart );
+        SkipBITDOUBLE( pabyInput, nBitOffsetFromStart );
+        SkipBITDOUBLE( pabyInput, nBitOffsetFromStart );
+    }
+    return CADVector( 0.0f, 0.0f, 1.0f );
+}
+
 void DWGFileR2000::fillCommonEntityHandleData( CADEntityObject * pEnt, const char * pabyInput,
                                                size_t& nBitOffsetFromStart )
 {
     if( pEnt->stCed.bbEntMode == 0 )
         pEnt->stChed.hOwner = ReadHANDLE( pabyInput, nBitOffsetFromStart );
 
-    for( long i = 0; i < pEnt->stCed.nNumReactors; ++i )
-        pEnt->stChed.hReactors.push_back( ReadHANDLE( pabyInput, nBitOffsetFromStart ) );
+    if( oFilter.getDecodeFlags() & CADFilter::SKIP_REACTORS )
+    {
+        for( long i = 0; i < pEnt->stCed.nNumReactors; ++i )
+            SkipHANDLE( pabyInput, nBitOffsetFromStart );
+    } else
+    {
+        pEnt->stChed.hReactors.reserve( pEnt->stCed.nNumReactors );
+        for( long i = 0; i < pEnt->stCed.nNumReactors; ++i )
+            pEnt->stChed.hReactors.push_back( ReadHANDLE( pabyInput, nBitOffsetFromStart ) );
+    }
 
-    pEnt->stChed.hXDictionary = ReadHANDLE( pabyInput, nBitOffsetFromStart );
+    if( oFilter.getDecodeFlags() & CADFilter::SKIP_XDICT )
+        SkipHANDLE( pabyInput, nBitOffsetFromStart );
+    else
+        pEnt->stChed.hXDictionary = ReadHANDLE( pabyInput, nBitOffsetFromStart );
 
     if( !pEnt->stCed.bNoLinks )
     {
@@ -3814,13 +4120,20 @@ void DWGFileR2000::fillCommonEntityHandleData( CADEntityObject * pEnt, const cha
         pEnt->stChed.hPlotStyle = ReadHANDLE( pabyInput, nBitOffsetFromStart );
 }
 
-DWGFileR2000::DWGFileR2000( CADFileIO * poFileIO ) : CADFile( poFileIO )
+DWGFileR2000::DWGFileR2000( CADFileIO * poFileIO ) : CADFile( poFileIO ), imageSeeker( 0 ),
+                                                     panCodePageTable( nullptr ), nObjectBufferOffset( 0 ),
+                                                     nObjectBufferSize( 0 ), nNextAsyncReadId( 0 )
 {
     oHeader.addValue( CADHeader::OPENCADVER, CADVersions::DWG_R2000 );
 }
 
 DWGFileR2000::~DWGFileR2000()
 {
+    // Buffers must outlive the reads kernel may still perform.
+    while( !mapAsyncReads.empty() && completeAsyncRead() )
+        ;
+    for( auto& oCompleted : aCompletedObjects )
+        delete oCompleted.second;
 }
 
 int DWGFileR2000::ReadSectionLocators()
@@ -3845,6 +4158,7 @@ int DWGFileR2000::ReadSectionLocators()
     pFileIO->Seek( 2, CADFileIO::SeekOrigin::CUR ); // 19
     pFileIO->Read( & dCodePage, 2 );
     oHeader.addValue( CADHeader::DWGCODEPAGE, dCodePage );
+    panCodePageTable = GetCodePageTable( dCodePage );
 
     DebugMsg( "DWG Code page: %d\n", dCodePage );
 
@@ -3874,9 +4188,16 @@ CADDictionary DWGFileR2000::GetNOD()
     unique_ptr<CADDictionaryObject> spoNamedDictObj(
             ( CADDictionaryObject * ) GetObject( oTables.GetTableHandle( CADTables::NamedObjectsDict ).getAsLong() ) );
 
+    vector<long> adItemHandles;
+    for( size_t i = 0; i < spoNamedDictObj->sItemNames.size(); ++i )
+        adItemHandles.push_back( spoNamedDictObj->hItemHandles[i].getAsLong() );
+
+    vector<CADObject *> apoDictRecords( adItemHandles.size(), nullptr );
+    GetObjects( adItemHandles.data(), adItemHandles.size(), apoDictRecords.data() );
+
     for( size_t i = 0; i < spoNamedDictObj->sItemNames.size(); ++i )
     {
-        unique_ptr<CADObject> spoDictRecord( GetObject( spoNamedDictObj->hItemHandles[i].getAsLong() ) );
+        unique_ptr<CADObject> spoDictRecord( apoDictRecords[i] );
 
         if( spoDictRecord == nullptr ) continue; // skip unreaded objects
 
@@ -33,6 +33,21 @@
 
 #include "cadfile.h"
 
+/**
+ * Size of the chunk GetObject() reads at once. Most of the objects fit in it,
+ * bigger ones need one more read.
+ */
+#ifndef DWG_OBJECT_READ_AHEAD
+#define DWG_OBJECT_READ_AHEAD 512
+#endif
+
+/**
+ * Maximum size of the file range GetObjects() reads at once.
+ */
+#ifndef DWG_OBJECTS_BATCH_MAX_SIZE
+#define DWG_OBJECTS_BATCH_MAX_SIZE ( 1024 * 1024 )
+#endif
+
 struct SectionLocatorRecord
 {
     char byRecordNumber = 0;
@@ -74,12 +89,26 @@ struct DWG2000Cehd
     CADHandle hplotstyle;
 };
 
+/**
+ * Range of the file read asynchronously, with objects to decode from it.
+ */
+struct DWGAsyncRead
+{
+    long              nOffset      = 0;
+    bool              bHandlesOnly = false;
+    std::vector<long> adHandles;
+    std::vector<char> abyData;
+};
+
 class DWGFileR2000 : public CADFile
 {
 public:
     DWGFileR2000( CADFileIO * poFileIO );
     virtual             ~DWGFileR2000();
 
+    bool          GetObjectAsync( long dHandle, bool bHandlesOnly = false ) override;
+    bool          GetCompletedObject( long& dHandle, CADObject *& poObject ) override;
+
 protected:
     virtual int ReadSectionLocators() override;
     virtual int ReadHeader( enum OpenOptions eOptions ) override;
@@ -87,7 +116,11 @@ protected:
     virtual int CreateFileMap() override;
 
     CADObject   * GetObject( long dHandle, bool bHandlesOnly = false ) override;
+    void          GetObjects( const long * padHandles, size_t nCount, CADObject ** papoObjects,
+                              bool bHandlesOnly = false ) override;
     CADGeometry * GetGeometry( size_t iLayerIndex, long dHandle, long dBlockRefHandle = 0 ) override;
+    void          GetBoundingBoxes( size_t iLayerIndex, const long * padHandles, size_t nCount,
+                                    CADBoundingBox * paoBoxes ) override;
 
     CADDictionary GetNOD() override;
 protected:
@@ -161,11 +194,37 @@ protected:
     CADImageDefObject        * getImageDef( long dObjectSize, const char * pabyInput, size_t& nBitOffsetFromStart );
     CADImageDefReactorObject * getImageDefReactor( long dObjectSize, const char * pabyInput,
                                                    size_t& nBitOffsetFromStart );
+    double                   readBitThickness( const char * pabyInput, size_t& nBitOffsetFromStart );
+    CADVector                readBitExtrusion( const char * pabyInput, size_t& nBitOffsetFromStart );
     void                     fillCommonEntityHandleData( CADEntityObject * pEnt, const char * pabyInput,
                                                          size_t& nBitOffsetFromStart );
+    /**
+     * @brief Makes nSize bytes of the file starting from nOffset available in
+     *        abyObjectBuffer, reading them only if buffer doesn't contain them yet.
+     * @return false if file is too short
+     */
+    bool                     fillObjectBuffer( long nOffset, size_t nSize );
+    /**
+     * @brief Queues asynchronous read of the file range. Objects from adHandles
+     *        are decoded when read completes.
+     */
+    void                     submitAsyncRead( long nOffset, size_t nSize, const std::vector<long>& adHandles,
+                                              bool bHandlesOnly );
+    /**
+     * @brief Waits for one of the reads queued by submitAsyncRead() and decodes its objects
+     * @return false if there is nothing to wait for
+     */
+    bool                     completeAsyncRead();
 protected:
     int                               imageSeeker;
     std::vector<SectionLocatorRecord> sectionLocatorRecords;
+    const unsigned short            * panCodePageTable; // $DWGCODEPAGE to unicode, nullptr if no transcoding
+    std::vector<char>                 abyObjectBuffer; // reused by GetObject() for every object
+    long                              nObjectBufferOffset;
+    size_t                            nObjectBufferSize;
+    size_t                            nNextAsyncReadId;
+    std::map<size_t, DWGAsyncRead>    mapAsyncReads; // request id <-> read
+    std::deque<std::pair<long, CADObject *> > aCompletedObjects; // decoded, but not returned yet
 };
 
 #endif // DWG_R2000_H_H
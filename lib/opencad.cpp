@@ -86,6 +86,20 @@ static int CheckCADFile(CADFileIO * pCADFileIO)
  * @return CADFile pointer or NULL if failed. The pointer have to be freed by user
  */
 CADFile * OpenCADFile( CADFileIO * pCADFileIO, enum CADFile::OpenOptions eOptions, bool bReadUnsupportedGeometries )
+{
+    return OpenCADFile( pCADFileIO, eOptions, CADFilter(), bReadUnsupportedGeometries );
+}
+
+/**
+ * @brief Open CAD file
+ * @param pCADFileIO CAD file reader pointer ownd by function
+ * @param eOptions Open options
+ * @param oFilter Only geometries passed the filter are read into layers
+ * @param bReadUnsupportedGeometries Unsupported geoms will be returned as CADUnknown
+ * @return CADFile pointer or NULL if failed. The pointer have to be freed by user
+ */
+CADFile * OpenCADFile( CADFileIO * pCADFileIO, enum CADFile::OpenOptions eOptions, const CADFilter& oFilter,
+                       bool bReadUnsupportedGeometries )
 {
     int nCADFileVersion = CheckCADFile( pCADFileIO );
     CADFile * poCAD = nullptr;
@@ -101,6 +115,7 @@ CADFile * OpenCADFile( CADFileIO * pCADFileIO, enum CADFile::OpenOptions eOption
             return nullptr;
     }
 
+    poCAD->setFilter( oFilter );
     gLastError = poCAD->ParseFile( eOptions, bReadUnsupportedGeometries );
     if( gLastError != CADErrorCodes::SUCCESS )
     {
@@ -190,6 +205,25 @@ CADFile * OpenCADFile( const char * pszFileName, enum CADFile::OpenOptions eOpti
     return OpenCADFile( GetDefaultFileIO( pszFileName ), eOptions, bReadUnsupportedGeometries );
 }
 
+/**
+ * @brief Open CAD file
+ * @param pszFileName Path to CAD file
+ * @param eOptions Open options
+ * @param oFilter Only geometries passed the filter are read into layers
+ * @return CADFile pointer or NULL if failed. The pointer have to be freed by user.
+ */
+CADFile * OpenCADFile( const char * pszFileName, enum CADFile::OpenOptions eOptions, const CADFilter& oFilter,
+                       bool bReadUnsupportedGeometries )
+{
+    if( pszFileName == NULL )
+    {
+        gLastError = CADErrorCodes::FILE_OPEN_FAILED;
+        return nullptr;
+    }
+
+    return OpenCADFile( GetDefaultFileIO( pszFileName ), eOptions, oFilter, bReadUnsupportedGeometries );
+}
+
 #ifdef _DEBUG
 void DebugMsg( const char* format, ... )
 #else
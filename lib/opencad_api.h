@@ -76,6 +76,10 @@ OCAD_EXTERN CADFile    * OpenCADFile( CADFileIO * pCADFileIO, enum CADFile::Open
                                       bool bReadUnsupportedGeometries = false );
 OCAD_EXTERN CADFile    * OpenCADFile( const char * pszFileName, enum CADFile::OpenOptions eOptions,
                                       bool bReadUnsupportedGeometries = false );
+OCAD_EXTERN CADFile    * OpenCADFile( CADFileIO * pCADFileIO, enum CADFile::OpenOptions eOptions,
+                                      const CADFilter& oFilter, bool bReadUnsupportedGeometries = false );
+OCAD_EXTERN CADFile    * OpenCADFile( const char * pszFileName, enum CADFile::OpenOptions eOptions,
+                                      const CADFilter& oFilter, bool bReadUnsupportedGeometries = false );
 OCAD_EXTERN int GetLastErrorCode();
 OCAD_EXTERN CADFileIO * GetDefaultFileIO( const char * pszFileName );
 OCAD_EXTERN int IdentifyCADFile( CADFileIO * pCADFileIO, bool bOwn = true );
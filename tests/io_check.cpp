@@ -1,5 +1,14 @@
 #include "gtest/gtest.h"
 #include "dwg/io.h"
+#include "cadcachedfileio.h"
+#include "cadfilestreamio.h"
+#ifdef HAVE_LINUX_IO_URING_H
+#include "cadfileuringio.h"
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 
 /*                                                          */
 /*               ReadBITSHORT() tests packet.               */
@@ -174,3 +183,249 @@ TEST(rawshort, rawshort_offset7)
     short a = ReadRAWSHORT ( buffer, bitOffsetFromStart );
     ASSERT_EQ (-18216, a);
 }
+
+/*                                                          */
+/*               ReadTV() tests packet.                     */
+/*                                                          */
+
+TEST(textvalue, tv_ascii_offset6)
+{
+    size_t bitOffsetFromStart = 6;
+    char buffer[6];
+    // 01 00000011 = 3 chars, string starts byte aligned.
+    buffer[0] = 0b00000001;
+    buffer[1] = 0b00000011;
+    buffer[2] = 0b01000001;
+    buffer[3] = 0b01100010;
+    buffer[4] = 0b00110001;
+    buffer[5] = 0b00000000;
+    std::string a = ReadTV ( buffer, bitOffsetFromStart, GetCodePageTable( 29 ) );
+    ASSERT_EQ ("Ab1", a);
+    ASSERT_EQ (40, bitOffsetFromStart);
+}
+
+TEST(textvalue, tv_ansi1251_offset0)
+{
+    size_t bitOffsetFromStart = 0;
+    char buffer[5];
+    // 01 00000011 = 3 chars, 0xCF 0xF0 0xE8 in ANSI 1251.
+    buffer[0] = 0b01000000;
+    buffer[1] = 0b11110011;
+    buffer[2] = 0b11111100;
+    buffer[3] = 0b00111010;
+    buffer[4] = 0b00000000;
+    std::string a = ReadTV ( buffer, bitOffsetFromStart, GetCodePageTable( 29 ) );
+    ASSERT_EQ ("\xD0\x9F\xD1\x80\xD0\xB8", a);
+    ASSERT_EQ (34, bitOffsetFromStart);
+}
+
+TEST(textvalue, tv_terminating_zero_offset6)
+{
+    size_t bitOffsetFromStart = 6;
+    char buffer[6];
+    // 01 00000011 = 3 chars, the last one is the terminating zero.
+    buffer[0] = 0b00000001;
+    buffer[1] = 0b00000011;
+    buffer[2] = 0b01000001;
+    buffer[3] = 0b01100010;
+    buffer[4] = 0b00000000;
+    buffer[5] = 0b00000000;
+    std::string a = ReadTV ( buffer, bitOffsetFromStart, GetCodePageTable( 29 ) );
+    ASSERT_EQ (2, a.size ());
+    ASSERT_EQ ("Ab", a);
+    ASSERT_EQ (40, bitOffsetFromStart);
+}
+
+/*                                                          */
+/*               CADCachedFileIO tests packet.              */
+/*                                                          */
+
+TEST(cachedfileio, same_data_as_stream)
+{
+    CADFileStreamIO oStreamIO ( "./data/r2000/1arc.dwg" );
+    CADCachedFileIO oCachedIO ( new CADFileStreamIO( "./data/r2000/1arc.dwg" ), 4096, 4 );
+    ASSERT_TRUE (oStreamIO.Open ( CADFileIO::OpenMode::read | CADFileIO::OpenMode::binary ));
+    ASSERT_TRUE (oCachedIO.Open ( CADFileIO::OpenMode::read | CADFileIO::OpenMode::binary ));
+
+    const long anOffsets[] = { 0, 4090, 100, 20000, 4100, 50000, 8, 8200 };
+    char abyExpected[256];
+    char abyReaded[256];
+    for( long nOffset : anOffsets )
+    {
+        oStreamIO.Seek ( nOffset, CADFileIO::SeekOrigin::BEG );
+        oCachedIO.Seek ( nOffset, CADFileIO::SeekOrigin::BEG );
+        size_t nExpected = oStreamIO.Read ( abyExpected, sizeof(abyExpected) );
+        size_t nReaded = oCachedIO.Read ( abyReaded, sizeof(abyReaded) );
+        ASSERT_EQ (nExpected, nReaded);
+        ASSERT_EQ (0, memcmp( abyExpected, abyReaded, nReaded ));
+        ASSERT_EQ (oStreamIO.Tell (), oCachedIO.Tell ());
+    }
+
+    // Short read at the end of file
+    oCachedIO.Seek ( -10, CADFileIO::SeekOrigin::END );
+    ASSERT_EQ (10, oCachedIO.Read ( abyReaded, sizeof(abyReaded) ));
+    ASSERT_TRUE (oCachedIO.Eof ());
+
+    ASSERT_GT (oCachedIO.GetHitCount (), 0);
+    ASSERT_GT (oCachedIO.GetMissCount (), 0);
+}
+
+TEST(cachedfileio, readline)
+{
+    const std::string osLongLine ( 100, 'x' );
+    {
+        std::ofstream oFile ( "./cached_readline.txt", std::ios::binary );
+        oFile << "first\r\n" << osLongLine << "\n\nlast";
+    }
+
+    // Lines cross the page bounds
+    CADCachedFileIO oCachedIO ( new CADFileStreamIO( "./cached_readline.txt" ), 16, 2 );
+    ASSERT_TRUE (oCachedIO.Open ( CADFileIO::OpenMode::read | CADFileIO::OpenMode::binary ));
+    ASSERT_STREQ ("first", oCachedIO.ReadLine ());
+    ASSERT_EQ (osLongLine, oCachedIO.ReadLine ());
+    ASSERT_STREQ ("", oCachedIO.ReadLine ());
+    ASSERT_STREQ ("last", oCachedIO.ReadLine ());
+    ASSERT_EQ (nullptr, oCachedIO.ReadLine ());
+    oCachedIO.Close ();
+    std::remove ( "./cached_readline.txt" );
+}
+
+/*                                                          */
+/*               Queued reads tests packet.                 */
+/*                                                          */
+
+// Queue reads of several parts of the file and compare with the stream ones.
+static void CheckQueuedReads( CADFileIO& oFileIO )
+{
+    CADFileStreamIO oStreamIO ( "./data/r2000/24127_circles_128_lines.dwg" );
+    ASSERT_TRUE (oStreamIO.Open ( CADFileIO::OpenMode::read | CADFileIO::OpenMode::binary ));
+
+    const long anOffsets[] = { 0, 4090, 100, 20000, 4100, 50000, 8, 8200, 300000, 123457 };
+    const size_t nCount = sizeof(anOffsets) / sizeof(anOffsets[0]);
+    char aabyReaded[nCount][1000];
+    for( size_t i = 0; i < nCount; ++i )
+        ASSERT_TRUE (oFileIO.SubmitRead ( anOffsets[i], aabyReaded[i], sizeof(aabyReaded[i]), i ));
+
+    bool abCompleted[nCount] = { false };
+    size_t nRequestId = 0, nReaded = 0;
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        ASSERT_TRUE (oFileIO.WaitRead ( nRequestId, nReaded ));
+        ASSERT_LT (nRequestId, nCount);
+        ASSERT_FALSE (abCompleted[nRequestId]);
+        abCompleted[nRequestId] = true;
+
+        char abyExpected[1000];
+        oStreamIO.Seek ( anOffsets[nRequestId], CADFileIO::SeekOrigin::BEG );
+        ASSERT_EQ (oStreamIO.Read ( abyExpected, sizeof(abyExpected) ), nReaded);
+        ASSERT_EQ (0, memcmp( abyExpected, aabyReaded[nRequestId], nReaded ));
+    }
+    ASSERT_FALSE (oFileIO.WaitRead ( nRequestId, nReaded ));
+}
+
+TEST(queuedreads, default_implementation)
+{
+    CADFileStreamIO oStreamIO ( "./data/r2000/24127_circles_128_lines.dwg" );
+    ASSERT_TRUE (oStreamIO.Open ( CADFileIO::OpenMode::read | CADFileIO::OpenMode::binary ));
+    CheckQueuedReads( oStreamIO );
+}
+
+#ifdef HAVE_LINUX_IO_URING_H
+TEST(queuedreads, uring)
+{
+    // Pass the queue depth, so the reader has to wait for free entries. If
+    // kernel has no io_uring, reads are synchronous and results are the same.
+    CADFileUringIO oUringIO ( "./data/r2000/24127_circles_128_lines.dwg", 4 );
+    ASSERT_TRUE (oUringIO.Open ( CADFileIO::OpenMode::read | CADFileIO::OpenMode::binary ));
+    CheckQueuedReads( oUringIO );
+
+    // Synchronous reads are the same as the stream ones too
+    CADFileStreamIO oStreamIO ( "./data/r2000/24127_circles_128_lines.dwg" );
+    ASSERT_TRUE (oStreamIO.Open ( CADFileIO::OpenMode::read | CADFileIO::OpenMode::binary ));
+    char abyExpected[256];
+    char abyReaded[256];
+    oStreamIO.Seek ( 5000, CADFileIO::SeekOrigin::BEG );
+    oUringIO.Seek ( 5000, CADFileIO::SeekOrigin::BEG );
+    ASSERT_EQ (sizeof(abyExpected), oStreamIO.Read ( abyExpected, sizeof(abyExpected) ));
+    ASSERT_EQ (sizeof(abyReaded), oUringIO.Read ( abyReaded, sizeof(abyReaded) ));
+    ASSERT_EQ (0, memcmp( abyExpected, abyReaded, sizeof(abyReaded) ));
+    ASSERT_EQ (5256, oUringIO.Tell ());
+
+    oUringIO.Seek ( -10, CADFileIO::SeekOrigin::END );
+    ASSERT_EQ (10, oUringIO.Read ( abyReaded, sizeof(abyReaded) ));
+    ASSERT_TRUE (oUringIO.Eof ());
+}
+
+TEST(queuedreads, uring_readline)
+{
+    const std::string osLongLine ( 1000, 'x' );
+    {
+        std::ofstream oFile ( "./uring_readline.txt", std::ios::binary );
+        oFile << "first\r\n" << osLongLine << "\n\nlast";
+    }
+
+    CADFileUringIO oUringIO ( "./uring_readline.txt" );
+    ASSERT_TRUE (oUringIO.Open ( CADFileIO::OpenMode::read ));
+    ASSERT_STREQ ("first", oUringIO.ReadLine ());
+    ASSERT_EQ (osLongLine, oUringIO.ReadLine ());
+    ASSERT_STREQ ("", oUringIO.ReadLine ());
+    ASSERT_STREQ ("last", oUringIO.ReadLine ());
+    ASSERT_EQ (nullptr, oUringIO.ReadLine ());
+    oUringIO.Close ();
+    std::remove ( "./uring_readline.txt" );
+}
+#endif
+
+/*                                                          */
+/*               Bulk double decoders tests packet.         */
+/*                                                          */
+
+static void FillPseudoRandom( char * pabyBuffer, size_t nSize )
+{
+    unsigned int nSeed = 12345;
+    for( size_t i = 0; i < nSize; ++i )
+    {
+        nSeed = nSeed * 1103515245 + 12345;
+        pabyBuffer[i] = static_cast<char>( nSeed >> 16 );
+    }
+}
+
+TEST(bulkdoubles, same_as_scalar)
+{
+    char buffer[512];
+    FillPseudoRandom( buffer, sizeof(buffer) );
+    const size_t nCount = 16;
+
+    for( size_t nStart = 0; nStart < 8; ++nStart )
+    {
+        double adfExpected[nCount], adfReaded[nCount];
+
+        size_t nScalarOffset = nStart, nBulkOffset = nStart;
+        for( size_t i = 0; i < nCount; ++i )
+            adfExpected[i] = ReadRAWDOUBLE ( buffer, nScalarOffset );
+        ReadRAWDOUBLEs ( buffer, nBulkOffset, adfReaded, nCount );
+        ASSERT_EQ (nScalarOffset, nBulkOffset);
+        ASSERT_EQ (0, memcmp( adfExpected, adfReaded, sizeof(adfExpected) ));
+
+        nScalarOffset = nBulkOffset = nStart;
+        for( size_t i = 0; i < nCount; ++i )
+            adfExpected[i] = ReadBITDOUBLE ( buffer, nScalarOffset );
+        ReadBITDOUBLEs ( buffer, nBulkOffset, adfReaded, nCount );
+        ASSERT_EQ (nScalarOffset, nBulkOffset);
+        ASSERT_EQ (0, memcmp( adfExpected, adfReaded, sizeof(adfExpected) ));
+
+        double adfExpectedX[nCount], adfExpectedY[nCount], adfX[nCount], adfY[nCount];
+        adfExpectedX[0] = adfX[0] = 1.5;
+        adfExpectedY[0] = adfY[0] = -2.5;
+        nScalarOffset = nBulkOffset = nStart;
+        for( size_t i = 1; i < nCount; ++i )
+        {
+            adfExpectedX[i] = ReadBITDOUBLEWD ( buffer, nScalarOffset, adfExpectedX[i - 1] );
+            adfExpectedY[i] = ReadBITDOUBLEWD ( buffer, nScalarOffset, adfExpectedY[i - 1] );
+        }
+        ReadBITDOUBLEWDPoints ( buffer, nBulkOffset, adfX, adfY, nCount );
+        ASSERT_EQ (nScalarOffset, nBulkOffset);
+        ASSERT_EQ (0, memcmp( adfExpectedX, adfX, sizeof(adfX) ));
+        ASSERT_EQ (0, memcmp( adfExpectedY, adfY, sizeof(adfY) ));
+    }
+}
@@ -1,6 +1,27 @@
 #include "gtest/gtest.h"
 #include "opencad_api.h"
 #include "cadgeometry.h"
+#include "cadmath.h"
+#include "cadflatgeobufwriter.h"
+#include "cadfilestreamio.h"
+#ifdef HAVE_LINUX_IO_URING_H
+#include "cadfileuringio.h"
+#endif
+#include "cadgeojsonwriter.h"
+#include "cadrasterizer.h"
+#include "cadsplineevaluator.h"
+#include "cadsvgwriter.h"
+#include "cadtessellator.h"
+#include "cadthreadpool.h"
+#include "cadvectortilewriter.h"
+#include "cadwkbwriter.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <sstream>
 
 // Following test demonstrates reading only actual geometries (deleted skipped).
 
@@ -51,6 +72,14 @@ TEST(reading_geometries, 256_polylines_7vertexes)
 
             CADLWPolyline * poly = static_cast<CADLWPolyline*>(geom);
             ASSERT_EQ( poly->getVertexCount(), 7);
+            ASSERT_EQ( poly->getXs().size(), 7);
+            ASSERT_EQ( poly->getYs().size(), 7);
+            ASSERT_TRUE( poly->getZs().empty() );
+            for( size_t j = 0; j < poly->getVertexCount(); ++j )
+            {
+                ASSERT_EQ( poly->getVertex(j).getX(), poly->getXs()[j] );
+                ASSERT_EQ( poly->getVertex(j).getY(), poly->getYs()[j] );
+            }
         }
         delete geom;
     }
@@ -233,11 +262,26 @@ TEST(reading_geometries, 3rays_5xlines)
             ++rays_count;
         }
 
+        // Rays and xlines are unbounded, the same box is got without
+        // reading the geometry
+        const CADBoundingBox& box = layer.getGeometryBoundingBox (i);
+        ASSERT_TRUE ( box.isUnbounded () );
+        ASSERT_EQ ( geom->getBoundingBox ().getMinX (), box.getMinX () );
+        ASSERT_EQ ( geom->getBoundingBox ().getMinY (), box.getMinY () );
+        ASSERT_EQ ( geom->getBoundingBox ().getMaxX (), box.getMaxX () );
+        ASSERT_EQ ( geom->getBoundingBox ().getMaxY (), box.getMaxY () );
+
         delete geom;
     }
 
     ASSERT_EQ (5, rays_count);
     ASSERT_EQ (3, xlines_count);
+
+    // They are left out of the extents, but found by any window they cross
+    ASSERT_TRUE ( layer.getExtents ().isEmpty () );
+    size_t nFound = 0;
+    layer.queryWindow ( -1e6, -1e6, 1e6, 1e6, [&nFound]( size_t ) { ++nFound; } );
+    ASSERT_EQ ( 8u, nFound );
     delete opened_dwg;
 }
 
@@ -299,3 +343,1103 @@ TEST(reading_geometries, 1arc)
     delete opened_dwg;
 }
 
+
+TEST(reading_geometries, triplet_extents)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                   CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+
+    // Circles are (0,0) R16.6, (10,10) R10 and (-15,0) R9.5
+    CADBoundingBox extents = openedDwg->computeExtents ();
+    ASSERT_FALSE (extents.isEmpty ());
+    ASSERT_NEAR (extents.getMinX (), -24.5, 0.0001);
+    ASSERT_NEAR (extents.getMinY (), -16.6, 0.0001);
+    ASSERT_NEAR (extents.getMaxX (), 20.0, 0.0001);
+    ASSERT_NEAR (extents.getMaxY (), 20.0, 0.0001);
+
+    delete openedDwg;
+}
+
+// Queue all layers and an unknown handle, every one must be returned once.
+static void CheckAsyncObjects( CADFileIO * pFileIO )
+{
+    CADFile * pFile = OpenCADFile ( pFileIO, CADFile::OpenOptions::READ_FAST );
+    ASSERT_NE (nullptr, pFile);
+
+    std::map<long, std::string> mapLayers;
+    for( size_t i = 0; i < pFile->GetLayersCount (); ++i )
+    {
+        CADLayer& layer = pFile->GetLayer (i);
+        mapLayers[layer.getHandle ()] = layer.getName ();
+        ASSERT_TRUE (pFile->GetObjectAsync ( layer.getHandle () ));
+    }
+    const long dUnknownHandle = -1;
+    ASSERT_TRUE (pFile->GetObjectAsync ( dUnknownHandle ));
+
+    long dHandle = 0;
+    CADObject * poObject = nullptr;
+    bool bUnknownReturned = false;
+    while( pFile->GetCompletedObject ( dHandle, poObject ) )
+    {
+        if( dHandle == dUnknownHandle )
+        {
+            ASSERT_FALSE (bUnknownReturned);
+            ASSERT_EQ (nullptr, poObject);
+            bUnknownReturned = true;
+            continue;
+        }
+
+        auto iterLayer = mapLayers.find (dHandle);
+        ASSERT_NE (mapLayers.end (), iterLayer);
+        ASSERT_NE (nullptr, poObject);
+        ASSERT_EQ (CADObject::LAYER, poObject->getType ());
+        ASSERT_EQ (iterLayer->second, static_cast<CADLayerObject *>( poObject )->sLayerName);
+        delete poObject;
+        mapLayers.erase (iterLayer);
+    }
+
+    ASSERT_TRUE (bUnknownReturned);
+    ASSERT_TRUE (mapLayers.empty ());
+    delete pFile;
+}
+
+TEST(reading_geometries, async_objects)
+{
+    CheckAsyncObjects( new CADFileStreamIO ( "./data/r2000/24127_circles_128_lines.dwg" ) );
+#ifdef HAVE_LINUX_IO_URING_H
+    CheckAsyncObjects( new CADFileUringIO ( "./data/r2000/24127_circles_128_lines.dwg" ) );
+#endif
+}
+
+TEST(reading_geometries, bounding_boxes_match_geometries)
+{
+    const char * files[] = { "./data/r2000/24127_circles_128_lines.dwg",
+                             "./data/r2000/256_lwpolylines_7vertexes.dwg",
+                             "./data/r2000/six_3dpolylines.dwg",
+                             "./data/r2000/1arc.dwg",
+                             "./data/r2000/4solids.dwg" };
+    for ( const char * file : files )
+    {
+        auto openedDwg = OpenCADFile (file, CADFile::OpenOptions::READ_FAST);
+        ASSERT_NE (openedDwg, nullptr);
+
+        CADLayer &layer = openedDwg->GetLayer (0);
+        for ( size_t i = 0; i < layer.getGeometryCount (); ++i )
+        {
+            CADGeometry * geom = layer.getGeometry (i);
+            const CADBoundingBox& box = layer.getGeometryBoundingBox (i);
+            ASSERT_NEAR (box.getMinX (), geom->getBoundingBox ().getMinX (), 0.0001);
+            ASSERT_NEAR (box.getMinY (), geom->getBoundingBox ().getMinY (), 0.0001);
+            ASSERT_NEAR (box.getMaxX (), geom->getBoundingBox ().getMaxX (), 0.0001);
+            ASSERT_NEAR (box.getMaxY (), geom->getBoundingBox ().getMaxY (), 0.0001);
+            delete geom;
+        }
+
+        delete openedDwg;
+    }
+}
+
+TEST(reading_geometries, query_window)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/24127_circles_128_lines.dwg",
+                                   CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+
+    CADLayer &layer = openedDwg->GetLayer (0);
+    const CADBoundingBox& extents = layer.getExtents ();
+    double width = extents.getMaxX () - extents.getMinX ();
+    double height = extents.getMaxY () - extents.getMinY ();
+
+    for ( int i = 0; i < 4; ++i )
+    {
+        // Windows of growing size from the bottom left corner.
+        CADBoundingBox window;
+        window.addPoint (extents.getMinX (), extents.getMinY (), 0.0);
+        window.addPoint (extents.getMinX () + width * (i + 1) / 4,
+                         extents.getMinY () + height * (i + 1) / 4, 0.0);
+
+        std::vector<size_t> found;
+        layer.queryWindow (window.getMinX (), window.getMinY (), window.getMaxX (),
+                           window.getMaxY (), [&found](size_t index) { found.push_back (index); });
+        std::sort (found.begin (), found.end ());
+
+        std::vector<size_t> expected;
+        for ( size_t j = 0; j < layer.getGeometryCount (); ++j )
+        {
+            if ( layer.getGeometryBoundingBox (j).intersects (window) )
+                expected.push_back (j);
+        }
+
+        ASSERT_FALSE (expected.empty ());
+        ASSERT_EQ (found, expected);
+    }
+
+    delete openedDwg;
+}
+
+TEST(reading_geometries, spatial_filter)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/24127_circles_128_lines.dwg",
+                                   CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+
+    CADLayer &layer = openedDwg->GetLayer (0);
+    const CADBoundingBox& extents = layer.getExtents ();
+    CADBoundingBox window;
+    window.addPoint (extents.getMinX (), extents.getMinY (), 0.0);
+    window.addPoint ((extents.getMinX () + extents.getMaxX ()) / 2,
+                     (extents.getMinY () + extents.getMaxY ()) / 2, 0.0);
+
+    size_t expected = 0;
+    for ( size_t i = 0; i < layer.getGeometryCount (); ++i )
+    {
+        if ( layer.getGeometryBoundingBox (i).intersects (window) )
+            ++expected;
+    }
+    ASSERT_GT (expected, 0);
+    ASSERT_LT (expected, layer.getGeometryCount ());
+    delete openedDwg;
+
+    CADFilter filter;
+    filter.setSpatialFilter (window.getMinX (), window.getMinY (), window.getMaxX (), window.getMaxY ());
+    openedDwg = OpenCADFile ("./data/r2000/24127_circles_128_lines.dwg",
+                             CADFile::OpenOptions::READ_FAST, filter);
+    ASSERT_NE (openedDwg, nullptr);
+
+    CADLayer &filteredLayer = openedDwg->GetLayer (0);
+    ASSERT_EQ (filteredLayer.getGeometryCount (), expected);
+    for ( size_t i = 0; i < filteredLayer.getGeometryCount (); ++i )
+    {
+        CADGeometry * geom = filteredLayer.getGeometry (i);
+        ASSERT_TRUE (geom->getBoundingBox ().intersects (window));
+        delete geom;
+    }
+
+    delete openedDwg;
+}
+
+TEST(reading_geometries, spatial_filter_rays_and_xlines)
+{
+    // Rays and xlines pass the filter, but stay out of the extents
+    CADFilter filter;
+    filter.setSpatialFilter (-1e6, -1e6, 1e6, 1e6);
+    auto openedDwg = OpenCADFile ("./data/r2000/5rays_3xlines.dwg",
+                                  CADFile::OpenOptions::READ_FAST, filter);
+    ASSERT_NE (openedDwg, nullptr);
+
+    CADLayer &layer = openedDwg->GetLayer (0);
+    ASSERT_EQ (layer.getGeometryCount (), 8);
+    ASSERT_FALSE (layer.getExtents ().isUnbounded ());
+    ASSERT_TRUE (layer.getExtents ().isEmpty ());
+    ASSERT_TRUE (openedDwg->computeExtents ().isEmpty ());
+    delete openedDwg;
+}
+
+TEST(reading_geometries, layer_and_type_filter)
+{
+    CADFilter filter;
+    filter.addObjectType (CADObject::LINE);
+    auto openedDwg = OpenCADFile ("./data/r2000/24127_circles_128_lines.dwg",
+                                  CADFile::OpenOptions::READ_FAST, filter);
+    ASSERT_NE (openedDwg, nullptr);
+    ASSERT_EQ (openedDwg->GetLayersCount (), 1);
+
+    CADLayer &layer = openedDwg->GetLayer (0);
+    ASSERT_EQ (layer.getGeometryCount (), 128);
+    ASSERT_EQ (layer.getGeometryTypes ().size (), 1);
+    ASSERT_EQ (layer.getGeometryTypes ()[0], CADObject::LINE);
+    delete openedDwg;
+
+    CADFilter layerFilter;
+    layerFilter.addLayer ("no such layer");
+    openedDwg = OpenCADFile ("./data/r2000/24127_circles_128_lines.dwg",
+                             CADFile::OpenOptions::READ_FAST, layerFilter);
+    ASSERT_NE (openedDwg, nullptr);
+    ASSERT_EQ (openedDwg->GetLayersCount (), 0);
+    delete openedDwg;
+}
+
+TEST(reading_circles, triplet_decode_flags)
+{
+    CADFilter filter;
+    filter.setDecodeFlags (CADFilter::SKIP_EED | CADFilter::SKIP_REACTORS | CADFilter::SKIP_XDICT |
+                           CADFilter::SKIP_EXTRUSION | CADFilter::SKIP_ATTRIBUTES);
+    auto openedDwg = OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                   CADFile::OpenOptions::READ_FAST, filter);
+    ASSERT_NE (openedDwg, nullptr);
+
+    CADLayer &layer = openedDwg->GetLayer (0);
+    ASSERT_GE (layer.getGeometryCount (), 3);
+
+    // Coordinates are read as usual, thickness is skipped.
+    CADGeometry * geometry = layer.getGeometry (1);
+    ASSERT_EQ (geometry->getType(), CADGeometry::GeometryType::CIRCLE);
+    CADCircle * circle = static_cast<CADCircle *>( geometry );
+    ASSERT_NEAR (circle->getPosition().getX(), 10.0f, 0.0001f);
+    ASSERT_NEAR (circle->getPosition().getY(), 10.0f, 0.0001f);
+    ASSERT_NEAR (circle->getPosition().getZ(), 10.0f, 0.0001f);
+    ASSERT_NEAR (circle->getRadius(), 10.0f, 0.0001f);
+    ASSERT_NEAR (circle->getThickness(), 0.0f, 0.0001f);
+    ASSERT_TRUE (circle->getEED().empty());
+    delete geometry;
+
+    delete openedDwg;
+}
+
+TEST(geometry, transform_points_same_as_multiply)
+{
+    Matrix matrix;
+    matrix.translate( CADVector( 10.5, -3.25 ) );
+    matrix.rotate( 0.7 );
+    matrix.scale( CADVector( 2.0, 0.5 ) );
+
+    const size_t nCount = 11; // not a multiple of the SIMD width
+    double adfX[nCount], adfY[nCount], adfZ[nCount];
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        adfX[i] = i * 1.5 - 4.0;
+        adfY[i] = 7.0 - i * 0.25;
+        adfZ[i] = i % 3;
+    }
+
+    double adfOutX[nCount], adfOutY[nCount], adfOutZ[nCount];
+    matrix.transformPoints( adfX, adfY, adfZ, adfOutX, adfOutY, adfOutZ, nCount );
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        CADVector expected = matrix.multiply( CADVector( adfX[i], adfY[i], adfZ[i] ) );
+        ASSERT_EQ( expected.getX(), adfOutX[i] );
+        ASSERT_EQ( expected.getY(), adfOutY[i] );
+        ASSERT_EQ( expected.getZ(), adfOutZ[i] );
+    }
+
+    // 2D input, in place
+    matrix.transformPoints( adfX, adfY, nullptr, adfX, adfY, adfZ, nCount );
+    CADVector expected = matrix.multiply( CADVector( -4.0, 7.0 ) );
+    ASSERT_EQ( expected.getX(), adfX[0] );
+    ASSERT_EQ( expected.getY(), adfY[0] );
+    ASSERT_EQ( expected.getZ(), adfZ[0] );
+}
+
+TEST(geometry, matrix_composition_and_ocs)
+{
+    // Transformations are applied to points in reverse order of the calls.
+    Matrix matrix;
+    matrix.translate( CADVector( 1.0, 2.0, 3.0 ) );
+    matrix.scale( CADVector( 2.0, 2.0, 2.0 ) );
+    CADVector point = matrix.multiply( CADVector( 1.0, 1.0, 1.0 ) );
+    ASSERT_DOUBLE_EQ( 3.0, point.getX() );
+    ASSERT_DOUBLE_EQ( 4.0, point.getY() );
+    ASSERT_DOUBLE_EQ( 5.0, point.getZ() );
+
+    Matrix rotation;
+    rotation.rotate( M_PI / 2 );
+    point = matrix.multiply( rotation ).multiply( CADVector( 1.0, 0.0, 0.0 ) );
+    ASSERT_NEAR( 1.0, point.getX(), 1e-12 );
+    ASSERT_NEAR( 4.0, point.getY(), 1e-12 );
+    ASSERT_NEAR( 3.0, point.getZ(), 1e-12 );
+
+    ASSERT_TRUE( Matrix::ocsToWcs( CADVector( 0.0, 0.0, 1.0 ) ).isIdentity() );
+
+    // Mirrored OCS, X axis is flipped
+    Matrix ocs = Matrix::ocsToWcs( CADVector( 0.0, 0.0, -1.0 ) );
+    point = ocs.multiply( CADVector( 1.0, 2.0, 3.0 ) );
+    ASSERT_DOUBLE_EQ( -1.0, point.getX() );
+    ASSERT_DOUBLE_EQ( 2.0, point.getY() );
+    ASSERT_DOUBLE_EQ( -3.0, point.getZ() );
+
+    // Arbitrary axis algorithm for extrusion along X: Ax = Wz x N = (0,1,0)
+    ocs = Matrix::ocsToWcs( CADVector( 1.0, 0.0, 0.0 ) );
+    point = ocs.multiply( CADVector( 1.0, 0.0, 0.0 ) );
+    ASSERT_NEAR( 0.0, point.getX(), 1e-12 );
+    ASSERT_NEAR( 1.0, point.getY(), 1e-12 );
+    ASSERT_NEAR( 0.0, point.getZ(), 1e-12 );
+}
+
+TEST(geometry, mirrored_arc_bounding_box)
+{
+    // Arc as read from the file: quarter from 0 to 90 degrees at OCS (5,0)
+    // with extrusion along -Z, which mirrors X.
+    CADArc arc;
+    arc.setPosition( CADVector( 5.0, 0.0, 0.0 ) );
+    arc.setExtrusion( CADVector( 0.0, 0.0, -1.0 ) );
+    arc.setRadius( 1.0 );
+    arc.setStartingAngle( 0.0 );
+    arc.setEndingAngle( M_PI / 2 );
+    arc.transformFromOCS();
+    ASSERT_DOUBLE_EQ( -5.0, arc.getPosition().getX() );
+    ASSERT_DOUBLE_EQ( -1.0, arc.getExtrusion().getZ() );
+    const CADBoundingBox& box = arc.getBoundingBox();
+    ASSERT_NEAR( -6.0, box.getMinX(), 1e-12 );
+    ASSERT_NEAR( -5.0, box.getMaxX(), 1e-12 );
+    ASSERT_NEAR( 0.0, box.getMinY(), 1e-12 );
+    ASSERT_NEAR( 1.0, box.getMaxY(), 1e-12 );
+
+    // The same arc in plain OCS under block reference mirrored by X scale -1
+    // ends in the same place.
+    CADArc insertedArc;
+    insertedArc.setPosition( CADVector( 5.0, 0.0, 0.0 ) );
+    insertedArc.setRadius( 1.0 );
+    insertedArc.setStartingAngle( 0.0 );
+    insertedArc.setEndingAngle( M_PI / 2 );
+    insertedArc.transformFromOCS();
+    Matrix mirror;
+    mirror.scale( CADVector( -1.0, 1.0, 1.0 ) );
+    insertedArc.transform( mirror );
+    const CADBoundingBox& insertedBox = insertedArc.getBoundingBox();
+    ASSERT_NEAR( -6.0, insertedBox.getMinX(), 1e-12 );
+    ASSERT_NEAR( -5.0, insertedBox.getMaxX(), 1e-12 );
+    ASSERT_NEAR( 0.0, insertedBox.getMinY(), 1e-12 );
+    ASSERT_NEAR( 1.0, insertedBox.getMaxY(), 1e-12 );
+
+    CADCircle circle;
+    circle.setPosition( CADVector( 5.0, 0.0, 0.0 ) );
+    circle.setExtrusion( CADVector( 0.0, 0.0, -1.0 ) );
+    circle.setRadius( 1.0 );
+    circle.transformFromOCS();
+    ASSERT_NEAR( -6.0, circle.getBoundingBox().getMinX(), 1e-12 );
+    ASSERT_NEAR( -4.0, circle.getBoundingBox().getMaxX(), 1e-12 );
+
+    // Half circle bulge going down from (0,0) to (2,0), mirrored by the block
+    // reference it goes down from (0,0) to (-2,0).
+    CADLWPolyline polyline;
+    polyline.addVertex( CADVector( 0.0, 0.0 ) );
+    polyline.addVertex( CADVector( 2.0, 0.0 ) );
+    polyline.setBulges( { 1.0, 0.0 } );
+    polyline.transformFromOCS();
+    polyline.transform( mirror );
+    const CADBoundingBox& polylineBox = polyline.getBoundingBox();
+    ASSERT_NEAR( -2.0, polylineBox.getMinX(), 1e-12 );
+    ASSERT_NEAR( 0.0, polylineBox.getMaxX(), 1e-12 );
+    ASSERT_NEAR( -1.0, polylineBox.getMinY(), 1e-12 );
+    ASSERT_NEAR( 0.0, polylineBox.getMaxY(), 1e-12 );
+}
+
+TEST(geometry, image_and_mtext_bounding_boxes)
+{
+    // 100 x 50 pixels of 0.5 units
+    CADImage image;
+    image.setVertInsertionPoint( CADVector( 10.0, 10.0, 0.0 ) );
+    image.setVectUDirection( CADVector( 0.5, 0.0, 0.0 ) );
+    image.setVectVDirection( CADVector( 0.0, 0.5, 0.0 ) );
+    image.setImageSize( CADVector( 100.0, 50.0 ) );
+    ASSERT_DOUBLE_EQ( 10.0, image.getBoundingBox().getMinX() );
+    ASSERT_DOUBLE_EQ( 10.0, image.getBoundingBox().getMinY() );
+    ASSERT_DOUBLE_EQ( 60.0, image.getBoundingBox().getMaxX() );
+    ASSERT_DOUBLE_EQ( 35.0, image.getBoundingBox().getMaxY() );
+
+    // Rotated by 90 degrees around the origin
+    Matrix rotation;
+    rotation.rotate( M_PI / 2 );
+    image.transform( rotation );
+    ASSERT_NEAR( -35.0, image.getBoundingBox().getMinX(), 1e-9 );
+    ASSERT_NEAR( 10.0, image.getBoundingBox().getMinY(), 1e-9 );
+    ASSERT_NEAR( -10.0, image.getBoundingBox().getMaxX(), 1e-9 );
+    ASSERT_NEAR( 60.0, image.getBoundingBox().getMaxY(), 1e-9 );
+
+    // Middle center attachment: the position is the rectangle center
+    CADMText mtext;
+    mtext.setPosition( CADVector( 0.0, 0.0, 0.0 ) );
+    mtext.setHeight( 1.0 );
+    mtext.setRectWidth( 10.0 );
+    mtext.setExtents( 2.0 );
+    mtext.setAttachment( 5 );
+    ASSERT_DOUBLE_EQ( -5.0, mtext.getBoundingBox().getMinX() );
+    ASSERT_DOUBLE_EQ( -1.0, mtext.getBoundingBox().getMinY() );
+    ASSERT_DOUBLE_EQ( 5.0, mtext.getBoundingBox().getMaxX() );
+    ASSERT_DOUBLE_EQ( 1.0, mtext.getBoundingBox().getMaxY() );
+
+    // Top left attachment, scaled twice by block reference
+    mtext.setAttachment( 1 );
+    Matrix scale;
+    scale.scale( CADVector( 2.0, 2.0, 1.0 ) );
+    mtext.transform( scale );
+    ASSERT_NEAR( 0.0, mtext.getBoundingBox().getMinX(), 1e-9 );
+    ASSERT_NEAR( -4.0, mtext.getBoundingBox().getMinY(), 1e-9 );
+    ASSERT_NEAR( 20.0, mtext.getBoundingBox().getMaxX(), 1e-9 );
+    ASSERT_NEAR( 0.0, mtext.getBoundingBox().getMaxY(), 1e-9 );
+}
+
+TEST(geometry, tessellate_circles_and_arcs)
+{
+    const double dfTolerance = 0.01;
+    CADTessellator tessellator( dfTolerance );
+
+    CADCircle circle;
+    circle.setPosition( CADVector( 5.0, 5.0 ) );
+    circle.setRadius( 10.0 );
+    CADVertexArray points;
+    size_t nCount = tessellator.tessellate( circle, points );
+    ASSERT_EQ( nCount, points.size() );
+    ASSERT_EQ( tessellator.getSegmentCount( 10.0, 2 * M_PI ) + 1, nCount );
+    ASSERT_FALSE( points.hasZ() );
+    ASSERT_EQ( points.getXs().front(), points.getXs().back() );
+    ASSERT_EQ( points.getYs().front(), points.getYs().back() );
+    for( size_t i = 0; i + 1 < nCount; ++i )
+    {
+        CADVector point = points.get( i );
+        ASSERT_NEAR( 10.0, hypot( point.getX() - 5.0, point.getY() - 5.0 ), 1e-9 );
+        // Chord middle is not farther than tolerance from the circle
+        double dfMidX = ( points.getXs()[i] + points.getXs()[i + 1] ) / 2;
+        double dfMidY = ( points.getYs()[i] + points.getYs()[i + 1] ) / 2;
+        ASSERT_LE( 10.0 - hypot( dfMidX - 5.0, dfMidY - 5.0 ), dfTolerance );
+    }
+
+    // Arc read in mirrored OCS is appended to the same buffer. Its center is
+    // at (-1,0) in WCS, angles go around the -Z normal.
+    CADArc arc;
+    arc.setPosition( CADVector( 1.0, 0.0 ) );
+    arc.setRadius( 2.0 );
+    arc.setStartingAngle( 0.0 );
+    arc.setEndingAngle( M_PI / 2 );
+    arc.setExtrusion( CADVector( 0.0, 0.0, -1.0 ) );
+    arc.transformFromOCS();
+    ASSERT_DOUBLE_EQ( -1.0, arc.getPosition().getX() );
+    ASSERT_TRUE( tessellator.tessellate( &arc, points ) );
+    ASSERT_NEAR( -3.0, points.getXs()[nCount], 1e-12 );
+    ASSERT_NEAR( 0.0, points.getYs()[nCount], 1e-12 );
+    ASSERT_NEAR( -1.0, points.getXs().back(), 1e-12 );
+    ASSERT_NEAR( 2.0, points.getYs().back(), 1e-12 );
+
+    // Fixed segment count
+    CADTessellator fixed( 0.0, 16 );
+    points.clear();
+    ASSERT_EQ( 17, fixed.tessellate( circle, points ) );
+    arc.setExtrusion( CADVector( 0.0, 0.0, 1.0 ) );
+    ASSERT_EQ( 5, fixed.tessellate( arc, points ) );
+}
+
+TEST(geometry, tessellate_ellipse)
+{
+    CADEllipse ellipse;
+    ellipse.setPosition( CADVector( 0.0, 0.0, 2.0 ) );
+    ellipse.setSMAxis( CADVector( 4.0, 0.0, 0.0 ) );
+    ellipse.setAxisRatio( 0.5 );
+    ellipse.setStartingAngle( 0.0 );
+    ellipse.setEndingAngle( 0.0 );
+    ellipse.setExtrusion( CADVector( 0.0, 0.0, 1.0 ) );
+
+    CADTessellator tessellator( 0.001 );
+    CADVertexArray points;
+    size_t nCount = tessellator.tessellate( ellipse, points );
+    ASSERT_GT( nCount, 4 );
+    ASSERT_TRUE( points.hasZ() );
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        CADVector point = points.get( i );
+        double x = point.getX() / 4.0, y = point.getY() / 2.0;
+        ASSERT_NEAR( 1.0, x * x + y * y, 1e-9 );
+        ASSERT_EQ( 2.0, point.getZ() );
+    }
+}
+
+TEST(geometry, spline_evaluator)
+{
+    // Cubic with one span is a Bezier curve
+    CADVertexArray ctrlPoints;
+    ctrlPoints.add( CADVector( 0.0, 0.0, 0.0 ) );
+    ctrlPoints.add( CADVector( 1.0, 2.0, 0.0 ) );
+    ctrlPoints.add( CADVector( 3.0, 2.0, 1.0 ) );
+    ctrlPoints.add( CADVector( 4.0, 0.0, 0.0 ) );
+    vector<double> knots = { 0.0, 0.0, 0.0, 0.0, 2.0, 2.0, 2.0, 2.0 };
+    CADSplineEvaluator bezier;
+    ASSERT_TRUE( bezier.init( 3, ctrlPoints, vector<double>(), knots ) );
+    ASSERT_TRUE( bezier.is3D() );
+    double adfParams[5] = { 0.0, 0.5, 1.0, 1.5, 2.0 };
+    double adfX[5], adfY[5], adfZ[5];
+    bezier.evaluate( adfParams, 5, adfX, adfY, adfZ );
+    for( size_t i = 0; i < 5; ++i )
+    {
+        double t = adfParams[i] / 2, s = 1.0 - t;
+        double b1 = 3 * s * s * t, b2 = 3 * s * t * t, b3 = t * t * t;
+        ASSERT_NEAR( b1 * 1.0 + b2 * 3.0 + b3 * 4.0, adfX[i], 1e-12 );
+        ASSERT_NEAR( b1 * 2.0 + b2 * 2.0, adfY[i], 1e-12 );
+        ASSERT_NEAR( b2, adfZ[i], 1e-12 );
+        ASSERT_EQ( adfX[i], bezier.evaluate( adfParams[i] ).getX() );
+    }
+
+    // Rational quadratic is an exact quarter of unit circle
+    CADSpline spline;
+    spline.setDegree( 2 );
+    spline.setRational( true );
+    spline.addControlPoint( CADVector( 1.0, 0.0, 0.0 ) );
+    spline.addControlPoint( CADVector( 1.0, 1.0, 0.0 ) );
+    spline.addControlPoint( CADVector( 0.0, 1.0, 0.0 ) );
+    spline.addControlPointsWeight( 1.0 );
+    spline.addControlPointsWeight( sqrt( 0.5 ) );
+    spline.addControlPointsWeight( 1.0 );
+    spline.setKnots( { 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 } );
+
+    const double dfTolerance = 0.001;
+    CADTessellator tessellator( dfTolerance );
+    CADVertexArray points;
+    size_t nCount = tessellator.tessellate( spline, points );
+    ASSERT_GT( nCount, 3 );
+    ASSERT_FALSE( points.hasZ() );
+    ASSERT_DOUBLE_EQ( 1.0, points.getXs().front() );
+    ASSERT_DOUBLE_EQ( 1.0, points.getYs().back() );
+    for( size_t i = 0; i + 1 < nCount; ++i )
+    {
+        ASSERT_NEAR( 1.0, hypot( points.getXs()[i], points.getYs()[i] ), 1e-12 );
+        double dfMidX = ( points.getXs()[i] + points.getXs()[i + 1] ) / 2;
+        double dfMidY = ( points.getYs()[i] + points.getYs()[i + 1] ) / 2;
+        ASSERT_LE( 1.0 - hypot( dfMidX, dfMidY ), dfTolerance );
+    }
+}
+
+TEST(geometry, spline_from_fit_points)
+{
+    CADVertexArray fitPoints;
+    fitPoints.add( CADVector( 0.0, 0.0, 0.0 ) );
+    fitPoints.add( CADVector( 1.0, 1.0, 0.0 ) );
+    fitPoints.add( CADVector( 2.0, 0.0, 0.0 ) );
+    fitPoints.add( CADVector( 3.0, 1.0, 0.0 ) );
+    fitPoints.add( CADVector( 4.0, 0.0, 0.0 ) );
+
+    CADSplineEvaluator evaluator;
+    ASSERT_FALSE( evaluator.init( 3, CADVertexArray(), vector<double>(), vector<double>() ) );
+    ASSERT_TRUE( evaluator.initFromFitPoints( fitPoints, CADVector( 0.0, 1.0, 0.0 ), CADVector( 0.0, 0.0, 0.0 ) ) );
+    ASSERT_EQ( 3, evaluator.getDegree() );
+
+    // Curve passes through the fit points at the inner knots
+    const vector<double>& knots = evaluator.getKnots();
+    ASSERT_EQ( 4 + 3 + 4, knots.size() );
+    for( size_t i = 0; i < fitPoints.size(); ++i )
+    {
+        double t = i == 0 ? evaluator.getStartParam() :
+                   i + 1 == fitPoints.size() ? evaluator.getEndParam() : knots[3 + i];
+        CADVector point = evaluator.evaluate( t );
+        ASSERT_NEAR( fitPoints.getXs()[i], point.getX(), 1e-12 );
+        ASSERT_NEAR( fitPoints.getYs()[i], point.getY(), 1e-12 );
+    }
+
+    // Start tangent is vertical
+    CADVector start = evaluator.evaluate( 1e-6 );
+    ASSERT_LT( fabs( start.getX() ), 1e-9 );
+    ASSERT_GT( start.getY(), 0.0 );
+}
+
+TEST(geometry, tessellate_bulged_polyline)
+{
+    // Square 2x2 with the top segment replaced by half circle going up
+    CADLWPolyline polyline;
+    polyline.addVertex( CADVector( 0.0, 0.0 ) );
+    polyline.addVertex( CADVector( 2.0, 0.0 ) );
+    polyline.addVertex( CADVector( 2.0, 2.0 ) );
+    polyline.addVertex( CADVector( 0.0, 2.0 ) );
+    polyline.setBulges( { 0.0, 0.0, 1.0, 0.0 } );
+    polyline.setClosed( true );
+
+    double cx, cy, dfRadius, dfStartAng, dfEndAng;
+    ASSERT_FALSE( CADTessellator::getBulgeArc( 0.0, 0.0, 2.0, 0.0, 0.0, cx, cy, dfRadius, dfStartAng, dfEndAng ) );
+    ASSERT_TRUE( CADTessellator::getBulgeArc( 2.0, 2.0, 0.0, 2.0, 1.0, cx, cy, dfRadius, dfStartAng, dfEndAng ) );
+    ASSERT_NEAR( 1.0, cx, 1e-12 );
+    ASSERT_NEAR( 2.0, cy, 1e-12 );
+    ASSERT_NEAR( 1.0, dfRadius, 1e-12 );
+    ASSERT_NEAR( 0.0, dfStartAng, 1e-12 );
+    ASSERT_NEAR( M_PI, dfEndAng, 1e-12 );
+
+    CADTessellator tessellator( 0.001 );
+    CADVertexArray points;
+    size_t nCount = tessellator.tessellate( polyline, points );
+    size_t nArcSegments = tessellator.getSegmentCount( 1.0, M_PI );
+    ASSERT_EQ( 4 + nArcSegments, nCount );
+    ASSERT_FALSE( points.hasZ() );
+    ASSERT_EQ( 0.0, points.getXs().back() );
+    ASSERT_EQ( 0.0, points.getYs().back() );
+    // Arc points are between the 3rd and 4th vertexes
+    ASSERT_EQ( 2.0, points.getXs()[2] );
+    ASSERT_EQ( 0.0, points.getXs()[2 + nArcSegments] );
+    for( size_t i = 3; i < 2 + nArcSegments; ++i )
+    {
+        ASSERT_NEAR( 1.0, hypot( points.getXs()[i] - 1.0, points.getYs()[i] - 2.0 ), 1e-12 );
+        ASSERT_GT( points.getYs()[i], 2.0 );
+    }
+
+    // Block reference mirrored by X scale -1 and moved by 10 along X. Bulges
+    // keep their sign around the flipped normal, so the arc still goes up.
+    Matrix insert;
+    insert.translate( CADVector( 10.0, 0.0, 0.0 ) );
+    insert.scale( CADVector( -1.0, 1.0, 1.0 ) );
+    polyline.transformFromOCS();
+    polyline.transform( insert );
+    ASSERT_DOUBLE_EQ( -1.0, polyline.getVectExtrusion().getZ() );
+    points.clear();
+    ASSERT_EQ( nCount, tessellator.tessellate( &polyline, points ) ? points.size() : 0 );
+    ASSERT_NEAR( 10.0, points.getXs()[0], 1e-12 );
+    ASSERT_NEAR( 8.0, points.getXs()[1], 1e-12 );
+    ASSERT_NEAR( 8.0, points.getXs()[2], 1e-12 );
+    ASSERT_NEAR( 2.0, points.getYs()[2], 1e-12 );
+    ASSERT_NEAR( 10.0, points.getXs()[2 + nArcSegments], 1e-12 );
+    for( size_t i = 3; i < 2 + nArcSegments; ++i )
+    {
+        ASSERT_NEAR( 1.0, hypot( points.getXs()[i] - 9.0, points.getYs()[i] - 2.0 ), 1e-12 );
+        ASSERT_GT( points.getYs()[i], 2.0 );
+    }
+
+    // Polyline read with extrusion along -Z and elevation 5 is mirrored and
+    // lies at -5 in WCS.
+    CADLWPolyline ocsPolyline;
+    ocsPolyline.addVertex( CADVector( 2.0, 0.0 ) );
+    ocsPolyline.addVertex( CADVector( 0.0, 0.0 ) );
+    ocsPolyline.setBulges( { 1.0, 0.0 } );
+    ocsPolyline.setVectExtrusion( CADVector( 0.0, 0.0, -1.0 ) );
+    ocsPolyline.setElevation( 5.0 );
+    ocsPolyline.transformFromOCS();
+    points.clear();
+    ASSERT_TRUE( tessellator.tessellate( &ocsPolyline, points ) );
+    ASSERT_TRUE( points.hasZ() );
+    ASSERT_NEAR( -2.0, points.getXs().front(), 1e-12 );
+    ASSERT_NEAR( 0.0, points.getXs().back(), 1e-12 );
+    for( size_t i = 1; i + 1 < points.size(); ++i )
+    {
+        ASSERT_NEAR( -5.0, points.getZs()[i], 1e-12 );
+        ASSERT_GT( points.getYs()[i], 0.0 );
+    }
+}
+
+TEST(geometry, wkb_writer)
+{
+    CADLine line( CADPoint3D( CADVector( 1.0, 2.0, 3.0 ), 0.0 ), CADPoint3D( CADVector( 4.0, 5.0, 6.0 ), 0.0 ) );
+
+    uint32_t nType, nCount;
+    double   dfValue;
+    vector<uint8_t> buffer;
+    CADWKBWriter    iso( CADWKBWriter::ISO, false );
+    ASSERT_TRUE( iso.write( &line, buffer ) );
+    ASSERT_EQ( 1 + 4 + 4 + 2 * 2 * 8, buffer.size() );
+    memcpy( &nType, buffer.data() + 1, 4 );
+    memcpy( &nCount, buffer.data() + 5, 4 );
+    memcpy( &dfValue, buffer.data() + 9 + 3 * 8, 8 );
+    ASSERT_EQ( 2, nType );
+    ASSERT_EQ( 2, nCount );
+    ASSERT_EQ( 5.0, dfValue );
+
+    // Appended after the first one
+    iso.setZ( true );
+    ASSERT_TRUE( iso.write( &line, buffer ) );
+    memcpy( &nType, buffer.data() + 41 + 1, 4 );
+    ASSERT_EQ( 1002, nType );
+    ASSERT_EQ( 41 + 1 + 4 + 4 + 2 * 3 * 8, buffer.size() );
+
+    buffer.clear();
+    CADWKBWriter ewkb( CADWKBWriter::EWKB );
+    ewkb.setSRID( 4326 );
+    // Solid read in mirrored OCS at elevation 1
+    CADSolid solid;
+    solid.setExtrusion( CADVector( 0.0, 0.0, -1.0 ) );
+    solid.setElevation( 1.0 );
+    solid.addCorner( CADVector( 0.0, 0.0 ) );
+    solid.addCorner( CADVector( 1.0, 0.0 ) );
+    solid.addCorner( CADVector( 0.0, 1.0 ) );
+    solid.addCorner( CADVector( 1.0, 1.0 ) );
+    solid.transformFromOCS();
+    ASSERT_TRUE( ewkb.write( &solid, buffer ) );
+    uint32_t nSRID, nRings;
+    memcpy( &nType, buffer.data() + 1, 4 );
+    memcpy( &nSRID, buffer.data() + 5, 4 );
+    memcpy( &nRings, buffer.data() + 9, 4 );
+    memcpy( &nCount, buffer.data() + 13, 4 );
+    ASSERT_EQ( 0xA0000003, nType );
+    ASSERT_EQ( 4326, nSRID );
+    ASSERT_EQ( 1, nRings );
+    ASSERT_EQ( 5, nCount );
+    ASSERT_EQ( 17 + 5 * 3 * 8, buffer.size() );
+    // Third point of the outline is the fourth corner, (-1,1,-1) in WCS
+    memcpy( &dfValue, buffer.data() + 17 + 2 * 24, 8 );
+    ASSERT_EQ( -1.0, dfValue );
+    memcpy( &dfValue, buffer.data() + 17 + 2 * 24 + 8, 8 );
+    ASSERT_EQ( 1.0, dfValue );
+    memcpy( &dfValue, buffer.data() + 17 + 2 * 24 + 16, 8 );
+    ASSERT_EQ( -1.0, dfValue );
+
+    CADRay ray;
+    size_t nSize = buffer.size();
+    ASSERT_FALSE( ewkb.write( &ray, buffer ) );
+    ASSERT_EQ( nSize, buffer.size() );
+}
+
+TEST(geometry, geojson_writer)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                   CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+
+    ostringstream oStream;
+    {
+        CADGeoJSONWriter writer( oStream, CADGeoJSONWriter::NDJSON );
+        ASSERT_EQ( openedDwg->GetLayer( 0 ).getGeometryCount(), writer.writeFile( *openedDwg ) );
+    }
+    string osJSON = oStream.str();
+    ASSERT_EQ( openedDwg->GetLayer( 0 ).getGeometryCount(),
+               static_cast<size_t>( count( osJSON.begin(), osJSON.end(), '\n' ) ) );
+    ASSERT_EQ( 0u, osJSON.find( "{\"type\":\"Feature\",\"geometry\":{\"type\":\"LineString\",\"coordinates\":[[" ) );
+    ASSERT_NE( string::npos, osJSON.find( "\"properties\":{\"layer\":\"0\"," ) );
+
+    // Coordinates are written with the shortest round trip precision
+    CADPoint3D point( CADVector( 0.1, 1.0 / 3 ), 0.0 );
+    ostringstream oCollection;
+    CADGeoJSONWriter writer( oCollection );
+    ASSERT_TRUE( writer.writeFeature( &point, openedDwg->GetLayer( 0 ) ) );
+    CADRay ray;
+    ASSERT_FALSE( writer.writeFeature( &ray, openedDwg->GetLayer( 0 ) ) );
+    writer.finish();
+    string osCollection = oCollection.str();
+    ASSERT_EQ( 0u, osCollection.find( "{\"type\":\"FeatureCollection\",\"features\":[\n"
+                                      "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\","
+                                      "\"coordinates\":[0.1,0.3333333333333333]}" ) );
+    ASSERT_EQ( osCollection.size() - 4, osCollection.rfind( "\n]}\n" ) );
+
+    delete openedDwg;
+}
+
+TEST(geometry, flatgeobuf_writer)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/24127_circles_128_lines.dwg",
+                                   CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+
+    CADLayer& layer = openedDwg->GetLayer( 0 );
+    ostringstream oStream;
+    CADFlatGeobufWriter writer;
+    ASSERT_EQ( layer.getGeometryCount(), writer.writeLayer( layer, oStream ) );
+    string osData = oStream.str();
+    ASSERT_EQ( 0, memcmp( osData.data(), "fgb\003fgb\000", 8 ) );
+
+    // Index levels have 24255, 1516, 95, 6 and 1 nodes
+    uint32_t nHeaderSize;
+    memcpy( &nHeaderSize, osData.data() + 8, 4 );
+    size_t nIndex    = 12 + nHeaderSize;
+    size_t nFeatures = nIndex + ( 24255 + 1516 + 95 + 6 + 1 ) * 40;
+    ASSERT_LT( nFeatures, osData.size() );
+
+    // Root covers the whole layer and points to the next level
+    double   adfRoot[4];
+    uint64_t nOffset;
+    memcpy( adfRoot, osData.data() + nIndex, sizeof( adfRoot ) );
+    memcpy( &nOffset, osData.data() + nIndex + 32, 8 );
+    ASSERT_EQ( 1u, nOffset );
+    const CADBoundingBox& extents = layer.getExtents();
+    ASSERT_NEAR( extents.getMinX(), adfRoot[0], 1e-6 );
+    ASSERT_NEAR( extents.getMaxY(), adfRoot[3], 1e-6 );
+
+    // First leaf points to the first feature, features are size prefixed
+    size_t   nFirstLeaf = nIndex + ( 1 + 6 + 95 + 1516 ) * 40;
+    uint32_t nFeatureSize;
+    memcpy( &nOffset, osData.data() + nFirstLeaf + 32, 8 );
+    ASSERT_EQ( 0u, nOffset );
+    memcpy( &nOffset, osData.data() + nFirstLeaf + 40 + 32, 8 );
+    memcpy( &nFeatureSize, osData.data() + nFeatures, 4 );
+    ASSERT_EQ( nFeatureSize + 4, nOffset );
+
+    delete openedDwg;
+}
+
+TEST(geometry, thread_pool)
+{
+    CADThreadPool pool( 4 );
+    ASSERT_EQ( 4u, pool.getThreadCount() );
+    vector<size_t> values( 1000 );
+    for( int nPass = 0; nPass < 3; ++nPass )
+    {
+        pool.parallelFor( values.size(), [&values, nPass]( size_t i ) { values[i] = i * nPass; } );
+        for( size_t i = 0; i < values.size(); ++i )
+            ASSERT_EQ( i * nPass, values[i] );
+    }
+}
+
+TEST(geometry, vector_tiles)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                   CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+
+    CADVectorTileWriter writer( 2 );
+    writer.setZoomRange( 0, 3 );
+    ASSERT_EQ( openedDwg->GetLayer( 0 ).getGeometryCount(), writer.addFile( *openedDwg ) );
+
+    // Tile has one layer (field 3) named "0" of version 2
+    string osTile;
+    ASSERT_TRUE( writer.writeTile( 0, 0, 0, osTile ) );
+    ASSERT_EQ( 0x1A, osTile[0] );
+    ASSERT_NE( string::npos, osTile.find( string( "\x78\x02\x0A\x01" "0", 5 ) ) );
+    ASSERT_FALSE( writer.writeTile( 1, 2, 0, osTile ) );
+
+    // Zoom 0 tile is the same whichever way it is made
+    string osZoom0;
+    size_t nTiles = writer.generate( [&osZoom0]( int z, int, int, const string& tile ) {
+        if( z == 0 )
+            osZoom0 = tile;
+    } );
+    ASSERT_LE( 4u, nTiles );
+    writer.writeTile( 0, 0, 0, osTile );
+    ASSERT_EQ( osTile, osZoom0 );
+
+    ostringstream oStream;
+    ASSERT_EQ( nTiles, writer.writeFlatFile( oStream ) );
+    string osFile = oStream.str();
+    uint64_t nCount;
+    memcpy( &nCount, osFile.data() + osFile.size() - 16, 8 );
+    ASSERT_EQ( nTiles, nCount );
+    ASSERT_EQ( string( "OCADMVT1" ), osFile.substr( osFile.size() - 8 ) );
+
+    // Tiles come in z/x/y order and segments cover every tile writeTile()
+    // finds not empty
+    writer.setZoomRange( 5, 5 );
+    vector<array<int, 3> > tiles;
+    writer.generate( [&tiles]( int z, int x, int y, const string& ) {
+        tiles.push_back( { { z, x, y } } );
+    } );
+    ASSERT_TRUE( is_sorted( tiles.begin(), tiles.end() ) );
+    size_t nNonEmpty = 0;
+    for( int x = 0; x < 32; ++x )
+        for( int y = 0; y < 32; ++y )
+            if( writer.writeTile( 5, x, y, osTile ) )
+            {
+                ++nNonEmpty;
+                ASSERT_TRUE( binary_search( tiles.begin(), tiles.end(), array<int, 3>{ { 5, x, y } } ) );
+            }
+    ASSERT_EQ( nNonEmpty, tiles.size() );
+
+    // Directory can't be made inside a file
+    ASSERT_EQ( 0u, writer.writeDirectory( "./data/r2000/triple_circles.dwg/tiles" ) );
+
+    delete openedDwg;
+}
+
+TEST(geometry, levels_of_detail)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/24127_circles_128_lines.dwg",
+                                   CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+
+    CADLayer& layer = openedDwg->GetLayer( 0 );
+    ASSERT_FALSE( layer.getLevelsOfDetail().isBuilt() );
+    layer.buildLevelsOfDetail( { 8.0, 0.5, 2.0 } );
+    const CADLevelOfDetail& lod = layer.getLevelsOfDetail();
+    ASSERT_TRUE( lod.isBuilt() );
+    ASSERT_EQ( layer.getGeometryCount(), lod.getGeometryCount() );
+    ASSERT_EQ( 4u, lod.getLevelCount() );
+    ASSERT_EQ( 2.0, lod.getTolerance( 2 ) );
+    ASSERT_EQ( 0u, lod.selectLevel( 0.1 ) );
+    ASSERT_EQ( 1u, lod.selectLevel( 1.0 ) );
+    ASSERT_EQ( 3u, lod.selectLevel( 100.0 ) );
+
+    // Coarser levels keep fewer vertexes, simplified lines stay within the
+    // tolerance from all original vertexes
+    const double * padfX = lod.getVertexes().getXs().data();
+    const double * padfY = lod.getVertexes().getYs().data();
+    size_t nFull = 0, nCoarse = 0;
+    for( size_t i = 0; i < lod.getGeometryCount(); i += 7 )
+    {
+        size_t nPrevCount = lod.getVertexCount( i );
+        size_t nFirst     = lod.getFirstVertex( i );
+        nFull += nPrevCount;
+        for( size_t nLevel = 1; nLevel < lod.getLevelCount(); ++nLevel )
+        {
+            size_t nCount;
+            const uint32_t * panIndexes = lod.getIndexes( i, nLevel, nCount );
+            ASSERT_LE( nCount, nPrevCount );
+            nPrevCount = nCount;
+            if( nLevel == 3 )
+                nCoarse += nCount;
+            if( panIndexes == nullptr )
+                continue;
+            ASSERT_EQ( 0u, panIndexes[0] );
+            ASSERT_EQ( lod.getVertexCount( i ) - 1, panIndexes[nCount - 1] );
+            for( size_t j = 0; j + 1 < nCount; ++j )
+            {
+                double ax = padfX[nFirst + panIndexes[j]], ay = padfY[nFirst + panIndexes[j]];
+                double dx = padfX[nFirst + panIndexes[j + 1]] - ax, dy = padfY[nFirst + panIndexes[j + 1]] - ay;
+                for( uint32_t k = panIndexes[j] + 1; k < panIndexes[j + 1]; ++k )
+                {
+                    double px = padfX[nFirst + k] - ax, py = padfY[nFirst + k] - ay;
+                    double dfLength2 = dx * dx + dy * dy;
+                    double t = dfLength2 > 0 ? max( 0.0, min( 1.0, ( px * dx + py * dy ) / dfLength2 ) ) : 0.0;
+                    ASSERT_LE( hypot( px - t * dx, py - t * dy ), lod.getTolerance( nLevel ) + 1e-9 );
+                }
+            }
+        }
+    }
+    ASSERT_LT( nCoarse, nFull );
+
+    CADVertexArray points;
+    size_t nCount;
+    lod.getIndexes( 0, 3, nCount );
+    ASSERT_EQ( nCount, lod.getVertexes( 0, 3, points ) );
+    ASSERT_EQ( nCount, points.size() );
+
+    layer.buildLevelsOfDetail( { 2.0 }, CADLevelOfDetail::VISVALINGAM );
+    ASSERT_EQ( 2u, lod.getLevelCount() );
+    size_t nVisvalingam = 0;
+    for( size_t i = 0; i < lod.getGeometryCount(); ++i )
+    {
+        lod.getIndexes( i, 1, nCount );
+        ASSERT_LE( nCount, lod.getVertexCount( i ) );
+        nVisvalingam += nCount;
+    }
+    ASSERT_LT( nVisvalingam, lod.getVertexes().size() );
+
+    delete openedDwg;
+}
+
+TEST(geometry, rasterizer)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                   CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+
+    CADRasterizer single( 1 );
+    ASSERT_EQ( 3u, single.addFile( *openedDwg ) );
+    vector<uint8_t> image;
+    single.render( 300, 200, image );
+    ASSERT_EQ( 300u * 200u * 4u, image.size() );
+    size_t nDrawn = 0;
+    for( size_t i = 0; i < image.size(); i += 4 )
+    {
+        ASSERT_EQ( 255, image[i + 3] );
+        if( image[i] != 255 || image[i + 1] != 255 || image[i + 2] != 255 )
+            ++nDrawn;
+    }
+    ASSERT_GT( nDrawn, 300u );
+
+    // Tiles are independent, thread count doesn't change the image
+    CADRasterizer parallel( 4 );
+    parallel.addFile( *openedDwg );
+    vector<uint8_t> parallelImage;
+    parallel.render( 300, 200, parallelImage );
+    ASSERT_TRUE( image == parallelImage );
+
+    ostringstream ppm;
+    ASSERT_TRUE( CADRasterizer::writePPM( ppm, image, 300, 200 ) );
+    ASSERT_EQ( 0u, ppm.str().find( "P6\n300 200\n255\n" ) );
+    ASSERT_EQ( 15u + 300u * 200u * 3u, ppm.str().size() );
+
+    ostringstream png;
+    ASSERT_TRUE( CADRasterizer::writePNG( png, image, 300, 200 ) );
+    string osPNG = png.str();
+    ASSERT_EQ( 0, memcmp( osPNG.data(), "\211PNG\r\n\032\n", 8 ) );
+    ASSERT_EQ( 0, memcmp( osPNG.data() + 12, "IHDR", 4 ) );
+    ASSERT_EQ( 0, memcmp( osPNG.data() + osPNG.size() - 8, "IEND", 4 ) );
+    ASSERT_LT( osPNG.size(), image.size() / 4 );
+    ASSERT_FALSE( CADRasterizer::writePNG( png, image, 301, 200 ) );
+
+    // Layer color and background
+    RGBColor black = { 0, 0, 0 };
+    parallel.clear();
+    parallel.setBackground( black, 0 );
+    parallel.setColorMode( CADRasterizer::LAYER_COLOR );
+    parallel.addLayer( openedDwg->GetLayer( 0 ) );
+    parallel.render( 64, 64, parallelImage );
+    RGBColor layerColor = CADACIColors[abs( openedDwg->GetLayer( 0 ).getColor() ) % 256];
+    size_t nLayerColored = 0;
+    for( size_t i = 0; i < parallelImage.size(); i += 4 )
+    {
+        if( parallelImage[i + 3] == 0 )
+            continue;
+        ASSERT_EQ( layerColor.R, parallelImage[i] );
+        ASSERT_EQ( layerColor.G, parallelImage[i + 1] );
+        ASSERT_EQ( layerColor.B, parallelImage[i + 2] );
+        ++nLayerColored;
+    }
+    ASSERT_GT( nLayerColored, 0u );
+
+    delete openedDwg;
+}
+
+// Writes single geometries
+class CADSVGGeometryWriter : public CADSVGWriter
+{
+public:
+    explicit CADSVGGeometryWriter( ostream& stream ) : CADSVGWriter( stream ) {}
+    using CADSVGWriter::start;
+    using CADSVGWriter::writeGeometry;
+};
+
+TEST(geometry, svg_writer)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                   CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+
+    ostringstream stream;
+    {
+        CADSVGWriter writer( stream );
+        ASSERT_EQ( 3u, writer.writeFile( *openedDwg ) );
+    }
+    string osSVG = stream.str();
+    ASSERT_EQ( 0u, osSVG.find( "<?xml" ) );
+    ASSERT_NE( string::npos, osSVG.find( "viewBox=\"-24.5 -20 44.5 36.6\"" ) );
+    ASSERT_NE( string::npos, osSVG.find( "<g id=\"0\"" ) );
+    ASSERT_NE( string::npos, osSVG.find( "<circle cx=\"10\" cy=\"10\" r=\"10\"/>" ) );
+    ASSERT_EQ( osSVG.size() - 12, osSVG.rfind( "</g>\n</svg>\n" ) );
+    delete openedDwg;
+
+    // Polylines are merged into one path with relative coordinates
+    openedDwg = OpenCADFile ("./data/r2000/256_lwpolylines_7vertexes.dwg",
+                             CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    ostringstream polylines;
+    CADSVGWriter writer( polylines, 1 );
+    ASSERT_EQ( 256u, writer.writeFile( *openedDwg ) );
+    writer.finish();
+    ASSERT_EQ( 0u, writer.writeLayer( openedDwg->GetLayer( 0 ) ) );
+    string osPolylines = polylines.str();
+    size_t nStart = osPolylines.find( " d=\"M" );
+    ASSERT_NE( string::npos, nStart );
+    string osPath = osPolylines.substr( nStart + 4, osPolylines.find( '"', nStart + 4 ) - nStart - 4 );
+    ASSERT_EQ( 255, count( osPath.begin(), osPath.end(), 'm' ) );
+    ASSERT_EQ( string::npos, osPath.find_first_not_of( "Mmlz0123456789.- " ) );
+    size_t nPoint = osPath.find( '.' );
+    ASSERT_TRUE( nPoint == string::npos || osPath.find_first_of( "0123456789", nPoint + 2 ) != nPoint + 2 );
+    delete openedDwg;
+
+    ostringstream empty;
+    {
+        CADSVGWriter emptyWriter( empty );
+    }
+    ASSERT_NE( string::npos, empty.str().find( "viewBox=\"0 -1 1 1\"" ) );
+
+    // Entities read in mirrored OCS or mirrored by block reference
+    ostringstream mirrored;
+    {
+        CADSVGGeometryWriter mirroredWriter( mirrored );
+        mirroredWriter.start( CADBoundingBox() );
+        RGBColor red = { 255, 0, 0 };
+
+        CADCircle circle;
+        circle.setPosition( CADVector( 5.0, 0.0 ) );
+        circle.setExtrusion( CADVector( 0.0, 0.0, -1.0 ) );
+        circle.setRadius( 1.0 );
+        circle.setColor( red );
+        circle.transformFromOCS();
+        ASSERT_TRUE( mirroredWriter.writeGeometry( &circle ) );
+
+        CADArc arc;
+        arc.setPosition( CADVector( 5.0, 0.0 ) );
+        arc.setExtrusion( CADVector( 0.0, 0.0, -1.0 ) );
+        arc.setRadius( 1.0 );
+        arc.setColor( red );
+        arc.setStartingAngle( 0.0 );
+        arc.setEndingAngle( M_PI / 2 );
+        arc.transformFromOCS();
+        ASSERT_TRUE( mirroredWriter.writeGeometry( &arc ) );
+
+        Matrix insert;
+        insert.translate( CADVector( 10.0, 0.0, 0.0 ) );
+        insert.scale( CADVector( -1.0, 1.0, 1.0 ) );
+        CADLWPolyline polyline;
+        polyline.addVertex( CADVector( 0.0, 0.0 ) );
+        polyline.addVertex( CADVector( 2.0, 0.0 ) );
+        polyline.setBulges( { 1.0, 0.0 } );
+        polyline.setColor( red );
+        polyline.transformFromOCS();
+        polyline.transform( insert );
+        ASSERT_TRUE( mirroredWriter.writeGeometry( &polyline ) );
+    }
+    string osMirrored = mirrored.str();
+    ASSERT_NE( string::npos, osMirrored.find( "<circle cx=\"-5\" cy=\"0\" r=\"1\"" ) ) << osMirrored;
+    // Both arcs go clockwise in the drawing: from (-6,0) to (-5,1) and from
+    // (10,0) to (8,0) below the chord.
+    ASSERT_NE( string::npos, osMirrored.find( "d=\"M-6 0a1 1 0 0 0 1 1m15-1a1 1 0 0 0-2 0\"" ) ) << osMirrored;
+}